@@ -42,6 +42,15 @@ Iribane, J.V., and W.L. Godson, 1981. Atmospheric Thermodynamics. 2nd
 #define PPFD50      75.0     /* (umol/m2/s) PPFD for 1/2 stomatal closure */
 #define Q10_VALUE	2.0      /* q10 value for respiration calculation */
 
+/* tabulated temperature response functions (tempresp.c) */
+#define TR_Q10_MR       0    /* maintenance respiration Q10 (Q10_VALUE, 20 C reference) */
+#define TR_LLOYDTAYLOR  1    /* Lloyd-Taylor decomposition scalar (25 C reference) */
+#define TR_PSN_KO       2    /* temperature factor of Ko (photosynthesis) */
+#define TR_PSN_KC       3    /* temperature factor of Kc (photosynthesis) */
+#define TR_PSN_ACT      4    /* temperature factor of Rubisco activity (photosynthesis) */
+#define TR_PSN_KP       5    /* temperature factor of PEP carboxylase Kp (photosynthesis) */
+#define N_TEMPRESP      6    /* number of tabulated response functions */
+
 /* precision control */
 /* This constant determines the lower limit of state variables before they
 are set to 0.0 to control rounding and overflow errors */
@@ -70,6 +70,14 @@ int maint_resp(const cstate_struct* cs, const nstate_struct* ns, const epconst_s
 int canopy_et(const epconst_struct* epc, const metvar_struct* metv, epvar_struct* epv, wflux_struct* wf);
 int penmon(const pmet_struct* in, int out_flag,	double* et);
 int photosynthesis(const epconst_struct* epc, const metvar_struct* metv, psn_struct* psn);
+/* batched photosynthesis of n leaf classes (e.g. sunlit and shaded canopy fractions) */
+int photosynthesis_n(const epconst_struct* epc, const metvar_struct* metv, psn_struct* const psn[], int n);
+
+/* tabulated temperature response functions (TR_* in bgc_constants.h) */
+double tempresp(int func, double t);
+double tempresp_exact(int func, double t);
+double tempresp_maxrelerr(int func);
+
 int decomp(const metvar_struct* metv, const epconst_struct* epc, epvar_struct* epv, 
 	const siteconst_struct* sitec, cstate_struct* cs, cflux_struct* cf,
 nstate_struct* ns, nflux_struct* nf, ntemp_struct* nt);
@@ -82,22 +90,17 @@ int spinup_daily_allocation(const epconst_struct* epc, const siteconst_struct* s
 							epvar_struct* epv, ntemp_struct* nt, double naddfrac);
 int annual_rates(const epconst_struct* epc, epvar_struct* epv);
 int growth_resp(epconst_struct* epc, cflux_struct* cf);
-/* Hidy 2010 - plus/new input variables */
-int daily_water_state_update(wflux_struct* wf, wstate_struct* ws);
-/* Hidy 2010 - plus/new input variables */
-int daily_carbon_state_update(cflux_struct* cf, cstate_struct* cs, int alloc, int woody, int evergreen);
-/* Hidy 2010 - plus/new input variables */
-int daily_nitrogen_state_update(const epconst_struct* epc, nflux_struct* nf, nstate_struct* ns, int alloc, int woody, int evergreen);
+/* daily update of the water, carbon and nitrogen state variables (table-driven) */
+int daily_state_update(const epconst_struct* epc, wflux_struct* wf, wstate_struct* ws, cflux_struct* cf, cstate_struct* cs,
+	                   nflux_struct* nf, nstate_struct* ns, int alloc, int woody, int evergreen);
 
 
 /* Hidy 2010 - plus/new input variables */
 int mortality(const control_struct* ctrl, const epconst_struct* epc, cstate_struct* cs, cflux_struct* cf,
 	nstate_struct* ns, nflux_struct* nf, int simyr);	
 
-/* Hidy 2010 - plus/new input variables */
-int check_water_balance(wstate_struct* ws, int first_balance);
-int check_carbon_balance(cstate_struct* cs, int first_balance);
-int check_nitrogen_balance(nstate_struct* ns, int first_balance);
+/* end-of-day precision control and water, carbon and nitrogen balance tests */
+int check_balance(wstate_struct* ws, cstate_struct* cs, nstate_struct* ns, int first_balance);
 
 /* Hidy 2010 - plus/new input variables */
 int cnw_summary(int yday, cstate_struct* cs, cflux_struct* cf, nstate_struct* ns, nflux_struct* nf, wflux_struct* wf, epvar_struct* epv, summary_struct* summary);
@@ -108,6 +111,9 @@ int cnw_summary(int yday, cstate_struct* cs, cflux_struct* cf, nstate_struct* ns
 int conduct_calc(const control_struct* ctrl, const metvar_struct* metv, const epconst_struct* epc, const siteconst_struct* sitec, 
 				 epvar_struct* epv, int simyr);
 
+/* conductance factors depending only on the air pressure and [CO2]: called whenever metv->pa or metv->co2 is set */
+void conduct_factors(metvar_struct* metv);
+
 /* calculating the water stress days */
 int waterstress_days(int yday, phenology_struct* phen, epvar_struct* epv, epconst_struct* epc);
 
@@ -179,9 +185,30 @@ int fertilizing(const control_struct* ctrl, fertilizing_struct* FRZ,
 int irrigation(const control_struct* ctrl,irrigation_struct* IRG, wstate_struct* ws, wflux_struct* wf);
 
 /* management days - Hidy 2013 */
-int management(const control_struct* ctrl, fertilizing_struct* FRZ, grazing_struct* GRZ, harvesting_struct* HRV, 
+int management(const control_struct* ctrl, mgmcalendar_struct* mgmcal, fertilizing_struct* FRZ, grazing_struct* GRZ, harvesting_struct* HRV, 
 			   mowing_struct* MOW,planting_struct* PLT, ploughing_struct* PLG, thinning_struct* THN, irrigation_struct* IRG);
 
+/* compiled management calendar (mgm_calendar.c) */
+int mgm_calendar_init(const control_struct* ctrl, const fertilizing_struct* FRZ, const grazing_struct* GRZ, const harvesting_struct* HRV,
+			   const mowing_struct* MOW, const planting_struct* PLT, const ploughing_struct* PLG, const thinning_struct* THN,
+			   const irrigation_struct* IRG, mgmcalendar_struct* mgmcal);
+int mgm_calendar_event(mgmcal_struct* cal, int ny, int yday);
+void mgm_calendar_free(mgmcalendar_struct* mgmcal);
+
+/* management submodules of the day, skipping the idle ones (see activity_mask) */
+int mgm_submodules(const control_struct* ctrl, const epconst_struct* epc, siteconst_struct* sitec, metvar_struct* metv, epvar_struct* epv,
+				   const activity_struct* act, planting_struct* PLT, thinning_struct* THN, mowing_struct* MOW, grazing_struct* GRZ,
+				   harvesting_struct* HRV, ploughing_struct* PLG, fertilizing_struct* FRZ,
+				   cflux_struct* cf, nflux_struct* nf, wflux_struct* wf, cstate_struct* cs, nstate_struct* ns, wstate_struct* ws);
+
+/* per-day activity mask; the management structs are NULL in spinup */
+int activity_mask(const metvar_struct* metv, const phenology_struct* phen, const cstate_struct* cs, const nstate_struct* ns,
+				  const wstate_struct* ws, double snowcover_limit, 
+				  const planting_struct* PLT, const thinning_struct* THN, const mowing_struct* MOW, const grazing_struct* GRZ,
+				  const harvesting_struct* HRV, const ploughing_struct* PLG, const fertilizing_struct* FRZ, const irrigation_struct* IRG,
+				  activity_struct* act);
+int activity_compare(const char* name, const double* fast, const double* full, int n);
+
 /* senescence mortality calculation */
 int senescence(const epconst_struct* epc, const grazing_struct* GRZ, 
 			   cstate_struct* cs, cflux_struct* cf, nstate_struct* ns, nflux_struct* nf, epvar_struct* epv);
@@ -192,4 +219,91 @@ int soilb_estimation(double sand, double silt, double* soil_b, double* vwc_sat,d
 
 
 /* empirical estimation of N2O flux */
-int otherGHGflux_estimation(const epconst_struct* epc, double CNR, double BD, double VWC, double T, double* N2O_flux, double* CH4_flux);
\ No newline at end of file
+int otherGHGflux_estimation(const epconst_struct* epc, double CNR, double BD, double VWC, double T, double* N2O_flux, double* CH4_flux);
+
+
+/* process timers of the daily loop (see proftimer.c) */
+#define PT_MANAGEMENT        0
+#define PT_DAYMET            1
+#define PT_TSOIL             2
+#define PT_PHENOLOGY         3
+#define PT_ROOTDEPTH         4
+#define PT_RADTRANS          5
+#define PT_CONDUCT           6
+#define PT_MAINT_RESP        7
+#define PT_CANOPY_ET         8
+#define PT_PHOTOSYNTHESIS    9
+#define PT_TRANSPIRATION     10
+#define PT_DECOMP            11
+#define PT_DAILY_ALLOCATION  12
+#define PT_HYDROLPROCESS     13
+#define PT_RICHARDS          14
+#define PT_TIPPING           15
+#define PT_STATE_UPDATE      16
+#define PT_MGM_SUBMODULES    17
+#define PT_MORTALITY         18
+#define PT_SMINN             19
+#define PT_BALANCE           20
+#define PT_OUTPUT            21
+#define PT_DAY               22
+#define N_PROFTIMERS         23
+
+extern int proftimer_on;
+#define PROF_BEGIN(id) do { if (proftimer_on) proftimer_begin(id); } while (0)
+#define PROF_END(id)   do { if (proftimer_on) proftimer_end(id); } while (0)
+
+void proftimer_init(int counters);
+void proftimer_begin(int id);
+void proftimer_end(int id);
+int proftimer_report(const char* logname);
+
+/* hardware performance counters of the process timers (see perfcount.c) */
+#define PC_CYCLES            0
+#define PC_INSTRUCTIONS      1
+#define PC_CACHE_MISSES      2
+#define PC_BRANCH_MISSES     3
+#define N_PERFCOUNTERS       4
+
+extern int perfcount_on;
+int perfcount_open(char* message, int len);
+void perfcount_read(unsigned long long* count);
+int perfcount_available(int id);
+double perfcount_running(void);
+void perfcount_close(void);
+
+
+/* recording of the process routines for the micro-benchmarks (see kernelrec.c) */
+#define KR_PHOTOSYNTHESIS    0
+#define KR_RICHARDS          1
+#define KR_DECOMP            2
+#define KR_TSOIL             3
+#define KR_CANOPY_ET         4
+#define KR_RUN_AVG           5
+#define N_KERNELS            6
+#define KREC_MAXARGS         12
+#define KREC_MAGIC           "MUSOKREC"
+#define KREC_VERSION         1
+
+/* argument of kernelrec_in: pointer and size of a variable */
+#define KR_ARG(x) (const void*) &(x), sizeof(x)
+
+extern int kernelrec_on;
+extern const char* kernelrec_name[N_KERNELS];
+int kernelrec_open(const char* name);
+void kernelrec_in(int id, int nblock, ...);
+void kernelrec_out(int id);
+void kernelrec_run_avg(const double* input, const double* output, int n, int w, int w_flag);
+int kernelrec_close(void);
+
+
+/* timeline of the run in the Chrome trace format (see trace.c) */
+extern int trace_on;
+#define TRACE_BEGIN(name)          do { if (trace_on) trace_event('B', name, -1); } while (0)
+#define TRACE_END(name)            do { if (trace_on) trace_event('E', name, -1); } while (0)
+#define TRACE_BEGIN_YEAR(name, yr) do { if (trace_on) trace_event('B', name, yr); } while (0)
+#define TRACE_END_YEAR(name, yr)   do { if (trace_on) trace_event('E', name, yr); } while (0)
+
+int trace_open(const char* name, const char* site);
+void trace_fork(const char* scenario);
+void trace_event(char ph, const char* name, int year);
+int trace_close(void);
@@ -53,6 +53,7 @@ typedef struct
 	int spinup_years;       /* number of years before reaching steady-state */
 	file control_file;
 	file log_file;
+	int scenario;           /* scenario of the process: 0 = base run, k = scenarios[k-1] */
 } bgcout_struct;
 
 /* function prototypes for calling bgc */
@@ -60,3 +61,30 @@ int bgc(bgcin_struct* bgcin, bgcout_struct* bgcout);
 int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout);
 /* Hidy 2014 - transient run */
 int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout);
+
+/* point driver initialization: from the init file or from a binary bundle (muso-compile) */
+int pointbgc_init(const char* ininame, bgcin_struct* bgcin, point_struct* point,
+				  restart_ctrl_struct* restart, output_struct* output);
+int bundle_write(const char* name, bgcin_struct* bgcin, point_struct* point,
+				 restart_ctrl_struct* restart, output_struct* output);
+int bundle_read(const char* name, bgcin_struct* bgcin, point_struct* point,
+				restart_ctrl_struct* restart, output_struct* output);
+int bundle_probe(const char* name);
+
+/* scenario branching of a normal run (fork at the branch year) */
+int scenario_parse(const char* arg, scenario_struct* scenario);
+int scenario_apply(const scenario_struct* scenario, epconst_struct* epc, siteconst_struct* sitec,
+				   metarr_struct* metarr, int ndays);
+int scenario_filename(char* name, const char* suffix);
+int scenario_branch(const control_struct* ctrl, bgcout_struct* bgcout);
+int scenario_wait(void);
+
+/* progress and throughput of the run in a status file (see runstatus.c) */
+extern int runstatus_on;
+int runstatus_open(const char* name, const char* site);
+void runstatus_fork(const char* scenario);
+void runstatus_phase(const char* phase, int years_total);
+void runstatus_year(int years_done, const control_struct* ctrl, const bgcout_struct* bgcout);
+void runstatus_spinup(double trend, int steady1, int steady2);
+void runstatus_children(int n);
+int runstatus_close(int ok);
@@ -22,8 +22,16 @@ element ndep_array (array). Changes are made by Galina Churkina adn Dora Hidy (2
 #define N_POOLS 3			/* Hidy 2010 - number of type of pools: water, carbon, nitrogen */
 #define N_MGMDAYS 7			/* Hidy 2013 - number of type of management events in a single year */
 #define N_SOILLAYERS 7		/* Hidy 2013 - number of type of soil layers in multilayer soil module */
+#define MAX_SCENARIOS 64		/* maximum number of scenario branches of a run */
 
 
+/* scenario branch of a normal run (see scenario.c) */
+typedef struct
+{
+	char name[32];         /* name of the scenario, suffix of its output files */
+	char file[128];        /* scenario definition file (parameter overrides and climate change) */
+} scenario_struct;
+
 /* simulation control variables */
 typedef struct
 {
@@ -32,6 +40,10 @@ typedef struct
     int simstartyear;      /* first year of simulation */
 	int spinup;            /* (flag) 1=spinup run, 0=normal run */
 	int maxspinyears;      /* maximum number of years for spinup run */
+	int spinup_early;      /* (flag) 1=stop the spinup at a met cycle boundary when converged, 0=block test only */
+	double spinup_abstol;  /* (kgC/m2/yr) tolerance of the soil C and total C trends of the early stop */
+	double spinup_reltol;  /* (1/yr) tolerance of the relative trends of the pools, 0=not used */
+	int spinup_ncycle;     /* number of convergence windows in a row meeting the criteria */
 	int dodaily;           /* flag for daily output */
 	int domonavg;          /* flag for monthly average of daily outputs */
 	int doannavg;          /* flag for annual average of daily outputs */
@@ -65,6 +77,10 @@ typedef struct
 	int varSGS_flag;	     /* Hidy 2012 - changing WPM value */
 	int varEGS_flag;	     /* Hidy 2012 - changing WPM value */
 	int GWD_flag;			 /* Hidy 2012 - using gorundwater depth */
+	int branch_simyr;	     /* simulation year of the scenario branching (-1: no branching) */
+	int nscenario;		     /* number of scenario branches */
+	scenario_struct* scenarios; /* scenario branches */
+	char* phencache_dir;	 /* directory of the phenology signal cache files (NULL: cache in memory only) */
 } control_struct;
 
 /* a structure to hold information about varied N-deposition scenario */
@@ -138,6 +154,8 @@ typedef struct
 	double parabs;							 /* (W/m2)  PAR absorbed by canopy */
 	double pa;								 /* (Pa)    atmospheric pressure */
 	double co2;								 /* (ppm)   atmospheric concentration of CO2 */
+	double pcorr;							 /* (DIM)   pressure correction of the conductances (set with pa) */
+	double m_co2;							 /* (DIM)   CO2 multiplier of the max. stomatal conductance (set with co2) */
 	double dayl;							 /* (s)     daylength */
 	double GDD;								 /* (Celsius) growing degree day */
 } metvar_struct;
@@ -1142,16 +1160,29 @@ typedef struct
 	double kl4;
 } ntemp_struct;
 	
+/* phenological signals of one phenological year, the daily signals are
+derived from these in dayphen() */
+typedef struct
+{
+	short onday;			/* first day of the growth period (phenological yday, -1: no growth) */
+	short offday;			/* last day of the litfall period (phenological yday, -1: no growth) */
+	short ntransfer;		/* number of transfer days */
+	short nlitfall;			/* number of litfall days */
+} phenyear_struct;
+
 /* phenological control arrays */
 typedef struct
 {
-	int* remdays_curgrowth; /* (nmetdays) days left in current growth season */
-	int* remdays_transfer;  /* (nmetdays) number of transfer days remaining */
-	int* remdays_litfall;   /* (nmetdays) number of litfall days remaining */
-	int* predays_transfer;  /* (nmetdays) number of transfer days previous */
-	int* predays_litfall;   /* (nmetdays) number of litfall days previous */
+	phenyear_struct* phenyear; /* (nphenyears) phenological signals of the phenological years */
+	int nphenyears;			/* number of phenological years (metyears+1 for southern sites) */
+	int south;				/* 1: phenological years start on yday 182 (southern hemisphere) */
+	int evergreen;			/* 1: evergreen signals (the whole year is growth period) */
 	int* onday_arr;			/* Hidy 2009 - (nmetyears) first day of transfer period */
 	int* offday_arr;		/* Hidy 2009 - (nmetyears) last day of transfer period */
+	int onday_min;			/* minimum of the onday values (log file) */
+	int onday_max;			/* maximum of the onday values (log file) */
+	int offday_min;			/* minimum of the offday values (log file) */
+	int offday_max;			/* maximum of the offday values (log file) */
 } phenarray_struct;
 
 /* daily phenological data array */
@@ -1565,6 +1596,48 @@ typedef struct
 
 } irrigation_struct;
 
+/* compiled management calendar of a management type: sorted day segments per year (mgm_calendar.c) */
+typedef struct
+{
+	int nyears;                                 /* number of years: 1 (constant) or simyears (yearly varied), 0: no management */
+	int* first;                                 /* (array) index of the first segment of the years (nyears+1 elements) */
+	int* start;                                 /* (array) first yday of the segments */
+	int* end;                                   /* (array) last yday of the segments */
+	int* md;                                    /* (array) management event (index of the management arrays) of the segments */
+	int ny;                                     /* cursor: actual year */
+	int yday;                                   /* cursor: last day looked up */
+	int cur;                                    /* cursor: actual segment */
+} mgmcal_struct;
+
+/* compiled management calendars of the management types */
+typedef struct
+{
+	mgmcal_struct FRZ;
+	mgmcal_struct GRZ;
+	mgmcal_struct HRV;
+	mgmcal_struct MOW;
+	mgmcal_struct PLT;
+	mgmcal_struct PLG;
+	mgmcal_struct THN;
+	mgmcal_struct IRG;
+} mgmcalendar_struct;
+
+/* per-day activity mask: processes with work to do on the actual day (activity.c) */
+typedef struct
+{
+	int canopy;                                 /* (flag) leaves displayed in daylight: canopy evapotranspiration */
+	int psn;                                    /* (flag) photosynthesis: canopy active in growing season, no snow cover */
+	int snowmelt;                               /* (flag) snowpack present */
+	int PLT;                                    /* (flag) planting day */
+	int THN;                                    /* (flag) thinning day or thinned material in the temporary pools */
+	int MOW;                                    /* (flag) mowing day, LAI-limit mowing or mowed material in the temporary pools */
+	int GRZ;                                    /* (flag) grazing day */
+	int HRV;                                    /* (flag) harvesting day or harvested material in the temporary pools */
+	int PLG;                                    /* (flag) ploughing day or ploughed material in the ploughing pools */
+	int FRZ;                                    /* (flag) fertilizing day or fertilizer above the ground */
+	int IRG;                                    /* (flag) irrigation day */
+} activity_struct;
+
 /* structure for the photosynthesis routine */
 typedef struct
 {
@@ -1655,6 +1728,31 @@ typedef struct
 
 } summary_struct;
 
+/* spinup convergence tracking (see spinup_conv.c) */
+#define SPC_VEGC    0
+#define SPC_LITRC   1
+#define SPC_SOIL1C  2
+#define SPC_SOIL2C  3
+#define SPC_SOIL3C  4
+#define SPC_SOIL4C  5
+#define SPC_SOILN   6
+#define SPC_SOILC   7
+#define SPC_TOTALC  8
+#define N_SPINPOOLS 9
+
+typedef struct
+{
+	int nwindow;                 /* years of a convergence window (a multiple of metyears) */
+	int nyear;                   /* years summed in the actual window */
+	int spinup_alloc;            /* (flag) the spinup allocation was used in the actual window */
+	int prev_valid;              /* (flag) the previous window is complete and without spinup allocation */
+	double sum[N_SPINPOOLS];     /* (kg/m2 * days) sums of the daily pools in the actual window */
+	double prev[N_SPINPOOLS];    /* (kg/m2) means of the pools in the previous window */
+	double trend[N_SPINPOOLS];   /* (kg/m2/yr) trends of the pools between the last two windows */
+	double maxrel;               /* (1/yr) largest relative trend of the pools */
+	int nconverged;              /* windows in a row meeting the criteria */
+} spinconv_struct;
+
 /* restart data structure */
 typedef struct
 {
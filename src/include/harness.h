@@ -0,0 +1,39 @@
+/*
+harness.h
+test harness of the model runs of muso_bench.c and muso_golden.c (harness.c):
+init files made from the sample inputs by line edits, and the runs of the
+model executable as separate processes
+
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+Biome-BGCMuSo v4.0.2
+Copyright 2016, D. Hidy [dori.hidy@gmail.com]
+Hungarian Academy of Sciences, Hungary
+See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentation, model executable and example input files.
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+*/
+
+#define HARNESS_MAX_EDITS    24
+#define HARNESS_MAX_LINE     4000
+#define HARNESS_MAX_CODES    1000
+
+/* edit of an init file: the first field of the line containing key is replaced by value */
+typedef struct
+{
+	const char* key;     /* part of the line (comment of the value) */
+	const char* value;   /* new value */
+} harness_edit;
+
+/* daily output variables: all the valid codes of output_map_init (ranges of codes) */
+extern const int harness_daycode_range[][2];
+extern const int harness_n_dayranges;
+int harness_ndaycodes(void);
+
+/* variable list of an output section of an init file: codes and descriptions, returns the number of variables (-1: error) */
+int harness_ini_codes(const char* path, const char* section, int* codes, char (*desc)[128], int max);
+
+/* init file of a run: the edited lines and the daily output list (daily: 0 unchanged, -1 every valid
+code, n > 0 the first n valid codes; with the descriptions of the sample), returns 0 if OK */
+int harness_ini_write(const char* src, const char* dst, const harness_edit* edit, int nedit, int daily);
+
+/* one run of the model in dir, with its output in <name>.stdout, wall time (s) and peak RSS (kB) if not NULL */
+int harness_run(const char* muso, const char* dir, const char* name, char* const* args, double* wall, long* rss);
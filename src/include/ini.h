@@ -13,15 +13,26 @@ See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentatio
 *-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
 */
 
+/* in-memory copy of an ascii input file: the scan functions serve the values
+from this buffer instead of calling fscanf for every value */
+typedef struct
+{
+	char *text;          /* whole file content, NUL-terminated (NULL until the first scan) */
+	long pos;            /* read position in text (= file offset) */
+	int line;            /* line number at the read position */
+} file_buffer;
+
 /* structure definition for filename handling */
 typedef struct
 {
 	char name[128];
 	FILE *ptr;
+	file_buffer *buf;    /* read modes only: shared by the copies of the structure */
 } file;
 
 /* function prototypes */
 int file_open (file *target, char mode);
+int file_close (file *target);
 int scan_value (file ini, void *var, char mode);
 int scan_array (file ini, void *var, char mode, int nl);
 int scan_open (file ini,file *target,char mode);
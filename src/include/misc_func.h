@@ -14,3 +14,24 @@ Missoula, MT 59812
 /* function prototypes for smoothing functions */
 int run_avg(const double *input, double *output, int n, int w, int w_flag);
 int boxcar_smooth(double* input, double* output, int n, int w, int w_flag);
+
+/* checksum of binary files (bundle, restart) */
+#define FNV1A_INIT 2166136261u
+unsigned int checksum_fnv1a(const void* data, long n, unsigned int hash);
+
+/* tagged memory allocation (see mem_account.c) */
+#define MEM_MET              0
+#define MEM_PHEN             1
+#define MEM_MGM              2
+#define MEM_OUTPUT           3
+#define MEM_PARAM            4
+#define MEM_INPUT            5
+#define MEM_RESTART          6
+#define N_MEMTAGS            7
+
+void* mem_alloc(int tag, size_t size);
+void* mem_calloc(int tag, size_t n, size_t size);
+void* mem_realloc(int tag, void* p, size_t size);
+void mem_free(void* p);
+void mem_report(FILE* log);
+void mem_free_all(void);
@@ -18,6 +18,9 @@ ndep_init function. Changes are made by Galina Churkina.
 
 int met_init(file init, point_struct* point);
 int restart_init(file init, restart_ctrl_struct* restart);
+int restart_open(restart_ctrl_struct* restart);
+int restart_load(const restart_ctrl_struct* restart, restart_data_struct* data);
+int restart_save(const restart_ctrl_struct* restart, const restart_data_struct* data);
 int time_init(file init, control_struct *ctrl);
 int scc_init(file init, climchange_struct* scc);
 int co2_init(file init, co2control_struct* co2, int simyears);
@@ -29,12 +32,25 @@ int wstate_init(file init, const siteconst_struct* sitec, wstate_struct* ws);
 int cnstate_init(file init, const epconst_struct* epc, cstate_struct* cs,
 	cinit_struct* cinit, nstate_struct* ns);
 int output_init(file init, output_struct* output);
+int output_open(output_struct* output);
 int end_init(file init);
 int metarr_init(file metf, metarr_struct* metarr, const climchange_struct* scc, const siteconst_struct* sitec,int nyears);
 int presim_state_init(wstate_struct* ws, cstate_struct* cs, nstate_struct* ns,
 	cinit_struct* cinit);
 int prephenology(file logfile, const control_struct* ctrl, const epconst_struct* epc, 
 	const siteconst_struct* sitec, const metarr_struct* metarr, phenarray_struct* phenarr);
+/* cached phenological signals (phen_cache.c) */
+int prephenology_cached(file logfile, const control_struct* ctrl, const epconst_struct* epc, 
+	const siteconst_struct* sitec, const metarr_struct* metarr, phenarray_struct* phenarr);
+int GSI_calculation_cached(const metarr_struct* metarr, const control_struct* ctrl, const siteconst_struct* sitec, const epconst_struct* epc, 
+	GSI_struct* GSI, phenarray_struct* phenarr);
+void phen_cache_reset(void);
+/* spinup convergence and early stop (spinup_conv.c) */
+void spinconv_defaults(control_struct* ctrl);
+int spinconv_parse(const char* arg, control_struct* ctrl);
+void spinconv_init(spinconv_struct* conv, const control_struct* ctrl, file logfile);
+void spinconv_day(spinconv_struct* conv, const summary_struct* summary, const cstate_struct* cs);
+int spinconv_year(spinconv_struct* conv, const control_struct* ctrl, int spinup_alloc, int spinyears, file logfile);
 /* limitation factors of conductance calculation - Hidy 2012. */
 int conduct_limit_factors(file logfile, const control_struct* ctrl, const siteconst_struct* sitec, const epconst_struct* epc, epvar_struct* epv);
 
@@ -50,6 +66,8 @@ int planting_init(file init, control_struct* ctrl, planting_struct* PLT);
 int GSI_init(file init, GSI_struct* GSI);
 int read_mgmarray(int simyr, int varMGM, file MGM_file, double*** mgmarray);
 int groundwater_init(siteconst_struct* sitec, control_struct* ctrl);
+int param_override(const char* assignment, epconst_struct* epc, siteconst_struct* sitec);
+int param_override_file(const char* name, epconst_struct* epc, siteconst_struct* sitec);
 
 /* model corrections - Hidy 2009. */
 int GSI_calculation(const metarr_struct* metarr, const control_struct* ctrl, const siteconst_struct* sitec, const epconst_struct* epc, 
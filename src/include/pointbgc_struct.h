@@ -12,6 +12,8 @@ See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentatio
 *-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
 */
 
+#define RESTART_KEYLEN 48     /* max. length (with the closing 0) of a site key in a restart archive */
+
 /* point simulation control parameters */
 typedef struct
 {
@@ -27,6 +29,8 @@ typedef struct
 	int keep_metyr;        /* (flag) 1=retain restart metyr, 0=reset metyr */
 	file in_restart;       /* input restart file */
 	file out_restart;      /* output restart file */
+	char in_key[RESTART_KEYLEN];  /* site key if in_restart is a restart archive ("<archive>#<key>"), else empty */
+	char out_key[RESTART_KEYLEN]; /* site key if out_restart is a restart archive, else empty */
 } restart_ctrl_struct;
 
 /* a structure to hold scalar climate change scenario information */
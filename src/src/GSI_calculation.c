@@ -23,13 +23,15 @@ See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentatio
 #include "bgc_constants.h"
 #include "misc_func.h"
 
+#define GSI_RESYNC_EPS 1e-9     /* running sums below this (but not 0.0) are recomputed */
+
 
 int GSI_calculation(const metarr_struct* metarr, const control_struct* ctrl, const siteconst_struct* sitec, const epconst_struct* epc, 
 					GSI_struct* GSI, phenarray_struct* phenarr)
 
 {
 	int ok=1;
-	int ny, yday, back;
+	int ny, yday, back, pos;
 
 	int firstdayLP = 240;		/* theoretically first day of litterfall */
 
@@ -77,6 +79,15 @@ int GSI_calculation(const metarr_struct* metarr, const control_struct* ctrl, con
 	double GSI_index_SUM = 0;
 	double GSI_index_avg = 0;
 	double GSI_index_total = 0;
+
+	/* indexes of the actual day and ring buffers of the moving period (n_period days) */
+	double tmin_day, vpd_day, dayl_day, heat_day;
+	double drop_GSI, drop_heat;
+	int n_period = n_moving_avg+1;
+	int nrunning = 0;
+	int resync;
+	double* GSI_ring = 0;
+	double* heat_ring = 0;
 	
 	int *onday_arr = 0;
 	int *offday_arr = 0;
@@ -93,7 +104,7 @@ int GSI_calculation(const metarr_struct* metarr, const control_struct* ctrl, con
 	/////////////allocate memory for arrays containing ondays and offdays /////////////////////////////////////
 	if (ok) 
 	{
-		onday_arr = (int*) malloc((nyears+1) * sizeof(int));
+		onday_arr = (int*) mem_alloc(MEM_PHEN, (nyears+1) * sizeof(int));
 		if (!onday_arr)
 		{
 			printf("Error allocating for onday_arr, prephenology()\n");
@@ -102,13 +113,28 @@ int GSI_calculation(const metarr_struct* metarr, const control_struct* ctrl, con
 	}
 	if (ok) 
 	{
-		offday_arr = (int*) malloc((nyears+1) * sizeof(int));
+		offday_arr = (int*) mem_alloc(MEM_PHEN, (nyears+1) * sizeof(int));
 		if (!offday_arr)
 		{
 			printf("Error allocating for offday_arr, prephenology()\n");
 			ok=0;
 		}
 	}
+	if (ok && n_period < 1)
+	{
+		printf("Error: number of days of the moving average must be positive (GSI_calculation.c)\n");
+		ok=0;
+	}
+	if (ok)
+	{
+		GSI_ring = (double*) mem_alloc(MEM_PHEN, n_period * sizeof(double));
+		heat_ring = (double*) mem_alloc(MEM_PHEN, n_period * sizeof(double));
+		if (!GSI_ring || !heat_ring)
+		{
+			printf("Error allocating for moving average buffers, GSI_calculation()\n");
+			ok=0;
+		}
+	}
 		
 	/////////////////////////////////////////////////////////////////////////////////////////////////////////
 	/////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -124,7 +150,7 @@ int GSI_calculation(const metarr_struct* metarr, const control_struct* ctrl, con
 	}
 	////////////////////////////////////////////////////////////////////
 
-	for (ny=0; ny<nyears; ny++)
+	for (ny=0; ok && ny<nyears; ny++)
 	{
 		onday  = 0;
 		offday = 0;
@@ -173,7 +199,57 @@ int GSI_calculation(const metarr_struct* metarr, const control_struct* ctrl, con
 			snowcover += snow_plus;
 
 			/* ******************************************************************* */
-			/* 2. calculation of indexes (based on moving averages of evironmental parameters) */
+			/* 2. calculation of indexes (based on moving averages of evironmental parameters):
+			the indexes of the actual day are calculated once and stored in a ring buffer
+			of the n_moving_avg long period. The sums of the period are running sums, updated
+			with the new and the dropped day. They are added up again from the buffer (from
+			the oldest day, as in the original order of summation) on the first day of the
+			period in the year, after every n_period days, and when a running sum is close
+			to but not 0.0 (e.g. heatsum after a warm period): the rounding of the running
+			sums does not accumulate and a zero period gives 0.0. The diagnostic GSI file of
+			the on-screen mode prints heatsum rounded to 0.1, it is written from the sums
+			added up every day */
+			vpd_act = metarr->vpd[ny*n_yday+yday];
+
+			/* 2.1 heatsum of the day regarding to the basic temperature */
+			if (tavg_act > base_temp) 
+				heat_day = tavg_act-base_temp;
+			else
+				heat_day = 0;
+
+			/* 2.2 indexes of the day regarding to the different variables */
+			/* !!!!!!!!!!!!!!!!!!!!!!!!!!  A: tmin !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! */
+			if (tmin_act < tmin_limit1)
+				tmin_day = 0;
+			else if (tmin_act < tmin_limit2)
+				tmin_day = (tmin_act-tmin_limit1)/(tmin_limit2-tmin_limit1);
+			else
+				tmin_day = 1;
+
+			/* !!!!!!!!!!!!!!!!!!!!!!!!!!!!  B: vpd !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! */
+			if (vpd_act > vpd_limit1)
+				vpd_day = 0;
+			else if (vpd_act > vpd_limit2)
+				vpd_day = (vpd_act-vpd_limit1)/(vpd_limit2-vpd_limit1);
+			else
+				vpd_day = 1;
+
+			/* !!!!!!!!!!!!!!!!!!!!!!!!!!!!!  C: dayl !!!!!!!!!!!!!!!!!!!!!!!!!!! */
+			if (dayl_act < dayl_limit1)
+				dayl_day = 0;
+			else if (dayl_act < dayl_limit2)
+				dayl_day = (dayl_act-dayl_limit1)/(dayl_limit2-dayl_limit1);
+			else
+				dayl_day = 1;
+
+			GSI_index = tmin_day * vpd_day * dayl_day;
+
+			/* 2.3 moving period: the oldest day is replaced by the actual day */
+			pos = yday % n_period;
+			drop_GSI  = GSI_ring[pos];
+			drop_heat = heat_ring[pos];
+			GSI_ring[pos]  = GSI_index;
+			heat_ring[pos] = heat_day;
 
 			if (yday < n_moving_avg)
 			{
@@ -185,84 +261,32 @@ int GSI_calculation(const metarr_struct* metarr, const control_struct* ctrl, con
 			}
 			else
 			{
-				GSI_index_SUM = 0;
-				heatsum_act = 0;
-				for (back=0; back<=n_moving_avg; back++)
+				if (yday == n_moving_avg || ++nrunning >= n_period || ctrl->onscreen)
 				{
-					/* search actual values of variables */
-					tmax_act = metarr->tmax[ny*n_yday+yday-(n_moving_avg-back)];
-					tmin_act = metarr->tmin[ny*n_yday+yday-(n_moving_avg-back)];
-					tavg_act = (tmax_act+tmin_act)/2.;
-					vpd_act  = metarr->vpd[ny*n_yday+yday-(n_moving_avg-back)];
-					dayl_act = metarr->dayl[ny*n_yday+yday-(n_moving_avg-back)];
-					 
-			
-					/* ******************************************************************* */
-					/* 1.1 calculation of heatsum regarding to the basic temperature and n_moving_avg long period */
-					if (tavg_act > base_temp) 
-					{
-						heatsum_act += (tavg_act-base_temp);
-					}
-
-					/* ******************************************************************* */
-					/* 1.2. calculation of indexes regarding to the different variables */
-					/* !!!!!!!!!!!!!!!!!!!!!!!!!!  A: tmin !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! */
-					if (tmin_act < tmin_limit1)
-					{
-						tmin_index=0;
-					}
-					else
-					{
-						if (tmin_act < tmin_limit2)
-						{
-							tmin_index = (tmin_act-tmin_limit1)/(tmin_limit2-tmin_limit1);
-						}
-						else
-						{
-							tmin_index = 1;
-						}
-
-					}
-					/* !!!!!!!!!!!!!!!!!!!!!!!!!!!!  B: vpd !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! */
-					if (vpd_act > vpd_limit1)
-					{
-						vpd_index=0;
-					}
-					else
-					{
-						if (vpd_act > vpd_limit2)
-						{
-							vpd_index = (vpd_act-vpd_limit1)/(vpd_limit2-vpd_limit1);
-						}
-						else
-						{
-							vpd_index = 1;
-						}
-
-					}
-					/* !!!!!!!!!!!!!!!!!!!!!!!!!!!!!  C: dayl !!!!!!!!!!!!!!!!!!!!!!!!!!! */
-					if (dayl_act < dayl_limit1)
-					{
-						dayl_index=0;
-					}
-					else
+					resync = 1;
+				}
+				else
+				{
+					heatsum_act   += heat_day - drop_heat;
+					GSI_index_SUM += GSI_index - drop_GSI;
+					resync = (heatsum_act != 0 && fabs(heatsum_act) < GSI_RESYNC_EPS) ||
+						(GSI_index_SUM != 0 && fabs(GSI_index_SUM) < GSI_RESYNC_EPS);
+				}
+				if (resync)
+				{
+					GSI_index_SUM = 0;
+					heatsum_act   = 0;
+					for (back=0; back<n_period; back++)
 					{
-						if (dayl_act < dayl_limit2)
-						{
-							dayl_index = (dayl_act-dayl_limit1)/(dayl_limit2-dayl_limit1);
-						}
-						else
-						{
-							dayl_index = 1;
-						}
-
+						pos = (yday+1+back) % n_period;
+						heatsum_act   += heat_ring[pos];
+						GSI_index_SUM += GSI_ring[pos];
 					}
-						
-					
-					GSI_index = tmin_index * vpd_index * dayl_index;
-					GSI_index_SUM += GSI_index;
-
-				} /* endfor - calculating indexes for the n_moving_average long period  */
+					nrunning = 0;
+				}
+				tmin_index  = tmin_day;
+				vpd_index   = vpd_day;
+				dayl_index  = dayl_day;
 
 				/* !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!  D: heatsum !!!!!!!!!!!!!!!!!!!!!!!!!!!!!! */
 				if (heatsum_act < heatsum_limit1)
@@ -282,7 +306,7 @@ int GSI_calculation(const metarr_struct* metarr, const control_struct* ctrl, con
 
 				}
 
-				GSI_index_avg = GSI_index_SUM / (n_moving_avg+1);
+				GSI_index_avg = GSI_index_SUM / n_period;
 				GSI_index_total = GSI_index_avg * heatsum_index;
 				
 			} /* endelse - calculating indexes */
@@ -349,6 +373,9 @@ int GSI_calculation(const metarr_struct* metarr, const control_struct* ctrl, con
 	phenarr->onday_arr = onday_arr;
 	phenarr->offday_arr= offday_arr;
 
+	mem_free(GSI_ring);
+	mem_free(heat_ring);
+
 	return (!ok);
 
 } /* end - subroutine */
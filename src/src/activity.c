@@ -0,0 +1,91 @@
+/*
+activity.c
+per-day activity mask: determines upfront which processes have work to do on the
+actual day, so that the day loop can skip the ones whose fluxes are zero
+(dormant, snow-covered and management-free days)
+
+Compiling with -DACTIVITY_CHECK runs the skipped management submodules on copies
+of the state and flux structures as well and reports any difference (see mgm_submodules)
+
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+Biome-BGCMuSo v4.0.2
+Original code: Copyright 2000, Peter E. Thornton
+Numerical Terradynamic Simulation Group, The University of Montana, USA
+Modified code: Copyright 2016, D. Hidy [dori.hidy@gmail.com]
+Hungarian Academy of Sciences, Hungary
+See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentation, model executable and example input files.
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "bgc_struct.h"
+#include "bgc_func.h"
+#include "bgc_constants.h"
+
+int activity_mask(const metvar_struct* metv, const phenology_struct* phen, const cstate_struct* cs, const nstate_struct* ns,
+				  const wstate_struct* ws, double snowcover_limit,
+				  const planting_struct* PLT, const thinning_struct* THN, const mowing_struct* MOW, const grazing_struct* GRZ,
+				  const harvesting_struct* HRV, const ploughing_struct* PLG, const fertilizing_struct* FRZ, const irrigation_struct* IRG,
+				  activity_struct* act)
+{
+	/* The mask has to be called after management() and dayphen(): the state variables
+	used here do not change before the processes it controls are called.
+	A management submodule is idle if there is no management event on the actual day
+	and its temporary pools are empty: all its fluxes are then products of zero
+	coefficients and they are left at the zero values set at the beginning of the day. */
+	int ok=1;
+
+	/* canopy processes: the same conditions as in the original day loop */
+	act->canopy   = (cs->leafc && metv->dayl);
+	act->psn      = (act->canopy && phen->remdays_curgrowth && ws->snoww <= snowcover_limit);
+	act->snowmelt = (ws->snoww != 0);
+
+	/* management submodules (no management in spinup) */
+	act->PLT = (PLT && PLT->mgmd >= 0);
+
+	act->THN = (THN && (THN->mgmd >= 0 ||
+		cs->litr1c_strg_THN || cs->litr2c_strg_THN || cs->litr3c_strg_THN || cs->litr4c_strg_THN || cs->cwdc_strg_THN ||
+		ns->litr1n_strg_THN || ns->litr2n_strg_THN || ns->litr3n_strg_THN || ns->litr4n_strg_THN || ns->cwdn_strg_THN));
+
+	/* LAI-limit mowing can happen on any day */
+	act->MOW = (MOW && (MOW->mgmd >= 0 || (MOW->fixday_or_fixLAI_flag != 0 && MOW->MOW_flag != 2) ||
+		cs->litr1c_strg_MOW || cs->litr2c_strg_MOW || cs->litr3c_strg_MOW || cs->litr4c_strg_MOW ||
+		ns->litr1n_strg_MOW || ns->litr2n_strg_MOW || ns->litr3n_strg_MOW || ns->litr4n_strg_MOW));
+
+	act->GRZ = (GRZ && GRZ->mgmd >= 0);
+
+	act->HRV = (HRV && (HRV->mgmd >= 0 ||
+		cs->litr1c_strg_HRV || cs->litr2c_strg_HRV || cs->litr3c_strg_HRV || cs->litr4c_strg_HRV ||
+		ns->litr1n_strg_HRV || ns->litr2n_strg_HRV || ns->litr3n_strg_HRV || ns->litr4n_strg_HRV));
+
+	act->PLG = (PLG && (PLG->mgmd >= 0 ||
+		PLG->PLG_pool_litr1c || PLG->PLG_pool_litr2c || PLG->PLG_pool_litr3c || PLG->PLG_pool_litr4c ||
+		PLG->PLG_pool_litr1n || PLG->PLG_pool_litr2n || PLG->PLG_pool_litr3n || PLG->PLG_pool_litr4n ||
+		cs->PLG_cpool || ns->PLG_npool));
+
+	act->FRZ = (FRZ && (FRZ->mgmd >= 0 || FRZ->FRZ_pool_act));
+
+	act->IRG = (IRG && IRG->mgmd >= 0);
+
+	return (!ok);
+}
+
+int activity_compare(const char* name, const double* fast, const double* full, int n)
+{
+	/* compare the results of the fast and the full path element by element
+	(structures of doubles): returns the number of differences */
+	int i;
+	int ndiff = 0;
+
+	for (i = 0; i < n; i++)
+	{
+		if (fast[i] != full[i] && !(fast[i] != fast[i] && full[i] != full[i]))
+		{
+			if (ndiff == 0) printf("ACTIVITY CHECK: %s differs at element %i: %.15e (skipped) vs %.15e (full)\n", name, i, fast[i], full[i]);
+			ndiff++;
+		}
+	}
+
+	return ndiff;
+}
@@ -0,0 +1,463 @@
+/*
+bundle.c
+binary run-configuration bundle: the bgc input structures of a point simulation
+(after reading the init file and all the input files it refers to) in one file.
+muso-compile writes the bundle, muso starts from it with a single mmap and
+without text parsing: the arrays are used in place from the mapped file.
+
+Layout: header (magic, version, structure sizes, payload size, checksum), then
+the payload: the images of bgcin_struct, point_struct, restart_ctrl_struct and
+output_struct, followed by the arrays they point to (see bundle_slots). Every
+block is preceded by its element count and size and padded to 8 bytes.
+The structure images are only valid for the same build (checked by the sizes).
+
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+Biome-BGCMuSo v4.0.2
+Copyright 2016, D. Hidy [dori.hidy@gmail.com]
+Hungarian Academy of Sciences, Hungary
+See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentation, model executable and example input files.
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "ini.h"
+#include "bgc_struct.h"
+#include "pointbgc_struct.h"
+#include "pointbgc_func.h"
+#include "bgc_io.h"
+#include "bgc_constants.h"
+#include "misc_func.h"
+
+#define BUNDLE_MAGIC "MUSOBNDL"
+#define BUNDLE_VERSION 1
+#define BUNDLE_MAXSLOT 128
+
+typedef struct
+{
+	char magic[8];
+	int version;
+	int size_bgcin;          /* structure sizes of the writing build */
+	int size_point;
+	int size_restart;
+	int size_output;
+	int size_file;
+	double nbytes;           /* payload size (bytes) */
+	unsigned int checksum;   /* FNV-1a of the payload */
+	int nslot;               /* number of array blocks */
+} bundle_header;
+
+typedef struct
+{
+	double count;            /* number of elements */
+	double elsize;           /* size of one element (bytes) */
+} bundle_block;
+
+/* array pointer of the input structures: plain arrays (ptr) or
+management arrays of N_MGMDAYS rows (mgm) */
+typedef struct
+{
+	void** ptr;
+	double*** mgm;
+	long count;
+	int elsize;
+} bundle_slot;
+
+#define SLOT(p, n) { slot[ns].ptr = (void**)&(p); slot[ns].mgm = NULL; slot[ns].count = (n); slot[ns].elsize = sizeof(*(p)); ns++; }
+#define MGM_SLOT(p, flag) { slot[ns].ptr = NULL; slot[ns].mgm = &(p); slot[ns].count = N_MGMDAYS * ((flag) == 2 ? ctrl->simyears : 1); slot[ns].elsize = sizeof(double); ns++; }
+
+/* the arrays of the input structures, in bundle order: the sizes and flags
+come from the structure images, so the reader finds the same list */
+static int bundle_slots(bgcin_struct* bgcin, output_struct* output, bundle_slot* slot)
+{
+	int ns = 0;
+	const control_struct* ctrl = &bgcin->ctrl;
+	long ndays = NDAY_OF_YEAR * ctrl->metyears;
+
+	SLOT(bgcin->metarr.tmax, ndays);
+	SLOT(bgcin->metarr.tmin, ndays);
+	SLOT(bgcin->metarr.prcp, ndays);
+	SLOT(bgcin->metarr.vpd, ndays);
+	SLOT(bgcin->metarr.swavgfd, ndays);
+	SLOT(bgcin->metarr.par, ndays);
+	SLOT(bgcin->metarr.dayl, ndays);
+	SLOT(bgcin->metarr.tday, ndays);
+	SLOT(bgcin->metarr.tavg, ndays);
+	SLOT(bgcin->metarr.tavg11_ra, ndays);
+	SLOT(bgcin->metarr.tavg10_ra, ndays);
+	SLOT(bgcin->metarr.tavg30_ra, ndays);
+	SLOT(bgcin->metarr.F_temprad, ndays);
+	SLOT(bgcin->metarr.F_temprad_ra, ndays);
+
+	if (bgcin->co2.varco2)       SLOT(bgcin->co2.co2ppm_array, ctrl->simyears);
+	if (bgcin->ndep.varndep == 1) SLOT(bgcin->ndep.ndep_array, ctrl->simyears);
+	if (ctrl->varSGS_flag)       SLOT(bgcin->epc.sgs_array, ctrl->simyears);
+	if (ctrl->varEGS_flag)       SLOT(bgcin->epc.egs_array, ctrl->simyears);
+	if (ctrl->varWPM_flag)       SLOT(bgcin->epc.wpm_array, ctrl->simyears);
+	if (ctrl->varMSC_flag)       SLOT(bgcin->epc.msc_array, ctrl->simyears);
+	if (ctrl->GWD_flag)          SLOT(bgcin->sitec.gwd_array, ctrl->simyears * NDAY_OF_YEAR);
+
+	MGM_SLOT(bgcin->PLT.PLTdays_array, bgcin->PLT.PLT_flag);
+	MGM_SLOT(bgcin->PLT.seed_quantity_array, bgcin->PLT.PLT_flag);
+	MGM_SLOT(bgcin->PLT.seed_carbon_array, bgcin->PLT.PLT_flag);
+	MGM_SLOT(bgcin->PLT.utiliz_coeff_array, bgcin->PLT.PLT_flag);
+
+	MGM_SLOT(bgcin->THN.THNdays_array, bgcin->THN.THN_flag);
+	MGM_SLOT(bgcin->THN.thinning_rate_array, bgcin->THN.THN_flag);
+	MGM_SLOT(bgcin->THN.transpcoeff_woody_array, bgcin->THN.THN_flag);
+	MGM_SLOT(bgcin->THN.transpcoeff_nwoody_array, bgcin->THN.THN_flag);
+
+	MGM_SLOT(bgcin->MOW.MOWdays_array, bgcin->MOW.MOW_flag);
+	MGM_SLOT(bgcin->MOW.LAI_limit_array, bgcin->MOW.MOW_flag);
+	MGM_SLOT(bgcin->MOW.transport_coeff_array, bgcin->MOW.MOW_flag);
+
+	MGM_SLOT(bgcin->GRZ.GRZ_start_array, bgcin->GRZ.GRZ_flag);
+	MGM_SLOT(bgcin->GRZ.GRZ_end_array, bgcin->GRZ.GRZ_flag);
+	MGM_SLOT(bgcin->GRZ.weight_LSU, bgcin->GRZ.GRZ_flag);
+	MGM_SLOT(bgcin->GRZ.stocking_rate_array, bgcin->GRZ.GRZ_flag);
+	MGM_SLOT(bgcin->GRZ.DMintake_array, bgcin->GRZ.GRZ_flag);
+	MGM_SLOT(bgcin->GRZ.trampling_effect, bgcin->GRZ.GRZ_flag);
+	MGM_SLOT(bgcin->GRZ.prop_DMintake2excr_array, bgcin->GRZ.GRZ_flag);
+	MGM_SLOT(bgcin->GRZ.prop_excr2litter_array, bgcin->GRZ.GRZ_flag);
+	MGM_SLOT(bgcin->GRZ.DM_Ccontent_array, bgcin->GRZ.GRZ_flag);
+	MGM_SLOT(bgcin->GRZ.EXCR_Ncontent_array, bgcin->GRZ.GRZ_flag);
+	MGM_SLOT(bgcin->GRZ.EXCR_Ccontent_array, bgcin->GRZ.GRZ_flag);
+	MGM_SLOT(bgcin->GRZ.EFman_N2O, bgcin->GRZ.GRZ_flag);
+	MGM_SLOT(bgcin->GRZ.Nexrate, bgcin->GRZ.GRZ_flag);
+	MGM_SLOT(bgcin->GRZ.EFman_CH4, bgcin->GRZ.GRZ_flag);
+	MGM_SLOT(bgcin->GRZ.EFfer_CH4, bgcin->GRZ.GRZ_flag);
+
+	MGM_SLOT(bgcin->HRV.HRVdays_array, bgcin->HRV.HRV_flag);
+	MGM_SLOT(bgcin->HRV.snag_array, bgcin->HRV.HRV_flag);
+	MGM_SLOT(bgcin->HRV.transport_coeff_array, bgcin->HRV.HRV_flag);
+
+	MGM_SLOT(bgcin->PLG.PLGdays_array, bgcin->PLG.PLG_flag);
+	MGM_SLOT(bgcin->PLG.PLGdepths_array, bgcin->PLG.PLG_flag);
+	MGM_SLOT(bgcin->PLG.dissolv_coeff_array, bgcin->PLG.PLG_flag);
+
+	MGM_SLOT(bgcin->FRZ.FRZdays_array, bgcin->FRZ.FRZ_flag);
+	MGM_SLOT(bgcin->FRZ.fertilizer_array, bgcin->FRZ.FRZ_flag);
+	MGM_SLOT(bgcin->FRZ.Ncontent_array, bgcin->FRZ.FRZ_flag);
+	MGM_SLOT(bgcin->FRZ.NH3content_array, bgcin->FRZ.FRZ_flag);
+	MGM_SLOT(bgcin->FRZ.Ccontent_array, bgcin->FRZ.FRZ_flag);
+	MGM_SLOT(bgcin->FRZ.litr_flab_array, bgcin->FRZ.FRZ_flag);
+	MGM_SLOT(bgcin->FRZ.litr_fucel_array, bgcin->FRZ.FRZ_flag);
+	MGM_SLOT(bgcin->FRZ.litr_fscel_array, bgcin->FRZ.FRZ_flag);
+	MGM_SLOT(bgcin->FRZ.litr_flig_array, bgcin->FRZ.FRZ_flag);
+	MGM_SLOT(bgcin->FRZ.dissolv_coeff_array, bgcin->FRZ.FRZ_flag);
+	MGM_SLOT(bgcin->FRZ.utiliz_coeff_array, bgcin->FRZ.FRZ_flag);
+	MGM_SLOT(bgcin->FRZ.EFfert_N2O, bgcin->FRZ.FRZ_flag);
+
+	MGM_SLOT(bgcin->IRG.IRGdays_array, bgcin->IRG.IRG_flag);
+	MGM_SLOT(bgcin->IRG.IRGquantity_array, bgcin->IRG.IRG_flag);
+
+	SLOT(output->daycodes, output->ndayout);
+	SLOT(output->anncodes, output->nannout);
+
+	return ns;
+}
+
+/* payload under construction (writer) */
+typedef struct
+{
+	unsigned char* data;
+	long n;
+	long nalloc;
+} bundle_buffer;
+
+static int put_block(bundle_buffer* b, const void* data, long count, int elsize)
+{
+	bundle_block block;
+	long size = count * elsize;
+	long padded = sizeof(bundle_block) + (size + 7) / 8 * 8;
+
+	if (b->n + padded > b->nalloc)
+	{
+		unsigned char* grown;
+		b->nalloc = 2 * (b->n + padded);
+		grown = (unsigned char*) mem_realloc(MEM_INPUT, b->data, b->nalloc);
+		if (!grown) return 1;
+		b->data = grown;
+	}
+
+	block.count = count;
+	block.elsize = elsize;
+	memset(b->data + b->n, 0, padded);
+	memcpy(b->data + b->n, &block, sizeof(bundle_block));
+	if (size) memcpy(b->data + b->n + sizeof(bundle_block), data, size);
+	b->n += padded;
+
+	return 0;
+}
+
+/* next block of the payload (reader): NULL if it does not match the expected size */
+static void* get_block(unsigned char** cur, const unsigned char* end, long count, int elsize)
+{
+	bundle_block block;
+	unsigned char* data;
+	long size = count * elsize;
+	long padded = sizeof(bundle_block) + (size + 7) / 8 * 8;
+
+	if (*cur + sizeof(bundle_block) > end) return NULL;
+	memcpy(&block, *cur, sizeof(bundle_block));
+	if (block.count != count || block.elsize != elsize || *cur + padded > end) return NULL;
+
+	data = *cur + sizeof(bundle_block);
+	*cur += padded;
+	return data;
+}
+
+static void header_init(bundle_header* h)
+{
+	memset(h, 0, sizeof(bundle_header));
+	memcpy(h->magic, BUNDLE_MAGIC, 8);
+	h->version = BUNDLE_VERSION;
+	h->size_bgcin = sizeof(bgcin_struct);
+	h->size_point = sizeof(point_struct);
+	h->size_restart = sizeof(restart_ctrl_struct);
+	h->size_output = sizeof(output_struct);
+	h->size_file = sizeof(file);
+}
+
+int bundle_write(const char* name, bgcin_struct* bgcin, point_struct* point,
+				 restart_ctrl_struct* restart, output_struct* output)
+{
+	int ok = 1;
+	int s, nd, ns;
+	bundle_slot slot[BUNDLE_MAXSLOT];
+	bundle_buffer b;
+	bundle_header h;
+	FILE* f;
+
+	b.data = NULL;
+	b.n = b.nalloc = 0;
+
+	/* structure images, then the arrays */
+	if (ok && (put_block(&b, bgcin, 1, sizeof(bgcin_struct)) || put_block(&b, point, 1, sizeof(point_struct)) ||
+		put_block(&b, restart, 1, sizeof(restart_ctrl_struct)) || put_block(&b, output, 1, sizeof(output_struct))))
+	{
+		printf("Error allocating for bundle, bundle_write()\n");
+		ok=0;
+	}
+
+	ns = bundle_slots(bgcin, output, slot);
+	for (s = 0; ok && s < ns; s++)
+	{
+		if (slot[s].ptr)
+		{
+			if (put_block(&b, *slot[s].ptr, slot[s].count, slot[s].elsize))
+			{
+				printf("Error allocating for bundle, bundle_write()\n");
+				ok=0;
+			}
+		}
+		else
+		{
+			/* management rows are stored one after the other */
+			long ny = slot[s].count / N_MGMDAYS;
+			double* rows = (double*) mem_alloc(MEM_INPUT, slot[s].count * sizeof(double));
+			if (!rows)
+			{
+				printf("Error allocating for bundle, bundle_write()\n");
+				ok=0;
+			}
+			for (nd = 0; ok && nd < N_MGMDAYS; nd++) memcpy(rows + nd * ny, (*slot[s].mgm)[nd], ny * sizeof(double));
+			if (ok && put_block(&b, rows, slot[s].count, slot[s].elsize))
+			{
+				printf("Error allocating for bundle, bundle_write()\n");
+				ok=0;
+			}
+			mem_free(rows);
+		}
+	}
+
+	if (ok)
+	{
+		header_init(&h);
+		h.nbytes = b.n;
+		h.checksum = checksum_fnv1a(b.data, b.n, FNV1A_INIT);
+		h.nslot = ns;
+
+		f = fopen(name, "wb");
+		if (!f)
+		{
+			printf("Error opening bundle file (%s), bundle_write()\n", name);
+			ok=0;
+		}
+		else
+		{
+			if (fwrite(&h, sizeof(bundle_header), 1, f) != 1 || fwrite(b.data, 1, b.n, f) != (size_t) b.n)
+			{
+				printf("Error writing bundle file (%s), bundle_write()\n", name);
+				ok=0;
+			}
+			if (fclose(f)) ok=0;
+		}
+	}
+
+	mem_free(b.data);
+	return (!ok);
+}
+
+int bundle_probe(const char* name)
+{
+	/* returns 1 if the file starts with the bundle magic */
+	char magic[8];
+	int is_bundle = 0;
+	FILE* f = fopen(name, "rb");
+
+	if (f)
+	{
+		if (fread(magic, 1, 8, f) == 8 && !memcmp(magic, BUNDLE_MAGIC, 8)) is_bundle = 1;
+		fclose(f);
+	}
+	return is_bundle;
+}
+
+/* the file structures of the images refer to the writing process */
+static void file_reset(file* f)
+{
+	f->ptr = NULL;
+	f->buf = NULL;
+}
+
+int bundle_read(const char* name, bgcin_struct* bgcin, point_struct* point,
+				restart_ctrl_struct* restart, output_struct* output)
+{
+	int ok = 1;
+	int valid;
+	int s, nd, ns;
+	long size = 0;
+	bundle_slot slot[BUNDLE_MAXSLOT];
+	bundle_header h, expect;
+	unsigned char* map = NULL;
+	unsigned char *cur, *end;
+	void* data;
+
+	/* map the whole file: the arrays are used in place (private mapping,
+	so the model can modify them without touching the file) */
+#ifndef _WIN32
+	int fd = open(name, O_RDONLY);
+	struct stat st;
+	if (fd < 0 || fstat(fd, &st))
+	{
+		printf("Error opening bundle file (%s), bundle_read()\n", name);
+		ok=0;
+	}
+	else
+	{
+		size = st.st_size;
+		map = (unsigned char*) mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		if (map == MAP_FAILED)
+		{
+			printf("Error mapping bundle file (%s), bundle_read()\n", name);
+			map = NULL;
+			ok=0;
+		}
+	}
+	if (fd >= 0) close(fd);
+#else
+	FILE* f = fopen(name, "rb");
+	if (!f || fseek(f, 0, SEEK_END) || (size = ftell(f)) < 0 || fseek(f, 0, SEEK_SET) ||
+		!(map = (unsigned char*) mem_alloc(MEM_INPUT, size)) || fread(map, 1, size, f) != (size_t) size)
+	{
+		printf("Error reading bundle file (%s), bundle_read()\n", name);
+		ok=0;
+	}
+	if (f) fclose(f);
+#endif
+
+	/* validate the header and the payload */
+	if (ok && size < (long) sizeof(bundle_header))
+	{
+		printf("Error: %s is not a complete bundle file\n", name);
+		ok=0;
+	}
+	if (ok)
+	{
+		memcpy(&h, map, sizeof(bundle_header));
+		header_init(&expect);
+		if (memcmp(h.magic, expect.magic, 8) || h.version != expect.version)
+		{
+			printf("Error: %s is not a version %d bundle file\n", name, BUNDLE_VERSION);
+			ok=0;
+		}
+		else if (h.size_bgcin != expect.size_bgcin || h.size_point != expect.size_point ||
+			h.size_restart != expect.size_restart || h.size_output != expect.size_output || h.size_file != expect.size_file)
+		{
+			printf("Error: bundle file %s was written by a different build, recompile it with muso-compile\n", name);
+			ok=0;
+		}
+		else if (h.nbytes != size - (long) sizeof(bundle_header) ||
+			h.checksum != checksum_fnv1a(map + sizeof(bundle_header), size - sizeof(bundle_header), FNV1A_INIT))
+		{
+			printf("Error: bundle file %s is corrupted (size or checksum mismatch)\n", name);
+			ok=0;
+		}
+	}
+
+	valid = ok;
+	cur = map + sizeof(bundle_header);
+	end = map + size;
+
+	/* structure images */
+	if (ok && (data = get_block(&cur, end, 1, sizeof(bgcin_struct)))) memcpy(bgcin, data, sizeof(bgcin_struct));
+	else ok=0;
+	if (ok && (data = get_block(&cur, end, 1, sizeof(point_struct)))) memcpy(point, data, sizeof(point_struct));
+	else ok=0;
+	if (ok && (data = get_block(&cur, end, 1, sizeof(restart_ctrl_struct)))) memcpy(restart, data, sizeof(restart_ctrl_struct));
+	else ok=0;
+	if (ok && (data = get_block(&cur, end, 1, sizeof(output_struct)))) memcpy(output, data, sizeof(output_struct));
+	else ok=0;
+
+	if (ok)
+	{
+		file_reset(&point->metf);
+		file_reset(&restart->in_restart);
+		file_reset(&restart->out_restart);
+		file_reset(&output->dayout);
+		file_reset(&output->monavgout);
+		file_reset(&output->annavgout);
+		file_reset(&output->annout);
+		file_reset(&output->anntext);
+		file_reset(&output->control_file);
+		file_reset(&output->log_file);
+		file_reset(&bgcin->GSI.GSI_file);
+	}
+
+	/* relocate the array pointers into the mapped file */
+	ns = ok ? bundle_slots(bgcin, output, slot) : 0;
+	if (ok && ns != h.nslot) ok=0;
+	for (s = 0; ok && s < ns; s++)
+	{
+		data = get_block(&cur, end, slot[s].count, slot[s].elsize);
+		if (!data)
+		{
+			ok=0;
+		}
+		else if (slot[s].ptr)
+		{
+			*slot[s].ptr = data;
+		}
+		else
+		{
+			long ny = slot[s].count / N_MGMDAYS;
+			*slot[s].mgm = (double**) mem_alloc(MEM_MGM, N_MGMDAYS * sizeof(double*));
+			if (!*slot[s].mgm) ok=0;
+			for (nd = 0; ok && nd < N_MGMDAYS; nd++) (*slot[s].mgm)[nd] = (double*) data + nd * ny;
+		}
+	}
+	if (valid && !ok)
+	{
+		printf("Error: inconsistent block structure in bundle file %s\n", name);
+	}
+
+	return (!ok);
+}
@@ -2,6 +2,12 @@
 check_balance.c
 daily test of mass balance (water, carbon, and nitrogen state variables)
 
+check_balance() is the end-of-day call on the state variables: the very low
+values are forced to 0.0 (precision_control), then the balance sums of the three
+state structures are computed. The sums are separate walks after the clamps,
+because a clamp moves mass into pools (e.g. litter) that a fused sum would
+already have visited.
+
 *-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
 Biome-BGCMuSo v4.0.2
 Original code: Copyright 2000, Peter E. Thornton
@@ -21,7 +27,46 @@ See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentatio
 #include "bgc_func.h"
 #include "bgc_constants.h"
 
-int check_water_balance(wstate_struct* ws, int first_balance)
+static int check_water_balance(wstate_struct* ws, int first_balance);
+static int check_carbon_balance(cstate_struct* cs, int first_balance);
+static int check_nitrogen_balance(nstate_struct* ns, int first_balance);
+
+int check_balance(wstate_struct* ws, cstate_struct* cs, nstate_struct* ns, int first_balance)
+{
+	int ok=1;
+
+	/* Hidy 2013 - test again for very low state variable values and force them
+	to 0.0 to avoid rounding and floating point overflow errors */
+	if (ok && precision_control(ws, cs, ns))
+	{
+		printf("Error in call to precision_control() from check_balance()\n");
+		ok=0;
+	}
+
+	/* test for water balance*/
+	if (ok && check_water_balance(ws, first_balance))
+	{
+		printf("Error in check_water_balance() from check_balance()\n");
+		ok=0;
+	}
+
+	if (ok && check_carbon_balance(cs, first_balance))
+	{
+		printf("Error in check_carbon_balance() from check_balance()\n");
+		ok=0;
+	}
+
+	/* test for nitrogen balance -  by Hidy 2008 */
+	if (ok && check_nitrogen_balance(ns, first_balance))
+	{
+		printf("Error in check_nitrogen_balance() from check_balance()\n");
+		ok=0;
+	}
+
+	return (!ok);
+}
+
+static int check_water_balance(wstate_struct* ws, int first_balance)
 {
 	int ok=1;
 	static double old_balance;
@@ -68,7 +113,7 @@ int check_water_balance(wstate_struct* ws, int first_balance)
 	return (!ok);
 }
 
-int check_carbon_balance(cstate_struct* cs, int first_balance)
+static int check_carbon_balance(cstate_struct* cs, int first_balance)
 {
 	int ok=1;
 	static double old_balance;
@@ -149,7 +194,7 @@ int check_carbon_balance(cstate_struct* cs, int first_balance)
 	return (!ok);
 }		
 
-int check_nitrogen_balance(nstate_struct* ns, int first_balance)
+static int check_nitrogen_balance(nstate_struct* ns, int first_balance)
 {
 	int ok=1;
 	double in,out,store,balance;
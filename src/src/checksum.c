@@ -0,0 +1,29 @@
+/*
+checksum.c
+FNV-1a checksum of the binary files written by the model (bundle, restart)
+
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+Biome-BGCMuSo v4.0.2
+Copyright 2016, D. Hidy [dori.hidy@gmail.com]
+Hungarian Academy of Sciences, Hungary
+See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentation, model executable and example input files.
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "misc_func.h"
+
+unsigned int checksum_fnv1a(const void* data, long n, unsigned int hash)
+{
+	/* start with hash = FNV1A_INIT; can be continued over several blocks */
+	const unsigned char* p = (const unsigned char*) data;
+	long i;
+
+	for (i = 0; i < n; i++)
+	{
+		hash ^= p[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
@@ -20,6 +20,7 @@ Missoula, MT 59812
 #include "bgc_struct.h"
 #include "pointbgc_struct.h"
 #include "pointbgc_func.h"
+#include "misc_func.h"
 
 int co2_init(file init, co2control_struct* co2, int simyears)
 {
@@ -73,7 +74,7 @@ int co2_init(file init, co2control_struct* co2, int simyears)
 		/* allocate space for the annual CO2 array */
 		if (ok) 
 		{
-			co2->co2ppm_array = (double*) malloc(simyears * sizeof(double));
+			co2->co2ppm_array = (double*) mem_alloc(MEM_PARAM, simyears * sizeof(double));
 			if (!co2->co2ppm_array)
 			{
 				printf("Error allocating for annual CO2 array, co2_init()\n");
@@ -96,7 +97,7 @@ int co2_init(file init, co2control_struct* co2, int simyears)
 				ok=0;
 			}
 		}
-		fclose(temp.ptr);
+		file_close(&temp);
 	}
 	else
 	{
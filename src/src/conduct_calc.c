@@ -41,13 +41,15 @@ int conduct_calc(const control_struct* ctrl, const metvar_struct* metv, const ep
 	double vwc_ratio;	
 	double m_soilstress_avg = 0;
 
-	/* Hidy 2015 - m_co2 */
-	double p_co2;
+	double tcorr, tcorr_sqrt;
 
 
 	
-	/* temperature and pressure correction factor for conductances */
-	gcorr = pow((metv->tday+273.15)/293.15, 1.75) * 101300/metv->pa;
+	/* temperature and pressure correction factor for conductances (pressure part: conduct_factors) */
+	/* tcorr^1.75 = tcorr * tcorr^0.5 * tcorr^0.25 (two sqrt instead of pow) */
+	tcorr      = (metv->tday+273.15)/293.15;
+	tcorr_sqrt = sqrt(tcorr);
+	gcorr      = tcorr * tcorr_sqrt * sqrt(tcorr_sqrt) * metv->pcorr;
 	
 	/* calculate leaf- and canopy-level conductances to water vapor and
 	sensible heat fluxes */
@@ -88,10 +90,7 @@ int conduct_calc(const control_struct* ctrl, const metvar_struct* metv, const ep
 	
 	
 	if (epc->CO2conduct_flag)
-	{
-		p_co2 = 39.43 * pow(360, -0.64);
-		m_co2 = 39.43 * pow(metv->co2, -0.64) / p_co2;
-	}
+		m_co2 = metv->m_co2;
 	else
 		m_co2 = 1;
 
@@ -218,3 +217,15 @@ int conduct_calc(const control_struct* ctrl, const metvar_struct* metv, const ep
 	
     return (!ok);
 }
+
+/* Hidy 2015 - m_co2; the pressure correction is constant for a site and the CO2 multiplier changes
+   only with [CO2] (annually with varying CO2), so both are computed when their input is set */
+void conduct_factors(metvar_struct* metv)
+{
+	double p_co2;
+
+	metv->pcorr = 101300/metv->pa;
+
+	p_co2       = 39.43 * pow(360, -0.64);
+	metv->m_co2 = 39.43 * pow(metv->co2, -0.64) / p_co2;
+}
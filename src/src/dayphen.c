@@ -24,12 +24,64 @@ See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentatio
 int dayphen(const phenarray_struct* phenarr, phenology_struct* phen, int metday, int metyr)
 {
 	int ok=1;
+	int n_yday = NDAY_OF_YEAR;
+	int pday, start;
+	const phenyear_struct* phensig;
 	
-	phen->remdays_curgrowth = (double)(phenarr->remdays_curgrowth[metday]);
-	phen->remdays_transfer = (double)(phenarr->remdays_transfer[metday]);
-	phen->remdays_litfall = (double)(phenarr->remdays_litfall[metday]);
-	phen->predays_transfer = (double)(phenarr->predays_transfer[metday]);
-	phen->predays_litfall = (double)(phenarr->predays_litfall[metday]);
+	/* phenological year and day of the met day: the phenological years of
+	southern sites start on yday 182, the first one in the year before the
+	first met year */
+	pday = phenarr->south ? metday + 182 : metday;
+	phensig = &phenarr->phenyear[pday / n_yday];
+	pday = pday % n_yday;
+
+	if (phenarr->evergreen)
+	{
+		/* evergreen: the whole year is transfer and litfall period */
+		phen->remdays_curgrowth = (double)(n_yday - pday);
+		phen->remdays_transfer = (double)(n_yday - pday);
+		phen->remdays_litfall = (double)(n_yday - pday);
+		phen->predays_transfer = (double)pday;
+		phen->predays_litfall = (double)pday;
+	}
+	else
+	{
+		/* days left in the growth period (onday..offday-1) */
+		if (pday >= phensig->onday && pday < phensig->offday)
+			phen->remdays_curgrowth = (double)(phensig->offday - pday);
+		else
+			phen->remdays_curgrowth = 0.0;
+
+		/* transfer period: the first ntransfer days of the growth period */
+		if (pday < phensig->onday || pday > phensig->offday)
+		{
+			phen->remdays_transfer = 0.0;
+			phen->predays_transfer = 0.0;
+		}
+		else if (pday < phensig->onday + phensig->ntransfer)
+		{
+			phen->remdays_transfer = (double)(phensig->ntransfer - (pday - phensig->onday));
+			phen->predays_transfer = (double)(pday - phensig->onday);
+		}
+		else
+		{
+			phen->remdays_transfer = 0.0;
+			phen->predays_transfer = (double)phensig->ntransfer;
+		}
+
+		/* litfall period: the last nlitfall days up to offday */
+		start = phensig->offday - phensig->nlitfall + 1;
+		if (pday >= start && pday <= phensig->offday)
+		{
+			phen->remdays_litfall = (double)(phensig->offday - pday + 1);
+			phen->predays_litfall = (double)(pday - start);
+		}
+		else
+		{
+			phen->remdays_litfall = 0.0;
+			phen->predays_litfall = 0.0;
+		}
+	}
 	
 	phen->onday = (int)(phenarr->onday_arr[metyr]);
 	phen->offday = (int)(phenarr->offday_arr[metyr]);
@@ -37,4 +89,3 @@ int dayphen(const phenarray_struct* phenarr, phenology_struct* phen, int metday,
 
 
 }
-	
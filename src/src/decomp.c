@@ -34,7 +34,7 @@ nstate_struct* ns, nflux_struct* nf, ntemp_struct* nt)
 	double t_scalar, w_scalar;
 	double rate_scalar = 0;
 	double rate_scalar_total = 0;
-	double tk, tsoil;
+	double tsoil;
 	double minvwc, maxvwc, opt1vwc, opt2vwc, vwc;
 	double rfl1s1, rfl2s2,rfl4s3,rfs1s2,rfs2s3,rfs3s4;
 	double kl1_base,kl2_base,kl4_base,ks1_base,ks2_base,ks3_base,ks4_base,kfrag_base;
@@ -98,8 +98,8 @@ nstate_struct* ns, nflux_struct* nf, ntemp_struct* nt)
 		{
 			if (tsoil < 25)
 			{
-				tk = tsoil + 273.15;
-				t_scalar = exp(308.56*((1.0/71.02)-(1.0/(tk-227.13))));
+				/* exp(308.56*((1.0/71.02)-(1.0/(tk-227.13)))), tabulated in tempresp.c */
+				t_scalar = tempresp(TR_LLOYDTAYLOR, tsoil);
 			}
 			else // !!!!!!!!!!!!! NEW BUG FIX - Hidy 2015 !!!!!!!!!!!!!!!!
 				t_scalar = 1;
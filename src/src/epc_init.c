@@ -27,6 +27,7 @@ See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentatio
 #include "pointbgc_struct.h"
 #include "pointbgc_func.h"
 #include "bgc_constants.h"
+#include "misc_func.h"
 
 
 
@@ -174,7 +175,7 @@ int epc_init(file init, epconst_struct* epc, control_struct* ctrl)
 	if (ok && ctrl->varSGS_flag) 
 	{
 		/* allocate space for the annual SGS array */
-		epc->sgs_array = (double*) malloc(ctrl->simyears * sizeof(double));
+		epc->sgs_array = (double*) mem_alloc(MEM_PARAM, ctrl->simyears * sizeof(double));
 		if (!epc->sgs_array)
 		{
 			printf("Error allocating for annual SGS array, epc_init()\n");
@@ -197,7 +198,7 @@ int epc_init(file init, epconst_struct* epc, control_struct* ctrl)
 				ok=0;
 			}
 		}
-		fclose(sgs_file.ptr);
+		file_close(&sgs_file);
 	}	
 	else /* if no changing data constant EPC parameter are used */
 	{
@@ -231,7 +232,7 @@ int epc_init(file init, epconst_struct* epc, control_struct* ctrl)
 	if (ok && ctrl->varEGS_flag) 
 	{	
 		/* allocate space for the annual EGS array */
-		epc->egs_array = (double*) malloc(ctrl->simyears * sizeof(double));
+		epc->egs_array = (double*) mem_alloc(MEM_PARAM, ctrl->simyears * sizeof(double));
 		if (!epc->egs_array)
 		{
 			printf("Error allocating for annual EGS array, epc_init()\n");
@@ -254,7 +255,7 @@ int epc_init(file init, epconst_struct* epc, control_struct* ctrl)
 				ok=0;
 			}
 		}
-		fclose(egs_file.ptr);
+		file_close(&egs_file);
 	}	
 	else /* if no changing data constant EPC parameter are used */
 	{
@@ -341,7 +342,7 @@ int epc_init(file init, epconst_struct* epc, control_struct* ctrl)
 	if (ok && ctrl->varWPM_flag) 
 	{
 		/* allocate space for the annual WPM array */
-		epc->wpm_array = (double*) malloc(ctrl->simyears * sizeof(double));
+		epc->wpm_array = (double*) mem_alloc(MEM_PARAM, ctrl->simyears * sizeof(double));
 		if (!epc->wpm_array)
 		{
 			printf("Error allocating for annual WPM array, epc_init()\n");
@@ -364,7 +365,7 @@ int epc_init(file init, epconst_struct* epc, control_struct* ctrl)
 				ok=0;
 			}
 		}
-		fclose(wpm_file.ptr);
+		file_close(&wpm_file);
 	}	
 	else /* if no changing data constant EPC parameter are used */
 	{		
@@ -828,7 +829,7 @@ int epc_init(file init, epconst_struct* epc, control_struct* ctrl)
 	if (ok && ctrl->varMSC_flag) 
 	{
 		/* allocate space for the annual MSC array */
-		epc->msc_array = (double*) malloc(ctrl->simyears * sizeof(double));
+		epc->msc_array = (double*) mem_alloc(MEM_PARAM, ctrl->simyears * sizeof(double));
 		if (!epc->msc_array)
 		{
 			printf("Error allocating for annual MSC array, epc_init()\n");
@@ -851,7 +852,7 @@ int epc_init(file init, epconst_struct* epc, control_struct* ctrl)
 				ok=0;
 			}
 		}
-		fclose(msc_file.ptr);
+		file_close(&msc_file);
 	}	
 	else /* if no changing data constant EPC parameter are used */
 	{
@@ -1202,7 +1203,7 @@ int epc_init(file init, epconst_struct* epc, control_struct* ctrl)
 	}
 	
 	/* -------------------------------------------*/
-	if (dofileclose) fclose(temp.ptr);
+	if (dofileclose) file_close(&temp);
 		
 	return (!ok);
 }
@@ -174,7 +174,7 @@ int fertilizing_init(file init, control_struct* ctrl, fertilizing_struct* FRZ)
 
 	if (FRZ->FRZ_flag == 2)
 	{
-		fclose (FRZ_file.ptr);
+		file_close (&FRZ_file);
 	}
 
 	/* local variables - Hidy 2015.*/
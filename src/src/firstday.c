@@ -29,6 +29,7 @@ int firstday(const siteconst_struct* sitec, const epconst_struct* epc, const cin
 	int ok=1;
 	int woody;
 	int predays,remdays;
+	phenology_struct phen0;
 	int layer;
 	double max_leafc,max_frootc,max_fruitc;
 	double max_softstemc =0; /* fruit and softstem simulation - Hidy 2013. */
@@ -163,8 +164,13 @@ int firstday(const siteconst_struct* sitec, const epconst_struct* epc, const cin
 	/* use then penology array information to determine, for the first
 	day of simulation, how many days of transfer and litterfall have
 	already occurred for this year */
-	predays = phen->predays_transfer[0];
-	remdays = phen->remdays_transfer[0];
+	if (ok && dayphen(phen, &phen0, 0, 0))
+	{
+		printf("Error in call to dayphen() from firstday()\n");
+		ok=0;
+	}
+	predays = (int) phen0.predays_transfer;
+	remdays = (int) phen0.remdays_transfer;
 	if (predays > 0)
 	{
 		prop_transfer = (double)predays/(double)(predays+remdays);
@@ -231,8 +237,8 @@ int firstday(const siteconst_struct* sitec, const epconst_struct* epc, const cin
 		
 		/* only test for litterfall if there has already been some
 		transfer growth this year */
-		predays = phen->predays_litfall[0];
-		remdays = phen->remdays_litfall[0];
+		predays = (int) phen0.predays_litfall;
+		remdays = (int) phen0.remdays_litfall;
 		if (predays > 0)
 		{
 			/* some litterfall has already occurred. in this case, just
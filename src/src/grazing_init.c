@@ -189,7 +189,7 @@ int grazing_init(file init, control_struct* ctrl, grazing_struct* GRZ)
 
 	if (GRZ->GRZ_flag == 2)
 	{
-		fclose (GRZ_file.ptr);
+		file_close (&GRZ_file);
 	}
 		
 	GRZ->mgmd = -1;
@@ -20,6 +20,7 @@ See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentatio
 #include "pointbgc_struct.h"
 #include "pointbgc_func.h"
 #include "bgc_constants.h"
+#include "misc_func.h"
 
 
 
@@ -68,7 +69,7 @@ int groundwater_init(siteconst_struct* sitec, control_struct* ctrl)
 	if (ok && ctrl->GWD_flag) 
 	{		
 		/* allocate space for the annual gwd array */
-		sitec->gwd_array = (double*) malloc(ctrl->simyears * NDAY_OF_YEAR * sizeof(double));
+		sitec->gwd_array = (double*) mem_alloc(MEM_PARAM, ctrl->simyears * NDAY_OF_YEAR * sizeof(double));
 		if (!sitec->gwd_array)
 		{
 			printf("Error allocating for gwd array, groundwater_init()\n");
@@ -91,7 +92,7 @@ int groundwater_init(siteconst_struct* sitec, control_struct* ctrl)
 				ok=0;
 			}
 		}
-		fclose(gwd_file.ptr);
+		file_close(&gwd_file);
 	}	
 	else /* if no changing data constant sitec parameter are used */
 	{
@@ -0,0 +1,222 @@
+/*
+harness.c
+test harness of the model runs of the benchmark suite (muso_bench.c) and the
+golden-output regression (muso_golden.c): the init files of the runs are the
+sample init files with edits (a value of a line is changed, the line is found
+by its comment) and with the daily output list of every valid output code,
+the runs are separate processes of the model executable.
+The valid daily output codes follow output_map_init.c: harness_daycode_range
+has to be updated with it.
+
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+Biome-BGCMuSo v4.0.2
+Copyright 2016, D. Hidy [dori.hidy@gmail.com]
+Hungarian Academy of Sciences, Hungary
+See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentation, model executable and example input files.
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#endif
+#include "harness.h"
+
+const int harness_daycode_range[][2] = { {0, 32}, {34, 79}, {500, 522}, {526, 553}, {612, 658} };
+const int harness_n_dayranges = (int)(sizeof(harness_daycode_range) / sizeof(harness_daycode_range[0]));
+
+int harness_ndaycodes(void)
+{
+	int r, n = 0;
+
+	for (r = 0; r < harness_n_dayranges; r++)
+		n += harness_daycode_range[r][1] - harness_daycode_range[r][0] + 1;
+
+	return n;
+}
+
+int harness_ini_codes(const char* path, const char* section, int* codes, char (*desc)[128], int max)
+{
+	char line[HARNESS_MAX_LINE];
+	char* p;
+	int n = -1;
+	int i = 0;
+	int len;
+	FILE* f;
+
+	f = fopen(path, "r");
+	if (!f) return -1;
+	while (n < 0 && fgets(line, sizeof(line), f))
+	{
+		if (strncmp(line, section, strlen(section))) continue;
+		/* the number of variables follows the section name (repeated in some files) */
+		while (n < 0 && fgets(line, sizeof(line), f))
+		{
+			if (!strncmp(line, section, strlen(section))) continue;
+			if (sscanf(line, "%d", &n) != 1 || n < 0 || n > max) break;
+		}
+	}
+	for (i = 0; n > 0 && i < n && fgets(line, sizeof(line), f); i++)
+	{
+		codes[i] = (int) strtol(line, &p, 10);
+		while (*p == ' ' || *p == '\t') p++;
+		len = (int) strcspn(p, "\r\n");
+		if (len > 127) len = 127;
+		memcpy(desc[i], p, len);
+		desc[i][len] = '\0';
+	}
+	fclose(f);
+
+	return i == n ? n : -1;
+}
+
+int harness_ini_write(const char* src, const char* dst, const harness_edit* edit, int nedit, int daily)
+{
+	int ok = 1;
+	int i, k, r, code, ndaily, nsrc;
+	int used[HARNESS_MAX_EDITS];
+	char line[HARNESS_MAX_LINE];
+	char* rest;
+	FILE* fin;
+	FILE* fout;
+	static int srccodes[HARNESS_MAX_CODES];
+	static char srcdesc[HARNESS_MAX_CODES][128];
+
+	if (nedit > HARNESS_MAX_EDITS)
+	{
+		printf("Error: too many edits of %s\n", src);
+		return 1;
+	}
+
+	/* descriptions of the daily output variables of the sample */
+	nsrc = daily ? harness_ini_codes(src, "DAILY_OUTPUT", srccodes, srcdesc, HARNESS_MAX_CODES) : 0;
+	if (nsrc < 0) nsrc = 0;
+
+	fin = fopen(src, "r");
+	fout = fopen(dst, "w");
+	if (!fin || !fout)
+	{
+		printf("Error opening %s or %s\n", src, dst);
+		if (fin) fclose(fin);
+		if (fout) fclose(fout);
+		return 1;
+	}
+
+	memset(used, 0, sizeof(used));
+	while (ok && fgets(line, sizeof(line), fin))
+	{
+		for (i = 0; i < nedit; i++)
+		{
+			if (strstr(line, edit[i].key)) break;
+		}
+		if (i < nedit && used[i]++)
+		{
+			printf("Error: %s is found more than once in %s\n", edit[i].key, src);
+			ok = 0;
+		}
+		else if (i < nedit)
+		{
+			for (rest = line; *rest == ' ' || *rest == '\t'; rest++);
+			for (; *rest && *rest != ' ' && *rest != '\t' && *rest != '\n' && *rest != '\r'; rest++);
+			fprintf(fout, "%-16s%s", edit[i].value, rest);
+		}
+		else
+		{
+			fputs(line, fout);
+		}
+
+		/* the daily output list: the valid codes, the old list is left out */
+		if (ok && daily && !strncmp(line, "DAILY_OUTPUT", 12))
+		{
+			if (!fgets(line, sizeof(line), fin) || sscanf(line, "%d", &k) != 1)
+			{
+				printf("Error reading the number of daily output variables in %s\n", src);
+				ok = 0;
+			}
+			for (i = 0; ok && i < k; i++)
+			{
+				if (!fgets(line, sizeof(line), fin)) ok = 0;
+			}
+			ndaily = harness_ndaycodes();
+			if (daily > 0 && daily < ndaily) ndaily = daily;
+			fprintf(fout, "%-11d number of daily output variables\n", ndaily);
+			for (r = 0, i = 0; i < ndaily; r++)
+			{
+				for (code = harness_daycode_range[r][0]; code <= harness_daycode_range[r][1] && i < ndaily; code++, i++)
+				{
+					for (k = 0; k < nsrc && srccodes[k] != code; k++);
+					fprintf(fout, "%-11d%s\n", code, k < nsrc ? srcdesc[k] : "");
+				}
+			}
+		}
+	}
+
+	for (i = 0; ok && i < nedit; i++)
+	{
+		if (!used[i])
+		{
+			printf("Error: %s is not found in %s\n", edit[i].key, src);
+			ok = 0;
+		}
+	}
+
+	fclose(fin);
+	fclose(fout);
+	return !ok;
+}
+
+int harness_run(const char* muso, const char* dir, const char* name, char* const* args, double* wall, long* rss)
+{
+#ifdef _WIN32
+	printf("Error: the model runs need fork(), it is not available in this build\n");
+	return 1;
+#else
+	pid_t pid;
+	int status, fd;
+	char out[300];
+	struct rusage ru;
+	struct timespec t0, t1;
+
+	fflush(stdout);
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	pid = fork();
+	if (pid < 0)
+	{
+		printf("Error in fork()\n");
+		return 1;
+	}
+	if (pid == 0)
+	{
+		snprintf(out, sizeof(out), "%s.stdout", name);
+		if (chdir(dir)) _exit(126);
+		fd = open(out, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd >= 0)
+		{
+			dup2(fd, 1);
+			dup2(fd, 2);
+			close(fd);
+		}
+		execv(muso, args);
+		_exit(127);
+	}
+
+	if (wait4(pid, &status, 0, &ru) != pid)
+	{
+		printf("Error in wait4()\n");
+		return 1;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	if (wall) *wall = (double)(t1.tv_sec - t0.tv_sec) + 1e-9 * (double)(t1.tv_nsec - t0.tv_nsec);
+	if (rss) *rss = ru.ru_maxrss;
+
+	return !(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+#endif
+}
@@ -113,7 +113,7 @@ int harvesting_init(file init, control_struct* ctrl, harvesting_struct* HRV)
 
 	if (HRV->HRV_flag == 2)
 	{
-		fclose (HRV_file.ptr);
+		file_close (&HRV_file);
 	}
 
 	HRV->mgmd = -1;
@@ -2,6 +2,12 @@
 ini.c
 Rudimentary file I/O functions
 
+The ascii input files (ini, epc, management files) are read
+into memory at the first scan (file_load) and the values are tokenized from
+this buffer: one read per file instead of one fscanf call per value. The
+tokens are converted as by fscanf (%d: strtol, %lf: strtod, %s: non-whitespace
+word) and the error messages are the same, completed with the line number.
+
 *-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
 Biome-BGCMuSo v4.0.2
 Original code: Copyright 2000, Peter E. Thornton
@@ -14,8 +20,13 @@ See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentatio
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <ctype.h>
 
 # include "ini.h"
+#include "misc_func.h"
+
+static int file_load(file *target);
 
 /* file_open() is the generic file opening routine using the file structure
 defined above */
@@ -28,6 +39,9 @@ int file_open (file *target, char mode)
 */
 {
 	int ok=1;
+
+	target->buf = NULL;
+
 	switch (mode)
 	{
         case 'r':
@@ -72,9 +86,79 @@ int file_open (file *target, char mode)
             printf("Invalid mode specification for file_open ... Exiting\n");
             ok=0;
     }
+
+	/* read modes: buffer of the scan functions, filled at the first scan */
+	if (ok && (mode == 'r' || mode == 'i' || mode == 'j'))
+	{
+		target->buf = (file_buffer*) mem_calloc(MEM_INPUT, 1, sizeof(file_buffer));
+		if (!target->buf)
+		{
+			printf("Error allocating file buffer for %s\n",target->name);
+			fclose(target->ptr);
+			ok=0;
+		}
+	}
+
     return(!ok);
 }
 
+/* file_load() reads the whole file into the buffer of the file structure. The
+read position is set to the actual position of the file pointer, so the lines
+read directly from the stream before the first scan (e.g. header) are skipped. */
+static int file_load(file *target)
+{
+	int ok=1;
+	long start, size, i;
+	file_buffer *buf = target->buf;
+
+	start = ftell(target->ptr);
+	if (start < 0 || fseek(target->ptr, 0, SEEK_END) || (size = ftell(target->ptr)) < 0 || fseek(target->ptr, 0, SEEK_SET))
+	{
+		printf("Error reading %s into memory\n",target->name);
+		ok=0;
+	}
+
+	if (ok && !(buf->text = (char*) mem_alloc(MEM_INPUT, size + 1)))
+	{
+		printf("Error allocating file buffer for %s\n",target->name);
+		ok=0;
+	}
+
+	if (ok)
+	{
+		size = (long) fread(buf->text, 1, size, target->ptr);
+		buf->text[size] = '\0';
+		if (start > size) start = size;
+
+		buf->pos  = start;
+		buf->line = 1;
+		for (i = 0; i < start; i++)
+			if (buf->text[i] == '\n') buf->line++;
+	}
+
+	return(!ok);
+}
+
+/* file_close() closes the file and releases its buffer */
+int file_close(file *target)
+{
+	int ok=1;
+
+	if (target->buf)
+	{
+		mem_free(target->buf->text);
+		mem_free(target->buf);
+		target->buf = NULL;
+	}
+	if (fclose(target->ptr))
+	{
+		printf("Error closing %s\n",target->name);
+		ok=0;
+	}
+
+	return(!ok);
+}
+
 /* scan_value is the generic ascii input function for use with text
 initialization files. Reads the first whitespace delimited word on a line,
 and discards the remainder of the line. Returns a pointer to value depending
@@ -89,12 +173,31 @@ int scan_array (file ini, void *var, char type, int nl)
 {
     int ok_scan;
     int ok=1;
+	file_buffer *buf = ini.buf;
+	char *p, *end;
+	long n;
+
+	if (!buf)
+	{
+		printf("Error: %s is not open for reading\n",ini.name);
+		return(1);
+	}
+	if (!buf->text && file_load(&ini)) return(1);
+
+	/* skip the whitespaces (and empty lines) before the value */
+	p = buf->text + buf->pos;
+	while (isspace((unsigned char) *p))
+	{
+		if (*p == '\n') buf->line++;
+		p++;
+	}
+	end = p;
 
     switch (type)
     {
         case 'i':
-			if (nl) ok_scan = fscanf(ini.ptr, "%d%*[^\n]",(int*)var);
-			else ok_scan = fscanf(ini.ptr, "%d",(int*)var);
+			if (*p) *(int*)var = (int) strtol(p, &end, 10);
+			ok_scan = (*p == '\0') ? EOF : (end != p);
             if (ok_scan == 0 || ok_scan == EOF) 
 			{
 				printf("Error reading int value from %s \n",ini.name);
@@ -103,8 +206,8 @@ int scan_array (file ini, void *var, char type, int nl)
             break;
 
         case 'd':
-			if (nl) ok_scan = fscanf(ini.ptr, "%lf%*[^\n]",(double*)var);
-			else ok_scan = fscanf(ini.ptr, "%lf",(double*)var);
+			if (*p) *(double*)var = strtod(p, &end);
+			ok_scan = (*p == '\0') ? EOF : (end != p);
             if (ok_scan == 0 || ok_scan == EOF)
 			{
 				printf("Error reading double value from %s\n",ini.name);
@@ -113,8 +216,14 @@ int scan_array (file ini, void *var, char type, int nl)
             break;
 
         case 's':
-			if (nl) ok_scan = fscanf(ini.ptr, "%s%*[^\n]",(char*)var);
-			else ok_scan = fscanf(ini.ptr, "%s",(char*)var);
+			while (*end && !isspace((unsigned char) *end)) end++;
+			n = (long) (end - p);
+			if (n) 
+			{
+				memcpy((char*)var, p, n);
+				((char*)var)[n] = '\0';
+			}
+			ok_scan = (*p == '\0') ? EOF : (n != 0);
             if (ok_scan == 0 || ok_scan == EOF) 
 			{
 				printf("Error reading string value from %s\n",ini.name);
@@ -126,6 +235,20 @@ int scan_array (file ini, void *var, char type, int nl)
             printf("Invalid type specifier for scan_value ... Exiting\n");
             ok=0;
     }
+
+	if (!ok)
+	{
+		if (*p) printf("(line %d of %s)\n",buf->line,ini.name);
+		else    printf("(end of file %s)\n",ini.name);
+	}
+
+	/* discard the remainder of the line (the newline is skipped by the next scan) */
+	if (ok && nl)
+	{
+		while (*end && *end != '\n') end++;
+	}
+	buf->pos = (long) (end - buf->text);
+
     return(!ok);
 }
 
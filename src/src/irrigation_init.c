@@ -109,7 +109,7 @@ int irrigation_init(file init, control_struct* ctrl, irrigation_struct* IRG)
 
 	if (IRG->IRG_flag == 2)
 	{
-		fclose (IRG_file.ptr);
+		file_close (&IRG_file);
 	}
 	
 	
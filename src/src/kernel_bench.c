@@ -0,0 +1,375 @@
+/*
+kernel_bench.c
+micro-benchmarks of the process routines: the calls recorded by the model
+(muso --record <file>, see kernelrec.c) are replayed without the rest of the
+model. Every record is checked first: the routine is called on the recorded
+input and its output is compared with the recorded output (8-byte words as
+doubles, maximal relative difference). Then the routine is called on the
+records in turn under a timer, the arguments it changes are restored before
+every call; the time of the restores is measured separately and subtracted.
+build and run from the src directory: make bench_kernels
+
+usage: kernel_bench [-n calls] [-s seconds] [-e tolerance] <record file> [routine ...]
+
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+Biome-BGCMuSo v4.0.2
+Copyright 2016, D. Hidy [dori.hidy@gmail.com]
+Hungarian Academy of Sciences, Hungary
+See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentation, model executable and example input files.
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "bgc_struct.h"
+#include "bgc_func.h"
+#include "bgc_constants.h"
+#include "misc_func.h"
+
+/* kinds of the arguments */
+#define KA_IN     0    /* not changed by the routine */
+#define KA_INOUT  1    /* read and changed: restored before every call */
+#define KA_OUT    2    /* only written: cleared before every call */
+#define KA_EPC    3    /* epconst_struct (input), the pointers are cleared */
+#define KA_SITEC  4    /* siteconst_struct (input), the pointers are cleared */
+
+typedef struct
+{
+	size_t size;       /* 0: variable size (arrays) */
+	int kind;
+} karg;
+
+typedef struct
+{
+	int nargs;
+	karg arg[KREC_MAXARGS];
+} ksig;
+
+/* the arguments of the routines, in the order of the records (KR_* in bgc_func.h) */
+static const ksig sig[N_KERNELS] =
+{
+	/* photosynthesis_n: epc, metv, psn_sun, psn_shade */
+	{ 4, { {sizeof(epconst_struct), KA_EPC}, {sizeof(metvar_struct), KA_IN},
+	       {sizeof(psn_struct), KA_INOUT}, {sizeof(psn_struct), KA_INOUT} } },
+	/* richards: sitec, epc, epv, ws, wf */
+	{ 5, { {sizeof(siteconst_struct), KA_SITEC}, {sizeof(epconst_struct), KA_EPC},
+	       {sizeof(epvar_struct), KA_INOUT}, {sizeof(wstate_struct), KA_INOUT}, {sizeof(wflux_struct), KA_INOUT} } },
+	/* decomp: metv, epc, epv, sitec, cs, cf, ns, nf, nt */
+	{ 9, { {sizeof(metvar_struct), KA_IN}, {sizeof(epconst_struct), KA_EPC}, {sizeof(epvar_struct), KA_INOUT},
+	       {sizeof(siteconst_struct), KA_SITEC}, {sizeof(cstate_struct), KA_INOUT}, {sizeof(cflux_struct), KA_INOUT},
+	       {sizeof(nstate_struct), KA_INOUT}, {sizeof(nflux_struct), KA_INOUT}, {sizeof(ntemp_struct), KA_INOUT} } },
+	/* multilayer_tsoil: yday, epc, sitec, ws, metv, epv */
+	{ 6, { {sizeof(int), KA_IN}, {sizeof(epconst_struct), KA_EPC}, {sizeof(siteconst_struct), KA_SITEC},
+	       {sizeof(wstate_struct), KA_IN}, {sizeof(metvar_struct), KA_INOUT}, {sizeof(epvar_struct), KA_INOUT} } },
+	/* canopy_et: epc, metv, epv, wf */
+	{ 4, { {sizeof(epconst_struct), KA_EPC}, {sizeof(metvar_struct), KA_IN},
+	       {sizeof(epvar_struct), KA_INOUT}, {sizeof(wflux_struct), KA_INOUT} } },
+	/* run_avg: input, output, (n, w, w_flag) */
+	{ 3, { {0, KA_IN}, {0, KA_OUT}, {3 * sizeof(int), KA_IN} } }
+};
+
+typedef struct
+{
+	int id;
+	int nblock;
+	unsigned int size[KREC_MAXARGS];
+	char* in[KREC_MAXARGS];
+	char* out[KREC_MAXARGS];
+} krecord;
+
+static double wall_seconds(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec + 1e-9 * (double) ts.tv_nsec;
+}
+
+static int call_kernel(int id, void** a)
+{
+	psn_struct* psn[2];
+	const int* par;
+
+	switch (id)
+	{
+	case KR_PHOTOSYNTHESIS:
+		psn[0] = (psn_struct*) a[2];
+		psn[1] = (psn_struct*) a[3];
+		return photosynthesis_n((const epconst_struct*) a[0], (const metvar_struct*) a[1], psn, 2);
+	case KR_RICHARDS:
+		return richards((const siteconst_struct*) a[0], (const epconst_struct*) a[1], (epvar_struct*) a[2],
+		                (wstate_struct*) a[3], (wflux_struct*) a[4]);
+	case KR_DECOMP:
+		return decomp((const metvar_struct*) a[0], (const epconst_struct*) a[1], (epvar_struct*) a[2],
+		              (const siteconst_struct*) a[3], (cstate_struct*) a[4], (cflux_struct*) a[5],
+		              (nstate_struct*) a[6], (nflux_struct*) a[7], (ntemp_struct*) a[8]);
+	case KR_TSOIL:
+		return multilayer_tsoil(*(const int*) a[0], (const epconst_struct*) a[1], (const siteconst_struct*) a[2],
+		                        (const wstate_struct*) a[3], (metvar_struct*) a[4], (epvar_struct*) a[5]);
+	case KR_CANOPY_ET:
+		return canopy_et((const epconst_struct*) a[0], (const metvar_struct*) a[1], (epvar_struct*) a[2], (wflux_struct*) a[3]);
+	case KR_RUN_AVG:
+		par = (const int*) a[2];
+		return run_avg((const double*) a[0], (double*) a[1], par[0], par[1], par[2]);
+	}
+	return 1;
+}
+
+/* the records of the file, checked against the argument lists */
+static krecord* read_records(const char* name, int* nrec)
+{
+	FILE* f;
+	char magic[8];
+	int header[2];
+	int b, n, size;
+	krecord* rec = NULL;
+	krecord* r;
+
+	*nrec = 0;
+	f = fopen(name, "rb");
+	if (!f)
+	{
+		printf("Error opening record file %s\n", name);
+		return NULL;
+	}
+	if (fread(magic, 1, 8, f) != 8 || memcmp(magic, KREC_MAGIC, 8) || fread(header, sizeof(int), 2, f) != 2 ||
+		header[0] != KREC_VERSION || header[1] != N_KERNELS)
+	{
+		printf("Error: %s is not a record file of this version (muso --record)\n", name);
+		fclose(f);
+		return NULL;
+	}
+
+	n = 0;
+	while (fread(header, sizeof(int), 2, f) == 2)
+	{
+		if (n % 256 == 0)
+		{
+			rec = (krecord*) realloc(rec, (n + 256) * sizeof(krecord));
+			if (!rec)
+			{
+				printf("Error allocating memory in kernel_bench\n");
+				fclose(f);
+				return NULL;
+			}
+		}
+		r = &rec[n];
+		r->id = header[0];
+		r->nblock = header[1];
+		if (r->id < 0 || r->id >= N_KERNELS || r->nblock != sig[r->id].nargs)
+		{
+			printf("Error: invalid record %d in %s\n", n, name);
+			fclose(f);
+			return NULL;
+		}
+		for (b = 0; b < r->nblock; b++)
+		{
+			if (fread(&r->size[b], sizeof(unsigned int), 1, f) != 1 ||
+				(sig[r->id].arg[b].size && r->size[b] != sig[r->id].arg[b].size))
+			{
+				printf("Error: the record file %s is written by another build (size of argument %d of %s)\n",
+					name, b+1, kernelrec_name[r->id]);
+				fclose(f);
+				return NULL;
+			}
+			/* in and out image in one allocation, 16-byte aligned */
+			size = ((r->size[b] + 15) / 16) * 16;
+			r->in[b] = (char*) malloc(2 * size);
+			if (!r->in[b])
+			{
+				printf("Error allocating memory in kernel_bench\n");
+				fclose(f);
+				return NULL;
+			}
+			r->out[b] = r->in[b] + size;
+			if (fread(r->in[b], 1, r->size[b], f) != r->size[b] || fread(r->out[b], 1, r->size[b], f) != r->size[b])
+			{
+				printf("Error reading record %d of %s\n", n, name);
+				fclose(f);
+				return NULL;
+			}
+			/* the pointers of the recording run are not valid */
+			if (sig[r->id].arg[b].kind == KA_EPC)
+			{
+				((epconst_struct*) r->in[b])->wpm_array = NULL;
+				((epconst_struct*) r->in[b])->msc_array = NULL;
+				((epconst_struct*) r->in[b])->sgs_array = NULL;
+				((epconst_struct*) r->in[b])->egs_array = NULL;
+			}
+			if (sig[r->id].arg[b].kind == KA_SITEC)
+			{
+				((siteconst_struct*) r->in[b])->gwd_array = NULL;
+			}
+		}
+		n++;
+	}
+	fclose(f);
+
+	*nrec = n;
+	return rec;
+}
+
+/* the arguments of a call: the changed arguments in the work buffers */
+static void prepare(const krecord* r, void** a, char** work)
+{
+	int b;
+
+	for (b = 0; b < r->nblock; b++)
+	{
+		switch (sig[r->id].arg[b].kind)
+		{
+		case KA_INOUT:
+			memcpy(work[b], r->in[b], r->size[b]);
+			a[b] = work[b];
+			break;
+		case KA_OUT:
+			memset(work[b], 0xff, r->size[b]);
+			a[b] = work[b];
+			break;
+		default:
+			a[b] = r->in[b];
+		}
+	}
+}
+
+/* maximal relative difference of the changed arguments and the recorded output */
+static double compare(const krecord* r, char** work)
+{
+	int b;
+	unsigned int i;
+	double x, y, d, maxdiff;
+
+	maxdiff = 0.0;
+	for (b = 0; b < r->nblock; b++)
+	{
+		if (sig[r->id].arg[b].kind != KA_INOUT && sig[r->id].arg[b].kind != KA_OUT) continue;
+		for (i = 0; i + sizeof(double) <= r->size[b]; i += sizeof(double))
+		{
+			if (!memcmp(work[b] + i, r->out[b] + i, sizeof(double))) continue;
+			memcpy(&x, work[b] + i, sizeof(double));
+			memcpy(&y, r->out[b] + i, sizeof(double));
+			if (x != x || y != y) d = HUGE_VAL;
+			else d = fabs(x - y) / (fabs(x) > fabs(y) ? fabs(x) : fabs(y));
+			if (d > maxdiff) maxdiff = d;
+		}
+		if (i < r->size[b] && memcmp(work[b] + i, r->out[b] + i, r->size[b] - i)) maxdiff = HUGE_VAL;
+	}
+	return maxdiff;
+}
+
+int main(int argc, char* argv[])
+{
+	long ncall = 1000000;
+	double maxsec = 2.0;
+	double tol = 0.0;
+	int arg, first, id, i, k, b, nrec, nsel, nbad, nmis, selected;
+	long calls, c;
+	double d, maxdiff, t0, t_call, t_restore;
+	unsigned int maxsize[KREC_MAXARGS];
+	char* work[KREC_MAXARGS];
+	void* a[KREC_MAXARGS];
+	krecord* rec;
+	int* sel;
+
+	for (arg = 1; arg + 1 < argc && argv[arg][0] == '-'; arg += 2)
+	{
+		if      (!strcmp(argv[arg], "-n")) ncall = atol(argv[arg+1]);
+		else if (!strcmp(argv[arg], "-s")) maxsec = atof(argv[arg+1]);
+		else if (!strcmp(argv[arg], "-e")) tol = atof(argv[arg+1]);
+		else break;
+	}
+	if (arg >= argc || argv[arg][0] == '-' || ncall < 1)
+	{
+		printf("usage: kernel_bench [-n calls] [-s seconds] [-e tolerance] <record file> [routine ...]\n");
+		return EXIT_FAILURE;
+	}
+
+	rec = read_records(argv[arg], &nrec);
+	if (!rec) return EXIT_FAILURE;
+	first = arg + 1;
+
+	sel = (int*) malloc((nrec + 1) * sizeof(int));
+	if (!sel)
+	{
+		printf("Error allocating memory in kernel_bench\n");
+		return EXIT_FAILURE;
+	}
+
+	printf("%-18s %8s %10s %12s %10s %12s %12s\n", "routine", "records", "mismatch", "max.rel.diff", "calls", "ns/call", "restore(ns)");
+	nbad = 0;
+	for (id = 0; id < N_KERNELS; id++)
+	{
+		selected = (first == argc);
+		for (i = first; !selected && i < argc; i++)
+		{
+			if (!strcmp(argv[i], kernelrec_name[id])) selected = 1;
+		}
+		if (!selected) continue;
+
+		/* the records of the routine, and the work buffers for the largest arguments */
+		nsel = 0;
+		memset(maxsize, 0, sizeof(maxsize));
+		for (k = 0; k < nrec; k++)
+		{
+			if (rec[k].id != id) continue;
+			sel[nsel++] = k;
+			for (b = 0; b < rec[k].nblock; b++)
+				if (rec[k].size[b] > maxsize[b]) maxsize[b] = rec[k].size[b];
+		}
+		if (!nsel) continue;
+		for (b = 0; b < sig[id].nargs; b++)
+		{
+			work[b] = (char*) malloc(maxsize[b] + 16);
+			if (!work[b])
+			{
+				printf("Error allocating memory in kernel_bench\n");
+				return EXIT_FAILURE;
+			}
+		}
+
+		/* correctness */
+		nmis = 0;
+		maxdiff = 0.0;
+		for (k = 0; k < nsel; k++)
+		{
+			prepare(&rec[sel[k]], a, work);
+			if (call_kernel(id, a)) d = HUGE_VAL;
+			else d = compare(&rec[sel[k]], work);
+			if (d > maxdiff) maxdiff = d;
+			if (d > tol) nmis++;
+		}
+		nbad += nmis;
+
+		/* timing: the records in turn, until ncall calls or maxsec seconds */
+		calls = 0;
+		t0 = wall_seconds();
+		do
+		{
+			for (c = 0; c < 1000; c++, calls++)
+			{
+				prepare(&rec[sel[calls % nsel]], a, work);
+				call_kernel(id, a);
+			}
+			t_call = wall_seconds() - t0;
+		} while (calls < ncall && t_call < maxsec);
+
+		t0 = wall_seconds();
+		for (c = 0; c < calls; c++) prepare(&rec[sel[c % nsel]], a, work);
+		t_restore = wall_seconds() - t0;
+
+		printf("%-18s %8d %10d %12.3e %10ld %12.1f %12.1f\n", kernelrec_name[id], nsel, nmis, maxdiff, calls,
+			1e9 * (t_call - t_restore) / (double) calls, 1e9 * t_restore / (double) calls);
+
+		for (b = 0; b < sig[id].nargs; b++) free(work[b]);
+	}
+
+	for (k = 0; k < nrec; k++)
+		for (b = 0; b < rec[k].nblock; b++) free(rec[k].in[b]);
+	free(rec);
+	free(sel);
+
+	if (nbad) printf("%d record(s) differ from the recorded output by more than %g\n", nbad, tol);
+	return nbad ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,185 @@
+/*
+kernelrec.c
+recording of the process routines for the micro-benchmarks (kernel_bench.c):
+with --record <file> the images of the arguments of photosynthesis_n(),
+richards(), decomp(), multilayer_tsoil() and canopy_et() are written into a
+corpus file before the call (input) and after the call (output), on every
+KREC_EVERY-th call of a routine and at most KREC_MAX times per routine;
+the calls of run_avg() in metarr_init() are all written.
+The call sites enclose the calls in kernelrec_in()/kernelrec_out(), which cost
+only a test of kernelrec_on if the recording is off.
+
+Layout: header (magic, version, number of routines), then the records: routine
+id and number of arguments, and for every argument its size, the input image
+and the output image. The images are only valid for the same build (the
+replay checks the sizes); the pointers in the images are not valid.
+
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+Biome-BGCMuSo v4.0.2
+Copyright 2016, D. Hidy [dori.hidy@gmail.com]
+Hungarian Academy of Sciences, Hungary
+See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentation, model executable and example input files.
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include "bgc_struct.h"
+#include "bgc_func.h"
+
+#define KREC_EVERY 7      /* every 7th call of a routine is recorded */
+#define KREC_MAX   500    /* maximal number of records per routine */
+
+int kernelrec_on = 0;
+
+const char* kernelrec_name[N_KERNELS] =
+{
+	"photosynthesis_n",
+	"richards",
+	"decomp",
+	"multilayer_tsoil",
+	"canopy_et",
+	"run_avg"
+};
+
+static FILE* krec_file = NULL;
+static long krec_calls[N_KERNELS];
+static int krec_nrec[N_KERNELS];
+
+/* the arguments of the actual call (between kernelrec_in and kernelrec_out) */
+static int krec_id = -1;
+static int krec_nblock;
+static const void* krec_ptr[KREC_MAXARGS];
+static unsigned int krec_size[KREC_MAXARGS];
+static char* krec_image = NULL;
+static size_t krec_imagesize = 0;
+
+int kernelrec_open(const char* name)
+{
+	int header[2];
+
+	krec_file = fopen(name, "wb");
+	if (!krec_file)
+	{
+		printf("Error opening kernel record file %s\n", name);
+		return 1;
+	}
+	header[0] = KREC_VERSION;
+	header[1] = N_KERNELS;
+	if (fwrite(KREC_MAGIC, 1, 8, krec_file) != 8 || fwrite(header, sizeof(int), 2, krec_file) != 2)
+	{
+		printf("Error writing kernel record file %s\n", name);
+		return 1;
+	}
+	memset(krec_calls, 0, sizeof(krec_calls));
+	memset(krec_nrec, 0, sizeof(krec_nrec));
+	kernelrec_on = 1;
+
+	return 0;
+}
+
+/* pairs of (pointer, size) of the arguments: the input images are kept until kernelrec_out */
+void kernelrec_in(int id, int nblock, ...)
+{
+	va_list ap;
+	int b;
+	size_t total, pos;
+
+	krec_id = -1;
+	if (!krec_file) return;
+	if ((id != KR_RUN_AVG && krec_calls[id] % KREC_EVERY) || krec_nrec[id] >= KREC_MAX)
+	{
+		krec_calls[id]++;
+		return;
+	}
+	krec_calls[id]++;
+
+	va_start(ap, nblock);
+	total = 0;
+	for (b = 0; b < nblock && b < KREC_MAXARGS; b++)
+	{
+		krec_ptr[b] = va_arg(ap, const void*);
+		krec_size[b] = (unsigned int) va_arg(ap, size_t);
+		total += krec_size[b];
+	}
+	va_end(ap);
+
+	if (total > krec_imagesize)
+	{
+		free(krec_image);
+		krec_image = (char*) malloc(total);
+		krec_imagesize = krec_image ? total : 0;
+		if (!krec_image) return;
+	}
+	for (b = 0, pos = 0; b < nblock && b < KREC_MAXARGS; pos += krec_size[b], b++)
+	{
+		memcpy(krec_image + pos, krec_ptr[b], krec_size[b]);
+	}
+
+	krec_nblock = b;
+	krec_id = id;
+}
+
+/* the record of the call: the input images and the actual (output) images */
+void kernelrec_out(int id)
+{
+	int b;
+	int header[2];
+	size_t pos;
+
+	if (id != krec_id) return;
+
+	header[0] = id;
+	header[1] = krec_nblock;
+	fwrite(header, sizeof(int), 2, krec_file);
+	for (b = 0, pos = 0; b < krec_nblock; pos += krec_size[b], b++)
+	{
+		fwrite(&krec_size[b], sizeof(unsigned int), 1, krec_file);
+		fwrite(krec_image + pos, 1, krec_size[b], krec_file);
+		fwrite(krec_ptr[b], 1, krec_size[b], krec_file);
+	}
+	krec_nrec[id]++;
+	krec_id = -1;
+}
+
+/* run_avg() is recorded after the call: the input is not changed, the output is not read */
+void kernelrec_run_avg(const double* input, const double* output, int n, int w, int w_flag)
+{
+	int par[3];
+
+	if (!krec_file) return;
+
+	par[0] = n;
+	par[1] = w;
+	par[2] = w_flag;
+	kernelrec_in(KR_RUN_AVG, 3, (const void*) input, n * sizeof(double), (const void*) output, n * sizeof(double), (const void*) par, sizeof(par));
+	kernelrec_out(KR_RUN_AVG);
+}
+
+int kernelrec_close(void)
+{
+	int ok = 1;
+	int id;
+
+	if (!krec_file) return 0;
+
+	if (fclose(krec_file))
+	{
+		printf("Error closing kernel record file\n");
+		ok = 0;
+	}
+	krec_file = NULL;
+	kernelrec_on = 0;
+	free(krec_image);
+	krec_image = NULL;
+	krec_imagesize = 0;
+
+	for (id = 0; id < N_KERNELS; id++)
+	{
+		if (krec_nrec[id]) printf("INFORMATION: %d records of %s (%ld calls)\n", krec_nrec[id], kernelrec_name[id], krec_calls[id]);
+	}
+
+	return (!ok);
+}
@@ -21,6 +21,15 @@ See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentatio
 #include "bgc_func.h"
 #include "bgc_constants.h"
 
+/* temperature response relative to 20 deg C: tabulated for the constant Q10 */
+static double mr_tresp(int q10depend_flag, double q10, double t)
+{
+	if (q10depend_flag)
+		return pow(q10, (t - 20.0) / 10.0);
+	else
+		return tempresp(TR_Q10_MR, t);
+}
+
 int maint_resp(const cstate_struct* cs, const nstate_struct* ns,const epconst_struct* epc, const metvar_struct* metv,
 		      cflux_struct* cf, epvar_struct* epv)
 {
@@ -48,7 +57,7 @@ int maint_resp(const cstate_struct* cs, const nstate_struct* ns,const epconst_st
 	int ok=1;
 	double t1;
 	
-	double exponent;
+	double t_day;
 	double n_area_sun, n_area_shade, dlmr_area_sun, dlmr_area_shade;
 	
 	/* Hidy 2010 - calculate the tsoil exponenet regarding to froot_resp in multilayer soil */
@@ -57,6 +66,7 @@ int maint_resp(const cstate_struct* cs, const nstate_struct* ns,const epconst_st
 
 	double mrpern = epc->mrpern;
 	double acclim_const = -0.00794;
+	double acclim_mult;
 
 	froot_mr = livecroot_mr = softstem_mr = livestem_mr = 0;
 
@@ -77,8 +87,8 @@ int maint_resp(const cstate_struct* cs, const nstate_struct* ns,const epconst_st
 		t1 = ns->leafn * mrpern;
 		
 		/* leaf, day */
-		exponent = (metv->tday - 20.0) / 10.0;
-		cf->leaf_day_mr = t1 * pow(q10, exponent) * metv->dayl / n_sec_in_day;
+		t_day = mr_tresp(epc->q10depend_flag, q10, metv->tday);
+		cf->leaf_day_mr = t1 * t_day * metv->dayl / n_sec_in_day;
 
 		/* for day respiration, also determine rates of maintenance respiration
 		per unit of projected leaf area in the sunlit and shaded portions of
@@ -89,16 +99,15 @@ int maint_resp(const cstate_struct* cs, const nstate_struct* ns,const epconst_st
 		n_area_shade = 1.0/(epv->shade_proj_sla * epc->leaf_cn);
 		/* convert to respiration flux in kg C/m2 projected area/day, and
 		correct for temperature */
-		dlmr_area_sun   = n_area_sun * mrpern * pow(q10, exponent);
-		dlmr_area_shade = n_area_shade * mrpern * pow(q10, exponent);
+		dlmr_area_sun   = n_area_sun * mrpern * t_day;
+		dlmr_area_shade = n_area_shade * mrpern * t_day;
 		/* finally, convert from mass to molar units, and from a daily rate to 
 		a rate per second */
 		epv->dlmr_area_sun = dlmr_area_sun/(n_sec_in_day * 12.011e-9);
 		epv->dlmr_area_shade = dlmr_area_shade/(n_sec_in_day * 12.011e-9);
 		
 		/* leaf, night */
-		exponent = (metv->tnight - 20.0) / 10.0;
-		cf->leaf_night_mr = t1 * pow(q10, exponent) * 
+		cf->leaf_night_mr = t1 * mr_tresp(epc->q10depend_flag, q10, metv->tnight) * 
 			(n_sec_in_day - metv->dayl) / n_sec_in_day;
 	}
 	else /* no leaves on */
@@ -125,8 +134,7 @@ int maint_resp(const cstate_struct* cs, const nstate_struct* ns,const epconst_st
 			tsoil = metv->tsoil[layer];
 			
 			frootn_layer = ns->frootn * epv->rootlength_prop[layer];
-			exponent = (tsoil - 20.0) / 10.0;
-			t1 = pow(q10, exponent);
+			t1 = mr_tresp(epc->q10depend_flag, q10, tsoil);
 			froot_mr += frootn_layer * mrpern * t1;
 		}
 		
@@ -140,8 +148,7 @@ int maint_resp(const cstate_struct* cs, const nstate_struct* ns,const epconst_st
     if (cs->fruitc)
 	{
        /* fruit maintenance respiration */
-		exponent = (metv->tavg - 20.0) / 10.0;
-		t1 = pow(q10, exponent);
+		t1 = mr_tresp(epc->q10depend_flag, q10, metv->tavg);
 		cf->fruit_mr = ns->fruitn * mrpern * t1;
 	}
 	/* no fruits on */
@@ -155,8 +162,7 @@ int maint_resp(const cstate_struct* cs, const nstate_struct* ns,const epconst_st
 		softstem_mr = 0;
 
 		/* live stem maintenance respiration */
-		exponent = (metv->tavg - 20.0) / 10.0;
-		t1 = pow(q10, exponent);
+		t1 = mr_tresp(epc->q10depend_flag, q10, metv->tavg);
 		livestem_mr = ns->livestemn * mrpern * t1;
 
 		/* live coarse root maintenance respiration */
@@ -166,8 +172,7 @@ int maint_resp(const cstate_struct* cs, const nstate_struct* ns,const epconst_st
 
 			livecrootn_layer = ns->livecrootn * epv->rootlength_prop[layer];
 			
-			exponent = (tsoil - 20.0) / 10.0;
-			t1 = pow(q10, exponent);
+			t1 = mr_tresp(epc->q10depend_flag, q10, tsoil);
 			livecroot_mr += livecrootn_layer * mrpern * t1;
 		}
 		
@@ -178,8 +183,7 @@ int maint_resp(const cstate_struct* cs, const nstate_struct* ns,const epconst_st
 		livestem_mr = 0;
 	
 		/* softstem maintenance respiration */
-		exponent = (metv->tavg - 20.0) / 10.0;
-		t1 = pow(q10, exponent);
+		t1 = mr_tresp(epc->q10depend_flag, q10, metv->tavg);
 		softstem_mr = ns->softstemn * mrpern * t1;
 
 	}
@@ -193,13 +197,14 @@ int maint_resp(const cstate_struct* cs, const nstate_struct* ns,const epconst_st
 	/* Hidy 2015 - acclimation (acc_flag=1 - only respiration is acclimated, acc_flag=3 - respiration and photosynt. are acclimated) */
 	if (epc->acclimation_flag == 1 || epc->acclimation_flag == 3)
 	{
-		cf->leaf_day_mr   = cf->leaf_day_mr   * pow(10,(acclim_const * (metv->tavg10_ra-20.0)));
-		cf->leaf_night_mr = cf->leaf_night_mr * pow(10,(acclim_const * (metv->tavg10_ra-20.0)));
-		cf->froot_mr      = cf->froot_mr      * pow(10,(acclim_const * (metv->tavg10_ra-20.0)));
-		cf->fruit_mr      = cf->fruit_mr      * pow(10,(acclim_const * (metv->tavg10_ra-20.0)));
-		cf->livestem_mr   = cf->livestem_mr   * pow(10,(acclim_const * (metv->tavg10_ra-20.0)));
-		cf->livecroot_mr  = cf->livecroot_mr  * pow(10,(acclim_const * (metv->tavg10_ra-20.0)));
-		cf->softstem_mr   = cf->softstem_mr   * pow(10,(acclim_const * (metv->tavg10_ra-20.0)));
+		acclim_mult = pow(10,(acclim_const * (metv->tavg10_ra-20.0)));
+		cf->leaf_day_mr   = cf->leaf_day_mr   * acclim_mult;
+		cf->leaf_night_mr = cf->leaf_night_mr * acclim_mult;
+		cf->froot_mr      = cf->froot_mr      * acclim_mult;
+		cf->fruit_mr      = cf->fruit_mr      * acclim_mult;
+		cf->livestem_mr   = cf->livestem_mr   * acclim_mult;
+		cf->livecroot_mr  = cf->livecroot_mr  * acclim_mult;
+		cf->softstem_mr   = cf->softstem_mr   * acclim_mult;
 	}
 	
 	return (!ok);
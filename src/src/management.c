@@ -20,12 +20,18 @@ See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentatio
 #include "pointbgc_struct.h"
 #include "bgc_struct.h"
 #include "pointbgc_func.h"
+#include "bgc_func.h"
 
-int management(const control_struct* ctrl, fertilizing_struct* FRZ, grazing_struct* GRZ, harvesting_struct* HRV, 
+static int mgm_submodules_run(const control_struct* ctrl, const epconst_struct* epc, siteconst_struct* sitec, metvar_struct* metv, epvar_struct* epv,
+				   const activity_struct* act, planting_struct* PLT, thinning_struct* THN, mowing_struct* MOW, grazing_struct* GRZ,
+				   harvesting_struct* HRV, ploughing_struct* PLG, fertilizing_struct* FRZ,
+				   cflux_struct* cf, nflux_struct* nf, wflux_struct* wf, cstate_struct* cs, nstate_struct* ns, wstate_struct* ws);
+
+int management(const control_struct* ctrl, mgmcalendar_struct* mgmcal, fertilizing_struct* FRZ, grazing_struct* GRZ, harvesting_struct* HRV, 
 			   mowing_struct* MOW,planting_struct* PLT, ploughing_struct* PLG, thinning_struct* THN, irrigation_struct* IRG)
 {
 
-	/* fertilizing parameters .*/
+	/* the management events of the day are looked up in the compiled calendar (mgm_calendar.c) */
 	int md, ny;
 	int ok=1;
 	int yday = ctrl->yday;
@@ -39,14 +45,8 @@ int management(const control_struct* ctrl, fertilizing_struct* FRZ, grazing_stru
 		if (FRZ->FRZ_flag > 1) ny=ctrl->simyr;
 		else ny=0;
 
-		for(md=0; md < N_MGMDAYS; ++md)
-		{
-			if (yday == FRZ->FRZdays_array[md][ny])
-			{
-				FRZ->mgmd=md;
-				if (ctrl->onscreen && (ctrl->spinup == 0 || ctrl->simyr == 0)) printf("FERTILIZING on yday %i\n", ctrl->yday);
-			}
-		}
+		FRZ->mgmd = mgm_calendar_event(&mgmcal->FRZ, ny, yday);
+		if (FRZ->mgmd >= 0 && ctrl->onscreen && (ctrl->spinup == 0 || ctrl->simyr == 0)) printf("FERTILIZING on yday %i\n", ctrl->yday);
 	}
 
 
@@ -60,18 +60,12 @@ int management(const control_struct* ctrl, fertilizing_struct* FRZ, grazing_stru
 		else ny=0;
 
 		/* determine grazing period */
-		for(md=0; md < N_MGMDAYS; ++md)
+		md = GRZ->mgmd = mgm_calendar_event(&mgmcal->GRZ, ny, yday);
+		if (md >= 0 && ctrl->onscreen && (ctrl->spinup == 0 || ctrl->simyr == 0))
 		{
-			if (yday >= GRZ->GRZ_start_array[md][ny] && yday <= GRZ->GRZ_end_array[md][ny] )
-			{
-				GRZ->mgmd=md;
-				if (ctrl->onscreen && (ctrl->spinup == 0 || ctrl->simyr == 0))
-				{
-					if (yday == GRZ->GRZ_start_array[md][ny]) printf("FIRST DAY OF GRAZING on yday %i\n", ctrl->yday);
-			
-					if (yday == GRZ->GRZ_end_array[md][ny]) printf("LAST DAY OF GRAZING on yday %i\n", ctrl->yday);
-				}
-			}
+			if (yday == GRZ->GRZ_start_array[md][ny]) printf("FIRST DAY OF GRAZING on yday %i\n", ctrl->yday);
+	
+			if (yday == GRZ->GRZ_end_array[md][ny]) printf("LAST DAY OF GRAZING on yday %i\n", ctrl->yday);
 		}
 	}
 	
@@ -84,14 +78,8 @@ int management(const control_struct* ctrl, fertilizing_struct* FRZ, grazing_stru
 		if (HRV->HRV_flag > 1) ny=ctrl->simyr;
 		else ny=0;
 
-		for(md=0; md < N_MGMDAYS; ++md)
-		{
-			if (yday == HRV->HRVdays_array[md][ny])
-			{
-				HRV->mgmd=md;
-				if (ctrl->onscreen && (ctrl->spinup == 0 || ctrl->simyr == 0)) printf("HARVESTING on yday %i\n", ctrl->yday);
-			}
-		}
+		HRV->mgmd = mgm_calendar_event(&mgmcal->HRV, ny, yday);
+		if (HRV->mgmd >= 0 && ctrl->onscreen && (ctrl->spinup == 0 || ctrl->simyr == 0)) printf("HARVESTING on yday %i\n", ctrl->yday);
 	}
 
 
@@ -103,14 +91,8 @@ int management(const control_struct* ctrl, fertilizing_struct* FRZ, grazing_stru
 		if (MOW->MOW_flag > 1) ny=ctrl->simyr;
 		else ny=0;
 
-		for(md=0; md < N_MGMDAYS; ++md)
-		{
-			if (yday == MOW->MOWdays_array[md][ny])
-			{
-				MOW->mgmd=md;
-				if (ctrl->onscreen && (ctrl->spinup == 0 || ctrl->simyr == 0)) printf("MOWING on yday %i\n", ctrl->yday);
-			}
-		}
+		MOW->mgmd = mgm_calendar_event(&mgmcal->MOW, ny, yday);
+		if (MOW->mgmd >= 0 && ctrl->onscreen && (ctrl->spinup == 0 || ctrl->simyr == 0)) printf("MOWING on yday %i\n", ctrl->yday);
 	}
 
 
@@ -122,14 +104,8 @@ int management(const control_struct* ctrl, fertilizing_struct* FRZ, grazing_stru
 		if (PLT->PLT_flag > 1) ny=ctrl->simyr;
 		else ny=0;
 
-		for(md=0; md < N_MGMDAYS; ++md)
-		{
-			if (yday == PLT->PLTdays_array[md][ny])
-			{
-				PLT->mgmd=md;
-				if (ctrl->onscreen && (ctrl->spinup == 0 || ctrl->simyr == 0)) printf("PLANTING on yday %i\n", ctrl->yday);
-			}
-		}
+		PLT->mgmd = mgm_calendar_event(&mgmcal->PLT, ny, yday);
+		if (PLT->mgmd >= 0 && ctrl->onscreen && (ctrl->spinup == 0 || ctrl->simyr == 0)) printf("PLANTING on yday %i\n", ctrl->yday);
 	}
 
 	/* do ploughing if gapflag=1  - Hidy 2013.*/
@@ -140,14 +116,8 @@ int management(const control_struct* ctrl, fertilizing_struct* FRZ, grazing_stru
 		if (PLG->PLG_flag > 1) ny=ctrl->simyr;
 		else ny=0;
 
-		for(md=0; md < N_MGMDAYS; ++md)
-		{
-			if (yday == PLG->PLGdays_array[md][ny])
-			{
-				PLG->mgmd=md;
-				if (ctrl->onscreen && (ctrl->spinup == 0 || ctrl->simyr == 0))  printf("PLOUGHING on yday %i\n", ctrl->yday);
-			}
-		}
+		PLG->mgmd = mgm_calendar_event(&mgmcal->PLG, ny, yday);
+		if (PLG->mgmd >= 0 && ctrl->onscreen && (ctrl->spinup == 0 || ctrl->simyr == 0))  printf("PLOUGHING on yday %i\n", ctrl->yday);
 	}
 
 
@@ -159,14 +129,8 @@ int management(const control_struct* ctrl, fertilizing_struct* FRZ, grazing_stru
 		if (THN->THN_flag > 1) ny=ctrl->simyr;
 		else ny=0;
 
-		for(md=0; md < N_MGMDAYS; ++md)
-		{
-			if (yday == THN->THNdays_array[md][ny])
-			{
-				THN->mgmd=md;
-				if (ctrl->onscreen && (ctrl->spinup == 0 || ctrl->simyr == 0))  printf("THINNING on yday %i\n", ctrl->yday);
-			}
-		}
+		THN->mgmd = mgm_calendar_event(&mgmcal->THN, ny, yday);
+		if (THN->mgmd >= 0 && ctrl->onscreen && (ctrl->spinup == 0 || ctrl->simyr == 0))  printf("THINNING on yday %i\n", ctrl->yday);
 	}
 
 	/* do irrigation if gapflag=1  - Hidy 2015.*/
@@ -177,16 +141,132 @@ int management(const control_struct* ctrl, fertilizing_struct* FRZ, grazing_stru
 		if (IRG->IRG_flag > 1) ny=ctrl->simyr;
 		else ny=0;
 
-		for(md=0; md < N_MGMDAYS; ++md)
+		IRG->mgmd = mgm_calendar_event(&mgmcal->IRG, ny, yday);
+		if (IRG->mgmd >= 0 && ctrl->onscreen && (ctrl->spinup == 0 || ctrl->simyr == 0)) printf("IRRIGATION on yday %i\n", ctrl->yday);
+	}
+
+   return (!ok);
+}
+
+int mgm_submodules(const control_struct* ctrl, const epconst_struct* epc, siteconst_struct* sitec, metvar_struct* metv, epvar_struct* epv,
+				   const activity_struct* act, planting_struct* PLT, thinning_struct* THN, mowing_struct* MOW, grazing_struct* GRZ,
+				   harvesting_struct* HRV, ploughing_struct* PLG, fertilizing_struct* FRZ,
+				   cflux_struct* cf, nflux_struct* nf, wflux_struct* wf, cstate_struct* cs, nstate_struct* ns, wstate_struct* ws)
+{
+	/* management submodules in their original order; the idle ones (act flag = 0) are skipped */
+	int ok=1;
+
+#ifdef ACTIVITY_CHECK
+	/* debug mode: the full path (all submodules called) is run on copies and compared to the fast path */
+	int ndiff;
+	activity_struct act_full = *act;
+	siteconst_struct sitec_full = *sitec;
+	metvar_struct metv_full = *metv;
+	epvar_struct epv_full = *epv;
+	planting_struct PLT_full = *PLT;
+	thinning_struct THN_full = *THN;
+	mowing_struct MOW_full = *MOW;
+	grazing_struct GRZ_full = *GRZ;
+	harvesting_struct HRV_full = *HRV;
+	ploughing_struct PLG_full = *PLG;
+	fertilizing_struct FRZ_full = *FRZ;
+	cflux_struct cf_full = *cf;
+	nflux_struct nf_full = *nf;
+	wflux_struct wf_full = *wf;
+	cstate_struct cs_full = *cs;
+	nstate_struct ns_full = *ns;
+	wstate_struct ws_full = *ws;
+
+	act_full.PLT = act_full.THN = act_full.MOW = act_full.GRZ = act_full.HRV = act_full.PLG = act_full.FRZ = 1;
+
+	if (ok && mgm_submodules_run(ctrl, epc, &sitec_full, &metv_full, &epv_full, &act_full, &PLT_full, &THN_full, &MOW_full, &GRZ_full, 
+		                         &HRV_full, &PLG_full, &FRZ_full, &cf_full, &nf_full, &wf_full, &cs_full, &ns_full, &ws_full))
+	{
+		printf("Error in full path of mgm_submodules()\n");
+		ok=0;
+	}
+#endif
+
+	if (ok && mgm_submodules_run(ctrl, epc, sitec, metv, epv, act, PLT, THN, MOW, GRZ, HRV, PLG, FRZ, cf, nf, wf, cs, ns, ws))
+	{
+		ok=0;
+	}
+
+#ifdef ACTIVITY_CHECK
+	if (ok)
+	{
+		ndiff  = activity_compare("cstate", (double*) cs, (double*) &cs_full, sizeof(cstate_struct)/sizeof(double));
+		ndiff += activity_compare("nstate", (double*) ns, (double*) &ns_full, sizeof(nstate_struct)/sizeof(double));
+		ndiff += activity_compare("wstate", (double*) ws, (double*) &ws_full, sizeof(wstate_struct)/sizeof(double));
+		ndiff += activity_compare("cflux",  (double*) cf, (double*) &cf_full, sizeof(cflux_struct)/sizeof(double));
+		ndiff += activity_compare("nflux",  (double*) nf, (double*) &nf_full, sizeof(nflux_struct)/sizeof(double));
+		ndiff += activity_compare("wflux",  (double*) wf, (double*) &wf_full, sizeof(wflux_struct)/sizeof(double));
+		if (ndiff)
 		{
-			if (yday == IRG->IRGdays_array[md][ny])
-			{
-				IRG->mgmd=md;
-				if (ctrl->onscreen && (ctrl->spinup == 0 || ctrl->simyr == 0)) printf("IRRIGATION on yday %i\n", ctrl->yday);
-			}
+			printf("ACTIVITY CHECK: skipped management submodules changed %i values (simyr %i, yday %i)\n", ndiff, ctrl->simyr, ctrl->yday);
+			ok=0;
 		}
 	}
+#endif
 
-   return (!ok);
+	return (!ok);
+}
+
+static int mgm_submodules_run(const control_struct* ctrl, const epconst_struct* epc, siteconst_struct* sitec, metvar_struct* metv, epvar_struct* epv,
+				   const activity_struct* act, planting_struct* PLT, thinning_struct* THN, mowing_struct* MOW, grazing_struct* GRZ,
+				   harvesting_struct* HRV, ploughing_struct* PLG, fertilizing_struct* FRZ,
+				   cflux_struct* cf, nflux_struct* nf, wflux_struct* wf, cstate_struct* cs, nstate_struct* ns, wstate_struct* ws)
+{
+	int ok=1;
+
+	/* PLANTING - Hidy 2009. */
+	if (ok && act->PLT && planting(ctrl, epc, PLT, cf, nf, cs, ns))
+	{
+		printf("Error in planting() from bgc()\n");
+		ok=0;
+	}
+
+	/* THINNIG - Hidy 2012. */
+	if (ok && act->THN && thinning(ctrl, epc, THN, cf, nf, wf, cs, ns, ws))
+	{
+		printf("Error in thinning() from bgc()\n");
+		ok=0;
+	}
+
+	/* MOWING - Hidy 2008. */
+	if (ok && act->MOW && mowing(ctrl, epc, MOW, cf, nf, wf, cs, ns, ws))
+	{
+		printf("Error in mowing() from bgc()\n");
+		ok=0;
+	}
+
+	/* GRAZING - Hidy 2009. */
+	if (ok && act->GRZ && grazing(ctrl, epc, GRZ, cf, nf, wf, cs, ns, ws))
+	{
+		printf("Error in grazing() from bgc()\n");
+		ok=0;
+	}
+
+	/* HARVESTING - Hidy 2012. */
+	if (ok && act->HRV && harvesting(ctrl, epc, HRV, cf, nf, wf, cs, ns, ws))
+	{
+		printf("Error in harvesting() from bgc()\n");
+		ok=0;
+	}
+
+	/* PLOUGHING - Hidy 2012. */
+	if (ok && act->PLG && ploughing(ctrl, epc, sitec, metv, epv, PLG, cf, nf, wf, cs, ns, ws))
+	{
+		printf("Error in ploughing() from bgc()\n");
+		ok=0;
+	}
+
+	/* FERTILIZING -  Hidy 2008 */
+	if (ok && act->FRZ && fertilizing(ctrl, FRZ, cs, ns, cf, nf))
+	{
+		printf("Error in fertilizing() from bgc()\n");
+		ok=0;
+	}
+
+	return (!ok);
 }
-	
\ No newline at end of file
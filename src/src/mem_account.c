@@ -0,0 +1,171 @@
+/*
+mem_account.c
+tagged memory allocation: the arrays of the model (meteorology, phenology,
+management, output buffers, parameter arrays, input file buffers, restart
+records) are allocated with mem_alloc/mem_calloc/mem_realloc with the tag of
+their subsystem and released with mem_free. The current and the peak bytes of
+every subsystem are counted; mem_report writes them with the peak resident
+set size of the process into the log file, mem_free_all releases the blocks
+still allocated at the end of the run (every pointer returned by mem_alloc is
+invalid afterwards).
+Every block has a header before the returned pointer (size, tag and the links
+of the list of the allocated blocks), aligned for any type.
+
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+Biome-BGCMuSo v4.0.2
+Copyright 2016, D. Hidy [dori.hidy@gmail.com]
+Hungarian Academy of Sciences, Hungary
+See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentation, model executable and example input files.
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+#include "misc_func.h"
+
+typedef union mem_header
+{
+	struct
+	{
+		union mem_header* prev;
+		union mem_header* next;
+		size_t size;
+		int tag;
+	} h;
+	long double align;
+} mem_header;
+
+static const char* mem_tagname[N_MEMTAGS] =
+{
+	"meteorology",
+	"phenology",
+	"management",
+	"output",
+	"parameter arrays",
+	"input files",
+	"restart"
+};
+
+static mem_header* mem_list = NULL;
+static size_t mem_current[N_MEMTAGS];
+static size_t mem_peak[N_MEMTAGS];
+static size_t mem_total;
+static size_t mem_total_peak;
+
+static void mem_link(mem_header* b, int tag, size_t size)
+{
+	b->h.tag = tag;
+	b->h.size = size;
+	b->h.prev = NULL;
+	b->h.next = mem_list;
+	if (mem_list) mem_list->h.prev = b;
+	mem_list = b;
+
+	mem_current[tag] += size;
+	if (mem_current[tag] > mem_peak[tag]) mem_peak[tag] = mem_current[tag];
+	mem_total += size;
+	if (mem_total > mem_total_peak) mem_total_peak = mem_total;
+}
+
+static void mem_unlink(mem_header* b)
+{
+	if (b->h.prev) b->h.prev->h.next = b->h.next;
+	else mem_list = b->h.next;
+	if (b->h.next) b->h.next->h.prev = b->h.prev;
+
+	mem_current[b->h.tag] -= b->h.size;
+	mem_total -= b->h.size;
+}
+
+void* mem_alloc(int tag, size_t size)
+{
+	mem_header* b;
+
+	b = (mem_header*) malloc(sizeof(mem_header) + size);
+	if (!b) return NULL;
+	mem_link(b, tag, size);
+
+	return b + 1;
+}
+
+void* mem_calloc(int tag, size_t n, size_t size)
+{
+	void* p;
+
+	if (size && n > ((size_t) -1 - sizeof(mem_header)) / size) return NULL;
+	p = mem_alloc(tag, n * size);
+	if (p) memset(p, 0, n * size);
+
+	return p;
+}
+
+/* as realloc: the block keeps its contents, it is not changed if the allocation fails */
+void* mem_realloc(int tag, void* p, size_t size)
+{
+	mem_header* b;
+	mem_header* grown;
+
+	if (!p) return mem_alloc(tag, size);
+
+	b = (mem_header*) p - 1;
+	mem_unlink(b);
+	grown = (mem_header*) realloc(b, sizeof(mem_header) + size);
+	if (!grown)
+	{
+		mem_link(b, b->h.tag, b->h.size);
+		return NULL;
+	}
+	mem_link(grown, tag, size);
+
+	return grown + 1;
+}
+
+void mem_free(void* p)
+{
+	mem_header* b;
+
+	if (!p) return;
+	b = (mem_header*) p - 1;
+	mem_unlink(b);
+	free(b);
+}
+
+void mem_report(FILE* log)
+{
+	int tag;
+	double mb = 1.0 / (1024.0 * 1024.0);
+
+	fprintf(log, "Memory usage of the subsystems (MB; allocated at the end of the run and peak)\n");
+	for (tag = 0; tag < N_MEMTAGS; tag++)
+	{
+		fprintf(log, "%-27s %12.3f %12.3f\n", mem_tagname[tag], mb * (double) mem_current[tag], mb * (double) mem_peak[tag]);
+	}
+	fprintf(log, "%-27s %12.3f %12.3f\n", "total", mb * (double) mem_total, mb * (double) mem_total_peak);
+#ifndef _WIN32
+	{
+		struct rusage ru;
+		/* ru_maxrss: kilobytes on Linux */
+		if (!getrusage(RUSAGE_SELF, &ru)) fprintf(log, "%-27s %12s %12.3f\n", "resident set size", "", (double) ru.ru_maxrss / 1024.0);
+	}
+#endif
+	fprintf(log, " \n");
+}
+
+/* release every block still allocated (at the end of the run) */
+void mem_free_all(void)
+{
+	mem_header* b;
+
+	while (mem_list)
+	{
+		b = mem_list;
+		mem_list = b->h.next;
+		free(b);
+	}
+	memset(mem_current, 0, sizeof(mem_current));
+	mem_total = 0;
+}
@@ -28,7 +28,6 @@ int met_init(file init, point_struct* point)
 	int i;
 	char key1[] = "MET_INPUT";
 	char keyword[80];
-	char junk_head[1024];
 
 	/********************************************************************
 	**                                                                 **
@@ -63,10 +62,11 @@ int met_init(file init, point_struct* point)
 		ok=0;
 	}
 	
-	/* read header lines from input met data file and discard */
+	/* read header lines from input met data file and discard: directly from the
+	stream as the data lines (metarr_init), the met file is not read into memory */
 	for (i=0 ; ok && i<nhead ; i++)
 	{
-		if (scan_value(point->metf, junk_head, 's'))
+		if (fscanf(point->metf.ptr, "%*s%*[^\n]") == EOF)
 		{
 			printf("Error reading met file header line #%d\n",i+1);
 			ok=0;
@@ -20,6 +20,7 @@ See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentatio
 #include "bgc_constants.h"
 #include "pointbgc_struct.h"
 #include "pointbgc_func.h"
+#include "bgc_func.h"
 #include "misc_func.h"
 
 /* It is assumed here that the meteorological datafile contains the following 
@@ -58,7 +59,7 @@ int metarr_init(file metf, metarr_struct* metarr, const climchange_struct* scc,c
 	/* allocate space for the metv arrays */
 	if (ok)
 	{
-		metarr->tmax = (double*) malloc(ndays * sizeof(double));
+		metarr->tmax = (double*) mem_alloc(MEM_MET, ndays * sizeof(double));
 		if (!metarr->tmax)
 		{
 			printf("Error allocating for tmax array\n");
@@ -68,7 +69,7 @@ int metarr_init(file metf, metarr_struct* metarr, const climchange_struct* scc,c
 
 	if (ok)
 	{
-		metarr->tmin = (double*) malloc(ndays * sizeof(double));
+		metarr->tmin = (double*) mem_alloc(MEM_MET, ndays * sizeof(double));
 		if (!metarr->tmin)
 		{
 			printf("Error allocating for tmin array\n");
@@ -78,7 +79,7 @@ int metarr_init(file metf, metarr_struct* metarr, const climchange_struct* scc,c
 
 	if (ok)
 	{
-		metarr->prcp = (double*) malloc(ndays * sizeof(double));
+		metarr->prcp = (double*) mem_alloc(MEM_MET, ndays * sizeof(double));
 		if (!metarr->prcp)
 		{
 			printf("Error allocating for prcp array\n");
@@ -88,7 +89,7 @@ int metarr_init(file metf, metarr_struct* metarr, const climchange_struct* scc,c
 
 	if (ok)
 	{
-		metarr->vpd = (double*) malloc(ndays * sizeof(double));
+		metarr->vpd = (double*) mem_alloc(MEM_MET, ndays * sizeof(double));
 		if (!metarr->vpd)
 		{
 			printf("Error allocating for vpd array\n");
@@ -98,7 +99,7 @@ int metarr_init(file metf, metarr_struct* metarr, const climchange_struct* scc,c
 
 	if (ok)
 	{
-		metarr->tday = (double*) malloc(ndays * sizeof(double));
+		metarr->tday = (double*) mem_alloc(MEM_MET, ndays * sizeof(double));
 		if (!metarr->tday)
 		{
 			printf("Error allocating for tday array\n");
@@ -108,7 +109,7 @@ int metarr_init(file metf, metarr_struct* metarr, const climchange_struct* scc,c
 
 	if (ok)
 	{
-		metarr->tavg = (double*) malloc(ndays * sizeof(double));
+		metarr->tavg = (double*) mem_alloc(MEM_MET, ndays * sizeof(double));
 		if (!metarr->tavg)
 		{
 			printf("Error allocating for tavg11 array\n");
@@ -118,7 +119,7 @@ int metarr_init(file metf, metarr_struct* metarr, const climchange_struct* scc,c
 
 	if (ok)
 	{
-		metarr->tavg11_ra = (double*) malloc(ndays * sizeof(double));
+		metarr->tavg11_ra = (double*) mem_alloc(MEM_MET, ndays * sizeof(double));
 		if (!metarr->tavg11_ra)
 		{
 			printf("Error allocating for tavg11_ra array\n");
@@ -130,7 +131,7 @@ int metarr_init(file metf, metarr_struct* metarr, const climchange_struct* scc,c
 	
 	if (ok)
 	{
-		metarr->tavg30_ra = (double*) malloc(ndays * sizeof(double));
+		metarr->tavg30_ra = (double*) mem_alloc(MEM_MET, ndays * sizeof(double));
 		if (!metarr->tavg30_ra)
 		{
 			printf("Error allocating for tavg30_ra array\n");
@@ -140,7 +141,7 @@ int metarr_init(file metf, metarr_struct* metarr, const climchange_struct* scc,c
 
 	if (ok)
 	{
-		metarr->tavg10_ra = (double*) malloc(ndays * sizeof(double));
+		metarr->tavg10_ra = (double*) mem_alloc(MEM_MET, ndays * sizeof(double));
 		if (!metarr->tavg10_ra)
 		{
 			printf("Error allocating for tavg10_ra array\n");
@@ -150,7 +151,7 @@ int metarr_init(file metf, metarr_struct* metarr, const climchange_struct* scc,c
 
 	if (ok)
 	{
-		metarr->F_temprad = (double*) malloc(ndays * sizeof(double));
+		metarr->F_temprad = (double*) mem_alloc(MEM_MET, ndays * sizeof(double));
 		if (!metarr->F_temprad)
 		{
 			printf("Error allocating for F_temprad array\n");
@@ -160,7 +161,7 @@ int metarr_init(file metf, metarr_struct* metarr, const climchange_struct* scc,c
 
 	if (ok)
 	{
-		metarr->F_temprad_ra = (double*) malloc(ndays * sizeof(double));
+		metarr->F_temprad_ra = (double*) mem_alloc(MEM_MET, ndays * sizeof(double));
 		if (!metarr->F_temprad_ra)
 		{
 			printf("Error allocating for F_temprad_ra array\n");
@@ -170,7 +171,7 @@ int metarr_init(file metf, metarr_struct* metarr, const climchange_struct* scc,c
 
 	if (ok)
 	{
-		metarr->swavgfd = (double*) malloc(ndays * sizeof(double));
+		metarr->swavgfd = (double*) mem_alloc(MEM_MET, ndays * sizeof(double));
 		if (!metarr->swavgfd)
 		{
 			printf("Error allocating for swavgfd array\n");
@@ -180,7 +181,7 @@ int metarr_init(file metf, metarr_struct* metarr, const climchange_struct* scc,c
 	
 	if (ok)
 	{
-		metarr->par = (double*) malloc(ndays * sizeof(double));
+		metarr->par = (double*) mem_alloc(MEM_MET, ndays * sizeof(double));
 		if (!metarr->par)
 		{
 			printf("Error allocating for par array\n");
@@ -190,7 +191,7 @@ int metarr_init(file metf, metarr_struct* metarr, const climchange_struct* scc,c
 	
 	if (ok)
 	{
-		metarr->dayl = (double*) malloc(ndays * sizeof(double));
+		metarr->dayl = (double*) mem_alloc(MEM_MET, ndays * sizeof(double));
 		if (!metarr->dayl)
 		{
 			printf("Error allocating for dayl array\n");
@@ -284,5 +285,14 @@ int metarr_init(file metf, metarr_struct* metarr, const climchange_struct* scc,c
 		printf("Error: run_avg() in metv_init.c \n");
 		ok = 0;
 	}
+
+	/* recording of the running averages for the micro-benchmarks (--record) */
+	if (ok && kernelrec_on)
+	{
+		kernelrec_run_avg(metarr->tavg, metarr->tavg11_ra, ndays, 11, 1);
+		kernelrec_run_avg(metarr->tavg, metarr->tavg30_ra, ndays, 30, 0);
+		kernelrec_run_avg(metarr->tavg, metarr->tavg10_ra, ndays, 10, 0);
+		kernelrec_run_avg(metarr->F_temprad, metarr->F_temprad_ra, ndays, 5, 0);
+	}
 	return (!ok);
 }
@@ -0,0 +1,165 @@
+/*
+mgm_calendar.c
+compiled management calendar: the management days of the input arrays are
+converted once before the simulation into a sorted list of day segments per
+year (one allocation per management type), management() looks up the event
+of the actual day with a cursor instead of scanning the event arrays every day.
+A segment is a run of days with the same event (one day for the single-day
+events, the grazing period for grazing); where events fall on the same day
+(or grazing periods overlap) the segment gets the event with the highest
+index, as the daily scan did. The calendar has no limit on the number of
+events in a year.
+
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+Biome-BGCMuSo v4.0.2
+Copyright 2016, D. Hidy [dori.hidy@gmail.com]
+Hungarian Academy of Sciences, Hungary
+See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentation, model executable and example input files.
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "ini.h"
+#include "bgc_struct.h"
+#include "bgc_func.h"
+#include "bgc_constants.h"
+#include "misc_func.h"
+
+/* event of the day in the input arrays (end=NULL: single-day events), -1: no event */
+static int day_event(double** start, double** end, int ny, int yday)
+{
+	int md;
+	int event = -1;
+
+	for (md = 0; md < N_MGMDAYS; md++)
+	{
+		if (end)
+		{
+			if (yday >= start[md][ny] && yday <= end[md][ny]) event = md;
+		}
+		else
+		{
+			if (yday == start[md][ny]) event = md;
+		}
+	}
+
+	return event;
+}
+
+static int calendar_build(int flag, int simyears, double** start, double** end, mgmcal_struct* cal)
+{
+	int ny, yday, event, prev, nseg, pass;
+	int* block;
+
+	memset(cal, 0, sizeof(mgmcal_struct));
+	cal->ny = -1;
+	if (!flag) return 0;
+
+	/* yearly varied (flag=2) or constant management days (flag=1) */
+	cal->nyears = (flag > 1) ? simyears : 1;
+
+	/* first pass: number of segments, second pass: filling the segments */
+	block = NULL;
+	nseg = 0;
+	for (pass = 0; pass < 2; pass++)
+	{
+		if (pass == 1)
+		{
+			block = (int*) mem_alloc(MEM_MGM, (cal->nyears + 1 + 3 * nseg) * sizeof(int));
+			if (!block)
+			{
+				printf("Error allocating for management calendar, mgm_calendar_init()\n");
+				return 1;
+			}
+			cal->first = block;
+			cal->start = cal->first + cal->nyears + 1;
+			cal->end   = cal->start + nseg;
+			cal->md    = cal->end + nseg;
+		}
+
+		nseg = 0;
+		for (ny = 0; ny < cal->nyears; ny++)
+		{
+			if (pass == 1) cal->first[ny] = nseg;
+			prev = -1;
+			for (yday = 0; yday < NDAY_OF_YEAR; yday++)
+			{
+				event = day_event(start, end, ny, yday);
+				if (event >= 0 && event == prev)
+				{
+					if (pass == 1) cal->end[nseg-1] = yday;
+				}
+				else if (event >= 0)
+				{
+					if (pass == 1)
+					{
+						cal->start[nseg] = yday;
+						cal->end[nseg] = yday;
+						cal->md[nseg] = event;
+					}
+					nseg++;
+				}
+				prev = event;
+			}
+		}
+		if (pass == 1) cal->first[cal->nyears] = nseg;
+	}
+
+	return 0;
+}
+
+int mgm_calendar_init(const control_struct* ctrl, const fertilizing_struct* FRZ, const grazing_struct* GRZ, const harvesting_struct* HRV,
+			   const mowing_struct* MOW, const planting_struct* PLT, const ploughing_struct* PLG, const thinning_struct* THN,
+			   const irrigation_struct* IRG, mgmcalendar_struct* mgmcal)
+{
+	int ok = 1;
+
+	memset(mgmcal, 0, sizeof(mgmcalendar_struct));
+
+	if (ok && calendar_build(FRZ->FRZ_flag, ctrl->simyears, FRZ->FRZdays_array, NULL, &mgmcal->FRZ)) ok=0;
+	if (ok && calendar_build(GRZ->GRZ_flag, ctrl->simyears, GRZ->GRZ_start_array, GRZ->GRZ_end_array, &mgmcal->GRZ)) ok=0;
+	if (ok && calendar_build(HRV->HRV_flag, ctrl->simyears, HRV->HRVdays_array, NULL, &mgmcal->HRV)) ok=0;
+	if (ok && calendar_build(MOW->MOW_flag, ctrl->simyears, MOW->MOWdays_array, NULL, &mgmcal->MOW)) ok=0;
+	if (ok && calendar_build(PLT->PLT_flag, ctrl->simyears, PLT->PLTdays_array, NULL, &mgmcal->PLT)) ok=0;
+	if (ok && calendar_build(PLG->PLG_flag, ctrl->simyears, PLG->PLGdays_array, NULL, &mgmcal->PLG)) ok=0;
+	if (ok && calendar_build(THN->THN_flag, ctrl->simyears, THN->THNdays_array, NULL, &mgmcal->THN)) ok=0;
+	if (ok && calendar_build(IRG->IRG_flag, ctrl->simyears, IRG->IRGdays_array, NULL, &mgmcal->IRG)) ok=0;
+
+	return (!ok);
+}
+
+int mgm_calendar_event(mgmcal_struct* cal, int ny, int yday)
+{
+	/* the cursor is moved forward within the year, it is reset at a new year
+	(or if the days are not called in increasing order) */
+	if (ny < 0 || ny >= cal->nyears) return -1;
+
+	if (ny != cal->ny || yday < cal->yday)
+	{
+		cal->ny = ny;
+		cal->cur = cal->first[ny];
+	}
+	cal->yday = yday;
+
+	while (cal->cur < cal->first[ny+1] && cal->end[cal->cur] < yday) cal->cur++;
+
+	if (cal->cur < cal->first[ny+1] && cal->start[cal->cur] <= yday) return cal->md[cal->cur];
+
+	return -1;
+}
+
+void mgm_calendar_free(mgmcalendar_struct* mgmcal)
+{
+	mem_free(mgmcal->FRZ.first);
+	mem_free(mgmcal->GRZ.first);
+	mem_free(mgmcal->HRV.first);
+	mem_free(mgmcal->MOW.first);
+	mem_free(mgmcal->PLT.first);
+	mem_free(mgmcal->PLG.first);
+	mem_free(mgmcal->THN.first);
+	mem_free(mgmcal->IRG.first);
+	memset(mgmcal, 0, sizeof(mgmcalendar_struct));
+}
@@ -133,7 +133,7 @@ int mowing_init(file init, control_struct* ctrl, mowing_struct* MOW)
 
 	if (MOW->MOW_flag == 2)
 	{
-		fclose (MOW_file.ptr);
+		file_close (&MOW_file);
 	}
 		
 	MOW->mgmd = -1;	
@@ -79,22 +79,28 @@ int multilayer_hydrolprocess(const control_struct* ctrl, const siteconst_struct*
 	/* 2. PERCOLATION  AND DIFFUSION  */
 	if (epc->SHCM_flag == 0)
 	{
+		PROF_BEGIN(PT_RICHARDS);
+		if (kernelrec_on) kernelrec_in(KR_RICHARDS, 5, KR_ARG(*sitec), KR_ARG(*epc), KR_ARG(*epv), KR_ARG(*ws), KR_ARG(*wf));
 		if (ok && richards(sitec, epc, epv, ws, wf))
 		{
 			printf("Error in richards() from bgc()\n");
 			ok=0; 
 		} 
+		if (kernelrec_on) kernelrec_out(KR_RICHARDS);
+		PROF_END(PT_RICHARDS);
 		#ifdef DEBUG
 					printf("%d\t%d\tdone richards\n",simyr,yday);
 		#endif	
 	}
 	else
 	{
+		PROF_BEGIN(PT_TIPPING);
 		if (ok && tipping(sitec, epc, epv, ws, wf))
 		{
 			printf("Error in tipping() from bgc()\n");
 			ok=0;
 		} 
+		PROF_END(PT_TIPPING);
 		#ifdef DEBUG
 					printf("%d\t%d\tdone tipping\n",simyr,yday);
 		#endif	
@@ -0,0 +1,489 @@
+/*
+muso_bench.c
+benchmark suite of the model: canonical runs built from the sample inputs
+(HU-He2 and the grass sample) and from a synthetic long met file, timed with
+the peak resident memory of the model process.
+build and run from the src directory: make bench (make bench_baseline writes
+the results as the new baseline)
+
+The cases are the sample init files with edits (a value of a line is changed,
+the line is found by its comment), the runs of a case are separate processes
+of the model executable (harness.c). The cases cover the spinup, the daily output, the
+soil hydrology (Richards method with wet soil), the management and many sites
+(the same run with different site constants, --set). The normal runs start
+from the restart files of the spinup cases, so these run first (if only
+some cases are selected, the spinup cases they need are run untimed).
+The results (wall time, simulated days per second, peak RSS) are written in a
+tab separated file and compared with the baseline file of the same format:
+a case is a regression if its wall time or peak RSS is greater than in the
+baseline by more than the tolerance (percent, -t and -r).
+
+usage: muso_bench [-m muso] [-d rundir] [-o results] [-b baseline] [-w]
+                  [-n repeats] [-t time tolerance] [-r RSS tolerance] [case ...]
+
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+Biome-BGCMuSo v4.0.2
+Copyright 2016, D. Hidy [dori.hidy@gmail.com]
+Hungarian Academy of Sciences, Hungary
+See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentation, model executable and example input files.
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "harness.h"
+
+#define MAX_EDITS 16
+#define MAX_SITES 16
+#define MAX_LINE 1000
+#define NDAY 365
+
+/* synthetic long met file: the HU-He2 met data of 1901-2000 cycled */
+#define LONGMET_FILE "bench_long.mtc43"
+#define LONGMET_SOURCE "hhs_1901-2000.mtc43"
+#define LONGMET_HEADER 4
+#define LONGMET_YEARS 200
+#define LONGMET_FIRST 2009
+
+typedef struct
+{
+	const char* name;
+	const char* dir;                  /* subdirectory of the run directory */
+	const char* ini;                  /* sample init file */
+	int spinup;                       /* spinup run: the days are read from the log */
+	int daily;                        /* number of daily output variables (0: not changed, -1: all) */
+	int nsites;                       /* number of runs with different site constants (0: one run) */
+	const char* set;                  /* parameter override of every run (or NULL) */
+	const char* restart;              /* case writing the restart file of the case (or NULL) */
+	harness_edit edit[MAX_EDITS];
+} bench_case;
+
+static const bench_case cases[] =
+{
+	/* spinup-dominated */
+	{ "spinup_he2", "he2", "spinup.ini", 1, 0, 0, NULL, NULL,
+		{ {"for on-screen progress indicator", "0"} } },
+	{ "spinup_grass", "grass", "SC_hist_c3_S.ini", 1, 0, 0, NULL, NULL,
+		{ {"for on-screen progress indicator", "0"} } },
+
+	/* daily output heavy: every daily variable, monthly and annual averages */
+	{ "daily_he2", "he2", "normal.ini", 0, -1, 0, NULL, "spinup_he2",
+		{ {"met file name", LONGMET_FILE}, {"number of meteorological data years", "200"},
+		  {"number of simulation years", "200"}, {"do MOWING?", "0"},
+		  {"1 = write daily output", "1"}, {"1 = monthly avg of daily variables", "1"},
+		  {"1 = annual avg of daily variables", "1"}, {"1 = write annual output", "1"},
+		  {"for on-screen progress indicator", "0"} } },
+
+	/* wet soil: triple precipitation, medium discretization level of the Richards method */
+	{ "wet_he2", "he2", "normal.ini", 0, 0, 0, "epc.discretlevel_Richards=1", "spinup_he2",
+		{ {"met file name", LONGMET_FILE}, {"number of meteorological data years", "200"},
+		  {"number of simulation years", "200"}, {"multiplier for PRCP", "3.0"}, {"do MOWING?", "0"},
+		  {"1 = write daily output", "0"}, {"for on-screen progress indicator", "0"} } },
+
+	/* management: every management type in every year */
+	{ "mgm_he2", "he2", "normal.ini", 0, 0, 0, NULL, "spinup_he2",
+		{ {"met file name", LONGMET_FILE}, {"number of meteorological data years", "200"},
+		  {"number of simulation years", "200"}, {"do PLANTING?", "1"}, {"do THINNING?", "1"},
+		  {"do MOWING?", "1"}, {"do GRAZING?", "1"}, {"do HARVESTING?", "1"}, {"do PLOUGHING?", "1"},
+		  {"do FERTILIZING?", "1"}, {"do IRRIGATION?", "1"},
+		  {"1 = write daily output", "0"}, {"for on-screen progress indicator", "0"} } },
+
+	/* many sites: the grass run with different latitude and elevation */
+	{ "sites_grass", "grass", "SC_hist_c3_N.ini", 0, 0, MAX_SITES, NULL, "spinup_grass",
+		{ {"1 = write daily output", "0"}, {"for on-screen progress indicator", "0"} } }
+};
+
+#define N_CASES ((int)(sizeof(cases) / sizeof(cases[0])))
+
+typedef struct
+{
+	char name[64];
+	double wall;        /* s */
+	double days;        /* simulated days */
+	long rss;           /* peak RSS of the model process, kB */
+	int ok;
+} bench_result;
+
+/* value of a line of an init file (first field of the line containing key) */
+static int ini_value(const char* path, const char* key, char* value, int size)
+{
+	char line[MAX_LINE];
+	char field[MAX_LINE];
+	FILE* f;
+	int found = 0;
+
+	f = fopen(path, "r");
+	if (!f) return 1;
+	while (!found && fgets(line, sizeof(line), f))
+	{
+		if (strstr(line, key) && sscanf(line, "%s", field) == 1)
+		{
+			snprintf(value, size, "%s", field);
+			found = 1;
+		}
+	}
+	fclose(f);
+
+	return !found;
+}
+
+/* synthetic long met file: the years of the source are cycled and renumbered,
+every year gets a temperature offset (deterministic, within +-1 Celsius) */
+static int genmet(const char* src, const char* dst, int nheader, int nyears, int firstyear)
+{
+	int ok = 1;
+	int i, n, ndays, year, yday, y;
+	double tmax, tmin, tday, prcp, vpd, srad, dayl, offset;
+	double* data;
+	unsigned int seed = 12345u;
+	char line[MAX_LINE];
+	FILE* fin;
+	FILE* fout;
+
+	fin = fopen(src, "r");
+	fout = fopen(dst, "w");
+	if (!fin || !fout)
+	{
+		printf("Error opening %s or %s\n", src, dst);
+		if (fin) fclose(fin);
+		if (fout) fclose(fout);
+		return 1;
+	}
+
+	for (i = 0; ok && i < nheader; i++)
+	{
+		if (!fgets(line, sizeof(line), fin)) ok = 0;
+		else fputs(line, fout);
+	}
+
+	/* the whole source: 7 values per day */
+	ndays = 0;
+	data = NULL;
+	while (ok && fgets(line, sizeof(line), fin))
+	{
+		if (sscanf(line, "%d %d %lf %lf %lf %lf %lf %lf %lf", &year, &yday, &tmax, &tmin, &tday, &prcp, &vpd, &srad, &dayl) != 9) continue;
+		if (ndays % NDAY == 0)
+		{
+			data = (double*) realloc(data, (ndays + NDAY) * 7 * sizeof(double));
+			if (!data) ok = 0;
+		}
+		if (ok)
+		{
+			data[7*ndays+0] = tmax;
+			data[7*ndays+1] = tmin;
+			data[7*ndays+2] = tday;
+			data[7*ndays+3] = prcp;
+			data[7*ndays+4] = vpd;
+			data[7*ndays+5] = srad;
+			data[7*ndays+6] = dayl;
+			ndays++;
+		}
+	}
+	if (ok && (ndays == 0 || ndays % NDAY))
+	{
+		printf("Error: %s does not contain whole years of met data\n", src);
+		ok = 0;
+	}
+
+	for (y = 0; ok && y < nyears; y++)
+	{
+		seed = seed * 1103515245u + 12345u;
+		offset = 2.0 * ((double)((seed >> 16) & 0x7fff) / 32767.0) - 1.0;
+		for (yday = 0; yday < NDAY; yday++)
+		{
+			n = 7 * ((y * NDAY + yday) % ndays);
+			fprintf(fout, "%6d %5d %7.2f %7.2f %7.2f %7.2f %8.2f %8.2f %7.0f\n", firstyear + y, yday + 1,
+				data[n] + offset, data[n+1] + offset, data[n+2] + offset, data[n+3], data[n+4], data[n+5], data[n+6]);
+		}
+	}
+
+	free(data);
+	fclose(fin);
+	fclose(fout);
+	return !ok;
+}
+
+/* spinup: the spinup years (from the log) and the transient years */
+static double spinup_days(const char* dir, const char* name)
+{
+	char path[512];
+	char line[MAX_LINE];
+	int spinyears = 0;
+	int simyears = 0;
+	FILE* f;
+
+	snprintf(path, sizeof(path), "%s/bench_%s.ini", dir, name);
+	if (!ini_value(path, "number of simulation years", line, sizeof(line))) simyears = atoi(line);
+
+	snprintf(path, sizeof(path), "%s/%s.log", dir, name);
+	f = fopen(path, "r");
+	if (f)
+	{
+		while (fgets(line, sizeof(line), f))
+		{
+			if (!strncmp(line, "spinyears =", 11)) spinyears = atoi(line + 11);
+		}
+		fclose(f);
+	}
+
+	return (double)(spinyears + simyears) * NDAY;
+}
+
+static int run_case(const char* muso, const char* rundir, const bench_case* bc, int repeats, bench_result* res)
+{
+	int ok = 1;
+	int rep, site, nruns, n;
+	char dir[256], src[512], ini[512], value[64];
+	char set1[64], set2[64];
+	char* args[10];
+	harness_edit edit[MAX_EDITS+2];
+	int nedit;
+	double wall = 0.0;
+	double sum;
+	long rss = 0;
+
+	snprintf(dir, sizeof(dir), "%s/%s", rundir, bc->dir);
+	snprintf(src, sizeof(src), "%s/%s", dir, bc->ini);
+	snprintf(ini, sizeof(ini), "%s/bench_%s.ini", dir, bc->name);
+
+	memset(res, 0, sizeof(bench_result));
+	strcpy(res->name, bc->name);
+	res->wall = -1.0;
+
+	/* the init file of the case: the edits of the case, the output prefix and the daily output list */
+	for (nedit = 0; nedit < MAX_EDITS && bc->edit[nedit].key; nedit++) edit[nedit] = bc->edit[nedit];
+	edit[nedit].key = "output prefix";
+	edit[nedit++].value = bc->name;
+	edit[nedit].key = "(filename) internal variables";
+	edit[nedit++].value = "bench_ctrl.txt";
+	if (harness_ini_write(src, ini, edit, nedit, bc->daily)) return 1;
+	snprintf(ini, sizeof(ini), "bench_%s.ini", bc->name);
+
+	nruns = bc->nsites ? bc->nsites : 1;
+	for (rep = 0; ok && rep < repeats; rep++)
+	{
+		sum = 0.0;
+		for (site = 0; ok && site < nruns; site++)
+		{
+			n = 0;
+			args[n++] = (char*) muso;
+			if (bc->set)
+			{
+				args[n++] = "--set";
+				args[n++] = (char*) bc->set;
+			}
+			if (bc->nsites)
+			{
+				sprintf(set1, "sitec.lat=%.1f", 35.0 + 1.5 * site);
+				sprintf(set2, "sitec.elev=%.0f", 50.0 + 100.0 * site);
+				args[n++] = "--set";
+				args[n++] = set1;
+				args[n++] = "--set";
+				args[n++] = set2;
+			}
+			args[n++] = ini;
+			args[n] = NULL;
+
+			if (harness_run(muso, dir, bc->name, args, &wall, &rss))
+			{
+				printf("Error: the run of %s failed, see %s/%s.stdout\n", bc->name, dir, bc->name);
+				ok = 0;
+			}
+			sum += wall;
+			if (rss > res->rss) res->rss = rss;
+		}
+		/* the fastest of the repeats */
+		if (ok && (res->wall < 0.0 || sum < res->wall)) res->wall = sum;
+	}
+
+	if (ok)
+	{
+		if (bc->spinup)
+		{
+			res->days = spinup_days(dir, bc->name);
+		}
+		else if (!ini_value(src, "number of simulation years", value, sizeof(value)))
+		{
+			/* the edited value of the case, if any */
+			for (n = 0; n < MAX_EDITS && bc->edit[n].key; n++)
+				if (!strcmp(bc->edit[n].key, "number of simulation years")) strcpy(value, bc->edit[n].value);
+			res->days = (double) atoi(value) * NDAY * nruns;
+		}
+	}
+	res->ok = ok;
+
+	return !ok;
+}
+
+static int write_results(const char* path, const bench_result* res, int n, int repeats)
+{
+	int i;
+	FILE* f;
+
+	f = fopen(path, "w");
+	if (!f)
+	{
+		printf("Error opening %s\n", path);
+		return 1;
+	}
+	fprintf(f, "# muso benchmark suite, wall time: fastest of %d repeats\n", repeats);
+	fprintf(f, "case\twall_s\tsim_days\tdays_per_s\tpeak_rss_kb\tstatus\n");
+	for (i = 0; i < n; i++)
+	{
+		fprintf(f, "%s\t%.3f\t%.0f\t%.0f\t%ld\t%s\n", res[i].name, res[i].wall, res[i].days,
+			res[i].wall > 0.0 ? res[i].days / res[i].wall : 0.0, res[i].rss, res[i].ok ? "ok" : "failed");
+	}
+	fclose(f);
+	return 0;
+}
+
+/* comparison with the baseline, returns the number of regressions and failed cases */
+static int compare(const char* path, const bench_result* res, int n, double time_tol, double rss_tol)
+{
+	int i, found, nbad;
+	char line[MAX_LINE];
+	char name[64], status[16];
+	double wall, days, dps, dwall, drss;
+	long rss;
+	const char* verdict;
+	FILE* f;
+
+	f = fopen(path, "r");
+	if (!f) printf("INFORMATION: no baseline file %s\n", path);
+
+	printf("%-14s %9s %9s %8s %10s %10s %8s  %s\n", "case", "wall(s)", "base(s)", "change%", "rss(kB)", "base(kB)", "change%", "result");
+	nbad = 0;
+	for (i = 0; i < n; i++)
+	{
+		found = 0;
+		if (f)
+		{
+			rewind(f);
+			while (!found && fgets(line, sizeof(line), f))
+			{
+				if (sscanf(line, "%63s %lf %lf %lf %ld %15s", name, &wall, &days, &dps, &rss, status) == 6 &&
+					!strcmp(name, res[i].name) && wall > 0.0 && rss > 0) found = 1;
+			}
+		}
+
+		if (!res[i].ok)
+		{
+			printf("%-14s %9s\n", res[i].name, "failed");
+			nbad++;
+			continue;
+		}
+		if (!found)
+		{
+			printf("%-14s %9.3f %9s %8s %10ld %10s %8s  %s\n", res[i].name, res[i].wall, "-", "-", res[i].rss, "-", "-", "no baseline");
+			continue;
+		}
+
+		dwall = 100.0 * (res[i].wall - wall) / wall;
+		drss = 100.0 * (double)(res[i].rss - rss) / (double) rss;
+		verdict = "ok";
+		if (dwall > time_tol || drss > rss_tol)
+		{
+			verdict = "REGRESSION";
+			nbad++;
+		}
+		printf("%-14s %9.3f %9.3f %+8.1f %10ld %10ld %+8.1f  %s\n", res[i].name, res[i].wall, wall, dwall, res[i].rss, rss, drss, verdict);
+	}
+	printf("tolerance: wall time %.1f%%, peak RSS %.1f%%\n", time_tol, rss_tol);
+
+	if (f) fclose(f);
+	return nbad;
+}
+
+int main(int argc, char* argv[])
+{
+	const char* muso = "../muso";
+	const char* rundir = "../../bench_run";
+	const char* output = "../../bench_output.txt";
+	const char* baseline = "../bench_baseline.txt";
+	int write_baseline = 0;
+	int repeats = 1;
+	double time_tol = 15.0;
+	double rss_tol = 10.0;
+	int arg, first, i, c, n, nbad, selected;
+	int done[N_CASES];
+	char src[300], dst[300];
+	bench_result res[N_CASES];
+
+	for (arg = 1; arg < argc && argv[arg][0] == '-'; arg++)
+	{
+		if (!strcmp(argv[arg], "-w"))
+		{
+			write_baseline = 1;
+			continue;
+		}
+		if (arg + 1 >= argc) break;
+		if      (!strcmp(argv[arg], "-m")) muso = argv[++arg];
+		else if (!strcmp(argv[arg], "-d")) rundir = argv[++arg];
+		else if (!strcmp(argv[arg], "-o")) output = argv[++arg];
+		else if (!strcmp(argv[arg], "-b")) baseline = argv[++arg];
+		else if (!strcmp(argv[arg], "-n")) repeats = atoi(argv[++arg]);
+		else if (!strcmp(argv[arg], "-t")) time_tol = atof(argv[++arg]);
+		else if (!strcmp(argv[arg], "-r")) rss_tol = atof(argv[++arg]);
+		else break;
+	}
+	if ((arg < argc && argv[arg][0] == '-') || repeats < 1)
+	{
+		printf("usage: muso_bench [-m muso] [-d rundir] [-o results] [-b baseline] [-w] [-n repeats] [-t time tolerance %%] [-r RSS tolerance %%] [case ...]\n");
+		return EXIT_FAILURE;
+	}
+
+	/* the synthetic long met file */
+	snprintf(src, sizeof(src), "%s/he2/%s", rundir, LONGMET_SOURCE);
+	snprintf(dst, sizeof(dst), "%s/he2/%s", rundir, LONGMET_FILE);
+	if (genmet(src, dst, LONGMET_HEADER, LONGMET_YEARS, LONGMET_FIRST))
+	{
+		printf("Error in genmet() from muso_bench\n");
+		return EXIT_FAILURE;
+	}
+
+	/* all the cases, or the cases named in the command line */
+	first = arg;
+	n = 0;
+	memset(done, 0, sizeof(done));
+	for (c = 0; c < N_CASES; c++)
+	{
+		selected = (first == argc);
+		for (i = first; !selected && i < argc; i++)
+		{
+			if (!strcmp(argv[i], cases[c].name)) selected = 1;
+		}
+		if (!selected) continue;
+
+		/* the restart file of the case, untimed */
+		for (i = 0; cases[c].restart && i < c; i++)
+		{
+			if (!done[i] && !strcmp(cases[i].name, cases[c].restart))
+			{
+				printf("running %s (restart file of %s)\n", cases[i].name, cases[c].name);
+				run_case(muso, rundir, &cases[i], 1, &res[n]);
+				done[i] = 1;
+			}
+		}
+
+		printf("running %s\n", cases[c].name);
+		run_case(muso, rundir, &cases[c], repeats, &res[n]);
+		done[c] = 1;
+		n++;
+	}
+
+	if (write_results(output, res, n, repeats)) return EXIT_FAILURE;
+	printf("results written to %s\n", output);
+
+	if (write_baseline)
+	{
+		if (write_results(baseline, res, n, repeats)) return EXIT_FAILURE;
+		printf("baseline written to %s\n", baseline);
+		return EXIT_SUCCESS;
+	}
+
+	nbad = compare(baseline, res, n, time_tol, rss_tol);
+	if (nbad) printf("%d case(s) failed or regressed\n", nbad);
+
+	return nbad ? EXIT_FAILURE : EXIT_SUCCESS;
+}
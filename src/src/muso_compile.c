@@ -0,0 +1,61 @@
+/*
+muso_compile.c
+front-end to write a binary run-configuration bundle: reads the main init file
+and all the input files it refers to (met, CO2, Ndep, EPC, management and
+groundwater files) and writes the resulting bgc input structures into one file
+that muso can start from instead of the init file.
+usage: muso-compile <initialization file name> <bundle file name>
+
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+Biome-BGCMuSo v4.0.2
+Copyright 2016, D. Hidy [dori.hidy@gmail.com]
+Hungarian Academy of Sciences, Hungary
+See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentation, model executable and example input files.
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "ini.h"
+#include "bgc_struct.h"
+#include "pointbgc_struct.h"
+#include "pointbgc_func.h"
+#include "bgc_io.h"
+
+int main(int argc, char *argv[])
+{
+	bgcin_struct bgcin;
+	point_struct point;
+	restart_ctrl_struct restart;
+	output_struct output;
+
+	if (argc != 3)
+	{
+		printf("usage: muso-compile <initialization file name> <bundle file name>\n");
+		exit(1);
+	}
+
+	/* read all the input files, without opening the restart and output files */
+	if (pointbgc_init(argv[1], &bgcin, &point, &restart, &output))
+	{
+		printf("Error in call to pointbgc_init() from muso_compile.c... Exiting\n");
+		exit(1);
+	}
+
+	if (bundle_write(argv[2], &bgcin, &point, &restart, &output))
+	{
+		printf("Error in call to bundle_write() from muso_compile.c... Exiting\n");
+		exit(1);
+	}
+
+	/* check the bundle by reading it back */
+	if (bundle_read(argv[2], &bgcin, &point, &restart, &output))
+	{
+		printf("Error in call to bundle_read() from muso_compile.c... Exiting\n");
+		exit(1);
+	}
+
+	printf("%s: %i simulation years, %i met years -> %s\n", argv[1], bgcin.ctrl.simyears, bgcin.ctrl.metyears, argv[2]);
+
+	return 0;
+}
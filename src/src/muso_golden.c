@@ -0,0 +1,831 @@
+/*
+muso_golden.c
+golden-output regression of the model: reference runs built from the sample
+inputs (HU-He2 and the grass sample: the spinup and the normal run of both),
+their outputs are stored as golden outputs once (make golden_baseline, with
+the reference build) and the outputs of a new build are compared with them
+variable by variable (make golden).
+build and run from the src directory.
+
+The cases are the sample init files with edits (harness.c, as in muso_bench.c). The
+normal runs write every daily output variable (all the valid codes of
+output_map_init) in binary format, the annual output variables of the init
+file, and a restart file; they start from the restart file of the spinup case.
+Compared files: the daily binary output (.dayout), the annual binary output
+(.annout), the annual text output (_ann.txt) and the restart record
+(.endpoint, by the field table of the file). The variables of the binary
+outputs are named by their output_map code (with the description of the
+sample init file), the columns of the text output by their header, the
+restart values by their field. The spinup cases are compared by their restart
+record only (their text output has the header only). A compared file without
+data (0 time steps) fails: it verifies nothing.
+A value is within the tolerance if |new - golden| <= abstol + reltol * |golden|
+(-a, -r; per variable with a tolerance file, -t: lines of <variable> <abstol>
+<reltol>, the variable is a code, a column name or a restart field).
+For every variable the report (-o) has the maximal absolute and relative
+error, the time of the maximal error, the first value out of the tolerance,
+and the drift: the maximal absolute error of every simulation year, so an
+error growing during the run can be told from a constant offset.
+The arguments after -- are passed to every model run (e.g. the switch of a
+fast mode), the exit status is not 0 if a run failed, a golden output is
+missing or a variable is out of the tolerance.
+
+usage: muso_golden [-m muso] [-d rundir] [-g goldendir] [-o report] [-w]
+                   [-a abstol] [-r reltol] [-t tolerance file] [case ...] [-- model arguments]
+
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+Biome-BGCMuSo v4.0.2
+Copyright 2016, D. Hidy [dori.hidy@gmail.com]
+Hungarian Academy of Sciences, Hungary
+See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentation, model executable and example input files.
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "harness.h"
+
+#define MAX_EDITS 16
+#define MAX_LINE HARNESS_MAX_LINE
+#define MAX_CODES HARNESS_MAX_CODES
+#define MAX_TOLS 256
+#define MAX_MODELARGS 32
+#define NDAY 365
+
+/* kinds of the compared files */
+#define GF_DAILY   0
+#define GF_ANNUAL  1
+#define GF_ANNTEXT 2
+#define GF_RESTART 3
+#define N_GFILES   4
+
+static const char* gfile_ext[N_GFILES] = { ".dayout", ".annout", "_ann.txt", ".endpoint" };
+static const char* gfile_kind[N_GFILES] = { "daily", "annual", "anntext", "restart" };
+
+/* sets of the compared files of a case */
+#define GFB(k)     (1 << (k))
+#define GFB_ALL    (GFB(GF_DAILY) | GFB(GF_ANNUAL) | GFB(GF_ANNTEXT) | GFB(GF_RESTART))
+
+typedef struct
+{
+	const char* name;
+	const char* dir;                  /* subdirectory of the run directory */
+	const char* ini;                  /* sample init file */
+	int daily;                        /* 1: every daily output variable, binary daily and annual output */
+	const char* restart;              /* case writing the input restart file (or NULL) */
+	int files;                        /* compared files (GFB bits) */
+	harness_edit edit[MAX_EDITS];
+} golden_case;
+
+static const golden_case cases[] =
+{
+	{ "spinup_he2", "he2", "spinup.ini", 0, NULL, GFB(GF_RESTART),
+		{ {"for on-screen progress indicator", "0"} } },
+	{ "normal_he2", "he2", "normal.ini", 1, "spinup_he2", GFB_ALL,
+		{ {"for on-screen progress indicator", "0"} } },
+	{ "spinup_grass", "grass", "SC_hist_c3_S.ini", 0, NULL, GFB(GF_RESTART),
+		{ {"for on-screen progress indicator", "0"} } },
+	{ "normal_grass", "grass", "SC_hist_c3_N.ini", 1, "spinup_grass", GFB_ALL,
+		{ {"for on-screen progress indicator", "0"} } }
+};
+
+#define N_CASES ((int)(sizeof(cases) / sizeof(cases[0])))
+
+/* values of a compared file: nrow time steps (days, years or 1) of nvar variables */
+typedef struct
+{
+	int nvar;
+	int nrow;
+	int rows_per_year;
+	char (*name)[48];
+	char (*desc)[128];
+	double* v;
+} golden_table;
+
+typedef struct
+{
+	char name[48];
+	double abstol;
+	double reltol;
+} golden_tol;
+
+static golden_tol tols[MAX_TOLS];
+static int ntols = 0;
+static double default_abstol = 1e-8;
+static double default_reltol = 1e-5;
+
+static int run_case(const char* muso, const char* rundir, const golden_case* gc, char** modelargs, int nmodelargs)
+{
+	int i, n, nedit;
+	char dir[256], src[512], ini[512];
+	char ctrlname[64], rstout[64], rstin[64];
+	char* args[MAX_MODELARGS + 3];
+	harness_edit edit[MAX_EDITS+8];
+
+	snprintf(dir, sizeof(dir), "%s/%s", rundir, gc->dir);
+	snprintf(src, sizeof(src), "%s/%s", dir, gc->ini);
+	snprintf(ini, sizeof(ini), "%s/%s.ini", dir, gc->name);
+
+	/* the init file of the case: the edits of the case, the output and restart files and the daily output list */
+	for (nedit = 0; nedit < MAX_EDITS && gc->edit[nedit].key; nedit++) edit[nedit] = gc->edit[nedit];
+	snprintf(ctrlname, sizeof(ctrlname), "golden_%s_ctrl.txt", gc->name);
+	snprintf(rstout, sizeof(rstout), "%s.endpoint", gc->name);
+	edit[nedit].key = "output prefix";
+	edit[nedit++].value = gc->name;
+	edit[nedit].key = "(filename) internal variables";
+	edit[nedit++].value = ctrlname;
+	edit[nedit].key = "1 = write restart";
+	edit[nedit++].value = "1";
+	edit[nedit].key = "name of the output restart file";
+	edit[nedit++].value = rstout;
+	if (gc->restart)
+	{
+		snprintf(rstin, sizeof(rstin), "%s.endpoint", gc->restart);
+		edit[nedit].key = "name of the input restart file";
+		edit[nedit++].value = rstin;
+	}
+	if (gc->daily)
+	{
+		edit[nedit].key = "1 = write daily output";
+		edit[nedit++].value = "1";
+		edit[nedit].key = "1 = write annual output";
+		edit[nedit++].value = "1";
+	}
+	if (harness_ini_write(src, ini, edit, nedit, gc->daily ? -1 : 0)) return 1;
+	snprintf(ini, sizeof(ini), "%s.ini", gc->name);
+
+	n = 0;
+	args[n++] = (char*) muso;
+	for (i = 0; i < nmodelargs; i++) args[n++] = modelargs[i];
+	args[n++] = ini;
+	args[n] = NULL;
+
+	if (harness_run(muso, dir, gc->name, args, NULL, NULL))
+	{
+		printf("Error: the run of %s failed, see %s/%s.stdout\n", gc->name, dir, gc->name);
+		return 1;
+	}
+	return 0;
+}
+
+static int file_exists(const char* path)
+{
+	FILE* f = fopen(path, "rb");
+	if (f) fclose(f);
+	return f != NULL;
+}
+
+static int copy_file(const char* src, const char* dst)
+{
+	char buf[65536];
+	size_t n;
+	int ok = 1;
+	FILE* fin;
+	FILE* fout;
+
+	fin = fopen(src, "rb");
+	fout = fopen(dst, "wb");
+	if (!fin || !fout)
+	{
+		printf("Error opening %s or %s\n", src, dst);
+		if (fin) fclose(fin);
+		if (fout) fclose(fout);
+		return 1;
+	}
+	while (ok && (n = fread(buf, 1, sizeof(buf), fin)) > 0)
+	{
+		if (fwrite(buf, 1, n, fout) != n) ok = 0;
+	}
+	if (ferror(fin)) ok = 0;
+	fclose(fin);
+	if (fclose(fout)) ok = 0;
+	if (!ok) printf("Error copying %s to %s\n", src, dst);
+
+	return !ok;
+}
+
+static void table_free(golden_table* t)
+{
+	free(t->name);
+	free(t->desc);
+	free(t->v);
+	memset(t, 0, sizeof(golden_table));
+}
+
+static int table_alloc(golden_table* t, int nvar, int nrow, int rows_per_year)
+{
+	t->nvar = nvar;
+	t->nrow = nrow;
+	t->rows_per_year = rows_per_year;
+	t->name = calloc(nvar > 0 ? nvar : 1, sizeof(t->name[0]));
+	t->desc = calloc(nvar > 0 ? nvar : 1, sizeof(t->desc[0]));
+	t->v = (double*) malloc(((size_t) nvar * nrow + 1) * sizeof(double));
+	if (!t->name || !t->desc || !t->v)
+	{
+		printf("Error allocating the values of a compared file\n");
+		table_free(t);
+		return 1;
+	}
+	return 0;
+}
+
+/* binary output (floats): the variables of the output section of the init file */
+static int load_binary(const char* path, const char* ini, const char* section, int rows_per_year, golden_table* t)
+{
+	int i, nvar;
+	long size, nrow;
+	float* buf;
+	FILE* f;
+	static int codes[MAX_CODES];
+	static char desc[MAX_CODES][128];
+
+	nvar = harness_ini_codes(ini, section, codes, desc, MAX_CODES);
+	if (nvar <= 0)
+	{
+		printf("Error reading the %s list of %s\n", section, ini);
+		return 1;
+	}
+
+	f = fopen(path, "rb");
+	if (!f)
+	{
+		printf("Error opening %s\n", path);
+		return 1;
+	}
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	rewind(f);
+	if (size < 0 || size % ((long) nvar * (long) sizeof(float)))
+	{
+		printf("Error: the size of %s is not a multiple of %d variables\n", path, nvar);
+		fclose(f);
+		return 1;
+	}
+	nrow = size / ((long) nvar * (long) sizeof(float));
+
+	buf = (float*) malloc((size_t) size + sizeof(float));
+	if (!buf || table_alloc(t, nvar, (int) nrow, rows_per_year) || fread(buf, 1, (size_t) size, f) != (size_t) size)
+	{
+		printf("Error reading %s\n", path);
+		free(buf);
+		table_free(t);
+		fclose(f);
+		return 1;
+	}
+	fclose(f);
+
+	for (i = 0; i < nvar; i++)
+	{
+		snprintf(t->name[i], sizeof(t->name[i]), "%d", codes[i]);
+		strcpy(t->desc[i], desc[i]);
+	}
+	for (i = 0; i < nvar * nrow; i++) t->v[i] = (double) buf[i];
+	free(buf);
+
+	return 0;
+}
+
+/* annual text output: the columns are named by the COLUMN<n>: lines of the header */
+static int load_anntext(const char* path, golden_table* t)
+{
+	char line[MAX_LINE];
+	char* p;
+	char* end;
+	int col, len, n, nvar, nrow, cap;
+	double* v;
+	double* grown;
+	double x;
+	static char name[100][48];
+	static char desc[100][128];
+	FILE* f;
+
+	f = fopen(path, "r");
+	if (!f)
+	{
+		printf("Error opening %s\n", path);
+		return 1;
+	}
+
+	nvar = 0;
+	nrow = 0;
+	cap = 64;
+	v = NULL;
+	memset(name, 0, sizeof(name));
+	while (fgets(line, sizeof(line), f))
+	{
+		/* COLUMN<n>: <name> = <description> */
+		if (sscanf(line, "COLUMN%d:", &col) == 1 && col >= 1 && col <= 100 && (p = strchr(line, ':')))
+		{
+			/* the name: the text before the '=' (the whole text without it), blanks replaced by '_' */
+			for (p++; *p == ' '; p++);
+			len = (int) strcspn(p, "=\r\n");
+			while (len > 0 && p[len-1] == ' ') len--;
+			if (len > 47) len = 47;
+			for (n = 0; n < len; n++) name[col-1][n] = p[n] == ' ' ? '_' : p[n];
+			name[col-1][len] = '\0';
+			p += strcspn(p, "=");
+			if (*p) p++;
+			while (*p == ' ') p++;
+			len = (int) strcspn(p, "\r\n");
+			if (len > 127) len = 127;
+			memcpy(desc[col-1], p, len);
+			desc[col-1][len] = '\0';
+			if (col > nvar) nvar = col;
+			continue;
+		}
+
+		/* data line: nvar numbers */
+		if (nvar == 0) continue;
+		if (!v || nrow == cap)
+		{
+			if (v) cap *= 2;
+			grown = (double*) realloc(v, (size_t) cap * nvar * sizeof(double));
+			if (!grown)
+			{
+				printf("Error allocating the values of %s\n", path);
+				free(v);
+				fclose(f);
+				return 1;
+			}
+			v = grown;
+		}
+		p = line;
+		for (n = 0; n < nvar; n++, p = end)
+		{
+			x = strtod(p, &end);
+			if (end == p) break;
+			v[nrow * nvar + n] = x;
+		}
+		if (n == nvar) nrow++;
+	}
+	fclose(f);
+
+	if (nvar == 0 || table_alloc(t, nvar, nrow, 1))
+	{
+		printf("Error: no columns in %s\n", path);
+		free(v);
+		return 1;
+	}
+	for (n = 0; n < nvar; n++)
+	{
+		strcpy(t->name[n], name[n][0] ? name[n] : "-");
+		strcpy(t->desc[n], desc[n]);
+	}
+	if (nrow) memcpy(t->v, v, (size_t) nrow * nvar * sizeof(double));
+	free(v);
+
+	return 0;
+}
+
+static unsigned int get_u32(const unsigned char* p)
+{
+	return (unsigned int) p[0] | ((unsigned int) p[1] << 8) | ((unsigned int) p[2] << 16) | ((unsigned int) p[3] << 24);
+}
+
+static double get_f64(const unsigned char* p)
+{
+	unsigned long long u = 0;
+	double d;
+	int i;
+
+	for (i = 7; i >= 0; i--) u = (u << 8) | p[i];
+	memcpy(&d, &u, sizeof(d));
+	return d;
+}
+
+/* restart record (see restart_file.c): magic, version, field table, data, checksum */
+static int load_restart(const char* path, golden_table* t)
+{
+	unsigned char* buf;
+	unsigned char* p;
+	unsigned char* fields;
+	long size;
+	unsigned int nfield, f, n, e;
+	int len, nvar, k;
+	char type;
+	char fname[33];
+	FILE* fp;
+
+	fp = fopen(path, "rb");
+	if (!fp)
+	{
+		printf("Error opening %s\n", path);
+		return 1;
+	}
+	fseek(fp, 0, SEEK_END);
+	size = ftell(fp);
+	rewind(fp);
+	buf = (unsigned char*) malloc(size > 0 ? (size_t) size : 1);
+	if (!buf || size < 20 || fread(buf, 1, (size_t) size, fp) != (size_t) size || memcmp(buf, "MUSORST1", 8))
+	{
+		printf("Error: %s is not a restart record of the portable format\n", path);
+		free(buf);
+		fclose(fp);
+		return 1;
+	}
+	fclose(fp);
+
+	/* the field table: the number of values */
+	nfield = get_u32(buf + 12);
+	fields = buf + 16;
+	p = fields;
+	nvar = 0;
+	for (f = 0; f < nfield && p + 6 <= buf + size && p + 6 + p[0] <= buf + size; f++)
+	{
+		len = p[0];
+		n = get_u32(p + 2 + len);
+		nvar += (int) n;
+		p += 6 + len;
+	}
+	if (f < nfield || table_alloc(t, nvar, 1, 1))
+	{
+		printf("Error in the field table of %s\n", path);
+		free(buf);
+		return 1;
+	}
+
+	/* the data */
+	k = 0;
+	for (f = 0, p = fields; f < nfield; f++)
+	{
+		len = p[0];
+		memcpy(fname, p + 1, len < 32 ? len : 32);
+		fname[len < 32 ? len : 32] = '\0';
+		n = get_u32(p + 2 + len);
+		p += 6 + len;
+		for (e = 0; e < n; e++, k++)
+		{
+			if (n > 1) snprintf(t->name[k], sizeof(t->name[k]), "%s[%u]", fname, e);
+			else snprintf(t->name[k], sizeof(t->name[k]), "%s", fname);
+			t->desc[k][0] = '\0';
+		}
+	}
+	for (f = 0, k = 0; f < nfield; f++)
+	{
+		len = fields[0];
+		type = (char) fields[1 + len];
+		n = get_u32(fields + 2 + len);
+		fields += 6 + len;
+		for (e = 0; e < n; e++, k++)
+		{
+			if (p + (type == 'd' ? 8 : 4) > buf + size - 4)
+			{
+				printf("Error: %s is truncated\n", path);
+				free(buf);
+				table_free(t);
+				return 1;
+			}
+			if (type == 'd')
+			{
+				t->v[k] = get_f64(p);
+				p += 8;
+			}
+			else
+			{
+				t->v[k] = (double) (int) get_u32(p);
+				p += 4;
+			}
+		}
+	}
+	free(buf);
+
+	return 0;
+}
+
+/* tolerance of a variable: the tolerance file (restart arrays by the name of the field), or the default */
+static void tolerance(const char* name, double* abstol, double* reltol)
+{
+	int i, len;
+
+	len = (int) strcspn(name, "[");
+	*abstol = default_abstol;
+	*reltol = default_reltol;
+	for (i = 0; i < ntols; i++)
+	{
+		if ((int) strlen(tols[i].name) == len && !strncmp(tols[i].name, name, len))
+		{
+			*abstol = tols[i].abstol;
+			*reltol = tols[i].reltol;
+		}
+	}
+}
+
+static int read_tolerances(const char* path)
+{
+	char line[MAX_LINE];
+	FILE* f;
+
+	f = fopen(path, "r");
+	if (!f)
+	{
+		printf("Error opening tolerance file %s\n", path);
+		return 1;
+	}
+	while (ntols < MAX_TOLS && fgets(line, sizeof(line), f))
+	{
+		if (line[0] == '#') continue;
+		if (sscanf(line, "%47s %lf %lf", tols[ntols].name, &tols[ntols].abstol, &tols[ntols].reltol) == 3) ntols++;
+	}
+	fclose(f);
+	return 0;
+}
+
+/* time of a row: year/day of the daily output, year otherwise */
+static void row_time(const golden_table* t, int row, char* s, int size)
+{
+	if (row < 0) snprintf(s, size, "-");
+	else if (t->nrow == 1) snprintf(s, size, "end");
+	else if (t->rows_per_year > 1) snprintf(s, size, "%d/%d", row / t->rows_per_year + 1, row % t->rows_per_year + 1);
+	else snprintf(s, size, "%d", row + 1);
+}
+
+/* comparison of the variables of a file, returns the number of variables out of the tolerance */
+static int compare_table(const char* casename, const char* kind, const golden_table* g, const golden_table* t,
+						 FILE* report, FILE* drift, int* nsame, int* nwithin)
+{
+	int var, row, nyear, y, nfail, nbad, rowmax, rowfirst;
+	double a, b, d, rel, abstol, reltol, maxabs, maxrel;
+	double* yearerr;
+	char tmax[32], tfirst[32];
+
+	*nsame = 0;
+	*nwithin = 0;
+	if (g->nvar != t->nvar || g->nrow != t->nrow)
+	{
+		printf("%-13s %-8s the golden output has %d variables x %d steps, the new %d x %d\n",
+			casename, kind, g->nvar, g->nrow, t->nvar, t->nrow);
+		fprintf(report, "%s\t%s\t-\tshape differs\t0\t0\t-\t-\t-\t-\t-\t-\tFAILED\n", casename, kind);
+		return 1;
+	}
+
+	nyear = (g->nrow + g->rows_per_year - 1) / g->rows_per_year;
+	yearerr = (double*) malloc((nyear > 0 ? nyear : 1) * sizeof(double));
+	if (!yearerr) return 1;
+
+	nbad = 0;
+	for (var = 0; var < g->nvar; var++)
+	{
+		if (strcmp(g->name[var], t->name[var]))
+		{
+			printf("%-13s %-8s variable %d: %s in the golden output, %s in the new\n", casename, kind, var + 1, g->name[var], t->name[var]);
+			nbad++;
+			continue;
+		}
+		tolerance(g->name[var], &abstol, &reltol);
+
+		nfail = 0;
+		maxabs = 0.0;
+		maxrel = 0.0;
+		rowmax = -1;
+		rowfirst = -1;
+		for (y = 0; y < nyear; y++) yearerr[y] = 0.0;
+		for (row = 0; row < g->nrow; row++)
+		{
+			b = g->v[row * g->nvar + var];
+			a = t->v[row * t->nvar + var];
+			if (isnan(a) && isnan(b)) continue;
+			d = (isnan(a) || isnan(b)) ? HUGE_VAL : fabs(a - b);
+			rel = b != 0.0 ? d / fabs(b) : (d > 0.0 ? HUGE_VAL : 0.0);
+			if (d > maxabs)
+			{
+				maxabs = d;
+				rowmax = row;
+			}
+			if (rel > maxrel) maxrel = rel;
+			y = row / g->rows_per_year;
+			if (d > yearerr[y]) yearerr[y] = d;
+			if (!(d <= abstol + reltol * fabs(b)))
+			{
+				if (rowfirst < 0) rowfirst = row;
+				nfail++;
+			}
+		}
+
+		if (maxabs == 0.0) (*nsame)++;
+		else if (nfail == 0) (*nwithin)++;
+		else nbad++;
+
+		row_time(g, rowmax, tmax, sizeof(tmax));
+		row_time(g, rowfirst, tfirst, sizeof(tfirst));
+		fprintf(report, "%s\t%s\t%s\t%s\t%d\t%d\t%.6e\t%.6e\t%s\t%s\t%.6e\t%.6e\t%s\n", casename, kind,
+			g->name[var], g->desc[var], g->nrow, nfail, maxabs, maxrel, tmax, tfirst,
+			nyear ? yearerr[0] : 0.0, nyear ? yearerr[nyear-1] : 0.0,
+			maxabs == 0.0 ? "identical" : (nfail ? "FAILED" : "ok"));
+		if (nfail)
+		{
+			printf("%-13s %-8s %-24.24s %-34.34s %8d %12.4e %12.4e %9s %9s\n", casename, kind, g->name[var], g->desc[var],
+				nfail, maxabs, maxrel, tmax, tfirst);
+		}
+
+		/* drift: the maximal absolute error of every year */
+		if (maxabs > 0.0 && nyear > 1)
+		{
+			fprintf(drift, "%s\t%s\t%s", casename, kind, g->name[var]);
+			for (y = 0; y < nyear; y++) fprintf(drift, "\t%.3e", yearerr[y]);
+			fprintf(drift, "\n");
+		}
+	}
+
+	free(yearerr);
+	return nbad;
+}
+
+static int load_table(int kind, const char* path, const char* ini, golden_table* t)
+{
+	switch (kind)
+	{
+		case GF_DAILY:   return load_binary(path, ini, "DAILY_OUTPUT", NDAY, t);
+		case GF_ANNUAL:  return load_binary(path, ini, "ANNUAL_OUTPUT", 1, t);
+		case GF_ANNTEXT: return load_anntext(path, t);
+		default:         return load_restart(path, t);
+	}
+}
+
+/* store (write) or compare the outputs of a case, returns the number of failures */
+static int golden_case_files(const char* rundir, const char* goldendir, const golden_case* gc, int write,
+							 FILE* report, FILE* drift)
+{
+	int k, nbad, nsame, nwithin;
+	char dir[256], path[600], gpath[600], ini[600], gini[600];
+	golden_table g, t;
+
+	snprintf(dir, sizeof(dir), "%s/%s", rundir, gc->dir);
+	snprintf(ini, sizeof(ini), "%s/%s.ini", dir, gc->name);
+	snprintf(gini, sizeof(gini), "%s/%s.ini", goldendir, gc->name);
+
+	nbad = 0;
+	if (write)
+	{
+		nbad += copy_file(ini, gini);
+		for (k = 0; k < N_GFILES; k++)
+		{
+			if (!(gc->files & GFB(k))) continue;
+			snprintf(path, sizeof(path), "%s/%s%s", dir, gc->name, gfile_ext[k]);
+			snprintf(gpath, sizeof(gpath), "%s/%s%s", goldendir, gc->name, gfile_ext[k]);
+			if (file_exists(path)) nbad += copy_file(path, gpath);
+		}
+		return nbad;
+	}
+
+	for (k = 0; k < N_GFILES; k++)
+	{
+		if (!(gc->files & GFB(k))) continue;
+		snprintf(path, sizeof(path), "%s/%s%s", dir, gc->name, gfile_ext[k]);
+		snprintf(gpath, sizeof(gpath), "%s/%s%s", goldendir, gc->name, gfile_ext[k]);
+		if (!file_exists(gpath))
+		{
+			if (file_exists(path))
+			{
+				printf("%-13s %-8s no golden output %s\n", gc->name, gfile_kind[k], gpath);
+				nbad++;
+			}
+			continue;
+		}
+		memset(&g, 0, sizeof(g));
+		memset(&t, 0, sizeof(t));
+		if (load_table(k, gpath, gini, &g) || load_table(k, path, ini, &t))
+		{
+			printf("%-13s %-8s the output can not be compared\n", gc->name, gfile_kind[k]);
+			nbad++;
+		}
+		else if (g.nrow == 0)
+		{
+			/* an empty golden output verifies nothing */
+			printf("%-13s %-8s no data in the golden output (%d variables x 0 steps)\n", gc->name, gfile_kind[k], g.nvar);
+			fprintf(report, "%s\t%s\t-\tno data\t0\t0\t-\t-\t-\t-\t-\t-\tFAILED\n", gc->name, gfile_kind[k]);
+			nbad++;
+		}
+		else
+		{
+			nbad += compare_table(gc->name, gfile_kind[k], &g, &t, report, drift, &nsame, &nwithin);
+			printf("%-13s %-8s %d variables x %d steps: %d identical, %d within the tolerance, %d out of it\n",
+				gc->name, gfile_kind[k], g.nvar, g.nrow, nsame, nwithin, g.nvar - nsame - nwithin);
+		}
+		table_free(&g);
+		table_free(&t);
+	}
+	return nbad;
+}
+
+int main(int argc, char* argv[])
+{
+	const char* muso = "../muso";
+	const char* rundir = "../../golden_run";
+	const char* goldendir = "../../golden_ref";
+	const char* reportname = "../../golden_report.txt";
+	const char* tolfile = NULL;
+	int write = 0;
+	int arg, first, last, i, c, nbad, selected;
+	int done[N_CASES];
+	int nmodelargs = 0;
+	char** modelargs = NULL;
+	char drname[600];
+	FILE* report;
+	FILE* drift;
+
+	for (arg = 1; arg < argc && argv[arg][0] == '-' && strcmp(argv[arg], "--"); arg++)
+	{
+		if (!strcmp(argv[arg], "-w"))
+		{
+			write = 1;
+			continue;
+		}
+		if (arg + 1 >= argc) break;
+		if      (!strcmp(argv[arg], "-m")) muso = argv[++arg];
+		else if (!strcmp(argv[arg], "-d")) rundir = argv[++arg];
+		else if (!strcmp(argv[arg], "-g")) goldendir = argv[++arg];
+		else if (!strcmp(argv[arg], "-o")) reportname = argv[++arg];
+		else if (!strcmp(argv[arg], "-a")) default_abstol = atof(argv[++arg]);
+		else if (!strcmp(argv[arg], "-r")) default_reltol = atof(argv[++arg]);
+		else if (!strcmp(argv[arg], "-t")) tolfile = argv[++arg];
+		else break;
+	}
+	/* the cases, and the model arguments after -- */
+	first = arg;
+	for (last = first; last < argc && strcmp(argv[last], "--"); last++);
+	if (last < argc)
+	{
+		modelargs = argv + last + 1;
+		nmodelargs = argc - last - 1;
+	}
+	if ((arg < last && argv[arg][0] == '-') || nmodelargs > MAX_MODELARGS || default_abstol < 0.0 || default_reltol < 0.0)
+	{
+		printf("usage: muso_golden [-m muso] [-d rundir] [-g goldendir] [-o report] [-w] [-a abstol] [-r reltol] [-t tolerance file] [case ...] [-- model arguments]\n");
+		return EXIT_FAILURE;
+	}
+	if (tolfile && read_tolerances(tolfile)) return EXIT_FAILURE;
+
+	/* the runs: all the cases, or the cases named in the command line (and the cases writing their restart files) */
+	nbad = 0;
+	memset(done, 0, sizeof(done));
+	for (c = 0; c < N_CASES; c++)
+	{
+		selected = (first == last);
+		for (i = first; !selected && i < last; i++)
+		{
+			if (!strcmp(argv[i], cases[c].name)) selected = 1;
+		}
+		if (!selected) continue;
+
+		for (i = 0; cases[c].restart && i < c; i++)
+		{
+			if (!done[i] && !strcmp(cases[i].name, cases[c].restart))
+			{
+				printf("running %s (restart file of %s)\n", cases[i].name, cases[c].name);
+				if (run_case(muso, rundir, &cases[i], modelargs, nmodelargs)) nbad++;
+				done[i] = 1;
+			}
+		}
+		printf("running %s\n", cases[c].name);
+		if (run_case(muso, rundir, &cases[c], modelargs, nmodelargs)) nbad++;
+		done[c] = 2;
+	}
+	if (nbad)
+	{
+		printf("%d run(s) failed\n", nbad);
+		return EXIT_FAILURE;
+	}
+
+	/* the golden outputs: the outputs of the selected cases and their init files */
+	if (write)
+	{
+		for (c = 0; c < N_CASES; c++)
+		{
+			if (done[c] == 2 && golden_case_files(rundir, goldendir, &cases[c], 1, NULL, NULL)) return EXIT_FAILURE;
+		}
+		printf("golden outputs written to %s\n", goldendir);
+		return EXIT_SUCCESS;
+	}
+
+	/* the comparison */
+	snprintf(drname, sizeof(drname), "%s.drift", reportname);
+	report = fopen(reportname, "w");
+	drift = fopen(drname, "w");
+	if (!report || !drift)
+	{
+		printf("Error opening %s or %s\n", reportname, drname);
+		return EXIT_FAILURE;
+	}
+	fprintf(report, "# muso golden-output comparison: |new - golden| <= abstol + reltol * |golden|, default abstol %g reltol %g%s%s\n",
+		default_abstol, default_reltol, tolfile ? ", tolerance file " : "", tolfile ? tolfile : "");
+	fprintf(report, "case\tfile\tvariable\tdescription\tn\tn_fail\tmax_abs\tmax_rel\tat_max\tfirst_fail\terr_first_year\terr_last_year\tresult\n");
+	fprintf(drift, "# maximal absolute error of every simulation year (variables with errors only)\n");
+	fprintf(drift, "case\tfile\tvariable\tyear1...\n");
+
+	printf("%-13s %-8s %-24s %-34s %8s %12s %12s %9s %9s\n", "case", "file", "variable", "description",
+		"n_fail", "max_abs", "max_rel", "at_max", "first");
+	for (c = 0; c < N_CASES; c++)
+	{
+		if (done[c] != 2) continue;
+		nbad += golden_case_files(rundir, goldendir, &cases[c], 0, report, drift);
+	}
+	fclose(report);
+	fclose(drift);
+	printf("tolerance: abstol %g, reltol %g%s%s\n", default_abstol, default_reltol, tolfile ? ", per variable in " : "", tolfile ? tolfile : "");
+	printf("report written to %s (drift: %s)\n", reportname, drname);
+	if (nbad) printf("%d variable(s) out of the tolerance or file(s) not compared\n", nbad);
+
+	return nbad ? EXIT_FAILURE : EXIT_SUCCESS;
+}
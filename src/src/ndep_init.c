@@ -21,6 +21,7 @@ Modified:
 #include "bgc_struct.h"
 #include "pointbgc_struct.h"
 #include "pointbgc_func.h"
+#include "misc_func.h"
 
 int ndep_init(file init, ndep_control_struct* ndep, int simyears)
 {
@@ -77,7 +78,7 @@ int ndep_init(file init, ndep_control_struct* ndep, int simyears)
 		/* allocate space for the annual Ndep array */
 		if (ok)
 		{
-			ndep->ndep_array = (double*) malloc(simyears * sizeof(double));
+			ndep->ndep_array = (double*) mem_alloc(MEM_PARAM, simyears * sizeof(double));
 			if (!ndep->ndep_array)
 			{
 				printf("Error allocating for annual Ndep array, ndep_init()\n");
@@ -100,7 +101,7 @@ int ndep_init(file init, ndep_control_struct* ndep, int simyears)
 				ok=0;
 			}
 		}
-		fclose(temp.ptr);
+		file_close(&temp);
 	}
 	else
 	{
@@ -1,6 +1,7 @@
 /* 
 output_init.c
 Reads output control information from initialization file
+(the output files are opened separately by output_open)
 
 *-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
 Biome-BGCMuSo v4.0.2
@@ -24,6 +25,7 @@ temperature to the formatted annual ascii output file.
 #include "bgc_struct.h"
 #include "pointbgc_struct.h"
 #include "pointbgc_func.h"
+#include "misc_func.h"
 
 int output_init(file init, output_struct* output)
 {
@@ -101,98 +103,6 @@ int output_init(file init, output_struct* output)
 	}
 	
 
-	/* open outfiles if specified */
-	if (ok)
-	{
-		strcpy(output->log_file.name,output->outprefix);
-		strcat(output->log_file.name,".log");
-		if (file_open(&(output->log_file),'w'))
-		{
-			printf("Error opening log_file (%s) in output_init()\n",output->log_file.name);
-			ok=0;
-		}
-	}
-
-	/* open outfiles if specified */
-	if (ok && output->dodaily)
-	{
-		strcpy(output->dayout.name,output->outprefix);
-		strcat(output->dayout.name,".dayout");
-		char type_flag = output->dodaily == 1 ? 'w' : 'o';
-		if (file_open(&(output->dayout),type_flag))
-		{
-			printf("Error opening daily outfile (%s) in output_init()\n",output->dayout.name);
-			ok=0;
-		}
-	}
-	if (ok && output->domonavg)
-	{
-		strcpy(output->monavgout.name,output->outprefix);
-		strcat(output->monavgout.name,".monavgout");
-		char type_flag = output->domonavg == 1 ? 'w' : 'o';
-		if (file_open(&(output->monavgout),type_flag))
-		{
-			printf("Error opening monthly average outfile (%s) in output_init()\n",output->monavgout.name);
-			ok=0;
-		}
-	}
-	if (ok && output->doannavg)
-	{
-		strcpy(output->annavgout.name,output->outprefix);
-		strcat(output->annavgout.name,".annavgout");
-		char type_flag = output->doannavg == 1 ? 'w' : 'o';
-		if (file_open(&(output->annavgout),type_flag))
-		{
-			printf("Error opening annual average outfile (%s) in output_init()\n",output->annavgout.name);
-			ok=0;
-		}
-	}
-	if (ok && output->doannual)
-	{
-		strcpy(output->annout.name,output->outprefix);
-		strcat(output->annout.name,".annout");
-		char type_flag = output->doannual == 1 ? 'w' : 'o';
-		if (file_open(&(output->annout),type_flag))
-		{
-			printf("Error opening annual outfile (%s) in output_init()\n",output->annout.name);
-			ok=0;
-		}
-	}
-	if (ok)
-	{
-		/* simple text output */
-		strcpy(output->anntext.name,output->outprefix);
-		strcat(output->anntext.name,"_ann.txt");
-		if (file_open(&(output->anntext),'o'))
-		{
-			printf("Error opening annual text file (%s) in output_init()\n",output->anntext.name);
-			ok=0;
-		}
-		/* write the header info for simple text file */
-		fprintf(output->anntext.ptr,"Annual summary output from BBGC MuSo v4\n");
-		fprintf(output->anntext.ptr,"COLUMN1: simulation year\n");
-		fprintf(output->anntext.ptr,"COLUMN2: ann_PRCP = annual total precipitation (mm/yr)\n");
-		fprintf(output->anntext.ptr,"COLUMN3: ann_Tavg = annual average air temperature (deg C)\n");
-		fprintf(output->anntext.ptr,"COLUMN4: max_LAI = annual maximum value of projected leaf area index (m2/m2)\n");
-		fprintf(output->anntext.ptr,"COLUMN5: ann_ET = annual total evapotranspiration (mm/yr)\n");
-		fprintf(output->anntext.ptr,"COLUMN6: ann_DP = annual total deep percolation (mm/yr)\n");
-		fprintf(output->anntext.ptr,"COLUMN7: ann_NEE = annual net ecosystem exchange (positive: net source to the atmosphere; gC/m2/yr)\n");
-		fprintf(output->anntext.ptr,"COLUMN8: ann_NBP = annual net biome production (positive: net gain; gC/m2/yr)\n");
-		fprintf(output->anntext.ptr,"COLUMN9: ann_Cchg_SNSC = annual net change of ecosystem's carbon content caused by senescence (positive: net gain; gC/m2/yr)\n");             /* by Hidy 2008. */
-		fprintf(output->anntext.ptr,"COLUMN10: ann_Cchg_PLT = annual net change of ecosystem's carbon content caused by planting (positive: net gain; gC/m2/yr)\n");      /* by Hidy 2008. */
-		fprintf(output->anntext.ptr,"COLUMN11: ann_Cchg_THN = annual net change of ecosystem's carbon content caused by thinning (positive: net gain; gC/m2/yr)\n");         /* by Hidy 2008. */
-		fprintf(output->anntext.ptr,"COLUMN12: ann_Cchg_MOW = annual net change of ecosystem's carbon content caused by mowing (positive: net gain; gC/m2/yr)\n");         /* by Hidy 2008. */
-		fprintf(output->anntext.ptr,"COLUMN13: ann_Cchg_GRZ = annual net change of ecosystem's carbon content caused by grazing(positive: net gain; gC/m2/yr)\n");          /* by Hidy 2008. */
-		fprintf(output->anntext.ptr,"COLUMN14: ann_Cchg_HRV = annual net change of ecosystem's carbon content caused by harvesting (positive: net gain; gC/m2/yr)\n");         /* by Hidy 2008. */
-		fprintf(output->anntext.ptr,"COLUMN15: ann_Cchg_FRZ = annual net change of ecosystem's carbon content caused by fertilization (positive: net gain; gC/m2/yr)\n");      /* by Hidy 2008. */
-		fprintf(output->anntext.ptr,"COLUMN16: ann_N_plus_GRZ = annual total N input from grazing (gN/m2/yr)\n");             /* by Hidy 2008. */
-		fprintf(output->anntext.ptr,"COLUMN17: ann_N_plus_FRZ = annual total N input from fertilizing (gN/m2/yr)\n");             /* by Hidy 2008. */
-		fprintf(output->anntext.ptr,"---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------\n");
-		fprintf(output->anntext.ptr,"COLUMN1  COLUMN2    COLUMN3    COLUMN4    COLUMN5    COLUMN6    COLUMN7    COLUMN8    COLUMN9    COLUMN10    COLUMN11    COLUMN12    COLUMN13    COLUMN14    COLUMN15   COLUMN16    COLUMN17\n"); 
-		fprintf(output->anntext.ptr,"---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------\n");
-
-	}
-	
 
 	/********************************************************************
 	**                                                                 **
@@ -222,7 +132,7 @@ int output_init(file init, output_struct* output)
 	/* allocate space for the daily output variable indices */
 	if (ok)
 	{
-		output->daycodes = (int*) malloc(output->ndayout * sizeof(int));
+		output->daycodes = (int*) mem_alloc(MEM_OUTPUT, output->ndayout * sizeof(int));
 		if 	(!output->daycodes)
 		{
 			printf("Error allocating for daycodes array: output_init()\n");
@@ -267,7 +177,7 @@ int output_init(file init, output_struct* output)
 	/* allocate space for the annual output variable indices */
 	if (ok)
 	{
-		output->anncodes = (int*) malloc(output->nannout * sizeof(int));
+		output->anncodes = (int*) mem_alloc(MEM_OUTPUT, output->nannout * sizeof(int));
 		if 	(!output->anncodes)
 		{
 			printf("Error allocating for anncodes array: output_init()\n");
@@ -285,11 +195,105 @@ int output_init(file init, output_struct* output)
 		}
 	}
 
-	if (!ok)
+	return (!ok);
+}
+
+int output_open(output_struct* output)
+{
+	/* opens the output files named by the output prefix and writes the header
+	of the simple annual text file */
+	int ok = 1;
+
+	/* open outfiles if specified */
+	if (ok)
+	{
+		strcpy(output->log_file.name,output->outprefix);
+		strcat(output->log_file.name,".log");
+		if (file_open(&(output->log_file),'w'))
+		{
+			printf("Error opening log_file (%s) in output_open()\n",output->log_file.name);
+			ok=0;
+		}
+	}
+
+	/* open outfiles if specified */
+	if (ok && output->dodaily)
+	{
+		strcpy(output->dayout.name,output->outprefix);
+		strcat(output->dayout.name,".dayout");
+		char type_flag = output->dodaily == 1 ? 'w' : 'o';
+		if (file_open(&(output->dayout),type_flag))
+		{
+			printf("Error opening daily outfile (%s) in output_open()\n",output->dayout.name);
+			ok=0;
+		}
+	}
+	if (ok && output->domonavg)
+	{
+		strcpy(output->monavgout.name,output->outprefix);
+		strcat(output->monavgout.name,".monavgout");
+		char type_flag = output->domonavg == 1 ? 'w' : 'o';
+		if (file_open(&(output->monavgout),type_flag))
+		{
+			printf("Error opening monthly average outfile (%s) in output_open()\n",output->monavgout.name);
+			ok=0;
+		}
+	}
+	if (ok && output->doannavg)
 	{
-		fprintf(output->log_file.ptr, "ERROR in reading output section of INI file\n");
-		fprintf(output->log_file.ptr, "SIMULATION STATUS [0 - failure; 1 - success]\n");
-		fprintf(output->log_file.ptr, "0\n");
+		strcpy(output->annavgout.name,output->outprefix);
+		strcat(output->annavgout.name,".annavgout");
+		char type_flag = output->doannavg == 1 ? 'w' : 'o';
+		if (file_open(&(output->annavgout),type_flag))
+		{
+			printf("Error opening annual average outfile (%s) in output_open()\n",output->annavgout.name);
+			ok=0;
+		}
+	}
+	if (ok && output->doannual)
+	{
+		strcpy(output->annout.name,output->outprefix);
+		strcat(output->annout.name,".annout");
+		char type_flag = output->doannual == 1 ? 'w' : 'o';
+		if (file_open(&(output->annout),type_flag))
+		{
+			printf("Error opening annual outfile (%s) in output_open()\n",output->annout.name);
+			ok=0;
+		}
+	}
+	if (ok)
+	{
+		/* simple text output */
+		strcpy(output->anntext.name,output->outprefix);
+		strcat(output->anntext.name,"_ann.txt");
+		if (file_open(&(output->anntext),'o'))
+		{
+			printf("Error opening annual text file (%s) in output_open()\n",output->anntext.name);
+			ok=0;
+		}
+		/* write the header info for simple text file */
+		fprintf(output->anntext.ptr,"Annual summary output from BBGC MuSo v4\n");
+		fprintf(output->anntext.ptr,"COLUMN1: simulation year\n");
+		fprintf(output->anntext.ptr,"COLUMN2: ann_PRCP = annual total precipitation (mm/yr)\n");
+		fprintf(output->anntext.ptr,"COLUMN3: ann_Tavg = annual average air temperature (deg C)\n");
+		fprintf(output->anntext.ptr,"COLUMN4: max_LAI = annual maximum value of projected leaf area index (m2/m2)\n");
+		fprintf(output->anntext.ptr,"COLUMN5: ann_ET = annual total evapotranspiration (mm/yr)\n");
+		fprintf(output->anntext.ptr,"COLUMN6: ann_DP = annual total deep percolation (mm/yr)\n");
+		fprintf(output->anntext.ptr,"COLUMN7: ann_NEE = annual net ecosystem exchange (positive: net source to the atmosphere; gC/m2/yr)\n");
+		fprintf(output->anntext.ptr,"COLUMN8: ann_NBP = annual net biome production (positive: net gain; gC/m2/yr)\n");
+		fprintf(output->anntext.ptr,"COLUMN9: ann_Cchg_SNSC = annual net change of ecosystem's carbon content caused by senescence (positive: net gain; gC/m2/yr)\n");             /* by Hidy 2008. */
+		fprintf(output->anntext.ptr,"COLUMN10: ann_Cchg_PLT = annual net change of ecosystem's carbon content caused by planting (positive: net gain; gC/m2/yr)\n");      /* by Hidy 2008. */
+		fprintf(output->anntext.ptr,"COLUMN11: ann_Cchg_THN = annual net change of ecosystem's carbon content caused by thinning (positive: net gain; gC/m2/yr)\n");         /* by Hidy 2008. */
+		fprintf(output->anntext.ptr,"COLUMN12: ann_Cchg_MOW = annual net change of ecosystem's carbon content caused by mowing (positive: net gain; gC/m2/yr)\n");         /* by Hidy 2008. */
+		fprintf(output->anntext.ptr,"COLUMN13: ann_Cchg_GRZ = annual net change of ecosystem's carbon content caused by grazing(positive: net gain; gC/m2/yr)\n");          /* by Hidy 2008. */
+		fprintf(output->anntext.ptr,"COLUMN14: ann_Cchg_HRV = annual net change of ecosystem's carbon content caused by harvesting (positive: net gain; gC/m2/yr)\n");         /* by Hidy 2008. */
+		fprintf(output->anntext.ptr,"COLUMN15: ann_Cchg_FRZ = annual net change of ecosystem's carbon content caused by fertilization (positive: net gain; gC/m2/yr)\n");      /* by Hidy 2008. */
+		fprintf(output->anntext.ptr,"COLUMN16: ann_N_plus_GRZ = annual total N input from grazing (gN/m2/yr)\n");             /* by Hidy 2008. */
+		fprintf(output->anntext.ptr,"COLUMN17: ann_N_plus_FRZ = annual total N input from fertilizing (gN/m2/yr)\n");             /* by Hidy 2008. */
+		fprintf(output->anntext.ptr,"---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------\n");
+		fprintf(output->anntext.ptr,"COLUMN1  COLUMN2    COLUMN3    COLUMN4    COLUMN5    COLUMN6    COLUMN7    COLUMN8    COLUMN9    COLUMN10    COLUMN11    COLUMN12    COLUMN13    COLUMN14    COLUMN15   COLUMN16    COLUMN17\n"); 
+		fprintf(output->anntext.ptr,"---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------\n");
+
 	}
 	
 	return (!ok);
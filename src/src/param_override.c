@@ -0,0 +1,316 @@
+/*
+param_override.c
+keyed overrides of the site and ecophysiological constants, applied after the
+init file (or the bundle) is read: calibration and sensitivity runs can change
+parameters without writing new EPC/INI files.
+An override is "<struct>.<field>=<value>" or "<struct>.<field>[<layer>]=<value>"
+for the per-layer soil arrays, <struct> is epc or sitec, e.g. epc.flnr=0.09 or
+sitec.vwc_fc[0]=0.3. The value is set in the structure field as the model uses
+it, so it is in the internal units and it does not update the values derived
+from it during the reading (e.g. the initial N pools computed from the C:N
+ratios). The fields read only as inputs of these derivations (soil texture,
+measured soil properties) and the flags checked against other parameters in
+epc_init (woody, evergreen, phenology_flag) are not in the table: an override
+of them would have no effect or an inconsistent one.
+Int fields take whole numbers only.
+
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+Biome-BGCMuSo v4.0.2
+Copyright 2016, D. Hidy [dori.hidy@gmail.com]
+Hungarian Academy of Sciences, Hungary
+See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentation, model executable and example input files.
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <limits.h>
+#include <errno.h>
+#include "ini.h"
+#include "bgc_struct.h"
+#include "pointbgc_struct.h"
+#include "pointbgc_func.h"
+#include "bgc_constants.h"
+
+#define PAR_EPC   0
+#define PAR_SITEC 1
+
+typedef struct
+{
+	const char* name;      /* key of the override */
+	int target;            /* PAR_EPC or PAR_SITEC */
+	size_t offset;         /* offset of the field in the structure */
+	char type;             /* 'd': double, 'i': int */
+	int n;                 /* number of elements (N_SOILLAYERS for the layer arrays) */
+} param_row;
+
+#define EPC_D(f)   { "epc." #f,   PAR_EPC,   offsetof(epconst_struct, f),   'd', 1 }
+#define EPC_I(f)   { "epc." #f,   PAR_EPC,   offsetof(epconst_struct, f),   'i', 1 }
+#define SITEC_D(f) { "sitec." #f, PAR_SITEC, offsetof(siteconst_struct, f), 'd', 1 }
+#define SITEC_A(f) { "sitec." #f, PAR_SITEC, offsetof(siteconst_struct, f), 'd', N_SOILLAYERS }
+
+/* the scalar fields of siteconst_struct and epconst_struct used by the simulation (not the annual arrays) */
+static const param_row param_table[] =
+{
+	SITEC_A(soillayer_depth),
+	SITEC_A(soillayer_thickness),
+	SITEC_A(soillayer_midpoint),
+	SITEC_A(soil_b),
+	SITEC_A(BD),
+	SITEC_D(RCN),
+	SITEC_A(vwc_sat),
+	SITEC_A(vwc_fc),
+	SITEC_A(vwc_wp),
+	SITEC_A(vwc_hw),
+	SITEC_A(psi_sat),
+	SITEC_A(psi_fc),
+	SITEC_A(psi_wp),
+	SITEC_D(psi_hw),
+	SITEC_A(hydr_conduct_sat),
+	SITEC_A(hydr_conduct_fc),
+	SITEC_A(hydr_diffus_fc),
+	SITEC_D(tair_annavg),
+	SITEC_D(tair_annrange),
+	SITEC_D(elev),
+	SITEC_D(lat),
+	SITEC_D(sw_alb),
+	SITEC_D(gwd_act),
+	EPC_I(c3_flag),
+	EPC_I(q10depend_flag),
+	EPC_I(acclimation_flag),
+	EPC_I(CO2conduct_flag),
+	EPC_I(SHCM_flag),
+	EPC_I(discretlevel_Richards),
+	EPC_I(STCM_flag),
+	EPC_I(onday),
+	EPC_I(offday),
+	EPC_I(base_temp),
+	EPC_I(GDD_fruitalloc),
+	EPC_I(GDD_maturity),
+	EPC_D(transfer_pdays),
+	EPC_D(litfall_pdays),
+	EPC_D(leaf_turnover),
+	EPC_D(froot_turnover),
+	EPC_D(livewood_turnover),
+	EPC_D(daily_mortality_turnover),
+	EPC_D(daily_fire_turnover),
+	EPC_D(alloc_frootc_leafc),
+	EPC_D(alloc_newstemc_newleafc),
+	EPC_D(alloc_newlivewoodc_newwoodc),
+	EPC_D(alloc_crootc_stemc),
+	EPC_D(alloc_prop_curgrowth),
+	EPC_D(avg_proj_sla),
+	EPC_D(sla_ratio),
+	EPC_D(lai_ratio),
+	EPC_D(int_coef),
+	EPC_D(ext_coef),
+	EPC_D(flnr),
+	EPC_D(flnp),
+	EPC_D(relVWC_crit1),
+	EPC_D(relVWC_crit2),
+	EPC_D(PSI_crit1),
+	EPC_D(PSI_crit2),
+	EPC_D(vpd_open),
+	EPC_D(vpd_close),
+	EPC_D(gl_smax),
+	EPC_D(gl_c),
+	EPC_D(gl_bl),
+	EPC_D(froot_cn),
+	EPC_D(leaf_cn),
+	EPC_D(livewood_cn),
+	EPC_D(deadwood_cn),
+	EPC_D(leaflitr_cn),
+	EPC_D(leaflitr_flab),
+	EPC_D(leaflitr_fucel),
+	EPC_D(leaflitr_fscel),
+	EPC_D(leaflitr_flig),
+	EPC_D(frootlitr_flab),
+	EPC_D(frootlitr_fucel),
+	EPC_D(frootlitr_fscel),
+	EPC_D(frootlitr_flig),
+	EPC_D(deadwood_fucel),
+	EPC_D(deadwood_fscel),
+	EPC_D(deadwood_flig),
+	EPC_D(mort_SNSC_abovebiom),
+	EPC_D(mort_SNSC_belowbiom),
+	EPC_D(mort_SNSC_leafphen),
+	EPC_D(mort_SNSC_to_litter),
+	EPC_D(mort_CnW_to_litter),
+	EPC_D(GR_ratio),
+	EPC_D(denitrif_prop),
+	EPC_D(bulkN_denitrif_prop_WET),
+	EPC_D(bulkN_denitrif_prop_DRY),
+	EPC_D(mobilen_prop),
+	EPC_D(nfix),
+	EPC_D(maturity_coeff),
+	EPC_D(fruit_turnover),
+	EPC_D(alloc_fruitc_leafc),
+	EPC_D(fruit_cn),
+	EPC_D(fruitlitr_flab),
+	EPC_D(fruitlitr_fucel),
+	EPC_D(fruitlitr_fscel),
+	EPC_D(fruitlitr_flig),
+	EPC_D(softstem_turnover),
+	EPC_D(alloc_softstemc_leafc),
+	EPC_D(softstem_cn),
+	EPC_D(softstemlitr_flab),
+	EPC_D(softstemlitr_fucel),
+	EPC_D(softstemlitr_fscel),
+	EPC_D(softstemlitr_flig),
+	EPC_D(storage_MGMmort),
+	EPC_D(m_soilstress_crit),
+	EPC_I(n_stressdays_crit),
+	EPC_D(max_rootzone_depth),
+	EPC_D(rootdistrib_param),
+	EPC_D(c_param_tsoil),
+	EPC_D(mrpern),
+	EPC_D(rfl1s1),
+	EPC_D(rfl2s2),
+	EPC_D(rfl4s3),
+	EPC_D(rfs1s2),
+	EPC_D(rfs2s3),
+	EPC_D(rfs3s4),
+	EPC_D(kl1_base),
+	EPC_D(kl2_base),
+	EPC_D(kl4_base),
+	EPC_D(ks1_base),
+	EPC_D(ks2_base),
+	EPC_D(ks3_base),
+	EPC_D(ks4_base),
+	EPC_D(kfrag_base),
+	EPC_D(N_pCNR1),
+	EPC_D(N_pCNR2),
+	EPC_D(N_pVWC1),
+	EPC_D(N_pVWC2),
+	EPC_D(N_pVWC3),
+	EPC_D(N_pVWC4),
+	EPC_D(N_pTS),
+	EPC_D(C_pBD1),
+	EPC_D(C_pBD2),
+	EPC_D(C_pVWC1),
+	EPC_D(C_pVWC2),
+	EPC_D(C_pVWC3),
+	EPC_D(C_pVWC4),
+	EPC_D(C_pTS)
+};
+
+#define N_PARAM (int)(sizeof(param_table) / sizeof(param_row))
+
+int param_override(const char* assignment, epconst_struct* epc, siteconst_struct* sitec)
+{
+	int ok = 1;
+	int p;
+	int index = 0;
+	char key[100];
+	const char* eq;
+	const char* br;
+	char* end;
+	size_t len;
+	double value = 0.0;
+	long ivalue = 0;
+	char* field;
+
+	/* split "<key>[<index>]=<value>" */
+	eq = strchr(assignment, '=');
+	if (!eq)
+	{
+		printf("Error: parameter override %s has no value (expected <key>=<value>)\n", assignment);
+		return 1;
+	}
+	len = eq - assignment;
+	while (len > 0 && assignment[len-1] == ' ') len--;
+	br = memchr(assignment, '[', len);
+	if (br)
+	{
+		index = (int) strtol(br + 1, &end, 10);
+		if (*end != ']')
+		{
+			printf("Error: bad layer index in parameter override %s\n", assignment);
+			return 1;
+		}
+		len = br - assignment;
+	}
+	if (len >= sizeof(key))
+	{
+		printf("Error: unknown parameter in override %s\n", assignment);
+		return 1;
+	}
+	memcpy(key, assignment, len);
+	key[len] = '\0';
+
+	for (p = 0; p < N_PARAM && strcmp(param_table[p].name, key); p++);
+	if (p == N_PARAM)
+	{
+		printf("Error: unknown parameter %s in override %s\n", key, assignment);
+		return 1;
+	}
+
+	/* int fields: whole numbers in the range of int, no truncation */
+	errno = 0;
+	if (param_table[p].type == 'i')
+		ivalue = strtol(eq + 1, &end, 10);
+	else
+		value = strtod(eq + 1, &end);
+	while (*end == ' ' || *end == '\t' || *end == '\r' || *end == '\n') end++;
+	if (end == eq + 1 || *end != '\0')
+	{
+		printf("Error: bad value in parameter override %s%s\n", assignment,
+			param_table[p].type == 'i' ? " (integer expected)" : "");
+		return 1;
+	}
+	if (param_table[p].type == 'i' && (errno == ERANGE || ivalue < INT_MIN || ivalue > INT_MAX))
+	{
+		printf("Error: value out of the integer range in parameter override %s\n", assignment);
+		return 1;
+	}
+
+	if (index < 0 || index >= param_table[p].n || (br && param_table[p].n == 1))
+	{
+		printf("Error: layer index out of range in parameter override %s\n", assignment);
+		ok=0;
+	}
+
+	if (ok)
+	{
+		field = (char*) (param_table[p].target == PAR_EPC ? (void*) epc : (void*) sitec) + param_table[p].offset;
+		if (param_table[p].type == 'i')
+			((int*) field)[index] = (int) ivalue;
+		else
+			((double*) field)[index] = value;
+	}
+
+	return (!ok);
+}
+
+int param_override_file(const char* name, epconst_struct* epc, siteconst_struct* sitec)
+{
+	/* override table: one <key>=<value> per line, empty lines and lines
+	starting with # or ; are skipped */
+	int ok = 1;
+	char line[200];
+	char* p;
+	FILE* f;
+
+	f = fopen(name, "r");
+	if (!f)
+	{
+		printf("Error opening parameter override file %s\n", name);
+		return 1;
+	}
+
+	while (ok && fgets(line, sizeof(line), f))
+	{
+		for (p = line; *p == ' ' || *p == '\t'; p++);
+		if (*p == '\0' || *p == '\n' || *p == '\r' || *p == '#' || *p == ';') continue;
+		if (param_override(p, epc, sitec))
+		{
+			printf("Error in parameter override file %s\n", name);
+			ok=0;
+		}
+	}
+
+	fclose(f);
+	return (!ok);
+}
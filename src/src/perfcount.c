@@ -0,0 +1,186 @@
+/*
+perfcount.c
+hardware performance counters of the process timers (--perf): the cycles, the
+instructions, the cache misses (last level) and the mispredicted branches of
+the process are counted in user mode by one group of Linux perf events
+(perf_event_open), the group is read with one read() at the beginning and at
+the end of every process timer (see proftimer.c). The counters not supported by
+the processor (or by a virtual machine) are left out, the group needs at least
+the cycles. The time the group was counting is compared with the time it was
+enabled at the end of the run: the counts are lower than the true ones if the
+kernel multiplexed the counters with other users.
+Where perf_event_open is not available (other systems, perf_event_paranoid > 2,
+containers without the counters) perfcount_open fails with a message and the
+profile is written without the counters.
+
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+Biome-BGCMuSo v4.0.2
+Copyright 2016, D. Hidy [dori.hidy@gmail.com]
+Hungarian Academy of Sciences, Hungary
+See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentation, model executable and example input files.
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef __linux__
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include "bgc_struct.h"
+#include "bgc_func.h"
+
+int perfcount_on = 0;
+
+#ifdef __linux__
+
+static const unsigned long long perfcount_config[N_PERFCOUNTERS] =
+{
+	PERF_COUNT_HW_CPU_CYCLES,
+	PERF_COUNT_HW_INSTRUCTIONS,
+	PERF_COUNT_HW_CACHE_MISSES,
+	PERF_COUNT_HW_BRANCH_MISSES
+};
+
+static int perfcount_fd[N_PERFCOUNTERS];
+/* position of the counter in the values of the group (-1: not available) */
+static int perfcount_slot[N_PERFCOUNTERS];
+static int perfcount_n;
+
+/* read format of the group: nr, time enabled, time running, values */
+static unsigned long long perfcount_buf[3 + N_PERFCOUNTERS];
+
+static int perfcount_event(unsigned long long config, int group)
+{
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.config = config;
+	attr.disabled = (group == -1);
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+	return (int) syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+int perfcount_open(char* message, int len)
+{
+	int id;
+
+	for (id = 0; id < N_PERFCOUNTERS; id++)
+	{
+		perfcount_fd[id] = -1;
+		perfcount_slot[id] = -1;
+	}
+	perfcount_n = 0;
+
+	/* the cycles lead the group */
+	perfcount_fd[PC_CYCLES] = perfcount_event(perfcount_config[PC_CYCLES], -1);
+	if (perfcount_fd[PC_CYCLES] < 0)
+	{
+		snprintf(message, len, "perf_event_open: %s", strerror(errno));
+		return 1;
+	}
+	perfcount_slot[PC_CYCLES] = perfcount_n++;
+
+	for (id = 0; id < N_PERFCOUNTERS; id++)
+	{
+		if (id == PC_CYCLES) continue;
+		perfcount_fd[id] = perfcount_event(perfcount_config[id], perfcount_fd[PC_CYCLES]);
+		if (perfcount_fd[id] >= 0) perfcount_slot[id] = perfcount_n++;
+	}
+
+	if (ioctl(perfcount_fd[PC_CYCLES], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP) ||
+		ioctl(perfcount_fd[PC_CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP))
+	{
+		snprintf(message, len, "perf_event ioctl: %s", strerror(errno));
+		perfcount_close();
+		return 1;
+	}
+
+	perfcount_on = 1;
+	return 0;
+}
+
+/* current counts (count[N_PERFCOUNTERS], 0 for the counters not available) */
+void perfcount_read(unsigned long long* count)
+{
+	int id;
+	ssize_t size = (ssize_t) ((3 + perfcount_n) * sizeof(unsigned long long));
+
+	if (read(perfcount_fd[PC_CYCLES], perfcount_buf, size) != size)
+	{
+		memset(count, 0, N_PERFCOUNTERS * sizeof(unsigned long long));
+		return;
+	}
+	for (id = 0; id < N_PERFCOUNTERS; id++)
+	{
+		count[id] = perfcount_slot[id] >= 0 ? perfcount_buf[3 + perfcount_slot[id]] : 0;
+	}
+}
+
+int perfcount_available(int id)
+{
+	return perfcount_on && perfcount_slot[id] >= 0;
+}
+
+/* share of the enabled time the group was counting (1: no multiplexing) */
+double perfcount_running(void)
+{
+	unsigned long long count[N_PERFCOUNTERS];
+
+	if (!perfcount_on) return 0.0;
+	perfcount_read(count);
+	return perfcount_buf[1] ? (double) perfcount_buf[2] / (double) perfcount_buf[1] : 1.0;
+}
+
+void perfcount_close(void)
+{
+	int id;
+
+	/* the members first, the leader last */
+	for (id = N_PERFCOUNTERS - 1; id >= 0; id--)
+	{
+		if (perfcount_fd[id] >= 0) close(perfcount_fd[id]);
+		perfcount_fd[id] = -1;
+		perfcount_slot[id] = -1;
+	}
+	perfcount_on = 0;
+}
+
+#else
+
+int perfcount_open(char* message, int len)
+{
+	snprintf(message, len, "perf_event_open is available on Linux only");
+	return 1;
+}
+
+void perfcount_read(unsigned long long* count)
+{
+	memset(count, 0, N_PERFCOUNTERS * sizeof(unsigned long long));
+}
+
+int perfcount_available(int id)
+{
+	return 0;
+}
+
+double perfcount_running(void)
+{
+	return 0.0;
+}
+
+void perfcount_close(void)
+{
+	perfcount_on = 0;
+}
+
+#endif
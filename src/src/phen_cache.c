@@ -0,0 +1,396 @@
+/*
+phen_cache.c
+cache of the phenological signals: the results of GSI_calculation() and
+prephenology() depend only on the meteorological arrays and a few site,
+ecophysiological and GSI parameters, so they are stored with a key (hash of
+these inputs) and reused instead of being recalculated: in the spinup and the
+transient phase, after a scenario branch without climate change and in
+ensemble runs varying other parameters.
+The cache is kept in memory for the run (phen_cache_reset releases it at the
+end of the run, before mem_free_all); with a cache directory
+(--phen-cache <dir>) the signals are also read from and written to files in
+the directory, shared by the runs using it.
+The GSI diagnostics (GSI file and messages of the on-screen mode) are only
+written by GSI_calculation(), so the GSI cache is not used in on-screen mode.
+
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+Biome-BGCMuSo v4.0.2
+Copyright 2016, D. Hidy [dori.hidy@gmail.com]
+Hungarian Academy of Sciences, Hungary
+See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentation, model executable and example input files.
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#ifndef _WIN32
+#include <unistd.h>
+#else
+#include <process.h>
+#define getpid _getpid
+#endif
+#include "ini.h"
+#include "bgc_struct.h"
+#include "pointbgc_struct.h"
+#include "pointbgc_func.h"
+#include "bgc_constants.h"
+#include "misc_func.h"
+
+#define PHENCACHE_MAGIC   "MUSOPHEN"
+#define PHENCACHE_VERSION 3
+#define PHENCACHE_SLOTS   8
+
+#define KIND_GSI  1
+#define KIND_PHEN 2
+
+/* key of a cache entry: two FNV-1a hashes of the inputs with different seeds */
+typedef struct
+{
+	unsigned int h1;
+	unsigned int h2;
+} phenkey;
+
+typedef struct
+{
+	int kind;
+	phenkey key;
+	int n;                 /* number of ints in data */
+	int* data;
+} phenentry;
+
+static phenentry cache[PHENCACHE_SLOTS];
+static int cache_next = 0;
+
+static void key_add(phenkey* key, const void* data, long nbytes)
+{
+	key->h1 = checksum_fnv1a(data, nbytes, key->h1);
+	key->h2 = checksum_fnv1a(data, nbytes, key->h2 ^ 0x5bd1e995u);
+}
+
+static void key_init(phenkey* key, int kind, const control_struct* ctrl)
+{
+	int version = PHENCACHE_VERSION;
+
+	key->h1 = FNV1A_INIT;
+	key->h2 = FNV1A_INIT;
+	key_add(key, &version, sizeof(int));
+	key_add(key, &kind, sizeof(int));
+	key_add(key, &ctrl->metyears, sizeof(int));
+}
+
+static void entry_name(char* name, const char* dir, int kind, const phenkey* key)
+{
+	sprintf(name, "%s/phen%i_%08x%08x.bin", dir, kind, key->h1, key->h2);
+}
+
+/* the data of an entry (NULL if not cached); a file entry is also kept in memory */
+static const int* cache_find(const control_struct* ctrl, int kind, const phenkey* key, int n)
+{
+	int i;
+	int head[6];
+	char magic[8];
+	char name[300];
+	int* data;
+	FILE* f;
+
+	for (i = 0; i < PHENCACHE_SLOTS; i++)
+	{
+		if (cache[i].data && cache[i].kind == kind && cache[i].n == n &&
+			cache[i].key.h1 == key->h1 && cache[i].key.h2 == key->h2) return cache[i].data;
+	}
+
+	if (!ctrl->phencache_dir || strlen(ctrl->phencache_dir) > 250) return NULL;
+
+	entry_name(name, ctrl->phencache_dir, kind, key);
+	f = fopen(name, "rb");
+	if (!f) return NULL;
+
+	/* header: magic, version, kind, key, number of ints and checksum of the data */
+	data = NULL;
+	if (fread(magic, 1, 8, f) == 8 && !memcmp(magic, PHENCACHE_MAGIC, 8) &&
+		fread(head, sizeof(int), 6, f) == 6 && head[0] == PHENCACHE_VERSION && head[1] == kind &&
+		(unsigned int) head[2] == key->h1 && (unsigned int) head[3] == key->h2 && head[4] == n)
+	{
+		data = (int*) mem_alloc(MEM_PHEN, n * sizeof(int));
+		if (data && (fread(data, sizeof(int), n, f) != (size_t) n ||
+			checksum_fnv1a(data, (long) n * sizeof(int), FNV1A_INIT) != (unsigned int) head[5]))
+		{
+			mem_free(data);
+			data = NULL;
+		}
+	}
+	fclose(f);
+	if (!data) return NULL;
+
+	mem_free(cache[cache_next].data);
+	cache[cache_next].kind = kind;
+	cache[cache_next].key = *key;
+	cache[cache_next].n = n;
+	cache[cache_next].data = data;
+	cache_next = (cache_next + 1) % PHENCACHE_SLOTS;
+
+	return data;
+}
+
+/* data is stored in memory (taking over the array) and in the cache directory */
+static void cache_store(const control_struct* ctrl, int kind, const phenkey* key, int n, int* data)
+{
+	int head[6];
+	char name[300];
+	char tmpname[320];
+	FILE* f;
+	int ok;
+
+	mem_free(cache[cache_next].data);
+	cache[cache_next].kind = kind;
+	cache[cache_next].key = *key;
+	cache[cache_next].n = n;
+	cache[cache_next].data = data;
+	cache_next = (cache_next + 1) % PHENCACHE_SLOTS;
+
+	if (!ctrl->phencache_dir || strlen(ctrl->phencache_dir) > 250) return;
+
+	/* written into a temporary file and renamed: the runs sharing the
+	directory see a complete file or no file */
+	entry_name(name, ctrl->phencache_dir, kind, key);
+	sprintf(tmpname, "%s.%i", name, (int) getpid());
+	f = fopen(tmpname, "wb");
+	if (!f)
+	{
+		if (ctrl->onscreen) printf("WARNING: cannot write phenology cache file %s\n", tmpname);
+		return;
+	}
+	head[0] = PHENCACHE_VERSION;
+	head[1] = kind;
+	head[2] = (int) key->h1;
+	head[3] = (int) key->h2;
+	head[4] = n;
+	head[5] = (int) checksum_fnv1a(data, (long) n * sizeof(int), FNV1A_INIT);
+	ok = (fwrite(PHENCACHE_MAGIC, 1, 8, f) == 8 && fwrite(head, sizeof(int), 6, f) == 6 &&
+		  fwrite(data, sizeof(int), n, f) == (size_t) n);
+	if (fclose(f) || !ok || rename(tmpname, name))
+	{
+		if (ctrl->onscreen) printf("WARNING: cannot write phenology cache file %s\n", name);
+		remove(tmpname);
+	}
+}
+
+int GSI_calculation_cached(const metarr_struct* metarr, const control_struct* ctrl, const siteconst_struct* sitec, const epconst_struct* epc,
+					GSI_struct* GSI, phenarray_struct* phenarr)
+{
+	/* data: onday_arr and offday_arr of the met years */
+	int ok = 1;
+	int nyears = ctrl->metyears;
+	int ndays = nyears * NDAY_OF_YEAR;
+	int n = 2 * nyears;
+	int* data;
+	const int* cached;
+	phenkey key;
+
+	key_init(&key, KIND_GSI, ctrl);
+	key_add(&key, metarr->tmax, ndays * sizeof(double));
+	key_add(&key, metarr->tmin, ndays * sizeof(double));
+	key_add(&key, metarr->prcp, ndays * sizeof(double));
+	key_add(&key, metarr->vpd, ndays * sizeof(double));
+	key_add(&key, metarr->swavgfd, ndays * sizeof(double));
+	key_add(&key, metarr->dayl, ndays * sizeof(double));
+	key_add(&key, &epc->base_temp, sizeof(double));
+	key_add(&key, &sitec->sw_alb, sizeof(double));
+	key_add(&key, &GSI->snowcover_limit, sizeof(double));
+	key_add(&key, &GSI->heatsum_limit1, sizeof(double));
+	key_add(&key, &GSI->heatsum_limit2, sizeof(double));
+	key_add(&key, &GSI->tmin_limit1, sizeof(double));
+	key_add(&key, &GSI->tmin_limit2, sizeof(double));
+	key_add(&key, &GSI->vpd_limit1, sizeof(double));
+	key_add(&key, &GSI->vpd_limit2, sizeof(double));
+	key_add(&key, &GSI->dayl_limit1, sizeof(double));
+	key_add(&key, &GSI->dayl_limit2, sizeof(double));
+	key_add(&key, &GSI->n_moving_avg, sizeof(int));
+	key_add(&key, &GSI->GSI_limit_SGS, sizeof(double));
+	key_add(&key, &GSI->GSI_limit_EGS, sizeof(double));
+
+	cached = ctrl->onscreen ? NULL : cache_find(ctrl, KIND_GSI, &key, n);
+	if (cached)
+	{
+		phenarr->onday_arr = (int*) mem_calloc(MEM_PHEN, nyears+1, sizeof(int));
+		phenarr->offday_arr = (int*) mem_calloc(MEM_PHEN, nyears+1, sizeof(int));
+		if (!phenarr->onday_arr || !phenarr->offday_arr)
+		{
+			printf("Error allocating for onday_arr, GSI_calculation_cached()\n");
+			return 1;
+		}
+		memcpy(phenarr->onday_arr, cached, nyears * sizeof(int));
+		memcpy(phenarr->offday_arr, cached + nyears, nyears * sizeof(int));
+		return 0;
+	}
+
+	if (ok && GSI_calculation(metarr, ctrl, sitec, epc, GSI, phenarr))
+	{
+		printf("Error in call to GSI_calculation() from GSI_calculation_cached()\n");
+		ok=0;
+	}
+
+	if (ok)
+	{
+		data = (int*) mem_alloc(MEM_PHEN, n * sizeof(int));
+		if (data)
+		{
+			memcpy(data, phenarr->onday_arr, nyears * sizeof(int));
+			memcpy(data + nyears, phenarr->offday_arr, nyears * sizeof(int));
+			cache_store(ctrl, KIND_GSI, &key, n, data);
+		}
+	}
+
+	return (!ok);
+}
+
+int prephenology_cached(file logfile, const control_struct* ctrl, const epconst_struct* epc,
+	const siteconst_struct* sitec, const metarr_struct* metarr, phenarray_struct* phenarr)
+{
+	/* data: the signals of the phenological years (4 values per year), the
+	evergreen flag, the onday and offday arrays of the phenology years (without
+	GSI) and the min/max values of the log file */
+	int ok = 1;
+	int i, py;
+	int nyears = ctrl->metyears;
+	int ndays = nyears * NDAY_OF_YEAR;
+	int phenyears = (sitec->lat < 0.0) ? nyears+1 : nyears;
+	int nsgs = (phenyears < ctrl->simyears) ? phenyears : ctrl->simyears;
+	int flag;
+	int n;
+	int* data;
+	const int* cached;
+	phenkey key;
+
+	n = 4 * phenyears + 1 + (ctrl->GSI_flag ? 0 : 2 * (nyears+1)) + 4;
+
+	key_init(&key, KIND_PHEN, ctrl);
+	key_add(&key, metarr->tmax, ndays * sizeof(double));
+	key_add(&key, metarr->tmin, ndays * sizeof(double));
+	key_add(&key, metarr->prcp, ndays * sizeof(double));
+	key_add(&key, metarr->tday, ndays * sizeof(double));
+	key_add(&key, metarr->tavg11_ra, ndays * sizeof(double));
+	key_add(&key, metarr->dayl, ndays * sizeof(double));
+	key_add(&key, &epc->phenology_flag, sizeof(int));
+	key_add(&key, &epc->woody, sizeof(int));
+	key_add(&key, &epc->evergreen, sizeof(int));
+	key_add(&key, &epc->onday, sizeof(int));
+	key_add(&key, &epc->offday, sizeof(int));
+	key_add(&key, &epc->transfer_pdays, sizeof(double));
+	key_add(&key, &epc->litfall_pdays, sizeof(double));
+	key_add(&key, &sitec->lat, sizeof(double));
+	key_add(&key, &ctrl->GSI_flag, sizeof(int));
+	/* annual SGS and EGS values are used out of the spinup phase */
+	flag = (ctrl->varSGS_flag && ctrl->spinup != 1);
+	key_add(&key, &flag, sizeof(int));
+	if (flag) key_add(&key, epc->sgs_array, nsgs * sizeof(double));
+	flag = (ctrl->varEGS_flag && ctrl->spinup != 1);
+	key_add(&key, &flag, sizeof(int));
+	if (flag) key_add(&key, epc->egs_array, nsgs * sizeof(double));
+	/* onday and offday from GSI_calculation() */
+	if (ctrl->GSI_flag)
+	{
+		key_add(&key, phenarr->onday_arr, nyears * sizeof(int));
+		key_add(&key, phenarr->offday_arr, nyears * sizeof(int));
+	}
+
+	cached = cache_find(ctrl, KIND_PHEN, &key, n);
+	if (cached)
+	{
+		phenarr->phenyear = (phenyear_struct*) mem_alloc(MEM_PHEN, (nyears+1) * sizeof(phenyear_struct));
+		if (!phenarr->phenyear) ok=0;
+		else
+		{
+			for (py = 0; py < phenyears; py++, cached += 4)
+			{
+				phenarr->phenyear[py].onday     = (short) cached[0];
+				phenarr->phenyear[py].offday    = (short) cached[1];
+				phenarr->phenyear[py].ntransfer = (short) cached[2];
+				phenarr->phenyear[py].nlitfall  = (short) cached[3];
+			}
+			phenarr->nphenyears = phenyears;
+			phenarr->south = (sitec->lat < 0.0);
+			phenarr->evergreen = *cached++;
+		}
+		if (ok && !ctrl->GSI_flag)
+		{
+			phenarr->onday_arr = (int*) mem_alloc(MEM_PHEN, (nyears+1) * sizeof(int));
+			phenarr->offday_arr = (int*) mem_alloc(MEM_PHEN, (nyears+1) * sizeof(int));
+			if (!phenarr->onday_arr || !phenarr->offday_arr) ok=0;
+			else
+			{
+				memcpy(phenarr->onday_arr, cached, (nyears+1) * sizeof(int));
+				memcpy(phenarr->offday_arr, cached + nyears+1, (nyears+1) * sizeof(int));
+			}
+			cached += 2 * (nyears+1);
+		}
+		if (!ok)
+		{
+			printf("Error allocating for phenarr, prephenology_cached()\n");
+			return 1;
+		}
+		phenarr->onday_min  = cached[0];
+		phenarr->onday_max  = cached[1];
+		phenarr->offday_min = cached[2];
+		phenarr->offday_max = cached[3];
+
+		/* the log file information of prephenology() */
+		fprintf(logfile.ptr, "Information about SGS and EGS values (yday of onday and offday)\n");
+		fprintf(logfile.ptr, "SGS value (min and max): %6i %6i\n", phenarr->onday_min, phenarr->onday_max);
+		fprintf(logfile.ptr, "EGS value (min and max): %6i %6i\n", phenarr->offday_min, phenarr->offday_max);
+		fprintf(logfile.ptr, " \n");
+		return 0;
+	}
+
+	if (ok && prephenology(logfile, ctrl, epc, sitec, metarr, phenarr))
+	{
+		printf("Error in call to prephenology() from prephenology_cached()\n");
+		ok=0;
+	}
+
+	if (ok)
+	{
+		data = (int*) mem_alloc(MEM_PHEN, n * sizeof(int));
+		if (data)
+		{
+			for (py = 0, i = 0; py < phenyears; py++, i += 4)
+			{
+				data[i]   = phenarr->phenyear[py].onday;
+				data[i+1] = phenarr->phenyear[py].offday;
+				data[i+2] = phenarr->phenyear[py].ntransfer;
+				data[i+3] = phenarr->phenyear[py].nlitfall;
+			}
+			data[i++] = phenarr->evergreen;
+			if (!ctrl->GSI_flag)
+			{
+				/* the unused element (northern sites) is not set by prephenology() */
+				memcpy(data + i, phenarr->onday_arr, phenyears * sizeof(int));
+				memcpy(data + i + nyears+1, phenarr->offday_arr, phenyears * sizeof(int));
+				if (phenyears == nyears) data[i + nyears] = data[i + 2*nyears+1] = 0;
+				i += 2 * (nyears+1);
+			}
+			data[i]   = phenarr->onday_min;
+			data[i+1] = phenarr->onday_max;
+			data[i+2] = phenarr->offday_min;
+			data[i+3] = phenarr->offday_max;
+			cache_store(ctrl, KIND_PHEN, &key, n, data);
+		}
+	}
+
+	return (!ok);
+}
+
+/* the memory entries are released and the slots cleared: to be called at the
+end of a run, before mem_free_all() releases the MEM_PHEN blocks */
+void phen_cache_reset(void)
+{
+	int i;
+
+	for (i = 0; i < PHENCACHE_SLOTS; i++)
+	{
+		mem_free(cache[i].data);
+		memset(&cache[i], 0, sizeof(phenentry));
+	}
+	cache_next = 0;
+}
@@ -155,7 +155,7 @@ int planting_init(file init, control_struct* ctrl, planting_struct* PLT)
 
 	if (PLT->PLT_flag == 2)
 	{
-		fclose (PLT_file.ptr);
+		file_close (&PLT_file);
 	}
 	
 	
@@ -114,7 +114,7 @@ int ploughing_init(file init, control_struct* ctrl, ploughing_struct* PLG)
 
 	if (PLG->PLG_flag == 2)
 	{
-		fclose (PLG_file.ptr);
+		file_close (&PLG_file);
 	}
 
 	
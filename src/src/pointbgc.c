@@ -22,10 +22,12 @@ See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentatio
 
 #include "ini.h"              /* general file structure and I/O prototypes */
 #include "bgc_struct.h"       /* data structures for bgc() */
+#include "bgc_func.h"         /* function prototypes for bgc() */
 #include "pointbgc_struct.h"   /* data structures for point driver */
 #include "pointbgc_func.h"     /* function prototypes for point driver */
 #include "bgc_io.h"           /* bgc() interface definition */
 #include "bgc_epclist.h"      /* array structure for epc-by-vegtype */
+#include "misc_func.h"         /* tagged memory allocation */
 
 int main(int argc, char *argv[])
 {
@@ -36,266 +38,223 @@ int main(int argc, char *argv[])
 	/* local control information */
 	point_struct point;
 	restart_ctrl_struct restart;
-	climchange_struct scc;
 	output_struct output;
 	
-	/* initialization file */
-	file init;
+	/* 1: arrays are mapped from a bundle file, not allocated */
+	int from_bundle;
+	char* ininame;
+	int arg, ok, k;
+
+	/* scenario branching */
+	scenario_struct scenarios[MAX_SCENARIOS];
+	int nscenario = 0;
+	int branch_year = -1;
+	epconst_struct epc_check;
+	siteconst_struct sitec_check;
+
+	/* directory of the phenology signal cache (NULL: in memory only) */
+	char* phencache_dir = NULL;
+	char* record = NULL;
+	char* trace = NULL;
+	char* status = NULL;
+
+	/* 1: process timers of the daily loop, profile next to the log file;
+	2: with the hardware performance counters */
+	int profile = 0;
 	
 	/* system time variables */
 	struct tm *tm_ptr;
 	time_t lt;
 	
-	/* get the system time at start of simulation */
-	lt = time(NULL);
-	tm_ptr = localtime(&lt);
-	strcpy(point.systime,asctime(tm_ptr));
-	
-
-	/* initialize the bgcin state variable structures before filling with
-	values from ini file */
-	if (presim_state_init(&bgcin.ws, &bgcin.cs, &bgcin.ns, &bgcin.cinit))
-	{
-		printf("Error in call to presim_state_init() from pointbgc()\n");
-		exit(1);
-	}
-
-
-
-
-	/******************************
-	**                           **
-	**  BEGIN READING INIT FILE  **
-	**                           **
-	******************************/
-	
-	/* read the name of the main init file from the command line
-	and store as init.name */
-	if (argc != 2)
-	{
-		printf("usage: <executable name>  <initialization file name>\n");
-		exit(1);
-	}
-	strcpy(init.name, argv[1]);
-
-	/* open the main init file for ascii read and check for errors */
-	if (file_open(&init,'i'))
-	{
-		printf("Error opening init file, pointbgc.c\n");
-		exit(1);
-	}
-
-	/* read the header string from the init file */
-	if (fgets(point.header, 100, init.ptr)==NULL)
-	{
-		printf("Error reading header string: pointbgc.c\n");
-		exit(1);
-	}
-
-	/* open met file, discard header lines */
-	if (met_init(init, &point))
-	{
-		printf("Error in call to met_init() from pointbgc.c... Exiting\n");
-		exit(1);
-	}
-
-	/* read restart control parameters */
-	if (restart_init(init, &restart))
-	{
-		printf("Error in call to restart_init() from pointbgc.c... Exiting\n");
-		exit(1);
-	}
-
-	/* read simulation timing control parameters */
-	if (time_init(init, &(bgcin.ctrl)))
-	{
-		printf("Error in call to time_init() from pointbgc.c... Exiting\n");
-		exit(1);
-	}
-	
-	/* read scalar climate change parameters */
-	if (scc_init(init, &scc))
-	{
-		printf("Error in call to scc_init() from pointbgc.c... Exiting\n");
-		exit(1);
-	}
-	
-	/* read CO2 control parameters */
-	if (co2_init(init, &(bgcin.co2), bgcin.ctrl.simyears))
-	{
-		printf("Error in call to co2_init() from pointbgc.c... Exiting\n");
-		exit(1);
-	}
-
-
-	/* read varied nitrogen deposition block */
-	if (ndep_init(init, &bgcin.ndep, bgcin.ctrl.simyears))
-	{
-		printf("Error in call to ndep_init() from pointbgc.c... Exiting\n");
-		exit(1);
-	}
-
-
-	/* read site constants */
-	if (sitec_init(init, &bgcin.sitec))
-	{
-		printf("Error in call to sitec_init() from pointbgc.c... Exiting\n");
-		exit(1);
-	}
-	
-	
-	/* read ecophysiological constants */
-	if (epc_init(init, &bgcin.epc, &bgcin.ctrl))
-	{
-		printf("Error in call to epc_init() from pointbgc.c... Exiting\n");
-		exit(1);
-	}
-
-
-	/* initialize water state structure */
-	if (wstate_init(init, &bgcin.sitec, &bgcin.ws))
-	{
-		printf("Error in call to wstate_init() from pointbgc.c... Exiting\n");
-		exit(1);
-	}
-
-	/* initialize carbon and nitrogen state structures */
-	if (cnstate_init(init, &bgcin.epc, &bgcin.cs, &bgcin.cinit,
-		&bgcin.ns))
-	{
-		printf("Error in call to cstate_init() from pointbgc.c... Exiting\n");
-		exit(1);
-	}
-  
-	/* Hidy 2012 - read the GSI information if GSI flag is 1.0 */
-	if (GSI_init(init, &bgcin.GSI))
-	{
-		printf("Error in call to GSI_init() from pointbgc.c... Exiting\n");
-		exit(1);
-	}
-	/* read the output control information */
-	if (output_init(init, &output))
+	/* read the name of the main init file (or of the binary bundle written
+	by muso-compile) from the command line: it is the last argument, the
+	parameter overrides (--set <key>=<value>, --set-file <file>), the
+	convergence criteria of the spinup (--spinup-stop <key>=<value>), the
+	scenario branching (--branch <year> --scenario <name>=<file> ...), the
+	phenology cache directory (--phen-cache <dir>), the recording of the process
+	routines for the micro-benchmarks (--record <file>), the timeline of the run
+	(--trace <file>), the progress of the run (--status <file>) and the
+	profiling switches (--profile, --perf with the hardware counters, the only
+	options without value) come before it */
+	for (arg = 1; arg < argc - 1; arg += 2)
 	{
-		printf("Error in call to output_init() from pointbgc.c... Exiting\n");
-		exit(1);
+		if (!strcmp(argv[arg], "--profile") || !strcmp(argv[arg], "--perf"))
+		{
+			if (!strcmp(argv[arg], "--perf")) profile = 2;
+			else if (!profile) profile = 1;
+			arg--;
+		}
+		else if (!strcmp(argv[arg], "--phen-cache"))
+		{
+			phencache_dir = argv[arg+1];
+		}
+		else if (!strcmp(argv[arg], "--record"))
+		{
+			record = argv[arg+1];
+		}
+		else if (!strcmp(argv[arg], "--trace"))
+		{
+			trace = argv[arg+1];
+		}
+		else if (!strcmp(argv[arg], "--status"))
+		{
+			status = argv[arg+1];
+		}
+		else if (!strcmp(argv[arg], "--branch"))
+		{
+			branch_year = atoi(argv[arg+1]);
+		}
+		else if (!strcmp(argv[arg], "--scenario"))
+		{
+			if (nscenario == MAX_SCENARIOS || scenario_parse(argv[arg+1], &scenarios[nscenario]))
+			{
+				printf("Error in scenario %s (maximum number of scenarios: %d)\n", argv[arg+1], MAX_SCENARIOS);
+				exit(1);
+			}
+			for (k = 0; k < nscenario; k++)
+			{
+				if (!strcmp(scenarios[k].name, scenarios[nscenario].name))
+				{
+					printf("Error: scenario name %s is used twice\n", scenarios[k].name);
+					exit(1);
+				}
+			}
+			nscenario++;
+		}
+		else if (strcmp(argv[arg], "--set") && strcmp(argv[arg], "--set-file") && strcmp(argv[arg], "--spinup-stop")) break;
 	}
-	
-	 /* -------------------------------------------------------------------------*/
-	/* MANAGEMENT SECTION - Hidy 2012.. */
-	
-	/* read the planting information */
-	if (planting_init(init, &bgcin.ctrl, &bgcin.PLT))
+	if (argc < 2 || arg != argc - 1)
 	{
-		printf("Error in call to planting_init() from pointbgc.c... Exiting\n");
-		fprintf(output.log_file.ptr, "ERROR in reading planting section of INI file\n");
-		fprintf(output.log_file.ptr, "SIMULATION STATUS [0 - failure; 1 - success]\n");
-		fprintf(output.log_file.ptr, "0\n");
+		printf("usage: <executable name>  [--set <key>=<value>] [--set-file <file>] [--spinup-stop <key>=<value>] [--branch <year> --scenario <name>=<file> ...] [--phen-cache <dir>] [--record <file>] [--trace <file>] [--status <file>] [--profile] [--perf] <initialization file name or bundle file name>\n");
 		exit(1);
 	}
+	ininame = argv[argc - 1];
 
-	/* read the thinning  information */
-	if (thinning_init(init, &bgcin.ctrl, &bgcin.THN))
+	/* the timeline starts with the reading of the inputs */
+	if (trace && trace_open(trace, ininame))
 	{
-		printf("Error in call to thinning_init() from pointbgc.c... Exiting\n");
-		fprintf(output.log_file.ptr, "ERROR in reading thinning section of INI file\n");
-		fprintf(output.log_file.ptr, "SIMULATION STATUS [0 - failure; 1 - success]\n");
-		fprintf(output.log_file.ptr, "0\n");
+		printf("Error in call to trace_open() from pointbgc.c... Exiting\n");
 		exit(1);
 	}
 
-	/* read the mowing  information */
-	if (mowing_init(init, &bgcin.ctrl, &bgcin.MOW))
+	/* the status file is written from the reading of the inputs on */
+	if (status && runstatus_open(status, ininame))
 	{
-		printf("Error in call to mowing_init() from pointbgc.c... Exiting\n");
-		fprintf(output.log_file.ptr, "ERROR in reading mowing section of INI file\n");
-		fprintf(output.log_file.ptr, "SIMULATION STATUS [0 - failure; 1 - success]\n");
-		fprintf(output.log_file.ptr, "0\n");
+		printf("Error in call to runstatus_open() from pointbgc.c... Exiting\n");
 		exit(1);
 	}
 
-	/* read the grazing information */
-	if (grazing_init(init, &bgcin.ctrl, &bgcin.GRZ))
+	/* the recording starts before reading the inputs (run_avg in metarr_init) */
+	if (record && kernelrec_open(record))
 	{
-		printf("Error in call to grazing_init() from pointbgc.c... Exiting\n");
-		fprintf(output.log_file.ptr, "ERROR in reading grazing section of INI file\n");
-		fprintf(output.log_file.ptr, "SIMULATION STATUS [0 - failure; 1 - success]\n");
-		fprintf(output.log_file.ptr, "0\n");
+		printf("Error in call to kernelrec_open() from pointbgc.c... Exiting\n");
 		exit(1);
 	}
 
-	/* read the harvesting information */
-	if (harvesting_init(init, &bgcin.ctrl, &bgcin.HRV))
+	TRACE_BEGIN("read inputs");
+	from_bundle = bundle_probe(ininame);
+	if (from_bundle)
 	{
-		printf("Error in call to harvesting_init() from pointbgc.c... Exiting\n");
-		fprintf(output.log_file.ptr, "ERROR in reading harvesting section of INI file\n");
-		fprintf(output.log_file.ptr, "SIMULATION STATUS [0 - failure; 1 - success]\n");
-		fprintf(output.log_file.ptr, "0\n");
-		exit(1);
+		/* precompiled run configuration: no text parsing, only the restart
+		and output files have to be opened */
+		if (bundle_read(ininame, &bgcin, &point, &restart, &output))
+		{
+			printf("Error in call to bundle_read() from pointbgc.c... Exiting\n");
+			exit(1);
+		}
 	}
-
-	/* read the harvesting information */
-	if (ploughing_init(init, &bgcin.ctrl, &bgcin.PLG))
+	else
 	{
-		printf("Error in call to ploughing_init() from pointbgc.c... Exiting\n");
-		fprintf(output.log_file.ptr, "ERROR in reading ploughing section of INI file\n");
-		fprintf(output.log_file.ptr, "SIMULATION STATUS [0 - failure; 1 - success]\n");
-		fprintf(output.log_file.ptr, "0\n");
-		exit(1);
+		/******************************
+		**                           **
+		**  BEGIN READING INIT FILE  **
+		**                           **
+		******************************/
+
+		/* the restart and output files are opened after the command line is
+		checked against the inputs (below) */
+		if (pointbgc_init(ininame, &bgcin, &point, &restart, &output)) exit(1);
 	}
-
-	/* read the fertilizing  information */
-	if (fertilizing_init(init, &bgcin.ctrl, &bgcin.FRZ))
+	TRACE_END("read inputs");
+	/* parameter overrides and spinup criteria, in command line order */
+	for (arg = 1; arg < argc - 1; arg += 2)
 	{
-		printf("Error in call to fertilizing_init() from pointbgc.c... Exiting\n");
-		fprintf(output.log_file.ptr, "ERROR in reading fertilizing section of INI file\n");
-		fprintf(output.log_file.ptr, "SIMULATION STATUS [0 - failure; 1 - success]\n");
-		fprintf(output.log_file.ptr, "0\n");
-		exit(1);
+		if (!strcmp(argv[arg], "--profile") || !strcmp(argv[arg], "--perf"))
+		{
+			arg--;
+			continue;
+		}
+		if (!strcmp(argv[arg], "--set"))
+			ok = !param_override(argv[arg+1], &bgcin.epc, &bgcin.sitec);
+		else if (!strcmp(argv[arg], "--set-file"))
+			ok = !param_override_file(argv[arg+1], &bgcin.epc, &bgcin.sitec);
+		else if (!strcmp(argv[arg], "--spinup-stop"))
+			ok = !spinconv_parse(argv[arg+1], &bgcin.ctrl);
+		else
+			continue;
+		if (!ok)
+		{
+			printf("Error in parameter override from pointbgc.c... Exiting\n");
+			exit(1);
+		}
+		if (output.onscreen) printf("INFORMATION: parameter override %s %s\n", argv[arg], argv[arg+1]);
 	}
 
-	/* read the irrigation information */
-	if (irrigation_init(init, &bgcin.ctrl, &bgcin.IRG))
+	/* scenario branching: only in normal runs, the scenario files are
+	checked before the run on copies of the constants */
+	bgcin.ctrl.branch_simyr = -1;
+	bgcin.ctrl.nscenario = nscenario;
+	bgcin.ctrl.scenarios = scenarios;
+	if (nscenario || branch_year != -1)
 	{
-		printf("Error in call to irrigation_init() from pointbgc.c... Exiting\n");
-		fprintf(output.log_file.ptr, "ERROR in reading irrigation section of INI file\n");
-		fprintf(output.log_file.ptr, "SIMULATION STATUS [0 - failure; 1 - success]\n");
-		fprintf(output.log_file.ptr, "0\n");
-		exit(1);
+		ok = 1;
+		if (!nscenario || branch_year < bgcin.ctrl.simstartyear || branch_year >= bgcin.ctrl.simstartyear + bgcin.ctrl.simyears)
+		{
+			printf("Error: --branch <year> needs at least one --scenario and a year of the simulation (%d-%d)\n",
+				bgcin.ctrl.simstartyear, bgcin.ctrl.simstartyear + bgcin.ctrl.simyears - 1);
+			ok = 0;
+		}
+		if (ok && bgcin.ctrl.spinup)
+		{
+			printf("Error: scenario branching is not available in spinup runs\n");
+			ok = 0;
+		}
+		for (k = 0; ok && k < nscenario; k++)
+		{
+			epc_check = bgcin.epc;
+			sitec_check = bgcin.sitec;
+			if (scenario_apply(&scenarios[k], &epc_check, &sitec_check, NULL, 0))
+			{
+				printf("Error in scenario %s\n", scenarios[k].name);
+				ok = 0;
+			}
+		}
+		if (!ok)
+		{
+			printf("Error in scenario branching from pointbgc.c... Exiting\n");
+			exit(1);
+		}
+		bgcin.ctrl.branch_simyr = branch_year - bgcin.ctrl.simstartyear;
+		if (output.onscreen) printf("INFORMATION: %d scenario(s) branching in year %d\n", nscenario, branch_year);
 	}
-	
-	/* -------------------------------------------------------------------------*/
 
-	/* read final line out of init file to test for proper file structure */
-	if (end_init(init))
+	/* the command line is valid: the restart and output files are opened
+	(and the earlier outputs overwritten) only now */
+	if (restart_open(&restart))
 	{
-		printf("Error in call to end_init() from pointbgc.c... exiting\n");
-		fprintf(output.log_file.ptr, "ERROR in reading final line of INI file\n");
-		fprintf(output.log_file.ptr, "SIMULATION STATUS [0 - failure; 1 - success]\n");
-		fprintf(output.log_file.ptr, "0\n");
+		printf("Error in call to restart_open() from pointbgc.c... Exiting\n");
 		exit(1);
 	}
-	fclose(init.ptr);
-
-	/* read meteorology file, build metarr arrays, compute running avgs */
-	if (metarr_init(point.metf, &bgcin.metarr, &scc, &bgcin.sitec, bgcin.ctrl.metyears))
+	if (output_open(&output))
 	{
-		printf("Error in call to metarr_init() from pointbgc.c... Exiting\n");
-		fprintf(output.log_file.ptr, "ERROR in reading meteorological file\n");
-		fprintf(output.log_file.ptr, "SIMULATION STATUS [0 - failure; 1 - success]\n");
-		fprintf(output.log_file.ptr, "0\n");
+		printf("Error in call to output_open() from pointbgc.c... Exiting\n");
 		exit(1);
 	}
-	fclose(point.metf.ptr);
 
-	/* read groundwater depth if it is available */
-	if (groundwater_init(&bgcin.sitec, &bgcin.ctrl))
-	{
-		printf("Error in call to groundwater_init() from pointbgc.c... Exiting\n");
-		fprintf(output.log_file.ptr, "ERROR in reading groundwater file\n");
-		fprintf(output.log_file.ptr, "SIMULATION STATUS [0 - failure; 1 - success]\n");
-		fprintf(output.log_file.ptr, "0\n");
-	}
-	
+	/* get the system time at start of simulation */
+	lt = time(NULL);
+	tm_ptr = localtime(&lt);
+	strcpy(point.systime,asctime(tm_ptr));
 
 
 	/* copy some of the info from input structure to bgc simulation control
@@ -324,6 +283,7 @@ int main(int argc, char *argv[])
 	bgcin.ctrl.simyr = 0;							/* counter - Hidy 2010.*/
 	bgcin.ctrl.yday = 0;							/* counter - Hidy 2010.*/
 	bgcin.ctrl.spinyears = 0;						/* counter - Hidy 2010.*/
+	bgcin.ctrl.phencache_dir = phencache_dir;
 
 	/* copy the output file structures into bgcout */
 	if (output.dodaily) bgcout.dayout = output.dayout;
@@ -333,14 +293,21 @@ int main(int argc, char *argv[])
 	bgcout.anntext = output.anntext;
 	bgcout.control_file = output.control_file;
 	bgcout.log_file = output.log_file;
+	bgcout.scenario = 0;
 	
 	
 	
 	/* if using an input restart file, read a record */
 	if (restart.read_restart)
 	{
-		fread(&(bgcin.restart_input),sizeof(restart_data_struct),1,
-			restart.in_restart.ptr);
+		if (restart_load(&restart, &(bgcin.restart_input)))
+		{
+			printf("Error in call to restart_load() from pointbgc.c... Exiting\n");
+			fprintf(output.log_file.ptr, "ERROR in reading restart file\n");
+			fprintf(output.log_file.ptr, "SIMULATION STATUS [0 - failure; 1 - success]\n");
+			fprintf(output.log_file.ptr, "0\n");
+			exit(1);
+		}
 	}
 
 	/*********************
@@ -350,9 +317,12 @@ int main(int argc, char *argv[])
 	*********************/
 
 	/* all initialization complete, call model */
+	if (profile) proftimer_init(profile == 2);
+
 	/* either call the spinup code or the normal simulation code */
 	if (bgcin.ctrl.spinup)
 	{
+		TRACE_BEGIN("spinup run");
 	 	if (spinup_bgc(&bgcin, &bgcout))
 		{
 			printf("Error in call to bgc()\n");
@@ -363,67 +333,112 @@ int main(int argc, char *argv[])
 		}
 		else
 		{
+			mem_report(output.log_file.ptr);
 			fprintf(output.log_file.ptr, "SIMULATION STATUS [0 - failure; 1 - success]\n");
 			fprintf(output.log_file.ptr, "1\n");
 		}
+		TRACE_END("spinup run");
 	
 	}
 	else
 	{   
-		if (bgc(&bgcin, &bgcout))
+		/* a scenario child returns from bgc() too, with its own output files
+		in bgcout; the base run waits for the scenarios */
+		TRACE_BEGIN("normal run");
+		ok = !bgc(&bgcin, &bgcout);
+		if (!bgcout.scenario && scenario_wait())
+		{
+			if (ok) fprintf(bgcout.log_file.ptr, "ERROR in scenario run\n");
+			ok = 0;
+		}
+		if (!bgcout.scenario) TRACE_END("normal run");
+		if (!ok)
 		{
 			printf("Error in call to bgc()\n");
-			fprintf(output.log_file.ptr, "ERROR in normal run\n");
-			fprintf(output.log_file.ptr, "SIMULATION STATUS [0 - failure; 1 - success]\n");
-			fprintf(output.log_file.ptr, "0\n");
+			fprintf(bgcout.log_file.ptr, "ERROR in normal run\n");
+			fprintf(bgcout.log_file.ptr, "SIMULATION STATUS [0 - failure; 1 - success]\n");
+			fprintf(bgcout.log_file.ptr, "0\n");
 			exit(1);
 		}
 		else
 		{
-			fprintf(output.log_file.ptr, "SIMULATION STATUS [0 - failure; 1 - success]\n");
-			fprintf(output.log_file.ptr, "1\n");
+			mem_report(bgcout.log_file.ptr);
+			fprintf(bgcout.log_file.ptr, "SIMULATION STATUS [0 - failure; 1 - success]\n");
+			fprintf(bgcout.log_file.ptr, "1\n");
 		}
 	}
 		
 
+	/* the restart output of a scenario goes to its own file (or key) */
+	if (restart.write_restart && bgcout.scenario)
+	{
+		ok = 1;
+		if (restart.out_key[0])
+		{
+			if (strlen(restart.out_key) + strlen(scenarios[bgcout.scenario-1].name) + 2 > RESTART_KEYLEN) ok = 0;
+			else sprintf(restart.out_key + strlen(restart.out_key), "_%s", scenarios[bgcout.scenario-1].name);
+		}
+		else
+		{
+			fclose(restart.out_restart.ptr);
+			ok = !scenario_filename(restart.out_restart.name, scenarios[bgcout.scenario-1].name) &&
+				 !file_open(&restart.out_restart, 'w');
+		}
+		if (!ok)
+		{
+			printf("Error in naming the restart output of scenario %s... Exiting\n", scenarios[bgcout.scenario-1].name);
+			exit(1);
+		}
+	}
+
 	/* if using an output restart file, write a record */
 	if (restart.write_restart)
 	{
-		fwrite(&(bgcout.restart_output),sizeof(restart_data_struct),1,
-			restart.out_restart.ptr);
+		TRACE_BEGIN("restart write");
+		if (restart_save(&restart, &(bgcout.restart_output)))
+		{
+			printf("Error in call to restart_save() from pointbgc.c... Exiting\n");
+			exit(1);
+		}
+		TRACE_END("restart write");
 	}
 
 	/* post-processing output handling, if any, goes here */
-	
-	/* free memory */
-	free(bgcin.metarr.tmax);
-	free(bgcin.metarr.tmin);
-	free(bgcin.metarr.prcp);
-	free(bgcin.metarr.vpd);
-	free(bgcin.metarr.tday);
-	free(bgcin.metarr.tavg);
-	free(bgcin.metarr.tavg11_ra);
-	free(bgcin.metarr.tavg30_ra);
-	free(bgcin.metarr.tavg10_ra);
-	free(bgcin.metarr.F_temprad);
-	free(bgcin.metarr.F_temprad_ra);
-	free(bgcin.metarr.swavgfd);
-	free(bgcin.metarr.par);
-	free(bgcin.metarr.dayl);
-
-	if (bgcin.co2.varco2) free(bgcin.co2.co2ppm_array);
-	free(output.anncodes);
-	free(output.daycodes);
+	if (profile && proftimer_report(bgcout.log_file.name))
+	{
+		printf("Error in call to proftimer_report() from pointbgc.c\n");
+	}
+	if (record && kernelrec_close())
+	{
+		printf("Error in call to kernelrec_close() from pointbgc.c\n");
+	}
 	
 	/* close files */
-	if (restart.read_restart) fclose(restart.in_restart.ptr);
-	if (restart.write_restart) fclose(restart.out_restart.ptr);
-	if (output.dodaily) fclose(output.dayout.ptr);
-	if (output.domonavg) fclose(output.monavgout.ptr);
-	if (output.doannavg) fclose(output.annavgout.ptr);
-	if (output.doannual) fclose(output.annout.ptr);
-	fclose(output.anntext.ptr);
-	fclose(output.log_file.ptr);
+	TRACE_BEGIN("close files");
+	if (restart.read_restart && !restart.in_key[0]) file_close(&restart.in_restart);
+	if (restart.write_restart && !restart.out_key[0]) fclose(restart.out_restart.ptr);
+	if (output.dodaily) fclose(bgcout.dayout.ptr);
+	if (output.domonavg) fclose(bgcout.monavgout.ptr);
+	if (output.doannavg) fclose(bgcout.annavgout.ptr);
+	if (output.doannual) fclose(bgcout.annout.ptr);
+	fclose(bgcout.anntext.ptr);
+	fclose(bgcout.log_file.ptr);
+	TRACE_END("close files");
+
+	/* free memory: every array allocated by the model (the arrays of a bundle
+	are part of the mapped file); the phenology cache first, it keeps its
+	blocks between the phases */
+	phen_cache_reset();
+	mem_free_all();
+
+	if (status && runstatus_close(1))
+	{
+		printf("Error in call to runstatus_close() from pointbgc.c\n");
+	}
+	if (trace && trace_close())
+	{
+		printf("Error in call to trace_close() from pointbgc.c\n");
+	}
 /* end of main */	
  } 
 	
@@ -0,0 +1,252 @@
+/*
+pointbgc_init.c
+reads the main init file and all the input files it refers to into the bgc input
+structures of the point driver (used by muso and by muso-compile)
+
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+Biome-BGCMuSo v4.0.2
+Original code: Copyright 2000, Peter E. Thornton
+Numerical Terradynamic Simulation Group, The University of Montana, USA
+Modified code: Copyright 2016, D. Hidy [dori.hidy@gmail.com]
+Hungarian Academy of Sciences, Hungary
+See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentation, model executable and example input files.
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "ini.h"
+#include "bgc_struct.h"
+#include "bgc_func.h"
+#include "pointbgc_struct.h"
+#include "pointbgc_func.h"
+#include "bgc_io.h"
+
+/* failure message of the init sections in the log file: the output files are
+not open yet (output_open is called after the command line is checked), the
+log file is written here with the failure status only */
+static void log_error(const output_struct* output, const char* message)
+{
+	char name[sizeof(output->outprefix) + 4];
+	FILE* log;
+
+	sprintf(name, "%s.log", output->outprefix);
+	if ((log = fopen(name, "w")) != NULL)
+	{
+		fprintf(log, "ERROR in %s\n", message);
+		fprintf(log, "SIMULATION STATUS [0 - failure; 1 - success]\n");
+		fprintf(log, "0\n");
+		fclose(log);
+	}
+}
+
+int pointbgc_init(const char* ininame, bgcin_struct* bgcin, point_struct* point,
+				  restart_ctrl_struct* restart, output_struct* output)
+{
+	/* only the input files are read, the restart and output files are opened
+	by restart_open and output_open (pointbgc.c) */
+	int ok = 1;
+	file init;
+	climchange_struct scc;
+
+	memset(output, 0, sizeof(output_struct));
+
+	/* initialize the bgcin state variable structures before filling with
+	values from ini file */
+	if (presim_state_init(&bgcin->ws, &bgcin->cs, &bgcin->ns, &bgcin->cinit))
+	{
+		printf("Error in call to presim_state_init() from pointbgc()\n");
+		return 1;
+	}
+
+	/* open the main init file for ascii read and check for errors */
+	strcpy(init.name, ininame);
+	if (file_open(&init,'i'))
+	{
+		printf("Error opening init file, pointbgc.c\n");
+		return 1;
+	}
+
+	/* read the header string from the init file */
+	if (fgets(point->header, 100, init.ptr)==NULL)
+	{
+		printf("Error reading header string: pointbgc.c\n");
+		return 1;
+	}
+
+	/* open met file, discard header lines */
+	if (met_init(init, point))
+	{
+		printf("Error in call to met_init() from pointbgc.c... Exiting\n");
+		return 1;
+	}
+
+	/* read restart control parameters */
+	if (restart_init(init, restart))
+	{
+		printf("Error in call to restart_init() from pointbgc.c... Exiting\n");
+		return 1;
+	}
+
+	/* read simulation timing control parameters */
+	if (time_init(init, &(bgcin->ctrl)))
+	{
+		printf("Error in call to time_init() from pointbgc.c... Exiting\n");
+		return 1;
+	}
+
+	/* read scalar climate change parameters */
+	if (scc_init(init, &scc))
+	{
+		printf("Error in call to scc_init() from pointbgc.c... Exiting\n");
+		return 1;
+	}
+
+	/* read CO2 control parameters */
+	if (co2_init(init, &(bgcin->co2), bgcin->ctrl.simyears))
+	{
+		printf("Error in call to co2_init() from pointbgc.c... Exiting\n");
+		return 1;
+	}
+
+	/* read varied nitrogen deposition block */
+	if (ndep_init(init, &bgcin->ndep, bgcin->ctrl.simyears))
+	{
+		printf("Error in call to ndep_init() from pointbgc.c... Exiting\n");
+		return 1;
+	}
+
+	/* read site constants */
+	if (sitec_init(init, &bgcin->sitec))
+	{
+		printf("Error in call to sitec_init() from pointbgc.c... Exiting\n");
+		return 1;
+	}
+
+	/* read ecophysiological constants */
+	if (epc_init(init, &bgcin->epc, &bgcin->ctrl))
+	{
+		printf("Error in call to epc_init() from pointbgc.c... Exiting\n");
+		return 1;
+	}
+
+	/* initialize water state structure */
+	if (wstate_init(init, &bgcin->sitec, &bgcin->ws))
+	{
+		printf("Error in call to wstate_init() from pointbgc.c... Exiting\n");
+		return 1;
+	}
+
+	/* initialize carbon and nitrogen state structures */
+	if (cnstate_init(init, &bgcin->epc, &bgcin->cs, &bgcin->cinit, &bgcin->ns))
+	{
+		printf("Error in call to cstate_init() from pointbgc.c... Exiting\n");
+		return 1;
+	}
+
+	/* Hidy 2012 - read the GSI information if GSI flag is 1.0 */
+	if (GSI_init(init, &bgcin->GSI))
+	{
+		printf("Error in call to GSI_init() from pointbgc.c... Exiting\n");
+		return 1;
+	}
+
+	/* read the output control information */
+	if (output_init(init, output))
+	{
+		printf("Error in call to output_init() from pointbgc.c... Exiting\n");
+		return 1;
+	}
+
+	/* -------------------------------------------------------------------------*/
+	/* MANAGEMENT SECTION - Hidy 2012.. */
+
+	if (ok && planting_init(init, &bgcin->ctrl, &bgcin->PLT))
+	{
+		printf("Error in call to planting_init() from pointbgc.c... Exiting\n");
+		log_error(output, "reading planting section of INI file");
+		ok=0;
+	}
+
+	if (ok && thinning_init(init, &bgcin->ctrl, &bgcin->THN))
+	{
+		printf("Error in call to thinning_init() from pointbgc.c... Exiting\n");
+		log_error(output, "reading thinning section of INI file");
+		ok=0;
+	}
+
+	if (ok && mowing_init(init, &bgcin->ctrl, &bgcin->MOW))
+	{
+		printf("Error in call to mowing_init() from pointbgc.c... Exiting\n");
+		log_error(output, "reading mowing section of INI file");
+		ok=0;
+	}
+
+	if (ok && grazing_init(init, &bgcin->ctrl, &bgcin->GRZ))
+	{
+		printf("Error in call to grazing_init() from pointbgc.c... Exiting\n");
+		log_error(output, "reading grazing section of INI file");
+		ok=0;
+	}
+
+	if (ok && harvesting_init(init, &bgcin->ctrl, &bgcin->HRV))
+	{
+		printf("Error in call to harvesting_init() from pointbgc.c... Exiting\n");
+		log_error(output, "reading harvesting section of INI file");
+		ok=0;
+	}
+
+	if (ok && ploughing_init(init, &bgcin->ctrl, &bgcin->PLG))
+	{
+		printf("Error in call to ploughing_init() from pointbgc.c... Exiting\n");
+		log_error(output, "reading ploughing section of INI file");
+		ok=0;
+	}
+
+	if (ok && fertilizing_init(init, &bgcin->ctrl, &bgcin->FRZ))
+	{
+		printf("Error in call to fertilizing_init() from pointbgc.c... Exiting\n");
+		log_error(output, "reading fertilizing section of INI file");
+		ok=0;
+	}
+
+	if (ok && irrigation_init(init, &bgcin->ctrl, &bgcin->IRG))
+	{
+		printf("Error in call to irrigation_init() from pointbgc.c... Exiting\n");
+		log_error(output, "reading irrigation section of INI file");
+		ok=0;
+	}
+
+	/* -------------------------------------------------------------------------*/
+
+	/* read final line out of init file to test for proper file structure */
+	if (ok && end_init(init))
+	{
+		printf("Error in call to end_init() from pointbgc.c... exiting\n");
+		log_error(output, "reading final line of INI file");
+		ok=0;
+	}
+	if (!ok) return 1;
+	file_close(&init);
+
+	/* read meteorology file, build metarr arrays, compute running avgs */
+	TRACE_BEGIN("metarr_init");
+	if (metarr_init(point->metf, &bgcin->metarr, &scc, &bgcin->sitec, bgcin->ctrl.metyears))
+	{
+		printf("Error in call to metarr_init() from pointbgc.c... Exiting\n");
+		log_error(output, "reading meteorological file");
+		return 1;
+	}
+	TRACE_END("metarr_init");
+	file_close(&point->metf);
+
+	/* read groundwater depth if it is available (not fatal) */
+	if (groundwater_init(&bgcin->sitec, &bgcin->ctrl))
+	{
+		printf("Error in call to groundwater_init() from pointbgc.c... Exiting\n");
+		log_error(output, "reading groundwater file");
+	}
+
+	return (!ok);
+}
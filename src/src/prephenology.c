@@ -37,12 +37,7 @@ const siteconst_struct* sitec, const metarr_struct* metarr, phenarray_struct* ph
 	int nyears,phenyears;
 	int ngrowthdays,ntransferdays,nlitfalldays;
 	int onday,offday;
-	int counter;
-	int remdays_curgrowth[365];
-	int remdays_transfer[365];
-	int predays_transfer[365];
-	int remdays_litfall[365];
-	int predays_litfall[365];
+	phenyear_struct phensig;
 	/* phenology model variables */
 	int *onday_arr = 0;
 	int *offday_arr = 0;
@@ -88,58 +83,18 @@ const siteconst_struct* sitec, const metarr_struct* metarr, phenarray_struct* ph
 	/* allocate space for phenology arrays */
 	if (ok)
 	{
-		phenarr->remdays_curgrowth = (int*) malloc(ndays*sizeof(int));
-		if (!phenarr->remdays_curgrowth)
+		/* one element per phenological year (nyears+1 for southern sites) */
+		phenarr->phenyear = (phenyear_struct*) mem_alloc(MEM_PHEN, (nyears+1) * sizeof(phenyear_struct));
+		if (!phenarr->phenyear)
 		{
-			printf("Error allocating for phenarr->curgrowth, prephenology()\n");
+			printf("Error allocating for phenarr->phenyear, prephenology()\n");
 			ok=0;
 		}
 	}
 
 	if (ok)
 	{
-		phenarr->remdays_transfer = (int*) malloc(ndays*sizeof(int));
-		if (!phenarr->remdays_transfer)
-		{
-			printf("Error allocating for phenarr->remdays_transfer, prephenology()\n");
-			ok=0;
-		}
-	}
-
-
-	if (ok)
-	{
-		phenarr->remdays_litfall = (int*) malloc(ndays*sizeof(int));
-		if (!phenarr->remdays_litfall)
-		{
-			printf("Error allocating for phenarr->remdays_litfall, prephenology()\n");
-			ok=0;
-		}
-	}
-
-	if (ok)
-	{
-		phenarr->predays_transfer = (int*) malloc(ndays*sizeof(int));
-		if (!phenarr->predays_transfer)
-		{
-			printf("Error allocating for phenarr->predays_transfer, prephenology()\n");
-			ok=0;
-		}
-	}
-
-	if (ok)
-	{
-		phenarr->predays_litfall = (int*) malloc(ndays*sizeof(int));
-		if (!phenarr->predays_litfall)
-		{
-			printf("Error allocating for phenarr->predays_litfall, prephenology()\n");
-			ok=0;
-		}
-	}
-
-	if (ok)
-	{
-		onday_arr = (int*) malloc((nyears+1) * sizeof(int));
+		onday_arr = (int*) mem_alloc(MEM_PHEN, (nyears+1) * sizeof(int));
 		if (!onday_arr)
 		{
 			printf("Error allocating for onday_arr, prephenology()\n");
@@ -149,7 +104,7 @@ const siteconst_struct* sitec, const metarr_struct* metarr, phenarray_struct* ph
 
 	if (ok)
 	{
-		offday_arr = (int*) malloc((nyears+1) * sizeof(int));
+		offday_arr = (int*) mem_alloc(MEM_PHEN, (nyears+1) * sizeof(int));
 		if (!offday_arr)
 		{
 			printf("Error allocating for offday_arr, prephenology()\n");
@@ -162,7 +117,7 @@ const siteconst_struct* sitec, const metarr_struct* metarr, phenarray_struct* ph
 	{
 		if (ok)
 		{
-			phenarr->onday_arr = (int*) malloc((nyears+1) * sizeof(int));
+			phenarr->onday_arr = (int*) mem_alloc(MEM_PHEN, (nyears+1) * sizeof(int));
 			if (!phenarr->onday_arr)
 			{
 				printf("Error allocating for onday_arr, prephenology()\n");
@@ -171,7 +126,7 @@ const siteconst_struct* sitec, const metarr_struct* metarr, phenarray_struct* ph
 		}
 		if (ok)
 		{
-			phenarr->offday_arr = (int*) malloc((nyears+1) * sizeof(int));
+			phenarr->offday_arr = (int*) mem_alloc(MEM_PHEN, (nyears+1) * sizeof(int));
 			if (!phenarr->offday_arr)
 			{
 				printf("Error allocating for offday_arr, prephenology()\n");
@@ -195,6 +150,12 @@ const siteconst_struct* sitec, const metarr_struct* metarr, phenarray_struct* ph
 	/* for southern hemisphere sites, use an extra phenology year */
 	if (south) phenyears = nyears+1;
 	else phenyears = nyears;
+
+	phenarr->nphenyears = phenyears;
+	phenarr->south = south;
+	phenarr->evergreen = 0;
+	phensig.onday = phensig.offday = -1;
+	phensig.ntransfer = phensig.nlitfall = 0;
 	
 
 	fprintf(logfile.ptr, "Information about SGS and EGS values (yday of onday and offday)\n");
@@ -203,16 +164,6 @@ const siteconst_struct* sitec, const metarr_struct* metarr, phenarray_struct* ph
 	are constant between years */
 	if (evergreen || !model)
 	{
-		/* zero the n_yday-day phen arrays */
-		for (pday=0 ; pday<n_yday ; pday++)
-		{
-			remdays_curgrowth[pday] = 0;
-			remdays_transfer[pday] = 0;
-			predays_transfer[pday] = 0;
-			remdays_litfall[pday] = 0;
-			predays_litfall[pday] = 0;
-		}
-		
 
 		/* Hidy 2015 - user defined on and off days (base zero) */
 		for (py=0 ; py<phenyears ; py++)
@@ -255,19 +206,17 @@ const siteconst_struct* sitec, const metarr_struct* metarr, phenarray_struct* ph
 		fprintf(logfile.ptr, "SGS value (min and max): %6i %6i\n", onday_min, onday_max);
 		fprintf(logfile.ptr, "EGS value (min and max): %6i %6i\n", offday_min, offday_max);
 		fprintf(logfile.ptr, " \n");
+		phenarr->onday_min  = onday_min;
+		phenarr->onday_max  = onday_max;
+		phenarr->offday_min = offday_min;
+		phenarr->offday_max = offday_max;
 
 		if (!model && onday == -1 && offday == -1)
 		{
 			/* this is the special signal to repress all vegetation
 			growth, for simulations of bare ground */
-			for (pday=0 ; pday<n_yday ; pday++)
-			{
-				remdays_curgrowth[pday] = 0;
-				remdays_transfer[pday] = 0;
-				predays_transfer[pday] = 0;
-				remdays_litfall[pday] = 0;
-				predays_litfall[pday] = 0;
-			}
+			phensig.onday = phensig.offday = -1;
+			phensig.ntransfer = phensig.nlitfall = 0;
 		} /* end if special no-growth signal */
 		else
 		{
@@ -308,135 +257,28 @@ const siteconst_struct* sitec, const metarr_struct* metarr, phenarray_struct* ph
 				nlitfalldays = atoi(round);
 				if (nlitfalldays < 1) nlitfalldays = 1;
 				if (nlitfalldays > ngrowthdays) nlitfalldays = ngrowthdays;
-				for (pday=0 ; pday<onday ; pday++)
-				{
-					remdays_curgrowth[pday] = 0;
-					remdays_transfer[pday] = 0;
-					remdays_litfall[pday] = 0;
-					predays_transfer[pday] = 0;
-					predays_litfall[pday] = 0;
-				}
-				counter = ngrowthdays;
-				for (pday=onday ; pday<offday ; pday++)
-				{
-					remdays_curgrowth[pday] = counter;
-					counter--;
-				}
-				for (pday=offday ; pday<n_yday ; pday++)
-				{
-					remdays_curgrowth[pday] = 0;
-				}
-				counter = ntransferdays;
-				for (pday=onday ; pday<onday+ntransferdays ; pday++)
-				{
-					remdays_transfer[pday] = counter;
-					predays_transfer[pday] = ntransferdays - counter;
-					counter--;
-				}
-				for (pday=onday+ntransferdays ; pday<=offday ; pday++)
-				{
-					remdays_transfer[pday] = 0;
-					predays_transfer[pday] = ntransferdays;
-				}
-				for (pday=offday+1 ; pday<n_yday ; pday++)
-				{
-					remdays_transfer[pday] = 0;
-					predays_transfer[pday] = 0;
-				}
-				for (pday=onday ; pday<offday-nlitfalldays+1 ; pday++)
-				{
-					remdays_litfall[pday] = 0;
-					predays_litfall[pday] = 0;
-				}
-				counter = nlitfalldays;
-				for (pday=offday-nlitfalldays+1 ; pday<=offday ; pday++)
-				{
-					remdays_litfall[pday] = counter;
-					predays_litfall[pday] = nlitfalldays - counter;
-					counter--;
-				}
-				for (pday=offday+1 ; pday<n_yday ; pday++)
-				{
-					remdays_litfall[pday] = 0;
-					predays_litfall[pday] = 0;
-				}
+				phensig.onday = (short) onday;
+				phensig.offday = (short) offday;
+				phensig.ntransfer = (short) ntransferdays;
+				phensig.nlitfall = (short) nlitfalldays;
 			} /* end if user-specified and deciduous */
 
 			if (evergreen)
 			{	
 				/* specifying evergreen overrides any user input phenology data,
 				and triggers a very simple treatment of the transfer, litterfall,
-				and current growth signals.  Treatment is the same for woody and
-				non-woody types, and the same for model or user-input phenology */
-				/* fill the local phenyear control arrays */
-				for (pday=0 ; pday<n_yday ; pday++)
-				{
-					remdays_curgrowth[pday] = n_yday-pday;
-					remdays_transfer[pday] = n_yday-pday;
-					remdays_litfall[pday] = n_yday-pday;
-					predays_transfer[pday] = pday;
-					predays_litfall[pday] = pday;
-				} 
+				and current growth signals (see dayphen()).  Treatment is the
+				same for woody and non-woody types, and the same for model or
+				user-input phenology */
+				phenarr->evergreen = 1;
+				phensig.onday = 0;
+				phensig.offday = (short) (n_yday-1);
+				phensig.ntransfer = phensig.nlitfall = (short) n_yday;
 			} /* end if evergreen */
 		} /* end else normal growth */
 
-		/* now copy this year multiple times to the permanent phenology struct
-		arrays, with tests for southern hemisphere. */
-		for (py=0 ; py<phenyears ; py++)
-		{
-			if (south)
-			{
-				if (py==0)
-				{
-					/* only copy the second half of this phenological
-					year to the permanent phenology array */
-					for (pday=182 ; pday<n_yday ; pday++)
-					{
-						phenarr->remdays_curgrowth[pday-182] = remdays_curgrowth[pday];
-						phenarr->remdays_transfer[pday-182] = remdays_transfer[pday];
-						phenarr->remdays_litfall[pday-182] = remdays_litfall[pday];
-						phenarr->predays_transfer[pday-182] = predays_transfer[pday];
-						phenarr->predays_litfall[pday-182] = predays_litfall[pday];
-					}
-				}
-				else if (py==phenyears-1)
-				{
-					/* only copy the first half of this phenological
-					year to the permanent phenology array */
-					for (pday=0 ; pday<182 ; pday++)
-					{
-						phenarr->remdays_curgrowth[py*n_yday-182+pday] = remdays_curgrowth[pday];
-						phenarr->remdays_transfer[py*n_yday-182+pday] = remdays_transfer[pday];
-						phenarr->remdays_litfall[py*n_yday-182+pday] = remdays_litfall[pday];
-						phenarr->predays_transfer[py*n_yday-182+pday] = predays_transfer[pday];
-						phenarr->predays_litfall[py*n_yday-182+pday] = predays_litfall[pday];
-					}
-				}
-				else
-				{
-					for (pday=0 ; pday<n_yday ; pday++)
-					{
-						phenarr->remdays_curgrowth[py*n_yday-182+pday] = remdays_curgrowth[pday];
-						phenarr->remdays_transfer[py*n_yday-182+pday] = remdays_transfer[pday];
-						phenarr->remdays_litfall[py*n_yday-182+pday] = remdays_litfall[pday];
-						phenarr->predays_transfer[py*n_yday-182+pday] = predays_transfer[pday];
-						phenarr->predays_litfall[py*n_yday-182+pday] = predays_litfall[pday];
-					}
-				}
-			} /* end if south */
-			else
-			{
-				/* north */
-				for (pday=0 ; pday<n_yday ; pday++)
-				{
-					phenarr->remdays_curgrowth[py*n_yday+pday] = remdays_curgrowth[pday];
-					phenarr->remdays_transfer[py*n_yday+pday] = remdays_transfer[pday];
-					phenarr->remdays_litfall[py*n_yday+pday] = remdays_litfall[pday];
-					phenarr->predays_transfer[py*n_yday+pday] = predays_transfer[pday];
-					phenarr->predays_litfall[py*n_yday+pday] = predays_litfall[pday];
-				}
-			} /* end if north */
-		} /* end py loop */
+		/* the signals are the same in every phenological year */
+		for (py=0 ; py<phenyears ; py++) phenarr->phenyear[py] = phensig;
 	} /* end if constant phenological signals */
 	else
 	{
@@ -878,6 +720,10 @@ const siteconst_struct* sitec, const metarr_struct* metarr, phenarray_struct* ph
 		fprintf(logfile.ptr, "SGS value (min and max): %6i %6i\n", onday_min, onday_max);
 		fprintf(logfile.ptr, "EGS value (min and max): %6i %6i\n", offday_min, offday_max);
 		fprintf(logfile.ptr, " \n");
+		phenarr->onday_min  = onday_min;
+		phenarr->onday_max  = onday_max;
+		phenarr->offday_min = offday_min;
+		phenarr->offday_max = offday_max;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -886,20 +732,10 @@ const siteconst_struct* sitec, const metarr_struct* metarr, phenarray_struct* ph
 		
 		/* now the onset and offset days are established for each phenyear,
 		either by the deciduous tree or the grass model.  Next loop through
-		phenyears filling the phenology signal arrays and copying them to 
-		the permanent phen struct arrays */
+		phenyears defining the lengths of the transfer and litfall periods,
+		the daily signals are derived from these in dayphen() */
 		for (py=0 ; py<phenyears ; py++)
 		{
-			/* zero the n_yday-day phen arrays */
-			for (pday=0 ; pday<n_yday ; pday++)
-			{
-				remdays_curgrowth[pday] = 0;
-				remdays_transfer[pday] = 0;
-				predays_transfer[pday] = 0;
-				remdays_litfall[pday] = 0;
-				predays_litfall[pday] = 0;
-			}
-			
 			onday = onday_arr[py];
 			offday = offday_arr[py];
 			
@@ -907,14 +743,7 @@ const siteconst_struct* sitec, const metarr_struct* metarr, phenarray_struct* ph
 			{
 				/* this is the special signal to repress all vegetation
 				growth */
-				for (pday=0 ; pday<n_yday ; pday++)
-				{
-					remdays_curgrowth[pday] = 0;
-					remdays_transfer[pday] = 0;
-					predays_transfer[pday] = 0;
-					remdays_litfall[pday] = 0;
-					predays_litfall[pday] = 0;
-				}
+				ntransferdays = nlitfalldays = 0;
 			} /* end if special no-growth signal */
 			else
 			{
@@ -943,121 +772,18 @@ const siteconst_struct* sitec, const metarr_struct* metarr, phenarray_struct* ph
 				nlitfalldays = atoi(round);
 				if (nlitfalldays < 1) nlitfalldays = 1;
 				if (nlitfalldays > ngrowthdays) nlitfalldays = ngrowthdays;
-				
-				for (pday=0 ; pday<onday ; pday++)
-				{
-					remdays_curgrowth[pday] = 0;
-					remdays_transfer[pday] = 0;
-					remdays_litfall[pday] = 0;
-					predays_transfer[pday] = 0;
-					predays_litfall[pday] = 0;
-				}
-				counter = ngrowthdays;
-				for (pday=onday ; pday<offday ; pday++)
-				{
-					remdays_curgrowth[pday] = counter;
-					counter--;
-				}
-				for (pday=offday ; pday<n_yday ; pday++)
-				{
-					remdays_curgrowth[pday] = 0;
-				}
-				counter = ntransferdays;
-				for (pday=onday ; pday<onday+ntransferdays ; pday++)
-				{
-					remdays_transfer[pday] = counter;
-					predays_transfer[pday] = ntransferdays - counter;
-					counter--;
-				}
-				for (pday=onday+ntransferdays ; pday<=offday ; pday++)
-				{
-					remdays_transfer[pday] = 0;
-					predays_transfer[pday] = ntransferdays;
-				}
-				for (pday=offday+1 ; pday<n_yday ; pday++)
-				{
-					remdays_transfer[pday] = 0;
-					predays_transfer[pday] = 0;
-				}
-				for (pday=onday ; pday<offday-nlitfalldays+1 ; pday++)
-				{
-					remdays_litfall[pday] = 0;
-					predays_litfall[pday] = 0;
-				}
-				counter = nlitfalldays;
-				for (pday=offday-nlitfalldays+1 ; pday<=offday ; pday++)
-				{
-					remdays_litfall[pday] = counter;
-					predays_litfall[pday] = nlitfalldays - counter;
-					counter--;
-				}
-				for (pday=offday+1 ; pday<n_yday ; pday++)
-				{
-					remdays_litfall[pday] = 0;
-					predays_litfall[pday] = 0;
-				}
 			} /* end else normal growth year */
 			
-			/* now put the signals for this phenological year into the
-			right place in the permanent phen struct arrays */ 
-			if (south)
-			{
-				if (py==0)
-				{
-					/* only copy the second half of this phenological
-					year to the permanent phenology array */
-					for (pday=182 ; pday<n_yday ; pday++)
-					{
-						phenarr->remdays_curgrowth[pday-182] = remdays_curgrowth[pday];
-						phenarr->remdays_transfer[pday-182] = remdays_transfer[pday];
-						phenarr->remdays_litfall[pday-182] = remdays_litfall[pday];
-						phenarr->predays_transfer[pday-182] = predays_transfer[pday];
-						phenarr->predays_litfall[pday-182] = predays_litfall[pday];
-					}
-				}
-				else if (py==phenyears-1)
-				{
-					/* only copy the first half of this phenological
-					year to the permanent phenology array */
-					for (pday=0 ; pday<182 ; pday++)
-					{
-						phenarr->remdays_curgrowth[py*n_yday-182+pday] = remdays_curgrowth[pday];
-						phenarr->remdays_transfer[py*n_yday-182+pday] = remdays_transfer[pday];
-						phenarr->remdays_litfall[py*n_yday-182+pday] = remdays_litfall[pday];
-						phenarr->predays_transfer[py*n_yday-182+pday] = predays_transfer[pday];
-						phenarr->predays_litfall[py*n_yday-182+pday] = predays_litfall[pday];
-					}
-				}
-				else
-				{
-					for (pday=0 ; pday<n_yday ; pday++)
-					{
-						phenarr->remdays_curgrowth[py*n_yday-182+pday] = remdays_curgrowth[pday];
-						phenarr->remdays_transfer[py*n_yday-182+pday] = remdays_transfer[pday];
-						phenarr->remdays_litfall[py*n_yday-182+pday] = remdays_litfall[pday];
-						phenarr->predays_transfer[py*n_yday-182+pday] = predays_transfer[pday];
-						phenarr->predays_litfall[py*n_yday-182+pday] = predays_litfall[pday];
-					}
-				}
-			} /* end if south */
-			else
-			{
-				/* north */
-				for (pday=0 ; pday<n_yday ; pday++)
-				{
-					phenarr->remdays_curgrowth[py*n_yday+pday] = remdays_curgrowth[pday];
-					phenarr->remdays_transfer[py*n_yday+pday] = remdays_transfer[pday];
-					phenarr->remdays_litfall[py*n_yday+pday] = remdays_litfall[pday];
-					phenarr->predays_transfer[py*n_yday+pday] = predays_transfer[pday];
-					phenarr->predays_litfall[py*n_yday+pday] = predays_litfall[pday];
-				}
-			} /* end if north */
+			phenarr->phenyear[py].onday = (short) onday;
+			phenarr->phenyear[py].offday = (short) offday;
+			phenarr->phenyear[py].ntransfer = (short) ntransferdays;
+			phenarr->phenyear[py].nlitfall = (short) nlitfalldays;
 		} /* end phenyears loop for filling permanent arrays */
 	} /* end else phenology model block */
 	
 	/* free the local array memory */
-	free(onday_arr); 
-	free(offday_arr);
+	mem_free(onday_arr); 
+	mem_free(offday_arr);
 
 	return (!ok);
 }
@@ -1067,13 +793,9 @@ int free_phenmem(phenarray_struct* phenarr)
 	int ok=1;
 	
 	/* free memory in phenology arrays */
-	free(phenarr->remdays_curgrowth);
-	free(phenarr->remdays_transfer);
-	free(phenarr->remdays_litfall);
-	free(phenarr->predays_transfer);
-	free(phenarr->predays_litfall);
-	free(phenarr->onday_arr);
-	free(phenarr->offday_arr);
+	mem_free(phenarr->phenyear);
+	mem_free(phenarr->onday_arr);
+	mem_free(phenarr->offday_arr);
 	
 	return (!ok);
 }
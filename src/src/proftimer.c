@@ -0,0 +1,250 @@
+/*
+proftimer.c
+process timers of the daily loop: the calls of the main daily processes in
+bgc(), spinup_bgc() and transient_bgc() are enclosed in PROF_BEGIN/PROF_END
+(see bgc_func.h), which cost only a test of proftimer_on if profiling is off.
+With profiling on (--profile) the time stamp counter of the processor is read
+at the beginning and at the end of the calls (the monotonic clock where the
+counter is not available), the ticks are converted to seconds with the rate
+measured over the whole run. The profile (calls, total and mean time and share
+of the run time of every process) is written next to the log file, with the
+extension .prof.
+The timers of richards() and tipping() are part of multilayer_hydrolprocess(),
+the timer of the whole day encloses the other timers of the daily loop.
+With the hardware counters (--perf, see perfcount.c) the cycles, instructions,
+cache misses and branch misses of every timer are added up as well, and a
+second table (instructions per cycle, misses per thousand instructions) is
+written into the profile. The counters are read with a system call, the
+counts of the whole day and of multilayer_hydrolprocess() include the reading
+of the counters of the timers inside them.
+
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+Biome-BGCMuSo v4.0.2
+Copyright 2016, D. Hidy [dori.hidy@gmail.com]
+Hungarian Academy of Sciences, Hungary
+See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentation, model executable and example input files.
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define PROF_TSC
+#endif
+#include "bgc_struct.h"
+#include "bgc_func.h"
+
+int proftimer_on = 0;
+
+static const char* proftimer_name[N_PROFTIMERS] =
+{
+	"management",
+	"daymet",
+	"multilayer_tsoil",
+	"phenology",
+	"multilayer_rootdepth",
+	"radtrans",
+	"conduct_calc",
+	"maint_resp",
+	"canopy_et",
+	"photosynthesis",
+	"multilayer_transpiration",
+	"decomp",
+	"daily_allocation",
+	"multilayer_hydrolprocess",
+	"  richards",
+	"  tipping",
+	"daily_state_update",
+	"mgm_submodules",
+	"mortality",
+	"multilayer_sminn",
+	"check_balance",
+	"daily output",
+	"whole day"
+};
+
+/* nested timers (part of an other timer, not counted in the sum) */
+static const int proftimer_nested[N_PROFTIMERS] =
+{
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,1,0,0,0,0,0,0,1
+};
+
+static unsigned long long prof_start[N_PROFTIMERS];
+static unsigned long long prof_ticks[N_PROFTIMERS];
+static unsigned long long prof_calls[N_PROFTIMERS];
+static unsigned long long prof_run_ticks;
+static double prof_run_sec;
+
+static unsigned long long prof_cstart[N_PROFTIMERS][N_PERFCOUNTERS];
+static unsigned long long prof_counts[N_PROFTIMERS][N_PERFCOUNTERS];
+static unsigned long long prof_run_counts[N_PERFCOUNTERS];
+static char prof_perf_message[200];
+
+/* time stamp counter, or nanoseconds of the monotonic clock */
+static unsigned long long prof_now(void)
+{
+#ifdef PROF_TSC
+	return (unsigned long long) __rdtsc();
+#elif defined(_WIN32)
+	return (unsigned long long) clock();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long) ts.tv_sec * 1000000000ULL + (unsigned long long) ts.tv_nsec;
+#endif
+}
+
+/* wall clock in seconds (for the tick rate) */
+static double prof_seconds(void)
+{
+#ifdef _WIN32
+	return (double) clock() / CLOCKS_PER_SEC;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec + 1e-9 * (double) ts.tv_nsec;
+#endif
+}
+
+/* counters: 1 to read the hardware performance counters as well */
+void proftimer_init(int counters)
+{
+	memset(prof_ticks, 0, sizeof(prof_ticks));
+	memset(prof_calls, 0, sizeof(prof_calls));
+	memset(prof_counts, 0, sizeof(prof_counts));
+	prof_perf_message[0] = '\0';
+	if (counters && perfcount_open(prof_perf_message, sizeof(prof_perf_message)))
+	{
+		printf("WARNING: hardware performance counters are not available (%s), profile without counters\n", prof_perf_message);
+	}
+	if (perfcount_on) perfcount_read(prof_run_counts);
+	prof_run_sec = prof_seconds();
+	prof_run_ticks = prof_now();
+	proftimer_on = 1;
+}
+
+void proftimer_begin(int id)
+{
+	if (perfcount_on) perfcount_read(prof_cstart[id]);
+	prof_start[id] = prof_now();
+}
+
+void proftimer_end(int id)
+{
+	int c;
+	unsigned long long count[N_PERFCOUNTERS];
+
+	prof_ticks[id] += prof_now() - prof_start[id];
+	prof_calls[id]++;
+	if (perfcount_on)
+	{
+		perfcount_read(count);
+		for (c = 0; c < N_PERFCOUNTERS; c++) prof_counts[id][c] += count[c] - prof_cstart[id][c];
+	}
+}
+
+/* one row of the counter table (n: counts of the timer or of the run) */
+static void prof_counter_row(FILE* f, const char* name, const unsigned long long* n)
+{
+	char ipc[16], cmiss[16], bmiss[16];
+	double instr = (double) n[PC_INSTRUCTIONS];
+
+	if (perfcount_available(PC_INSTRUCTIONS) && n[PC_CYCLES])
+		sprintf(ipc, "%.2f", instr / (double) n[PC_CYCLES]);
+	else
+		strcpy(ipc, "n/a");
+	if (perfcount_available(PC_INSTRUCTIONS) && perfcount_available(PC_CACHE_MISSES) && instr > 0.0)
+		sprintf(cmiss, "%.3f", 1000.0 * (double) n[PC_CACHE_MISSES] / instr);
+	else
+		strcpy(cmiss, "n/a");
+	if (perfcount_available(PC_INSTRUCTIONS) && perfcount_available(PC_BRANCH_MISSES) && instr > 0.0)
+		sprintf(bmiss, "%.3f", 1000.0 * (double) n[PC_BRANCH_MISSES] / instr);
+	else
+		strcpy(bmiss, "n/a");
+
+	fprintf(f, "%-26s %12.3f %12.3f %6s %12.4f %10s %12.4f %10s\n", name,
+		1e-6 * (double) n[PC_CYCLES], 1e-6 * instr, ipc,
+		1e-6 * (double) n[PC_CACHE_MISSES], cmiss, 1e-6 * (double) n[PC_BRANCH_MISSES], bmiss);
+}
+
+int proftimer_report(const char* logname)
+{
+	int id, c;
+	char name[140];
+	char* dot;
+	char* slash;
+	unsigned long long run_ticks, sum_ticks;
+	unsigned long long count[N_PERFCOUNTERS], run_counts[N_PERFCOUNTERS];
+	double run_sec, sec_per_tick, t;
+	FILE* f;
+
+	if (!proftimer_on) return 0;
+
+	run_ticks = prof_now() - prof_run_ticks;
+	run_sec = prof_seconds() - prof_run_sec;
+	if (run_ticks == 0 || run_sec <= 0.0) run_ticks = 1;
+	sec_per_tick = run_sec / (double) run_ticks;
+
+	/* <log file name without extension>.prof */
+	strncpy(name, logname, 128);
+	name[128] = '\0';
+	dot = strrchr(name, '.');
+	slash = strrchr(name, '/');
+	if (!slash) slash = strrchr(name, '\\');
+	if (!dot || (slash && dot < slash)) dot = name + strlen(name);
+	strcpy(dot, ".prof");
+
+	f = fopen(name, "w");
+	if (!f)
+	{
+		printf("Error opening profile file %s\n", name);
+		return 1;
+	}
+
+	fprintf(f, "PROFILE OF THE DAILY PROCESSES\n");
+	fprintf(f, "run time: %.3f s\n", run_sec);
+	fprintf(f, " \n");
+	fprintf(f, "%-26s %12s %12s %12s %8s\n", "process", "calls", "total (s)", "mean (us)", "share(%)");
+	sum_ticks = 0;
+	for (id = 0; id < N_PROFTIMERS; id++)
+	{
+		if (!proftimer_nested[id]) sum_ticks += prof_ticks[id];
+		if (prof_calls[id] == 0) continue;
+		t = (double) prof_ticks[id] * sec_per_tick;
+		fprintf(f, "%-26s %12llu %12.4f %12.3f %8.2f\n", proftimer_name[id], prof_calls[id], t,
+				1e6 * t / (double) prof_calls[id], 100.0 * (double) prof_ticks[id] / (double) run_ticks);
+	}
+	t = (double) (run_ticks > sum_ticks ? run_ticks - sum_ticks : 0) * sec_per_tick;
+	fprintf(f, "%-26s %12s %12.4f %12s %8.2f\n", "other", "", t, "", 100.0 * t / (run_sec > 0.0 ? run_sec : 1.0));
+
+	/* hardware performance counters */
+	fprintf(f, " \n");
+	if (perfcount_on)
+	{
+		perfcount_read(count);
+		for (c = 0; c < N_PERFCOUNTERS; c++) run_counts[c] = count[c] - prof_run_counts[c];
+
+		fprintf(f, "HARDWARE PERFORMANCE COUNTERS (user mode; counts in millions, misses per thousand instructions)\n");
+		fprintf(f, "counting time / enabled time: %.3f (below 1: multiplexed counters, the counts are too low)\n", perfcount_running());
+		fprintf(f, " \n");
+		fprintf(f, "%-26s %12s %12s %6s %12s %10s %12s %10s\n", "process", "cycles", "instructions", "IPC",
+			"cache miss", "cmiss/kI", "branch miss", "bmiss/kI");
+		for (id = 0; id < N_PROFTIMERS; id++)
+		{
+			if (prof_calls[id] == 0) continue;
+			prof_counter_row(f, proftimer_name[id], prof_counts[id]);
+		}
+		prof_counter_row(f, "run", run_counts);
+		perfcount_close();
+	}
+	else if (prof_perf_message[0])
+	{
+		fprintf(f, "hardware performance counters are not available: %s\n", prof_perf_message);
+	}
+
+	fclose(f);
+	return 0;
+}
@@ -20,6 +20,7 @@ See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentatio
 #include "bgc_struct.h"
 #include "pointbgc_struct.h"
 #include "pointbgc_func.h"
+#include "misc_func.h"
 
 
 int read_mgmarray(int simyr, int MGM_flag, file MGM_file, double*** mgmarray)
@@ -33,12 +34,18 @@ int read_mgmarray(int simyr, int MGM_flag, file MGM_file, double*** mgmarray)
 	int arraySizeX=N_MGMDAYS;
 	int arraySizeY=simyr;
 
-	/* allocate space for the MGM array */
-	(*mgmarray) = (double**) malloc(arraySizeX*sizeof(double*));  
+	/* allocate space for the MGM array: the rows are in one block */
+	(*mgmarray) = (double**) mem_alloc(MEM_MGM, arraySizeX*sizeof(double*));  
+	if ((*mgmarray)) (*mgmarray)[0] = (double*) mem_alloc(MEM_MGM, arraySizeX*arraySizeY*sizeof(double));  
+	if (!(*mgmarray) || !(*mgmarray)[0])
+	{
+		printf("Error allocating for management array (read_mgmarray.c)\n");
+		return 1;
+	}
  
-	for (nmd = 0; nmd < arraySizeX; nmd++)  
+	for (nmd = 1; nmd < arraySizeX; nmd++)  
 	{
-		(*mgmarray)[nmd] = (double*) malloc(arraySizeY*sizeof(double));  
+		(*mgmarray)[nmd] = (*mgmarray)[0] + nmd*arraySizeY;  
 
 	}
 
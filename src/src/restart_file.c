@@ -0,0 +1,709 @@
+/*
+restart_file.c
+reading and writing the restart (endpoint) file in a portable, versioned format
+
+Layout (all integers and values little-endian, values as IEEE-754 doubles):
+	magic "MUSORST1" (8 bytes), format version (uint32), number of fields (uint32)
+	field table: for each field name length (uint8), name, type (uint8: 'd' double,
+	'i' int32), number of elements (uint32)
+	data: the elements of the fields in the order of the field table
+	checksum: FNV-1a of everything above (uint32)
+The fields are matched by name, so a file written by an older or newer model version
+can be read as long as the common fields agree in type and size: fields missing from
+the file are set to zero, unknown fields of the file are skipped (both reported).
+If the field table of the file is the same as the actual one (the normal case) and the
+machine is little-endian, the data are copied field by field without conversion.
+Files in the old format (a raw image of restart_data_struct) are still accepted.
+A restart name "<archive>#<site key>" in the init file refers to the record of one
+site in a restart archive (see below).
+
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+Biome-BGCMuSo v4.0.2
+Copyright 2016, D. Hidy [dori.hidy@gmail.com]
+Hungarian Academy of Sciences, Hungary
+See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentation, model executable and example input files.
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "ini.h"
+#include "bgc_struct.h"
+#include "pointbgc_struct.h"
+#include "pointbgc_func.h"
+#include "bgc_constants.h"
+#include "misc_func.h"
+
+#define RESTART_MAGIC "MUSORST1"
+#define RESTART_VERSION 1
+
+typedef struct
+{
+	const char* name;
+	size_t offset;         /* offset in restart_data_struct */
+	char type;             /* 'd': double, 'i': int */
+	int n;                 /* number of elements */
+} restart_field;
+
+#define RST_D(f)    { #f, offsetof(restart_data_struct, f), 'd', 1 }
+#define RST_I(f)    { #f, offsetof(restart_data_struct, f), 'i', 1 }
+#define RST_A(f, n) { #f, offsetof(restart_data_struct, f), 'd', n }
+
+/* the fields of restart_data_struct: a new field of the structure has to be added
+here too (restart_file_write checks that the table covers the structure) */
+static const restart_field restart_table[] =
+{
+	RST_A(soilw, N_SOILLAYERS),
+	RST_D(snoww),
+	RST_D(canopyw),
+	RST_D(leafc),
+	RST_D(leafc_storage),
+	RST_D(leafc_transfer),
+	RST_D(frootc),
+	RST_D(frootc_storage),
+	RST_D(frootc_transfer),
+	RST_D(livestemc),
+	RST_D(livestemc_storage),
+	RST_D(livestemc_transfer),
+	RST_D(deadstemc),
+	RST_D(deadstemc_storage),
+	RST_D(deadstemc_transfer),
+	RST_D(livecrootc),
+	RST_D(livecrootc_storage),
+	RST_D(livecrootc_transfer),
+	RST_D(deadcrootc),
+	RST_D(deadcrootc_storage),
+	RST_D(deadcrootc_transfer),
+	RST_D(gresp_storage),
+	RST_D(gresp_transfer),
+	RST_D(cwdc),
+	RST_D(litr1c),
+	RST_D(litr2c),
+	RST_D(litr3c),
+	RST_D(litr4c),
+	RST_D(litr1c_STDB),
+	RST_D(litr2c_STDB),
+	RST_D(litr3c_STDB),
+	RST_D(litr4c_STDB),
+	RST_D(litr1c_strg_HRV),
+	RST_D(litr2c_strg_HRV),
+	RST_D(litr3c_strg_HRV),
+	RST_D(litr4c_strg_HRV),
+	RST_D(litr1c_strg_MOW),
+	RST_D(litr2c_strg_MOW),
+	RST_D(litr3c_strg_MOW),
+	RST_D(litr4c_strg_MOW),
+	RST_D(litr1c_strg_THN),
+	RST_D(litr2c_strg_THN),
+	RST_D(litr3c_strg_THN),
+	RST_D(litr4c_strg_THN),
+	RST_D(litr_aboveground),
+	RST_D(litr_belowground),
+	RST_D(soil1c),
+	RST_D(soil2c),
+	RST_D(soil3c),
+	RST_D(soil4c),
+	RST_D(cpool),
+	RST_D(leafn),
+	RST_D(leafn_storage),
+	RST_D(leafn_transfer),
+	RST_D(frootn),
+	RST_D(frootn_storage),
+	RST_D(frootn_transfer),
+	RST_D(livestemn),
+	RST_D(livestemn_storage),
+	RST_D(livestemn_transfer),
+	RST_D(deadstemn),
+	RST_D(deadstemn_storage),
+	RST_D(deadstemn_transfer),
+	RST_D(livecrootn),
+	RST_D(livecrootn_storage),
+	RST_D(livecrootn_transfer),
+	RST_D(deadcrootn),
+	RST_D(deadcrootn_storage),
+	RST_D(deadcrootn_transfer),
+	RST_D(cwdn),
+	RST_D(litr1n),
+	RST_D(litr2n),
+	RST_D(litr3n),
+	RST_D(litr4n),
+	RST_D(litr1n_STDB),
+	RST_D(litr2n_STDB),
+	RST_D(litr3n_STDB),
+	RST_D(litr4n_STDB),
+	RST_D(litr1n_strg_HRV),
+	RST_D(litr2n_strg_HRV),
+	RST_D(litr3n_strg_HRV),
+	RST_D(litr4n_strg_HRV),
+	RST_D(litr1n_strg_MOW),
+	RST_D(litr2n_strg_MOW),
+	RST_D(litr3n_strg_MOW),
+	RST_D(litr4n_strg_MOW),
+	RST_D(litr1n_strg_THN),
+	RST_D(litr2n_strg_THN),
+	RST_D(litr3n_strg_THN),
+	RST_D(litr4n_strg_THN),
+	RST_D(CTDBc),
+	RST_D(soil1n),
+	RST_D(soil2n),
+	RST_D(soil3n),
+	RST_D(soil4n),
+	RST_D(retransn),
+	RST_D(npool),
+	RST_D(day_leafc_litfall_increment),
+	RST_D(day_frootc_litfall_increment),
+	RST_D(day_livestemc_turnover_increment),
+	RST_D(day_livecrootc_turnover_increment),
+	RST_D(annmax_leafc),
+	RST_D(annmax_frootc),
+	RST_D(annmax_livestemc),
+	RST_D(annmax_livecrootc),
+	RST_D(dsr),
+	RST_I(metyr),
+	RST_A(sminn, N_SOILLAYERS),
+	RST_D(fruitc),
+	RST_D(fruitc_storage),
+	RST_D(fruitc_transfer),
+	RST_D(fruitn),
+	RST_D(fruitn_storage),
+	RST_D(fruitn_transfer),
+	RST_D(day_fruitc_litfall_increment),
+	RST_D(annmax_fruitc),
+	RST_D(softstemc),
+	RST_D(softstemc_storage),
+	RST_D(softstemc_transfer),
+	RST_D(softstemn),
+	RST_D(softstemn_storage),
+	RST_D(softstemn_transfer),
+	RST_D(day_softstemc_litfall_increment),
+	RST_D(annmax_softstemc)
+};
+
+#define N_RESTART_FIELD (int)(sizeof(restart_table) / sizeof(restart_field))
+
+/* little-endian encoding independent of the byte order of the machine */
+static int little_endian(void)
+{
+	unsigned int one = 1;
+	return *(unsigned char*) &one == 1;
+}
+
+static void put_u32(unsigned char* p, unsigned int v)
+{
+	p[0] = v & 0xff; p[1] = (v >> 8) & 0xff; p[2] = (v >> 16) & 0xff; p[3] = (v >> 24) & 0xff;
+}
+
+static unsigned int get_u32(const unsigned char* p)
+{
+	return p[0] | (p[1] << 8) | ((unsigned int) p[2] << 16) | ((unsigned int) p[3] << 24);
+}
+
+/* copy n elements of a field between the file (little-endian) and memory */
+static void copy_field(unsigned char* dst, const unsigned char* src, char type, int n, int le)
+{
+	int size = (type == 'd') ? 8 : 4;
+	int i, b;
+
+	if (le)
+	{
+		memcpy(dst, src, n * size);
+	}
+	else
+	{
+		for (i = 0; i < n; i++)
+			for (b = 0; b < size; b++) dst[i*size + b] = src[i*size + size - 1 - b];
+	}
+}
+
+static int field_size(const restart_field* f)
+{
+	return f->n * (f->type == 'd' ? 8 : 4);
+}
+
+/* the table has to cover the structure: between the fields (in offset order)
+and at the end only alignment padding is allowed */
+static int table_check(void)
+{
+	int ok = 1;
+	int i, next;
+	size_t end = 0;
+	size_t start;
+
+	for (start = 0; ok && start < sizeof(restart_data_struct); start = restart_table[next].offset + field_size(&restart_table[next]))
+	{
+		next = -1;
+		for (i = 0; i < N_RESTART_FIELD; i++)
+			if (restart_table[i].offset >= start && (next < 0 || restart_table[i].offset < restart_table[next].offset)) next = i;
+		if (next < 0) break;
+		if (restart_table[next].offset - start >= sizeof(double)) ok=0;
+		end = restart_table[next].offset + field_size(&restart_table[next]);
+	}
+	if (sizeof(restart_data_struct) - end >= sizeof(double)) ok=0;
+
+	return ok;
+}
+
+/* one restart record in the portable format (malloc'd, size in nbytes) */
+static unsigned char* restart_encode(const restart_data_struct* restart, long* nbytes)
+{
+	int i, len;
+	long n;
+	unsigned char* buf;
+
+	/* every byte of the structure (apart from padding) has to be in the table */
+	if (sizeof(int) != 4 || !table_check())
+	{
+		printf("Error: restart field table does not match restart_data_struct, restart_encode()\n");
+		return NULL;
+	}
+
+	n = 16;
+	for (i = 0; i < N_RESTART_FIELD; i++) n += 2 + strlen(restart_table[i].name) + 4 + field_size(&restart_table[i]);
+	buf = (unsigned char*) mem_alloc(MEM_RESTART, n + 4);
+	if (!buf)
+	{
+		printf("Error allocating restart buffer, restart_encode()\n");
+		return NULL;
+	}
+
+	memcpy(buf, RESTART_MAGIC, 8);
+	put_u32(buf + 8, RESTART_VERSION);
+	put_u32(buf + 12, N_RESTART_FIELD);
+	n = 16;
+	for (i = 0; i < N_RESTART_FIELD; i++)
+	{
+		len = strlen(restart_table[i].name);
+		buf[n++] = (unsigned char) len;
+		memcpy(buf + n, restart_table[i].name, len);
+		n += len;
+		buf[n++] = (unsigned char) restart_table[i].type;
+		put_u32(buf + n, restart_table[i].n);
+		n += 4;
+	}
+	for (i = 0; i < N_RESTART_FIELD; i++)
+	{
+		copy_field(buf + n, (const unsigned char*) restart + restart_table[i].offset, restart_table[i].type, restart_table[i].n, little_endian());
+		n += field_size(&restart_table[i]);
+	}
+	put_u32(buf + n, checksum_fnv1a(buf, n, FNV1A_INIT));
+
+	*nbytes = n + 4;
+	return buf;
+}
+
+/* one restart record from memory: source is the name used in the messages */
+static int restart_decode(const unsigned char* buf, long size, const char* source, restart_data_struct* restart)
+{
+	int ok = 1;
+	int i, f, len, nfield, type, count, found;
+	long n, data;
+	int le = little_endian();
+	char name[256];
+	int* match = NULL;       /* table row of the fields of the file (-1: unknown) */
+	long* fbytes = NULL;     /* data size of the fields of the file */
+
+	/* old format: raw image of the structure */
+	if (size < 20 || memcmp(buf, RESTART_MAGIC, 8))
+	{
+		if (size == (long) sizeof(restart_data_struct))
+		{
+			printf("INFORMATION: restart file %s is in the old (raw) format\n", source);
+			memcpy(restart, buf, sizeof(restart_data_struct));
+		}
+		else
+		{
+			printf("Error: %s is not a restart file, restart_decode()\n", source);
+			ok=0;
+		}
+		return (!ok);
+	}
+
+	/* header and checksum */
+	if (get_u32(buf + size - 4) != checksum_fnv1a(buf, size - 4, FNV1A_INIT))
+	{
+		printf("Error: restart file %s is corrupted (checksum mismatch)\n", source);
+		ok=0;
+	}
+	if (ok && get_u32(buf + 8) > RESTART_VERSION)
+	{
+		printf("Error: restart file %s has format version %u, this model reads up to %d\n", source, get_u32(buf + 8), RESTART_VERSION);
+		ok=0;
+	}
+	nfield = ok ? (int) get_u32(buf + 12) : 0;
+	match = (int*) mem_alloc(MEM_RESTART, (nfield + 1) * sizeof(int));
+	fbytes = (long*) mem_alloc(MEM_RESTART, (nfield + 1) * sizeof(long));
+	if (ok && (!match || !fbytes))
+	{
+		printf("Error allocating restart field table, restart_decode()\n");
+		ok=0;
+	}
+
+	memset(restart, 0, sizeof(restart_data_struct));
+
+	/* field table */
+	n = 16;
+	data = 0;
+	for (f = 0; ok && f < nfield; f++)
+	{
+		if (n + 1 > size - 4 || n + 1 + buf[n] + 5 > size - 4)
+		{
+			printf("Error: truncated field table in restart file %s\n", source);
+			ok=0;
+			break;
+		}
+		len = buf[n++];
+		memcpy(name, buf + n, len);
+		name[len] = '\0';
+		n += len;
+		type = buf[n++];
+		count = get_u32(buf + n);
+		n += 4;
+
+		/* same position as in the actual table: no search needed */
+		if (f < N_RESTART_FIELD && !strcmp(restart_table[f].name, name)) i = f;
+		else for (i = 0; i < N_RESTART_FIELD && strcmp(restart_table[i].name, name); i++);
+
+		if (i == N_RESTART_FIELD)
+		{
+			printf("INFORMATION: restart field %s is not used by this model version\n", name);
+			i = -1;
+		}
+		else if (restart_table[i].type != type || restart_table[i].n != count)
+		{
+			printf("Error: restart field %s has a different type or size in %s\n", name, source);
+			ok=0;
+		}
+		match[f] = i;
+		fbytes[f] = (long) count * (type == 'd' ? 8 : 4);
+		data += fbytes[f];
+	}
+	if (ok && n + data != size - 4)
+	{
+		printf("Error: restart file %s has a wrong size\n", source);
+		ok=0;
+	}
+
+	/* data */
+	for (f = 0; ok && f < nfield; f++)
+	{
+		if (match[f] >= 0)
+		{
+			const restart_field* r = &restart_table[match[f]];
+			copy_field((unsigned char*) restart + r->offset, buf + n, r->type, r->n, le);
+		}
+		n += fbytes[f];
+	}
+
+	/* fields of the actual model that are missing from the file */
+	for (i = 0; ok && i < N_RESTART_FIELD; i++)
+	{
+		for (found = 0, f = 0; !found && f < nfield; f++) found = (match[f] == i);
+		if (!found) printf("INFORMATION: restart field %s is missing from %s, set to 0\n", restart_table[i].name, source);
+	}
+
+	mem_free(match);
+	mem_free(fbytes);
+	return (!ok);
+}
+
+static int restart_file_write(file restart_file, const restart_data_struct* restart)
+{
+	int ok = 1;
+	long n;
+	unsigned char* buf = restart_encode(restart, &n);
+
+	if (!buf) return 1;
+	if (fwrite(buf, 1, n, restart_file.ptr) != (size_t) n)
+	{
+		printf("Error writing restart file %s, restart_file_write()\n", restart_file.name);
+		ok=0;
+	}
+
+	mem_free(buf);
+	return (!ok);
+}
+
+static int restart_file_read(file restart_file, restart_data_struct* restart)
+{
+	int ok = 1;
+	long size;
+	unsigned char* buf = NULL;
+
+	/* the whole file */
+	if (fseek(restart_file.ptr, 0, SEEK_END) || (size = ftell(restart_file.ptr)) < 0 || fseek(restart_file.ptr, 0, SEEK_SET))
+	{
+		printf("Error reading restart file %s, restart_file_read()\n", restart_file.name);
+		return 1;
+	}
+	buf = (unsigned char*) mem_alloc(MEM_RESTART, size + 1);
+	if (!buf || fread(buf, 1, size, restart_file.ptr) != (size_t) size)
+	{
+		printf("Error reading restart file %s, restart_file_read()\n", restart_file.name);
+		ok=0;
+	}
+
+	if (ok && restart_decode(buf, size, restart_file.name, restart)) ok=0;
+
+	mem_free(buf);
+	return (!ok);
+}
+
+/* ---------------------------------------------------------------------------
+restart archive: the restart records of many sites in one file, so that a
+regional run does not need one restart file per cell.
+Layout: header (magic "MUSORSA1", version, number of index slots, number of
+records: uint32 each, padded to ARCHIVE_HEADER bytes), index (hash table with
+open addressing, ARCHIVE_ENTRY bytes per slot: site key, offset (uint64) and
+size (uint32) of the record), records (restart records as above) appended at
+the end of the file. A producer locks the file (fcntl) only for appending its
+record and filling its index slot, so many runs can write the same archive
+concurrently; a reader maps the file and finds the record of a site through
+the index without reading anything else. Writing an existing key again appends
+a new record and redirects the index entry to it.
+--------------------------------------------------------------------------- */
+
+#define ARCHIVE_MAGIC "MUSORSA1"
+#define ARCHIVE_VERSION 1
+#define ARCHIVE_HEADER 32
+#define ARCHIVE_ENTRY (RESTART_KEYLEN + 16)
+#define ARCHIVE_SLOTS 131072
+
+static void put_u64(unsigned char* p, unsigned long long v)
+{
+	put_u32(p, (unsigned int) (v & 0xffffffffu));
+	put_u32(p + 4, (unsigned int) (v >> 32));
+}
+
+static unsigned long long get_u64(const unsigned char* p)
+{
+	return get_u32(p) | ((unsigned long long) get_u32(p + 4) << 32);
+}
+
+#ifndef _WIN32
+
+/* first index slot of a key (linear probing from here) */
+static unsigned int archive_hash(const char* key, unsigned int nslot)
+{
+	return checksum_fnv1a(key, strlen(key), FNV1A_INIT) % nslot;
+}
+
+static int archive_write(const char* name, const char* key, const restart_data_struct* data)
+{
+	int ok = 1;
+	int fd;
+	unsigned int nslot = 0;
+	unsigned int count = 0;
+	unsigned int slot, probe;
+	long n = 0;
+	off_t end;
+	struct stat st;
+	struct flock lock;
+	unsigned char header[ARCHIVE_HEADER];
+	unsigned char entry[ARCHIVE_ENTRY];
+	unsigned char* record;
+
+	record = restart_encode(data, &n);
+	if (!record) return 1;
+
+	fd = open(name, O_RDWR | O_CREAT, 0644);
+	if (fd < 0)
+	{
+		printf("Error opening restart archive %s, archive_write()\n", name);
+		mem_free(record);
+		return 1;
+	}
+
+	/* exclusive lock of the whole file while the record and its index entry are written */
+	memset(&lock, 0, sizeof(lock));
+	lock.l_type = F_WRLCK;
+	lock.l_whence = SEEK_SET;
+	if (fcntl(fd, F_SETLKW, &lock) || fstat(fd, &st))
+	{
+		printf("Error locking restart archive %s, archive_write()\n", name);
+		ok=0;
+	}
+
+	/* new archive: header and empty index */
+	if (ok && st.st_size == 0)
+	{
+		memset(header, 0, ARCHIVE_HEADER);
+		memcpy(header, ARCHIVE_MAGIC, 8);
+		put_u32(header + 8, ARCHIVE_VERSION);
+		put_u32(header + 12, ARCHIVE_SLOTS);
+		put_u32(header + 16, 0);
+		if (pwrite(fd, header, ARCHIVE_HEADER, 0) != ARCHIVE_HEADER ||
+			ftruncate(fd, ARCHIVE_HEADER + (off_t) ARCHIVE_SLOTS * ARCHIVE_ENTRY))
+		{
+			printf("Error creating restart archive %s, archive_write()\n", name);
+			ok=0;
+		}
+	}
+
+	if (ok && (pread(fd, header, ARCHIVE_HEADER, 0) != ARCHIVE_HEADER || memcmp(header, ARCHIVE_MAGIC, 8) ||
+		get_u32(header + 8) != ARCHIVE_VERSION))
+	{
+		printf("Error: %s is not a version %d restart archive\n", name, ARCHIVE_VERSION);
+		ok=0;
+	}
+	if (ok)
+	{
+		nslot = get_u32(header + 12);
+		count = get_u32(header + 16);
+	}
+
+	/* index slot of the key: its own entry or the first free one */
+	slot = ok ? archive_hash(key, nslot) : 0;
+	for (probe = 0; ok && probe < nslot; probe++, slot = (slot + 1) % nslot)
+	{
+		if (pread(fd, entry, ARCHIVE_ENTRY, ARCHIVE_HEADER + (off_t) slot * ARCHIVE_ENTRY) != ARCHIVE_ENTRY)
+		{
+			printf("Error reading index of restart archive %s\n", name);
+			ok=0;
+		}
+		else if (entry[0] == 0 || !strncmp((char*) entry, key, RESTART_KEYLEN)) break;
+	}
+	if (ok && probe == nslot)
+	{
+		printf("Error: restart archive %s is full (%u sites)\n", name, nslot);
+		ok=0;
+	}
+
+	/* append the record, then point the index entry to it */
+	if (ok)
+	{
+		if (entry[0] == 0) count++;
+		end = lseek(fd, 0, SEEK_END);
+		memset(entry, 0, ARCHIVE_ENTRY);
+		strncpy((char*) entry, key, RESTART_KEYLEN - 1);
+		put_u64(entry + RESTART_KEYLEN, (unsigned long long) end);
+		put_u32(entry + RESTART_KEYLEN + 8, (unsigned int) n);
+		put_u32(header + 16, count);
+		if (end < 0 || pwrite(fd, record, n, end) != n ||
+			pwrite(fd, entry, ARCHIVE_ENTRY, ARCHIVE_HEADER + (off_t) slot * ARCHIVE_ENTRY) != ARCHIVE_ENTRY ||
+			pwrite(fd, header, ARCHIVE_HEADER, 0) != ARCHIVE_HEADER)
+		{
+			printf("Error writing restart archive %s, archive_write()\n", name);
+			ok=0;
+		}
+	}
+
+	/* closing the file releases the lock */
+	close(fd);
+	mem_free(record);
+	return (!ok);
+}
+
+static int archive_read(const char* name, const char* key, restart_data_struct* data)
+{
+	int ok = 1;
+	int fd;
+	unsigned int nslot, slot, probe;
+	unsigned long long offset = 0;
+	unsigned int size = 0;
+	struct stat st;
+	unsigned char* map = NULL;
+	const unsigned char* entry = NULL;
+	char source[sizeof(((file*) 0)->name) + RESTART_KEYLEN + 1];
+
+	fd = open(name, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st))
+	{
+		printf("Error opening restart archive %s, archive_read()\n", name);
+		ok=0;
+	}
+	if (ok && st.st_size < ARCHIVE_HEADER)
+	{
+		printf("Error: %s is not a restart archive\n", name);
+		ok=0;
+	}
+	if (ok)
+	{
+		map = (unsigned char*) mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		if (map == MAP_FAILED)
+		{
+			printf("Error mapping restart archive %s, archive_read()\n", name);
+			map = NULL;
+			ok=0;
+		}
+	}
+	if (fd >= 0) close(fd);
+
+	if (ok && (memcmp(map, ARCHIVE_MAGIC, 8) || get_u32(map + 8) != ARCHIVE_VERSION ||
+		ARCHIVE_HEADER + (off_t) get_u32(map + 12) * ARCHIVE_ENTRY > st.st_size))
+	{
+		printf("Error: %s is not a version %d restart archive\n", name, ARCHIVE_VERSION);
+		ok=0;
+	}
+
+	/* index lookup */
+	if (ok)
+	{
+		nslot = get_u32(map + 12);
+		slot = archive_hash(key, nslot);
+		for (probe = 0; probe < nslot; probe++, slot = (slot + 1) % nslot)
+		{
+			entry = map + ARCHIVE_HEADER + (size_t) slot * ARCHIVE_ENTRY;
+			if (entry[0] == 0 || !strncmp((const char*) entry, key, RESTART_KEYLEN)) break;
+		}
+		if (probe == nslot || entry[0] == 0)
+		{
+			printf("Error: site %s is not in restart archive %s\n", key, name);
+			ok=0;
+		}
+	}
+	if (ok)
+	{
+		offset = get_u64(entry + RESTART_KEYLEN);
+		size = get_u32(entry + RESTART_KEYLEN + 8);
+		if (offset + size > (unsigned long long) st.st_size)
+		{
+			printf("Error: record of site %s is outside of restart archive %s\n", key, name);
+			ok=0;
+		}
+	}
+
+	if (ok)
+	{
+		sprintf(source, "%s#%s", name, key);
+		if (restart_decode(map + offset, size, source, data)) ok=0;
+	}
+
+	if (map) munmap(map, st.st_size);
+	return (!ok);
+}
+
+#else
+
+static int archive_write(const char* name, const char* key, const restart_data_struct* data)
+{
+	printf("Error: restart archives (%s#%s) are not supported on this platform\n", name, key);
+	return 1;
+}
+
+static int archive_read(const char* name, const char* key, restart_data_struct* data)
+{
+	printf("Error: restart archives (%s#%s) are not supported on this platform\n", name, key);
+	return 1;
+}
+
+#endif
+
+int restart_load(const restart_ctrl_struct* restart, restart_data_struct* data)
+{
+	if (restart->in_key[0]) return archive_read(restart->in_restart.name, restart->in_key, data);
+	else                    return restart_file_read(restart->in_restart, data);
+}
+
+int restart_save(const restart_ctrl_struct* restart, const restart_data_struct* data)
+{
+	if (restart->out_key[0]) return archive_write(restart->out_restart.name, restart->out_key, data);
+	else                     return restart_file_write(restart->out_restart, data);
+}
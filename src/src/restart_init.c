@@ -21,12 +21,30 @@ Missoula, MT 59812
 #include "pointbgc_struct.h"
 #include "pointbgc_func.h"
 
+/* splits "<archive>#<site key>" into the archive name and the key */
+static int restart_key(char* name, char* key)
+{
+	char* hash = strchr(name, '#');
+
+	key[0] = '\0';
+	if (hash)
+	{
+		if (strlen(hash + 1) == 0 || strlen(hash + 1) >= RESTART_KEYLEN)
+		{
+			printf("Error: site key of restart archive %s is empty or longer than %d characters\n", name, RESTART_KEYLEN - 1);
+			return 1;
+		}
+		strcpy(key, hash + 1);
+		*hash = '\0';
+	}
+	return 0;
+}
+
 int restart_init(file init, restart_ctrl_struct* restart)
 {
 	int ok = 1;
 	char key1[] = "RESTART";
 	char keyword[80];
-	char junk[80];
 
 	/********************************************************************
 	**                                                                 **
@@ -65,39 +83,44 @@ int restart_init(file init, restart_ctrl_struct* restart)
 		printf("Error reading keep_metyr flag\n");
 		ok=0;
 	}
-	/* if using an input restart file, open it, otherwise
-	discard the next line of the ini file */
-	if (ok && restart->read_restart)
+	/* restart filenames (the files are opened by restart_open) */
+	if (ok && scan_value(init, restart->in_restart.name, 's'))
 	{
-    	if (scan_open(init,&(restart->in_restart),'r')) 
-		{
-			printf("Error opening input restart file\n");
-			ok=0;
-		}
+		printf("Error scanning input restart filename\n");
+		ok=0;
 	}
-	else
+	if (ok && scan_value(init, restart->out_restart.name, 's'))
 	{
-		if (scan_value(init, junk, 's'))
-		{
-			printf("Error scanning input restart filename\n");
-			ok=0;
-		}
+		printf("Error scanning output restart filename\n");
+		ok=0;
 	}
-	/* if using an output restart file, open it, otherwise
-	discard the next line of the ini file */
-	if (ok && restart->write_restart)
+	
+	/* "<archive>#<site key>": record of one site in a restart archive */
+	if (ok && restart_key(restart->in_restart.name, restart->in_key)) ok=0;
+	if (ok && restart_key(restart->out_restart.name, restart->out_key)) ok=0;
+	
+	return (!ok);
+}
+
+int restart_open(restart_ctrl_struct* restart)
+{
+	/* opens the input and output restart files if they are used
+	(restart archives are opened by restart_load and restart_save) */
+	int ok = 1;
+
+	if (ok && restart->read_restart && !restart->in_key[0])
 	{
-    	if (scan_open(init,&(restart->out_restart),'w')) 
+		if (file_open(&(restart->in_restart),'r')) 
 		{
-			printf("Error opening output restart file\n");
+			printf("Error opening input restart file\n");
 			ok=0;
 		}
 	}
-	else
+	if (ok && restart->write_restart && !restart->out_key[0])
 	{
-		if (scan_value(init, junk, 's'))
+		if (file_open(&(restart->out_restart),'w')) 
 		{
-			printf("Error scanning output restart filename\n");
+			printf("Error opening output restart file\n");
 			ok=0;
 		}
 	}
@@ -60,6 +60,9 @@ int richards(const siteconst_struct* sitec, const epconst_struct* epc, epvar_str
 	{
 		soilw_act[layer] = ws->soilw[layer];
 		vwc_act[layer]   = epv->vwc[layer];
+		/* the bottom layer is not calculated: 0 instead of an undefined value */
+		hydr_conduct[layer] = 0;
+		hydr_diffus[layer]  = 0;
 	}
 	
 	/* ********************************/
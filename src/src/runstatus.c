@@ -0,0 +1,241 @@
+/*
+runstatus.c
+progress and throughput of a run for the monitoring of many runs: with
+--status <file> a small JSON object is written into the file at the end of a
+simulated year if RUNSTATUS_INTERVAL seconds passed since the last update, at
+the change of the phase (spinup, transient, normal) or of the number of the
+scenario children running and at the end of the run. The file is written
+under a temporary name and renamed, a reader never sees a partial file.
+Contents: the phase and the state of the run (running, done, failed), the
+simulated years of the phase and their number (the maximal number of spinup
+years in the spinup), the simulated days of the run and the simulated days per
+second, the estimated remaining time of the phase, the trend of the soil
+carbon in the last spinup cycle with the tolerance of the steady state, the
+bytes written into the output files and the number of scenario children
+running. The time of the last update ("updated", Unix time) shows a stuck run.
+A scenario child writes its own file (_<scenario> inserted before the
+extension).
+
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+Biome-BGCMuSo v4.0.2
+Copyright 2016, D. Hidy [dori.hidy@gmail.com]
+Hungarian Academy of Sciences, Hungary
+See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentation, model executable and example input files.
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#ifndef _WIN32
+#include <unistd.h>
+#define STATUS_PID() ((int) getpid())
+#else
+#define STATUS_PID() 0
+#endif
+#include "ini.h"
+#include "bgc_struct.h"
+#include "bgc_func.h"
+#include "bgc_constants.h"
+#include "pointbgc_struct.h"
+#include "bgc_io.h"
+
+#define RUNSTATUS_INTERVAL 1.0    /* minimal time between two updates (s) */
+
+int runstatus_on = 0;
+
+static char status_name[128];
+static char status_site[128];
+static char status_scenario[64];
+static const char* status_phase = "init";
+static double status_start;          /* start of the run (s) */
+static double status_phase_start;    /* start of the phase (s) */
+static double status_last;           /* last update (s) */
+static int status_years_total;
+static int status_years_done;
+static long status_sim_days;
+static double status_trend;
+static int status_steady1, status_steady2, status_have_trend;
+static long status_output_bytes;
+static int status_children;
+
+static double status_seconds(void)
+{
+#ifdef _WIN32
+	return (double) clock() / CLOCKS_PER_SEC;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec + 1e-9 * (double) ts.tv_nsec;
+#endif
+}
+
+static int status_write(const char* state);
+
+/* a run ending with exit() before runstatus_close failed */
+static void status_atexit(void)
+{
+	if (runstatus_on) status_write("failed");
+}
+
+static int status_write(const char* state)
+{
+	char tmpname[140];
+	double now, elapsed, phase_elapsed, rate, eta;
+	FILE* f;
+
+	now = status_seconds();
+	status_last = now;
+	elapsed = now - status_start;
+	phase_elapsed = now - status_phase_start;
+
+	/* remaining time of the phase from the years per second of the phase */
+	eta = -1.0;
+	if (status_years_done > 0 && phase_elapsed > 0.0 && status_years_total >= status_years_done)
+	{
+		rate = (double) status_years_done / phase_elapsed;
+		eta = (double) (status_years_total - status_years_done) / rate;
+	}
+
+	sprintf(tmpname, "%s.tmp", status_name);
+	f = fopen(tmpname, "w");
+	if (!f) return 1;
+
+	fprintf(f, "{\n");
+	fprintf(f, "  \"pid\": %d,\n", STATUS_PID());
+	fprintf(f, "  \"site\": \"%s\",\n", status_site);
+	fprintf(f, "  \"scenario\": \"%s\",\n", status_scenario);
+	fprintf(f, "  \"state\": \"%s\",\n", state);
+	fprintf(f, "  \"phase\": \"%s\",\n", status_phase);
+	fprintf(f, "  \"updated\": %ld,\n", (long) time(NULL));
+	fprintf(f, "  \"elapsed_s\": %.3f,\n", elapsed);
+	fprintf(f, "  \"years_done\": %d,\n", status_years_done);
+	fprintf(f, "  \"years_total\": %d,\n", status_years_total);
+	fprintf(f, "  \"sim_days\": %ld,\n", status_sim_days);
+	fprintf(f, "  \"days_per_s\": %.1f,\n", elapsed > 0.0 ? (double) status_sim_days / elapsed : 0.0);
+	fprintf(f, "  \"eta_s\": %.1f,\n", eta);
+	if (status_have_trend)
+		fprintf(f, "  \"spinup_trend\": %.6f,\n", status_trend);
+	else
+		fprintf(f, "  \"spinup_trend\": null,\n");
+	fprintf(f, "  \"spinup_tolerance\": %.6f,\n", SPINUP_TOLERANCE);
+	fprintf(f, "  \"spinup_steady\": [%d, %d],\n", status_steady1, status_steady2);
+	fprintf(f, "  \"output_bytes\": %ld,\n", status_output_bytes);
+	fprintf(f, "  \"scenarios_running\": %d\n", status_children);
+	fprintf(f, "}\n");
+
+	if (fclose(f)) return 1;
+#ifdef _WIN32
+	remove(status_name);
+#endif
+	return rename(tmpname, status_name) != 0;
+}
+
+int runstatus_open(const char* name, const char* site)
+{
+	const char* p;
+	int i;
+
+	if (strlen(name) > 127 - 4)
+	{
+		printf("Error: status file name %s is too long\n", name);
+		return 1;
+	}
+	strcpy(status_name, name);
+
+	/* site: the init file name without the directory (quotes and backslashes left out) */
+	p = strrchr(site, '/');
+	if (!p) p = strrchr(site, '\\');
+	p = p ? p + 1 : site;
+	for (i = 0; *p && i < (int) sizeof(status_site) - 1; p++)
+	{
+		if (*p != '"' && *p != '\\') status_site[i++] = *p;
+	}
+	status_site[i] = '\0';
+	status_scenario[0] = '\0';
+
+	status_start = status_seconds();
+	status_phase_start = status_start;
+	runstatus_on = 1;
+	atexit(status_atexit);
+
+	if (status_write("running"))
+	{
+		printf("Error writing status file %s\n", name);
+		runstatus_on = 0;
+		return 1;
+	}
+	return 0;
+}
+
+/* a scenario child (scenario_branch) writes its own status file */
+void runstatus_fork(const char* scenario)
+{
+	if (scenario_filename(status_name, scenario) || strlen(status_name) > 127 - 4)
+	{
+		runstatus_on = 0;
+		return;
+	}
+	strncpy(status_scenario, scenario, sizeof(status_scenario) - 1);
+	status_scenario[sizeof(status_scenario) - 1] = '\0';
+	status_children = 0;
+	status_write("running");
+}
+
+/* start of a phase: spinup (years_total: maximal number of spinup years), transient, normal */
+void runstatus_phase(const char* phase, int years_total)
+{
+	status_phase = phase;
+	status_years_total = years_total;
+	status_years_done = 0;
+	status_phase_start = status_seconds();
+	status_write("running");
+}
+
+/* end of a simulated year */
+void runstatus_year(int years_done, const control_struct* ctrl, const bgcout_struct* bgcout)
+{
+	long bytes = 0;
+
+	status_years_done = years_done;
+	status_sim_days += NDAY_OF_YEAR;
+
+	/* bytes written into the output files (buffered data included) */
+	if (ctrl->dodaily) bytes += ftell(bgcout->dayout.ptr);
+	if (ctrl->domonavg) bytes += ftell(bgcout->monavgout.ptr);
+	if (ctrl->doannavg) bytes += ftell(bgcout->annavgout.ptr);
+	if (ctrl->doannual) bytes += ftell(bgcout->annout.ptr);
+	bytes += ftell(bgcout->anntext.ptr);
+	status_output_bytes = bytes;
+
+	if (status_seconds() - status_last >= RUNSTATUS_INTERVAL) status_write("running");
+}
+
+/* trend of the soil carbon at the end of a spinup cycle (kgC/m2/yr) */
+void runstatus_spinup(double trend, int steady1, int steady2)
+{
+	status_trend = trend;
+	status_steady1 = steady1;
+	status_steady2 = steady2;
+	status_have_trend = 1;
+}
+
+/* number of scenario children running */
+void runstatus_children(int n)
+{
+	status_children = n;
+	status_write("running");
+}
+
+int runstatus_close(int ok)
+{
+	int err;
+
+	if (!runstatus_on) return 0;
+	err = status_write(ok ? "done" : "failed");
+	runstatus_on = 0;
+	if (err) printf("Error writing status file %s\n", status_name);
+
+	return err;
+}
@@ -0,0 +1,312 @@
+/*
+scenario.c
+scenario branching of a normal run: the simulation is run once up to the
+branch year, then the process is forked and every scenario continues from
+the shared state in its own child process (the memory is shared copy-on-write,
+the years before the branch are not simulated again). The parent process
+continues the base run.
+A scenario is "<name>=<file>", the file has the format of the parameter
+override files (one <key>=<value> per line), the keys scc.s_tmax, scc.s_tmin,
+scc.s_prcp, scc.s_vpd and scc.s_swavgfd are scalar climate changes applied to
+the meteorological data of the scenario (with the meaning of the CLIMATE
+CHANGE block of the init file), the other keys are parameter overrides.
+The output files of a scenario are named after the output files of the run
+with _<name> inserted before the extension, they contain the output of the
+years before the branch year too.
+
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+Biome-BGCMuSo v4.0.2
+Copyright 2016, D. Hidy [dori.hidy@gmail.com]
+Hungarian Academy of Sciences, Hungary
+See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentation, model executable and example input files.
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+#include "ini.h"
+#include "bgc_struct.h"
+#include "pointbgc_struct.h"
+#include "pointbgc_func.h"
+#include "bgc_func.h"
+#include "bgc_constants.h"
+#include "bgc_io.h"
+
+/* process ids of the scenario children (parent process only) */
+#ifndef _WIN32
+static pid_t scenario_pid[MAX_SCENARIOS];
+#endif
+static int scenario_nchild = 0;
+
+int scenario_parse(const char* arg, scenario_struct* scenario)
+{
+	/* <name>=<file>, the name is used in the output file names */
+	const char* eq;
+	const char* p;
+	size_t len;
+
+	eq = strchr(arg, '=');
+	if (!eq || eq == arg)
+	{
+		printf("Error: scenario %s is not in <name>=<file> form\n", arg);
+		return 1;
+	}
+	len = (size_t)(eq - arg);
+	if (len >= sizeof(scenario->name) || strlen(eq+1) >= sizeof(scenario->file) || !eq[1])
+	{
+		printf("Error: scenario name or file name is too long or empty in %s\n", arg);
+		return 1;
+	}
+	for (p = arg; p < eq; p++)
+	{
+		if (!((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z') || (*p >= '0' && *p <= '9') || *p == '_' || *p == '-'))
+		{
+			printf("Error: scenario name may contain only letters, digits, _ and - (%s)\n", arg);
+			return 1;
+		}
+	}
+	memcpy(scenario->name, arg, len);
+	scenario->name[len] = '\0';
+	strcpy(scenario->file, eq+1);
+
+	return 0;
+}
+
+int scenario_apply(const scenario_struct* scenario, epconst_struct* epc, siteconst_struct* sitec,
+				   metarr_struct* metarr, int ndays)
+{
+	/* metarr=NULL: only the overrides are applied (checking the file before the run) */
+	int ok = 1;
+	int i;
+	char line[200];
+	char* p;
+	char* end;
+	double value;
+	climchange_struct scc;
+	FILE* f;
+
+	scc.s_tmax = 0.0;
+	scc.s_tmin = 0.0;
+	scc.s_prcp = 1.0;
+	scc.s_vpd = 1.0;
+	scc.s_swavgfd = 1.0;
+
+	f = fopen(scenario->file, "r");
+	if (!f)
+	{
+		printf("Error opening scenario file %s\n", scenario->file);
+		return 1;
+	}
+
+	while (ok && fgets(line, sizeof(line), f))
+	{
+		for (p = line; *p == ' ' || *p == '\t'; p++);
+		if (*p == '\0' || *p == '\n' || *p == '\r' || *p == '#' || *p == ';') continue;
+		if (strncmp(p, "scc.", 4))
+		{
+			if (param_override(p, epc, sitec))
+			{
+				printf("Error in scenario file %s\n", scenario->file);
+				ok=0;
+			}
+			continue;
+		}
+
+		/* scalar climate change */
+		end = strchr(p, '=');
+		if (end) value = strtod(end+1, &end);
+		if (!end || (*end && *end != '\n' && *end != '\r' && *end != ' ' && *end != '\t'))
+		{
+			printf("Error in scenario file %s: invalid value in %s", scenario->file, p);
+			ok=0;
+		}
+		else if (!strncmp(p, "scc.s_tmax", 10) && (p[10] == '=' || p[10] == ' ')) scc.s_tmax = value;
+		else if (!strncmp(p, "scc.s_tmin", 10) && (p[10] == '=' || p[10] == ' ')) scc.s_tmin = value;
+		else if (!strncmp(p, "scc.s_prcp", 10) && (p[10] == '=' || p[10] == ' ')) scc.s_prcp = value;
+		else if (!strncmp(p, "scc.s_vpd", 9) && (p[9] == '=' || p[9] == ' ')) scc.s_vpd = value;
+		else if (!strncmp(p, "scc.s_swavgfd", 13) && (p[13] == '=' || p[13] == ' ')) scc.s_swavgfd = value;
+		else
+		{
+			printf("Error in scenario file %s: unknown climate change key in %s", scenario->file, p);
+			ok=0;
+		}
+	}
+	fclose(f);
+
+	/* the whole met array is changed: the cyclic met data of the years after
+	the branch can come from any met year; the running averages of the
+	temperature are not changed, as in metarr_init */
+	if (ok && metarr)
+	{
+		for (i = 0; i < ndays; i++)
+		{
+			metarr->tmax[i] += scc.s_tmax;
+			metarr->tmin[i] += scc.s_tmin;
+			metarr->prcp[i] *= scc.s_prcp;
+			metarr->vpd[i] *= scc.s_vpd;
+			metarr->swavgfd[i] *= scc.s_swavgfd;
+			metarr->par[i] *= scc.s_swavgfd;
+		}
+	}
+
+	return (!ok);
+}
+
+int scenario_filename(char* name, const char* suffix)
+{
+	/* insert _<suffix> before the extension of the file name (name has 128 characters) */
+	char tail[128];
+	char* dot;
+	char* slash;
+
+	dot = strrchr(name, '.');
+	slash = strrchr(name, '/');
+	if (!slash) slash = strrchr(name, '\\');
+	if (!dot || (slash && dot < slash)) dot = name + strlen(name);
+
+	if (strlen(name) + strlen(suffix) + 2 > 128)
+	{
+		printf("Error: scenario file name of %s is too long\n", name);
+		return 1;
+	}
+	strcpy(tail, dot);
+	sprintf(dot, "_%s%s", suffix, tail);
+
+	return 0;
+}
+
+/* a scenario child continues writing an output file of the parent in a new
+file: the output written before the branch is copied into it */
+static int scenario_file(file* target, long prefix, const char* suffix)
+{
+	int ok = 1;
+	char buf[65536];
+	long left;
+	size_t n;
+	FILE* src;
+
+	fclose(target->ptr);
+	target->ptr = NULL;
+
+	src = fopen(target->name, "rb");
+	if (!src)
+	{
+		printf("Error reopening %s for scenario %s\n", target->name, suffix);
+		return 1;
+	}
+	if (scenario_filename(target->name, suffix) || file_open(target, 'w'))
+	{
+		fclose(src);
+		return 1;
+	}
+
+	for (left = prefix; ok && left > 0; left -= (long)n)
+	{
+		n = fread(buf, 1, left < (long)sizeof(buf) ? (size_t)left : sizeof(buf), src);
+		if (n == 0 || fwrite(buf, 1, n, target->ptr) != n)
+		{
+			printf("Error copying the output of %s into the scenario file\n", target->name);
+			ok=0;
+		}
+	}
+	fclose(src);
+
+	return (!ok);
+}
+
+int scenario_branch(const control_struct* ctrl, bgcout_struct* bgcout)
+{
+#ifdef _WIN32
+	printf("Error: scenario branching needs fork(), it is not available in this build\n");
+	return 1;
+#else
+	int ok = 1;
+	int k, i, n;
+	pid_t pid;
+	file* files[7];
+	long offset[7];
+	const char* suffix;
+
+	/* the open output files, the children continue them in new files */
+	n = 0;
+	if (ctrl->dodaily) files[n++] = &bgcout->dayout;
+	if (ctrl->domonavg) files[n++] = &bgcout->monavgout;
+	if (ctrl->doannavg) files[n++] = &bgcout->annavgout;
+	if (ctrl->doannual) files[n++] = &bgcout->annout;
+	files[n++] = &bgcout->anntext;
+	files[n++] = &bgcout->log_file;
+	if (ctrl->onscreen) files[n++] = &bgcout->control_file;
+
+	/* the buffers are flushed, so that the output is not written twice by
+	the children, and the files contain the whole prefix */
+	fflush(NULL);
+	for (k = 0; k < n; k++) offset[k] = ftell(files[k]->ptr);
+
+	for (k = 1; ok && k <= ctrl->nscenario; k++)
+	{
+		fflush(stdout);
+		pid = fork();
+		if (pid < 0)
+		{
+			printf("Error in fork() for scenario %s\n", ctrl->scenarios[k-1].name);
+			ok=0;
+		}
+		else if (pid == 0)
+		{
+			/* child: the scenario k */
+			scenario_nchild = 0;
+			bgcout->scenario = k;
+			/* the routines are recorded only by the base run */
+			kernelrec_on = 0;
+			suffix = ctrl->scenarios[k-1].name;
+			/* the child continues the timeline as a process of its own */
+			if (trace_on) trace_fork(suffix);
+			if (runstatus_on) runstatus_fork(suffix);
+			for (i = 0; i < n; i++)
+			{
+				if (scenario_file(files[i], offset[i], suffix))
+				{
+					printf("Error in scenario_file() from scenario_branch()\n");
+					return 1;
+				}
+			}
+			return 0;
+		}
+		else
+		{
+			scenario_pid[scenario_nchild++] = pid;
+			if (runstatus_on) runstatus_children(scenario_nchild);
+			if (ctrl->onscreen) printf("INFORMATION: scenario %s started (process %d)\n", ctrl->scenarios[k-1].name, (int)pid);
+		}
+	}
+
+	return (!ok);
+#endif
+}
+
+int scenario_wait(void)
+{
+	/* number of scenario children which failed */
+	int nfail = 0;
+#ifndef _WIN32
+	int k, status;
+
+	for (k = 0; k < scenario_nchild; k++)
+	{
+		if (waitpid(scenario_pid[k], &status, 0) != scenario_pid[k] || !WIFEXITED(status) || WEXITSTATUS(status))
+		{
+			printf("Error: scenario process %d failed\n", (int)scenario_pid[k]);
+			nfail++;
+		}
+	}
+	scenario_nchild = 0;
+	if (runstatus_on) runstatus_children(0);
+#endif
+	return nfail;
+}
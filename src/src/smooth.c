@@ -39,7 +39,7 @@ int run_avg(const double *input, double *output, int n, int w, int w_flag)
 
     if (ok)
     {
-		wt = (int*) malloc(w * sizeof(int));
+		wt = (int*) mem_alloc(MEM_MET, w * sizeof(int));
 		if (!wt)
 		{
     		printf("Allocation error in boxcar_smooth... Exiting\n");
@@ -80,7 +80,7 @@ int run_avg(const double *input, double *output, int n, int w, int w_flag)
             
         } /* end for i=nelements */
         
-        free(wt);
+        mem_free(wt);
     }
     return (!ok);
 }
@@ -115,7 +115,7 @@ int boxcar_smooth(double* input, double* output, int n, int w, int w_flag)
 	
 	 if (ok)
     {
-		wt = (int*) malloc(w * sizeof(int));
+		wt = (int*) mem_alloc(MEM_MET, w * sizeof(int));
 		if (!wt)
 		{
     		printf("Allocation error in boxcar_smooth... Exiting\n");
@@ -172,7 +172,7 @@ int boxcar_smooth(double* input, double* output, int n, int w, int w_flag)
 	        
 	    } /* end for i=nelements */
 	    
-		free(wt);
+		mem_free(wt);
 		
 	} /* end if ok */
 	
@@ -31,6 +31,7 @@ See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentatio
 #include "bgc_func.h"
 #include "bgc_io.h"
 #include "pointbgc_func.h" 
+#include "misc_func.h"
 /* #define DEBUG  set this to see function roll-call on-screen */
 /* #define DEBUG_SPINUP set this to see the spinup details on-screen */
 
@@ -73,6 +74,8 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 
 	/* photosynthesis structures */
 	psn_struct         psn_sun, psn_shade;
+	psn_struct*        psn_canopy[2];
+	activity_struct    act;
 	
 	/* temporary nitrogen variables for decomposition and allocation */
 	ntemp_struct       nt;
@@ -123,6 +126,10 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 	double tally2  = 0;
 	double tally2b = 0;
 	double naddfrac;
+
+	/* convergence between the block tests, early stop */
+	spinconv_struct spinconv;
+	int early_stop = 0;
 	
 	/* copy the input structures into local structures */
 	ws = bgcin->ws;
@@ -268,7 +275,7 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 	/* allocate memory for local output arrays */
 	if (ok && dayout) 
 	{
-		dayarr = (float*) malloc(ctrl.ndayout * sizeof(float));
+		dayarr = (float*) mem_alloc(MEM_OUTPUT, ctrl.ndayout * sizeof(float));
 		if (!dayarr)
 		{
 			printf("Error allocating for local daily output array in bgc()\n");
@@ -277,7 +284,7 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 	}
 	if (ok && ctrl.domonavg) 
 	{
-		monavgarr = (float*) malloc(ctrl.ndayout * sizeof(float));
+		monavgarr = (float*) mem_alloc(MEM_OUTPUT, ctrl.ndayout * sizeof(float));
 		if (!monavgarr)
 		{
 			printf("Error allocating for monthly average output array in bgc()\n");
@@ -286,7 +293,7 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 	}
 	if (ok && ctrl.doannavg) 
 	{
-		annavgarr = (float*) malloc(ctrl.ndayout * sizeof(float));
+		annavgarr = (float*) mem_alloc(MEM_OUTPUT, ctrl.ndayout * sizeof(float));
 		if (!annavgarr)
 		{
 			printf("Error allocating for annual average output array in bgc()\n");
@@ -295,7 +302,7 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 	}
 	if (ok && ctrl.doannual)
 	{
-		annarr = (float*) malloc(ctrl.nannout * sizeof(float));
+		annarr = (float*) mem_alloc(MEM_OUTPUT, ctrl.nannout * sizeof(float));
 		if (!annarr)
 		{
 			printf("Error allocating for local annual output array in bgc()\n");
@@ -305,7 +312,7 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 	/* allocate space for the output map pointers */
 	if (ok) 
 	{
-		output_map = (double**) malloc(NMAP * sizeof(double*));
+		output_map = (double**) mem_alloc(MEM_OUTPUT, NMAP * sizeof(double*));
 		if (!output_map)
 		{
 			printf("Error allocating for output map in output_map_init()\n");
@@ -373,9 +380,9 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 	/* Hidy 2009. - calculate GSI to deterime onday and offday 	*/
 	if (ctrl.GSI_flag)
 	{
-		if (ok && GSI_calculation(&metarr, &ctrl, &sitec, &epc, &GSI, &phenarr))
+		if (ok && GSI_calculation_cached(&metarr, &ctrl, &sitec, &epc, &GSI, &phenarr))
 		{
-			printf("Error in call to GSI_calculation(), from bgc()\n");
+			printf("Error in call to GSI_calculation_cached(), from bgc()\n");
 			ok=0;
 		}
 	}
@@ -404,11 +411,13 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 	/********************************************************************************************************* */
 
 	/* determine phenological signals */		
-	if (ok && prephenology(bgcout->log_file, &ctrl, &epc, &sitec, &metarr, &phenarr))
+	TRACE_BEGIN("prephenology");
+	if (ok && prephenology_cached(bgcout->log_file, &ctrl, &epc, &sitec, &metarr, &phenarr))
 	{
-		printf("Error in call to prephenology(), from bgc()\n");
+		printf("Error in call to prephenology_cached(), from bgc()\n");
 		ok=0;
 	}
+	TRACE_END("prephenology");
 	
 
 #ifdef DEBUG
@@ -426,6 +435,13 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 	}
 	tair_annavg /= (double)nmetdays;
 
+	/* soil temperature of the layers before the first call of multilayer_tsoil (the layers
+	are averaged by multilayer_hydrolparams on the first simulation day) */
+	for (i=0 ; i<N_SOILLAYERS ; i++)
+	{
+		metv.tsoil[i] = sitec.tair_annavg;
+	}
+
 
 	/* if this simulation is using a restart file for its initial
 	conditions, then copy restart info into structures */
@@ -498,19 +514,24 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 	steady1 = 0;
 	steady2 = 0;
 	rising = 1;
+	spinconv_init(&spinconv, &ctrl, bgcout->log_file);
 
 
 				
 	
 
 
+	if (runstatus_on) runstatus_phase("spinup", ctrl.maxspinyears);
+
 	/* do loop for spinup */
 	do
 	{	
+		TRACE_BEGIN("spinup cycle");
 
 		/* annual model loop, one cycle of metyears at a time */
-		for (simyr=0 ; ok && simyr<nblock ; simyr++)
+		for (simyr=0 ; ok && !early_stop && simyr<nblock ; simyr++)
 		{
+			TRACE_BEGIN_YEAR("spinup year", spinyears);
 
 			/* set current month to 0 (january) at the beginning of each year */
 			curmonth = 0;
@@ -554,11 +575,13 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 
 			/* atmospheric concentration of CO2 (ppm) */
 			metv.co2 = co2.co2ppm;
+			conduct_factors(&metv);
 	
 	
 			/* begin the daily model loop */
 			for (yday=0 ; ok && yday<NDAY_OF_YEAR ; yday++)
 			{
+				PROF_BEGIN(PT_DAY);
 #ifdef DEBUG
 				printf("year %d\tyday %d\n",simyr,yday);
 #endif
@@ -596,11 +619,13 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 			printf("%d\t%d\tdone multilayer_hydrolparams\n",simyr,yday);
 #endif
 				/* daily meteorological variables from metarrays */
+				PROF_BEGIN(PT_DAYMET);
 				if (ok && daymet(&ctrl, &metarr, &sitec, &epc, &PLT, &HRV,&ws, &epv, &metv, &tair_annavg, metday))
 				{
 					printf("Error in daymet() from bgc()\n");
 					ok=0;
 				}
+				PROF_END(PT_DAYMET);
 
 #ifdef DEBUG
 				printf("%d\t%d\tdone daymet\n",simyr,yday);
@@ -609,11 +634,15 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 		
 
 			/* soil temperature calculations */
+				PROF_BEGIN(PT_TSOIL);
+				if (kernelrec_on) kernelrec_in(KR_TSOIL, 6, KR_ARG(yday), KR_ARG(epc), KR_ARG(sitec), KR_ARG(ws), KR_ARG(metv), KR_ARG(epv));
 				if (ok && multilayer_tsoil(yday, &epc, &sitec, &ws, &metv, &epv))
 				{
 					printf("Error in multilayer_tsoil() from bgc()\n");
 					ok=0;
 				}
+				if (kernelrec_on) kernelrec_out(KR_TSOIL);
+				PROF_END(PT_TSOIL);
 
 #ifdef DEBUG
 			printf("%d\t%d\tdone multilayer_tsoil\n",simyr,yday);
@@ -631,16 +660,25 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 				printf("%d\t%d\tdone dayphen\n",simyr,yday);
 #endif
 
+				/* activity mask of the day: processes without work are skipped */
+				if (ok && activity_mask(&metv, &phen, &cs, &ns, &ws, GSI.snowcover_limit, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &act))
+				{
+					printf("Error in activity_mask() from bgc()\n");
+					ok=0;
+				}
+
 				/* test for the annual allocation day */
 				if (phen.remdays_litfall == 1) annual_alloc = 1;
 				else annual_alloc = 0;
 
 				/* phenology fluxes */
+				PROF_BEGIN(PT_PHENOLOGY);
 				if (ok && phenology(&ctrl, &epc, &phen, &epv, &cs, &cf, &ns, &nf))
 				{
 					printf("Error in phenology() from bgc()\n");
 					ok=0;
 				}
+				PROF_END(PT_PHENOLOGY);
 
 #ifdef DEBUG
 				printf("%d\t%d\tdone phenology\n",simyr,yday);
@@ -651,11 +689,13 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 				/* !!!!!!!!!!!!!!!!!!!!!!!!!!!!!! Hidy 2011 - MULTILAYER SOIL !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! */
 				/* rooting depth */
 
+ 				 PROF_BEGIN(PT_ROOTDEPTH);
  				 if (ok && multilayer_rootdepth(&ctrl, &epc, &sitec, &phen, &PLT, &HRV, &epv, &ns))
 				 {
 					printf("Error in multilayer_rootdepth() from bgc()\n");
 					ok=0;
 				 }
+ 				 PROF_END(PT_ROOTDEPTH);
 
 #ifdef DEBUG
 			printf("%d\t%d\tdone multilayer_rootdepth\n",simyr,yday);
@@ -666,11 +706,13 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 				/* calculate leaf area index, sun and shade fractions, and specific
 				leaf area for sun and shade canopy fractions, then calculate
 				canopy radiation interception and transmission */
+				PROF_BEGIN(PT_RADTRANS);
 				if (ok && radtrans(&cs, &epc, &metv, &epv, sitec.sw_alb))
 				{
 					printf("Error in radtrans() from bgc()\n");
 					ok=0;
 				}
+				PROF_END(PT_RADTRANS);
 
 				/* update the ann max LAI for annual diagnostic output */
 				if (epv.proj_lai > epv.ytd_maxplai) epv.ytd_maxplai = epv.proj_lai;
@@ -691,7 +733,7 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 #endif
 
 				/* snowmelt (when there is a snowpack) */
-				if (ok && ws.snoww && snowmelt(&metv, &wf, ws.snoww))
+				if (ok && act.snowmelt && snowmelt(&metv, &wf, ws.snoww))
 				{
 					printf("Error in snowmelt() from bgc()\n");
 					ok=0;
@@ -714,22 +756,26 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 #endif
 
 				/* conductance - Hidy 2011 */
+				PROF_BEGIN(PT_CONDUCT);
 				if (ok && conduct_calc(&ctrl, &metv, &epc, &sitec, &epv, simyr))
 				{
 					printf("Error in conduct_calc() from bgc()\n");
 					ok=0;
 				}
+				PROF_END(PT_CONDUCT);
 			
 #ifdef DEBUG
 			printf("%d\t%d\tdone conduct_calc\n",simyr,yday);
 #endif
 			
 				/* daily maintenance respiration */
+				PROF_BEGIN(PT_MAINT_RESP);
 				if (ok && maint_resp(&cs, &ns, &epc, &metv, &cf, &epv))
 				{
 					printf("Error in m_resp() from bgc()\n");
 					ok=0;
 				}
+				PROF_END(PT_MAINT_RESP);
 
 #ifdef DEBUG
 				printf("%d\t%d\tdone maint resp\n",simyr,yday);
@@ -741,15 +787,19 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 				/* do canopy ET calculations whenever there is leaf area
 				displayed, since there may be intercepted water on the 
 				canopy that needs to be dealt with */
-				if (ok && cs.leafc && metv.dayl)
+				if (ok && act.canopy)
 				{
 
 					/* evapo-transpiration */
+					PROF_BEGIN(PT_CANOPY_ET);
+					if (kernelrec_on) kernelrec_in(KR_CANOPY_ET, 4, KR_ARG(epc), KR_ARG(metv), KR_ARG(epv), KR_ARG(wf));
 					if (ok && canopy_et(&epc, &metv, &epv, &wf))
 					{
 						printf("Error in canopy_et() from bgc()\n");
 						ok=0;
 					}
+					if (kernelrec_on) kernelrec_out(KR_CANOPY_ET);
+					PROF_END(PT_CANOPY_ET);
 
 #ifdef DEBUG
 					printf("%d\t%d\tdone canopy_et\n",simyr,yday);
@@ -762,70 +812,52 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 				growth season, as defined by the remdays_curgrowth flag.  This
 				keeps the occurrence of new growth consistent with the treatment
 				of litterfall and allocation */
-				if (ok && cs.leafc && phen.remdays_curgrowth && metv.dayl && ws.snoww <= GSI.snowcover_limit)
+				if (ok && act.psn)
 				{
-					/* SUNLIT canopy fraction photosynthesis */
+					/* SUNLIT and SHADED canopy fraction photosynthesis */
 					/* set the input variables */
-					psn_sun.c3 = epc.c3_flag;
-					psn_sun.co2 = metv.co2;
-					psn_sun.pa = metv.pa;
-					psn_sun.t = metv.tday;
+					psn_sun.c3 = psn_shade.c3 = epc.c3_flag;
+					psn_sun.co2 = psn_shade.co2 = metv.co2;
+					psn_sun.pa = psn_shade.pa = metv.pa;
+					psn_sun.t = psn_shade.t = metv.tday;
 					psn_sun.lnc = 1.0 / (epv.sun_proj_sla * epc.leaf_cn);
-					psn_sun.flnr = epc.flnr;
-                                        psn_sun.flnp = epc.flnp;
-					psn_sun.ppfd = metv.ppfd_per_plaisun;
-					/* convert conductance from m/s --> umol/m2/s/Pa, and correct
-					for CO2 vs. water vapor */
-					psn_sun.g = epv.gl_t_wv_sun * 1e6/(1.6*R*(metv.tday+273.15));
-					psn_sun.dlmr = epv.dlmr_area_sun;
-					
-					if (ok && photosynthesis(&epc, &metv, &psn_sun))
-					{
-						printf("Error in photosynthesis() from bgc()\n");
-						ok=0;
-					}
-
-#ifdef DEBUG
-					printf("%d\t%d\tdone sun psn\n",simyr,yday);
-#endif
-
-					epv.assim_sun = psn_sun.A;
-
-					/* for the final flux assignment, the assimilation output
-					needs to have the maintenance respiration rate added, this
-					sum multiplied by the projected leaf area in the relevant canopy
-					fraction, and this total converted from umol/m2/s -> kgC/m2/d */
-					cf.psnsun_to_cpool = (epv.assim_sun + epv.dlmr_area_sun) * epv.plaisun * metv.dayl * 12.011e-9; 
-						
-
-					/* SHADED canopy fraction photosynthesis */
-					psn_shade.c3 = epc.c3_flag;
-					psn_shade.co2 = metv.co2;
-					psn_shade.pa = metv.pa;
-					psn_shade.t = metv.tday;
 					psn_shade.lnc = 1.0 / (epv.shade_proj_sla * epc.leaf_cn);
-					psn_shade.flnr = epc.flnr;
+					psn_sun.flnr = psn_shade.flnr = epc.flnr;
+					psn_sun.flnp = psn_shade.flnp = epc.flnp;
+					psn_sun.ppfd = metv.ppfd_per_plaisun;
 					psn_shade.ppfd = metv.ppfd_per_plaishade;
 					/* convert conductance from m/s --> umol/m2/s/Pa, and correct
 					for CO2 vs. water vapor */
+					psn_sun.g = epv.gl_t_wv_sun * 1e6/(1.6*R*(metv.tday+273.15));
 					psn_shade.g = epv.gl_t_wv_shade * 1e6/(1.6*R*(metv.tday+273.15));
+					psn_sun.dlmr = epv.dlmr_area_sun;
 					psn_shade.dlmr = epv.dlmr_area_shade;
-					if (ok && photosynthesis(&epc, &metv, &psn_shade))
+
+					/* the two canopy fractions share the temperature dependent terms: solved in one batch */
+					psn_canopy[0] = &psn_sun;
+					psn_canopy[1] = &psn_shade;
+					PROF_BEGIN(PT_PHOTOSYNTHESIS);
+					if (kernelrec_on) kernelrec_in(KR_PHOTOSYNTHESIS, 4, KR_ARG(epc), KR_ARG(metv), KR_ARG(psn_sun), KR_ARG(psn_shade));
+					if (ok && photosynthesis_n(&epc, &metv, psn_canopy, 2))
 					{
-						printf("Error in photosynthesis() from bgc()\n");
+						printf("Error in photosynthesis_n() from bgc()\n");
 						ok=0;
 					}
+					if (kernelrec_on) kernelrec_out(KR_PHOTOSYNTHESIS);
+					PROF_END(PT_PHOTOSYNTHESIS);
 
 #ifdef DEBUG
-					printf("%d\t%d\tdone shade_psn\n",simyr,yday);
+					printf("%d\t%d\tdone sun and shade psn\n",simyr,yday);
 #endif
 
+					epv.assim_sun = psn_sun.A;
 					epv.assim_shade = psn_shade.A;
 
 					/* for the final flux assignment, the assimilation output
 					needs to have the maintenance respiration rate added, this
 					sum multiplied by the projected leaf area in the relevant canopy
 					fraction, and this total converted from umol/m2/s -> kgC/m2/d */
+					cf.psnsun_to_cpool = (epv.assim_sun + epv.dlmr_area_sun) * epv.plaisun * metv.dayl * 12.011e-9; 
 					cf.psnshade_to_cpool = (epv.assim_shade + epv.dlmr_area_shade) * epv.plaishade * metv.dayl * 12.011e-9; 
 						
 
@@ -857,11 +889,13 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 			
 			/* !!!!!!!!!!!!!!!!!!!!!!  TRANSPIRATION AND SOILPSI IN MULTILAYER SOIL!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! */		        
 			/* Hidy 2010 - calculate the part-transpiration from total transpiration */
+			PROF_BEGIN(PT_TRANSPIRATION);
 			if (ok && multilayer_transpiration(&ctrl, &sitec, &epv, &ws, &wf))
 			{
 				printf("Error in multilayer_transpiration() from bgc()\n");
 				ok=0;
 			}
+			PROF_END(PT_TRANSPIRATION);
 #ifdef DEBUG
 			printf("%d\t%d\tdone multilayer_transpiration\n",simyr,yday);
 #endif		
@@ -875,11 +909,15 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 	
 
 			/* daily litter and soil decomp and nitrogen fluxes */
+			PROF_BEGIN(PT_DECOMP);
+			if (kernelrec_on) kernelrec_in(KR_DECOMP, 9, KR_ARG(metv), KR_ARG(epc), KR_ARG(epv), KR_ARG(sitec), KR_ARG(cs), KR_ARG(cf), KR_ARG(ns), KR_ARG(nf), KR_ARG(nt));
 			if (ok && decomp(&metv,&epc,&epv,&sitec,&cs,&cf,&ns,&nf,&nt))
 			{
 				printf("Error in decomp() from bgc.c\n");
 				ok=0;
 			}
+			if (kernelrec_on) kernelrec_out(KR_DECOMP);
+			PROF_END(PT_DECOMP);
 
 #ifdef DEBUG
 			printf("%d\t%d\tdone decomp\n",simyr,yday);
@@ -905,11 +943,13 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 			}
 			else
 			{
+				PROF_BEGIN(PT_DAILY_ALLOCATION);
 				if (ok && daily_allocation(&epc,&sitec,&cf,&cs,&nf,&ns,&epv,&nt))
 				{
 					printf("Error in daily_allocation() from bgc.c\n");
 					ok=0;
 				}
+				PROF_END(PT_DAILY_ALLOCATION);
 			}
 
 
@@ -948,11 +988,13 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 	
 			/* !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!  MULTILAYER SOIL !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! */	
 			/* Hidy 2013 - multilayer soil hydrology: percolation calculation based on PRCP, RUNOFF, EVAP, TRANS */
+     		PROF_BEGIN(PT_HYDROLPROCESS);
      		if (ok && multilayer_hydrolprocess(&ctrl, &sitec, &epc, &epv, &ws, &wf))
 			{ 
 				printf("Error in multilayer_hydrolprocess() from bgc()\n");
 				ok=0;
 			}
+     		PROF_END(PT_HYDROLPROCESS);
 
 #ifdef DEBUG
 		printf("%d\t%d\tdone multilayer_hydrolprocess\n",simyr,yday);
@@ -971,37 +1013,17 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 #endif	
 
 			/* !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! */
-			/* daily update of the water state variables */
-			if (ok && daily_water_state_update(&wf, &ws))
-			{
-				printf("Error in daily_water_state_update() from bgc()\n");
-				ok=0;
-			}
-
-#ifdef DEBUG
-			printf("%d\t%d\tdone water state update\n",simyr,yday);
-#endif
-
-			/* daily update of carbon state variables */
-			if (ok && daily_carbon_state_update(&cf, &cs, annual_alloc, epc.woody, epc.evergreen))
+			/* daily update of the water, carbon and nitrogen state variables */
+			PROF_BEGIN(PT_STATE_UPDATE);
+			if (ok && daily_state_update(&epc, &wf, &ws, &cf, &cs, &nf, &ns, annual_alloc, epc.woody, epc.evergreen))
 			{
-				printf("Error in daily_carbon_state_update() from bgc()\n");
+				printf("Error in daily_state_update() from bgc()\n");
 				ok=0;
 			}
-
-#ifdef DEBUG
-			printf("%d\t%d\tdone carbon state update\n",simyr,yday);
-#endif
-	
-			/* daily update of nitrogen state variables */
-			if (ok && daily_nitrogen_state_update(&epc, &nf, &ns, annual_alloc, epc.woody, epc.evergreen))
-			{
-				printf("Error in daily_nitrogen_state_update() from bgc()\n");
-				ok=0;
-			}
-
+			PROF_END(PT_STATE_UPDATE);
+			
 #ifdef DEBUG
-			printf("%d\t%d\tdone nitrogen state update\n",simyr,yday);
+			printf("%d\t%d\tdone state update\n",simyr,yday);
 #endif
 
 
@@ -1009,11 +1031,13 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 			/* this is done last, with a special state update procedure, to
 			insure that pools don't go negative due to mortality fluxes
 			conflicting with other proportional fluxes */
+			PROF_BEGIN(PT_MORTALITY);
 			if (ok && mortality(&ctrl, &epc, &cs, &cf, &ns, &nf, simyr))
 			{
 				printf("Error in mortality() from bgc()\n");
 				ok=0;
 			}
+			PROF_END(PT_MORTALITY);
 
 #ifdef DEBUG
 			printf("%d\t%d\tdone mortality\n",simyr,yday);
@@ -1037,11 +1061,13 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 			/* Hidy 2011 - calculate the change of soil mineralized N in multilayer soil.  
 			This is a special state variable update routine, done after the other fluxes and states are reconciled 
 			in order to avoid negative sminn (nleaching is included) */
+			PROF_BEGIN(PT_SMINN);
 			if (ok && multilayer_sminn(&epc, &sitec, &epv, &ns, &nf, &ws, &wf))
 			{
 				printf("Error in multilayer_sminn() from bgc()\n");
 				ok=0;
 			}
+			PROF_END(PT_SMINN);
 
 #ifdef DEBUG
 			printf("%d\t%d\tdone multilayer_sminn\n",simyr,yday);
@@ -1049,55 +1075,19 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 		
 
 			/* Hidy 2013 - test again for very low state variable values and force them
-			to 0.0 to avoid rounding and floating point overflow errors */
-			if (ok && precision_control(&ws, &cs, &ns))
-			{
-				printf("Error in call to precision_control() from bgc()\n");
-				ok=0;
-			} 
-			
-#ifdef DEBUG
-			printf("%d\t%d\tdone precision_control\n",simyr,yday);
-#endif
-
-
-			/* test for water balance */
-			if (ok && check_water_balance(&ws, first_balance))
+				to 0.0 to avoid rounding and floating point overflow errors, then test for
+				water, carbon and nitrogen balance */
+			PROF_BEGIN(PT_BALANCE);
+			if (ok && check_balance(&ws, &cs, &ns, first_balance))
 			{
-				printf("Error in check_water_balance() from bgc()\n");
+				printf("Error in check_balance() from bgc()\n");
 				printf("%d\n",metday);
 				ok=0;
 			}
-
-#ifdef DEBUG
-			printf("%d\t%d\tdone water balance\n",simyr,yday);
-#endif
-
-
-
-			/* test for carbon balance */
-			if (ok && check_carbon_balance(&cs, first_balance))
-			{
-				printf("Error in check_carbon_balance() from bgc()\n");
-				printf("%d\n",metday);
-				ok=0;
-			}
-
-#ifdef DEBUG
-			printf("%d\t%d\tdone carbon balance\n",simyr,yday);
-#endif
+			PROF_END(PT_BALANCE);
 			
-
-			/* test for nitrogen balance -  modified by Hidy 2008 */
-			if (ok && check_nitrogen_balance(&ns, first_balance))
-			{
-				printf("Error in check_nitrogen_balance() from bgc()\n");
-				printf("%d\n",metday);
-				ok=0;
-			}
-
 #ifdef DEBUG
-			printf("%d\t%d\tdone nitrogen balance\n",simyr,yday);
+			printf("%d\t%d\tdone balance\n",simyr,yday);
 #endif
 
 			
@@ -1131,6 +1121,7 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 
 	
 
+				PROF_BEGIN(PT_OUTPUT);
 				/* DAILY OUTPUT HANDLING */
 				/* fill the daily output array if daily output is requested,
 				or if the monthly or annual average of daily output variables
@@ -1161,6 +1152,8 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 
 				}
 			
+				PROF_END(PT_OUTPUT);
+
 				/* MONTHLY AVERAGE OF DAILY OUTPUT VARIABLES */
 				if (ctrl.domonavg)
 				{
@@ -1257,14 +1250,17 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 					tally2 += summary.soilc;
 					tally2b += summary.totalc;
 				}
+				spinconv_day(&spinconv, &summary, &cs);
 
 				/* at the end of first day of simulation, turn off the 
 				first_balance switch */
 				if (first_balance) first_balance = 0;
 
+				PROF_END(PT_DAY);
 			}   /* end of daily model loop */
 
 			/* ANNUAL OUTPUT HANDLING */
+			TRACE_BEGIN("annual output");
 			/* only write annual outputs if requested */
 			if (ok && ctrl.doannual)
 			{
@@ -1286,19 +1282,35 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 				printf("%d\t%d\tdone annual output\n",simyr,yday);
 #endif
 			}
+			TRACE_END("annual output");
 
 		
 			metyr++;
 			
+			TRACE_END_YEAR("spinup year", spinyears);
+
 			/* spinup control */
 			spinyears++;
+			if (runstatus_on) runstatus_year(spinyears, &ctrl, bgcout);
+
+			/* convergence window, the early stop is tested at its end (a met cycle boundary) */
+			early_stop = spinconv_year(&spinconv, &ctrl, !steady1 && rising && metcycle == 0, spinyears, bgcout->log_file);
 			
 		}   /* end of annual model loop */
 		
 		/* spinup control */
 		/* if this is the third pass through metcycle, do comparison */
 		/* first block is during the rising phase */
-		if (!steady1 && metcycle == 2)
+		if (early_stop)
+		{
+			/* converged between the block tests */
+			fprintf(bgcout->log_file.ptr, "early stop of the spinup after %d years\n", spinyears);
+			steady1 = 1;
+			steady2 = 1;
+			metcycle = 0;
+			if (runstatus_on) runstatus_spinup(spinconv.trend[SPC_SOILC], steady1, steady2);
+		}
+		else if (!steady1 && metcycle == 2)
 		{
 			/* convert tally1 and tally2 to average daily soilc */
 			tally1 /= (double)nblock * NDAY_OF_YEAR;
@@ -1306,6 +1318,7 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 			rising = (tally2 > tally1);
 			t1 = (tally2-tally1)/(double)nblock;
 			steady1 = (fabs(t1) < SPINUP_TOLERANCE);
+			if (runstatus_on) runstatus_spinup(t1, steady1, steady2);
 			
 #ifdef DEBUG_SPINUP
 			printf("spinyears = %d rising = %d steady1 = %d\n",spinyears,
@@ -1336,6 +1349,7 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 				steady1 = 0;
 				rising = 1;
 			}
+			if (runstatus_on) runstatus_spinup(t1, steady1, steady2);
 			
 #ifdef DEBUG_SPINUP
 			printf("spinyears = %d rising = %d steady2 = %d\n",spinyears,
@@ -1361,6 +1375,7 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 			metcycle++;
 		}
 
+		TRACE_END("spinup cycle");
 
 	
 	/* end of do block, test for steady state */	
@@ -1391,6 +1406,7 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 	tally1b /= (double)nblock * NDAY_OF_YEAR;
 	tally2b /= (double)nblock * NDAY_OF_YEAR;
 	bgcout->spinup_resid_trend = (tally2b-tally1b)/(double)nblock;
+	if (early_stop) bgcout->spinup_resid_trend = spinconv.trend[SPC_TOTALC];
 	bgcout->spinup_years = spinyears;
 	
 	if (ctrl.onscreen) printf("\n");
@@ -1431,11 +1447,13 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 			printf("Start of transient run.\n");
 		}
 
+		TRACE_BEGIN("transient run");
 		if (transient_bgc(bgcin, bgcout))
 		{
 			printf("Error in call to bgc()\n");
 			exit(1);
 		}
+		TRACE_END("transient run");
 
 		ws = bgcin->ws;
 		cs = bgcin->cs;
@@ -1467,11 +1485,11 @@ int spinup_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 #endif
 	
 	/* free memory for local output arrays */
-	if (dayout) free(dayarr);
-	if (ctrl.domonavg) free(monavgarr);
-	if (ctrl.doannavg) free(annavgarr);
-	if (ctrl.doannual) free(annarr);
-	free(output_map);
+	if (dayout) mem_free(dayarr);
+	if (ctrl.domonavg) mem_free(monavgarr);
+	if (ctrl.doannavg) mem_free(annavgarr);
+	if (ctrl.doannual) mem_free(annarr);
+	mem_free(output_map);
 		
 	/* print timing info if error */
 	if (!ok)
@@ -0,0 +1,176 @@
+/*
+spinup_conv.c
+convergence of the spinup between the block tests of spinup_bgc(): the daily
+C pools (vegetation, litter, the four soil pools, soil and total C) and the
+soil N are averaged over windows of whole met cycles (the smallest multiple of
+metyears not shorter than SPC_MINYEARS years), and the trend of every pool
+(kg/m2/yr) is computed between two successive windows simulated without the
+spinup allocation (supplemental N). A window converged if the trends of the
+soil C and of the total C are below spinup_abstol and, with spinup_reltol > 0,
+the trend of every pool relative to its mean is below spinup_reltol.
+Every window is written into the log file (the convergence curve of the site).
+With spinup_early the spinup stops at the end of the window in which
+spinup_ncycle windows in a row converged, instead of the end of the block.
+The criteria are set with --spinup-stop <key>=<value> (keys: early, abstol,
+reltol, cycles), the defaults (block test only, SPINUP_TOLERANCE, no relative
+criterion, 2 windows) are set in time_init.
+
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+Biome-BGCMuSo v4.0.2
+Copyright 2016, D. Hidy [dori.hidy@gmail.com]
+Hungarian Academy of Sciences, Hungary
+See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentation, model executable and example input files.
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "ini.h"
+#include "bgc_struct.h"
+#include "bgc_constants.h"
+#include "pointbgc_struct.h"
+#include "pointbgc_func.h"
+
+#define SPC_MINYEARS 10     /* minimal length of a convergence window (years) */
+
+static const char* spinconv_poolname[N_SPINPOOLS] =
+{
+	"vegc", "litrc", "soil1c", "soil2c", "soil3c", "soil4c", "soiln", "soilc", "totalc"
+};
+
+void spinconv_defaults(control_struct* ctrl)
+{
+	ctrl->spinup_early = 0;
+	ctrl->spinup_abstol = SPINUP_TOLERANCE;
+	ctrl->spinup_reltol = 0.0;
+	ctrl->spinup_ncycle = 2;
+}
+
+/* one criterion: early=<0|1>, abstol=<kgC/m2/yr>, reltol=<1/yr>, cycles=<n> */
+int spinconv_parse(const char* arg, control_struct* ctrl)
+{
+	int ok = 1;
+	const char* eq;
+	char* end;
+	char key[32];
+	double value;
+
+	eq = strchr(arg, '=');
+	if (!eq || eq == arg || eq - arg >= (int) sizeof(key))
+	{
+		printf("Error: spinup criterion %s is not <key>=<value>\n", arg);
+		return 1;
+	}
+	strncpy(key, arg, eq - arg);
+	key[eq - arg] = '\0';
+	value = strtod(eq + 1, &end);
+	if (end == eq + 1 || *end)
+	{
+		printf("Error: invalid value in spinup criterion %s\n", arg);
+		return 1;
+	}
+
+	if (!strcmp(key, "early") && (value == 0.0 || value == 1.0))
+		ctrl->spinup_early = (int) value;
+	else if (!strcmp(key, "abstol") && value > 0.0)
+		ctrl->spinup_abstol = value;
+	else if (!strcmp(key, "reltol") && value >= 0.0)
+		ctrl->spinup_reltol = value;
+	else if (!strcmp(key, "cycles") && value >= 1.0 && value == floor(value))
+		ctrl->spinup_ncycle = (int) value;
+	else
+	{
+		printf("Error: unknown key or invalid value in spinup criterion %s (keys: early=0|1, abstol>0, reltol>=0, cycles>=1)\n", arg);
+		ok=0;
+	}
+
+	return (!ok);
+}
+
+void spinconv_init(spinconv_struct* conv, const control_struct* ctrl, file logfile)
+{
+	memset(conv, 0, sizeof(spinconv_struct));
+	conv->nwindow = ctrl->metyears * ((SPC_MINYEARS + ctrl->metyears - 1) / ctrl->metyears);
+
+	fprintf(logfile.ptr, "Spinup convergence (window of %d years; means in kgC/m2, trends in kgC/m2/yr)\n", conv->nwindow);
+	if (ctrl->spinup_early)
+	{
+		fprintf(logfile.ptr, "early stop: abstol %g, reltol %g, %d windows in a row\n",
+			ctrl->spinup_abstol, ctrl->spinup_reltol, ctrl->spinup_ncycle);
+	}
+	fprintf(logfile.ptr, "%6s %5s %10s %10s %12s %12s %12s %-7s %4s\n",
+		"year", "Nadd", "soilc", "totalc", "soilc_trend", "totalc_trend", "max_reltrend", "pool", "conv");
+}
+
+void spinconv_day(spinconv_struct* conv, const summary_struct* summary, const cstate_struct* cs)
+{
+	conv->sum[SPC_VEGC]   += summary->vegc;
+	conv->sum[SPC_LITRC]  += summary->litrc;
+	conv->sum[SPC_SOIL1C] += cs->soil1c;
+	conv->sum[SPC_SOIL2C] += cs->soil2c;
+	conv->sum[SPC_SOIL3C] += cs->soil3c;
+	conv->sum[SPC_SOIL4C] += cs->soil4c;
+	conv->sum[SPC_SOILN]  += summary->soiln;
+	conv->sum[SPC_SOILC]  += summary->soilc;
+	conv->sum[SPC_TOTALC] += summary->totalc;
+}
+
+/* end of a spinup year (spinup_alloc: the spinup allocation was used in the year);
+returns 1 if the spinup can stop (early stop policy) */
+int spinconv_year(spinconv_struct* conv, const control_struct* ctrl, int spinup_alloc, int spinyears, file logfile)
+{
+	int p, maxpool, valid, converged;
+	double mean[N_SPINPOOLS];
+	double rel;
+
+	conv->nyear++;
+	if (spinup_alloc) conv->spinup_alloc = 1;
+	if (conv->nyear < conv->nwindow) return 0;
+
+	for (p = 0; p < N_SPINPOOLS; p++)
+	{
+		mean[p] = conv->sum[p] / ((double) conv->nwindow * NDAY_OF_YEAR);
+	}
+	valid = !conv->spinup_alloc;
+
+	if (valid && conv->prev_valid)
+	{
+		conv->maxrel = 0.0;
+		maxpool = 0;
+		for (p = 0; p < N_SPINPOOLS; p++)
+		{
+			conv->trend[p] = (mean[p] - conv->prev[p]) / (double) conv->nwindow;
+			rel = mean[p] != 0.0 ? fabs(conv->trend[p] / mean[p]) : 0.0;
+			if (rel > conv->maxrel)
+			{
+				conv->maxrel = rel;
+				maxpool = p;
+			}
+		}
+		converged = fabs(conv->trend[SPC_SOILC]) < ctrl->spinup_abstol &&
+			fabs(conv->trend[SPC_TOTALC]) < ctrl->spinup_abstol &&
+			(ctrl->spinup_reltol <= 0.0 || conv->maxrel < ctrl->spinup_reltol);
+		conv->nconverged = converged ? conv->nconverged + 1 : 0;
+
+		fprintf(logfile.ptr, "%6d %5d %10.4f %10.4f %12.6f %12.6f %12.3e %-7s %4d\n",
+			spinyears, conv->spinup_alloc, mean[SPC_SOILC], mean[SPC_TOTALC], conv->trend[SPC_SOILC],
+			conv->trend[SPC_TOTALC], conv->maxrel, spinconv_poolname[maxpool], conv->nconverged);
+	}
+	else
+	{
+		/* no trend across the supplemental N addition */
+		conv->nconverged = 0;
+		fprintf(logfile.ptr, "%6d %5d %10.4f %10.4f %12s %12s %12s %-7s %4d\n",
+			spinyears, conv->spinup_alloc, mean[SPC_SOILC], mean[SPC_TOTALC], "-", "-", "-", "-", 0);
+	}
+
+	memcpy(conv->prev, mean, sizeof(mean));
+	conv->prev_valid = valid;
+	memset(conv->sum, 0, sizeof(conv->sum));
+	conv->nyear = 0;
+	conv->spinup_alloc = 0;
+
+	return ctrl->spinup_early && conv->nconverged >= ctrl->spinup_ncycle;
+}
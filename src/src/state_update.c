@@ -2,6 +2,13 @@
 state_update.c
 Resolve the fluxes in bgc() daily loop to update state variables
 
+The water, carbon and nitrogen state variables are updated in one call
+(daily_state_update). The carbon and nitrogen transfers are described by static
+flux-to-pool tables: every row moves one flux from a source pool to a destination
+pool, and the tables are walked once per day in the order of the relevant fluxes in
+the daily model loop (the same order as in the original, separate update routines,
+so that the results are identical to the last bit).
+
 *-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
 Biome-BGCMuSo v4.0.2
 Original code: Copyright 2000, Peter E. Thornton
@@ -18,32 +25,339 @@ for complete description of this change.
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <stddef.h>
 #include <math.h>
 #include <malloc.h>
 #include "bgc_struct.h"
 #include "bgc_func.h"
 #include "bgc_constants.h"
 
+/* flags of the table rows */
+#define UPD_ALL       0    /* transfer for all biomes */
+#define UPD_WOODY     1    /* transfer only for woody biomes */
+#define UPD_NONWOODY  2    /* transfer only for non-woody biomes (soft stem) */
+#define UPD_SRC_ADD   4    /* the source is a cumulative source term: it is increased by the flux */
+#define UPD_NONE     -1    /* no source pool (flux into a sink only) */
+
+/* one pool-to-pool transfer: byte offsets of the flux and of the pools in the flux/state structures */
+typedef struct
+{
+	int flux;
+	int dst;
+	int src;
+	int flag;
+} transfer_row;
+
+/* one decomposition step of the nitrogen pools with the associated immobilization flux
+and the volatilization of the mineralized N */
+typedef struct
+{
+	int flux;
+	int dst;
+	int src;
+	int sminn_flux;
+	int nvol_flux;
+} decomp_row;
+
+#define FIELD(base, off) (*(double*)((char*)(base) + (off)))
+
+#define C_ROW(flux, dst, src, flag) { offsetof(cflux_struct, flux), offsetof(cstate_struct, dst), offsetof(cstate_struct, src), flag }
+#define N_ROW(flux, dst, src, flag) { offsetof(nflux_struct, flux), offsetof(nstate_struct, dst), offsetof(nstate_struct, src), flag }
+#define N_SNK(flux, dst)            { offsetof(nflux_struct, flux), offsetof(nstate_struct, dst), UPD_NONE, UPD_ALL }
+#define N_DECOMP(flux, dst, src, sminn_flux, nvol_flux) \
+	{ offsetof(nflux_struct, flux), offsetof(nstate_struct, dst), offsetof(nstate_struct, src), \
+	  offsetof(nflux_struct, sminn_flux), offsetof(nflux_struct, nvol_flux) }
+
+/* NOTE: Mortality fluxes are all accounted for in a separate routine,
+which is to be called after this routine.  This is a special case
+where the updating of state variables is order-sensitive, since
+otherwise the complications of possibly having mortality fluxes drive
+the pools negative would create big, unnecessary headaches. */
+
+static const transfer_row carbon_daily[] =
+{
+	/* Phenology fluxes: leaf, fine root and fruit transfer growth */
+	C_ROW(leafc_transfer_to_leafc,           leafc,      leafc_transfer,      UPD_ALL),
+	C_ROW(frootc_transfer_to_frootc,         frootc,     frootc_transfer,     UPD_ALL),
+	C_ROW(fruitc_transfer_to_fruitc,         fruitc,     fruitc_transfer,     UPD_ALL),
+	/* stem and coarse root transfer growth */
+	C_ROW(livestemc_transfer_to_livestemc,   livestemc,  livestemc_transfer,  UPD_WOODY),
+	C_ROW(deadstemc_transfer_to_deadstemc,   deadstemc,  deadstemc_transfer,  UPD_WOODY),
+	C_ROW(livecrootc_transfer_to_livecrootc, livecrootc, livecrootc_transfer, UPD_WOODY),
+	C_ROW(deadcrootc_transfer_to_deadcrootc, deadcrootc, deadcrootc_transfer, UPD_WOODY),
+	C_ROW(softstemc_transfer_to_softstemc,   softstemc,  softstemc_transfer,  UPD_NONWOODY),
+
+	/* Leaf, fine root and fruit litterfall */
+	C_ROW(leafc_to_litr1c,  litr1c, leafc,  UPD_ALL),
+	C_ROW(leafc_to_litr2c,  litr2c, leafc,  UPD_ALL),
+	C_ROW(leafc_to_litr3c,  litr3c, leafc,  UPD_ALL),
+	C_ROW(leafc_to_litr4c,  litr4c, leafc,  UPD_ALL),
+	C_ROW(frootc_to_litr1c, litr1c, frootc, UPD_ALL),
+	C_ROW(frootc_to_litr2c, litr2c, frootc, UPD_ALL),
+	C_ROW(frootc_to_litr3c, litr3c, frootc, UPD_ALL),
+	C_ROW(frootc_to_litr4c, litr4c, frootc, UPD_ALL),
+	C_ROW(fruitc_to_litr1c, litr1c, fruitc, UPD_ALL),
+	C_ROW(fruitc_to_litr2c, litr2c, fruitc, UPD_ALL),
+	C_ROW(fruitc_to_litr3c, litr3c, fruitc, UPD_ALL),
+	C_ROW(fruitc_to_litr4c, litr4c, fruitc, UPD_ALL),
+	/* livewood turnover fluxes */
+	C_ROW(livestemc_to_deadstemc,   deadstemc,  livestemc,  UPD_WOODY),
+	C_ROW(livecrootc_to_deadcrootc, deadcrootc, livecrootc, UPD_WOODY),
+	/* soft stem litterfall */
+	C_ROW(softstemc_to_litr1c, litr1c, softstemc, UPD_NONWOODY),
+	C_ROW(softstemc_to_litr2c, litr2c, softstemc, UPD_NONWOODY),
+	C_ROW(softstemc_to_litr3c, litr3c, softstemc, UPD_NONWOODY),
+	C_ROW(softstemc_to_litr4c, litr4c, softstemc, UPD_NONWOODY),
+
+	/* Maintenance respiration fluxes */
+	C_ROW(leaf_day_mr,   leaf_mr_snk,      cpool, UPD_ALL),
+	C_ROW(leaf_night_mr, leaf_mr_snk,      cpool, UPD_ALL),
+	C_ROW(froot_mr,      froot_mr_snk,     cpool, UPD_ALL),
+	C_ROW(fruit_mr,      fruit_mr_snk,     cpool, UPD_ALL),
+	C_ROW(livestem_mr,   livestem_mr_snk,  cpool, UPD_WOODY),
+	C_ROW(livecroot_mr,  livecroot_mr_snk, cpool, UPD_WOODY),
+	C_ROW(softstem_mr,   softstem_mr_snk,  cpool, UPD_NONWOODY),
+
+	/* Photosynthesis fluxes */
+	C_ROW(psnsun_to_cpool,   cpool, psnsun_src,   UPD_SRC_ADD),
+	C_ROW(psnshade_to_cpool, cpool, psnshade_src, UPD_SRC_ADD),
+
+	/* Litter decomposition fluxes: coarse woody debris into litter pools */
+	C_ROW(cwdc_to_litr2c,   litr2c,       cwdc,   UPD_ALL),
+	C_ROW(cwdc_to_litr3c,   litr3c,       cwdc,   UPD_ALL),
+	C_ROW(cwdc_to_litr4c,   litr4c,       cwdc,   UPD_ALL),
+	/* labile, cellulose (shielded and unshielded) and lignin litter pools */
+	C_ROW(litr1_hr,         litr1_hr_snk, litr1c, UPD_ALL),
+	C_ROW(litr1c_to_soil1c, soil1c,       litr1c, UPD_ALL),
+	C_ROW(litr2_hr,         litr2_hr_snk, litr2c, UPD_ALL),
+	C_ROW(litr2c_to_soil2c, soil2c,       litr2c, UPD_ALL),
+	C_ROW(litr3c_to_litr2c, litr2c,       litr3c, UPD_ALL),
+	C_ROW(litr4_hr,         litr4_hr_snk, litr4c, UPD_ALL),
+	C_ROW(litr4c_to_soil3c, soil3c,       litr4c, UPD_ALL),
+	/* fast, medium, slow and recalcitrant soil pools */
+	C_ROW(soil1_hr,         soil1_hr_snk, soil1c, UPD_ALL),
+	C_ROW(soil1c_to_soil2c, soil2c,       soil1c, UPD_ALL),
+	C_ROW(soil2_hr,         soil2_hr_snk, soil2c, UPD_ALL),
+	C_ROW(soil2c_to_soil3c, soil3c,       soil2c, UPD_ALL),
+	C_ROW(soil3_hr,         soil3_hr_snk, soil3c, UPD_ALL),
+	C_ROW(soil3c_to_soil4c, soil4c,       soil3c, UPD_ALL),
+	C_ROW(soil4_hr,         soil4_hr_snk, soil4c, UPD_ALL),
+
+	/* Daily allocation fluxes */
+	C_ROW(cpool_to_leafc,               leafc,              cpool, UPD_ALL),
+	C_ROW(cpool_to_leafc_storage,       leafc_storage,      cpool, UPD_ALL),
+	C_ROW(cpool_to_frootc,              frootc,             cpool, UPD_ALL),
+	C_ROW(cpool_to_frootc_storage,      frootc_storage,     cpool, UPD_ALL),
+	C_ROW(cpool_to_fruitc,              fruitc,             cpool, UPD_ALL),
+	C_ROW(cpool_to_fruitc_storage,      fruitc_storage,     cpool, UPD_ALL),
+	C_ROW(cpool_to_livestemc,           livestemc,          cpool, UPD_WOODY),
+	C_ROW(cpool_to_livestemc_storage,   livestemc_storage,  cpool, UPD_WOODY),
+	C_ROW(cpool_to_deadstemc,           deadstemc,          cpool, UPD_WOODY),
+	C_ROW(cpool_to_deadstemc_storage,   deadstemc_storage,  cpool, UPD_WOODY),
+	C_ROW(cpool_to_livecrootc,          livecrootc,         cpool, UPD_WOODY),
+	C_ROW(cpool_to_livecrootc_storage,  livecrootc_storage, cpool, UPD_WOODY),
+	C_ROW(cpool_to_deadcrootc,          deadcrootc,         cpool, UPD_WOODY),
+	C_ROW(cpool_to_deadcrootc_storage,  deadcrootc_storage, cpool, UPD_WOODY),
+	C_ROW(cpool_to_softstemc,           softstemc,          cpool, UPD_NONWOODY),
+	C_ROW(cpool_to_softstemc_storage,   softstemc_storage,  cpool, UPD_NONWOODY),
+	/* allocation for transfer growth respiration */
+	C_ROW(cpool_to_gresp_storage,       gresp_storage,      cpool, UPD_ALL),
+
+	/* Daily growth respiration fluxes */
+	C_ROW(cpool_leaf_gr,                leaf_gr_snk,      cpool,          UPD_ALL),
+	C_ROW(cpool_leaf_storage_gr,        leaf_gr_snk,      cpool,          UPD_ALL),
+	C_ROW(transfer_leaf_gr,             leaf_gr_snk,      gresp_transfer, UPD_ALL),
+	C_ROW(cpool_froot_gr,               froot_gr_snk,     cpool,          UPD_ALL),
+	C_ROW(cpool_froot_storage_gr,       froot_gr_snk,     cpool,          UPD_ALL),
+	C_ROW(transfer_froot_gr,            froot_gr_snk,     gresp_transfer, UPD_ALL),
+	C_ROW(cpool_fruit_gr,               fruit_gr_snk,     cpool,          UPD_ALL),
+	C_ROW(cpool_fruit_storage_gr,       fruit_gr_snk,     cpool,          UPD_ALL),
+	C_ROW(transfer_fruit_gr,            fruit_gr_snk,     gresp_transfer, UPD_ALL),
+	C_ROW(cpool_livestem_gr,            livestem_gr_snk,  cpool,          UPD_WOODY),
+	C_ROW(cpool_livestem_storage_gr,    livestem_gr_snk,  cpool,          UPD_WOODY),
+	C_ROW(transfer_livestem_gr,         livestem_gr_snk,  gresp_transfer, UPD_WOODY),
+	C_ROW(cpool_deadstem_gr,            deadstem_gr_snk,  cpool,          UPD_WOODY),
+	C_ROW(cpool_deadstem_storage_gr,    deadstem_gr_snk,  cpool,          UPD_WOODY),
+	C_ROW(transfer_deadstem_gr,         deadstem_gr_snk,  gresp_transfer, UPD_WOODY),
+	C_ROW(cpool_livecroot_gr,           livecroot_gr_snk, cpool,          UPD_WOODY),
+	C_ROW(cpool_livecroot_storage_gr,   livecroot_gr_snk, cpool,          UPD_WOODY),
+	C_ROW(transfer_livecroot_gr,        livecroot_gr_snk, gresp_transfer, UPD_WOODY),
+	C_ROW(cpool_deadcroot_gr,           deadcroot_gr_snk, cpool,          UPD_WOODY),
+	C_ROW(cpool_deadcroot_storage_gr,   deadcroot_gr_snk, cpool,          UPD_WOODY),
+	C_ROW(transfer_deadcroot_gr,        deadcroot_gr_snk, gresp_transfer, UPD_WOODY),
+	C_ROW(cpool_softstem_gr,            softstem_gr_snk,  cpool,          UPD_NONWOODY),
+	C_ROW(cpool_softstem_storage_gr,    softstem_gr_snk,  cpool,          UPD_NONWOODY),
+	C_ROW(transfer_softstem_gr,         softstem_gr_snk,  gresp_transfer, UPD_NONWOODY)
+};
+
+/* Annual allocation fluxes, one day per year: the whole storage pool moves into the
+transfer pool (the flux is assessed from the source pool in the update routine) */
+static const transfer_row carbon_annual[] =
+{
+	C_ROW(leafc_storage_to_leafc_transfer,           leafc_transfer,      leafc_storage,      UPD_ALL),
+	C_ROW(frootc_storage_to_frootc_transfer,         frootc_transfer,     frootc_storage,     UPD_ALL),
+	C_ROW(gresp_storage_to_gresp_transfer,           gresp_transfer,      gresp_storage,      UPD_ALL),
+	C_ROW(fruitc_storage_to_fruitc_transfer,         fruitc_transfer,     fruitc_storage,     UPD_ALL),
+	C_ROW(livestemc_storage_to_livestemc_transfer,   livestemc_transfer,  livestemc_storage,  UPD_WOODY),
+	C_ROW(deadstemc_storage_to_deadstemc_transfer,   deadstemc_transfer,  deadstemc_storage,  UPD_WOODY),
+	C_ROW(livecrootc_storage_to_livecrootc_transfer, livecrootc_transfer, livecrootc_storage, UPD_WOODY),
+	C_ROW(deadcrootc_storage_to_deadcrootc_transfer, deadcrootc_transfer, deadcrootc_storage, UPD_WOODY),
+	C_ROW(softstemc_storage_to_softstemc_transfer,   softstemc_transfer,  softstemc_storage,  UPD_NONWOODY)
+};
+
+static const transfer_row nitrogen_plant[] =
+{
+	/* Phenology fluxes: transfer growth */
+	N_ROW(leafn_transfer_to_leafn,           leafn,      leafn_transfer,      UPD_ALL),
+	N_ROW(frootn_transfer_to_frootn,         frootn,     frootn_transfer,     UPD_ALL),
+	N_ROW(fruitn_transfer_to_fruitn,         fruitn,     fruitn_transfer,     UPD_ALL),
+	N_ROW(livestemn_transfer_to_livestemn,   livestemn,  livestemn_transfer,  UPD_WOODY),
+	N_ROW(deadstemn_transfer_to_deadstemn,   deadstemn,  deadstemn_transfer,  UPD_WOODY),
+	N_ROW(livecrootn_transfer_to_livecrootn, livecrootn, livecrootn_transfer, UPD_WOODY),
+	N_ROW(deadcrootn_transfer_to_deadcrootn, deadcrootn, deadcrootn_transfer, UPD_WOODY),
+	N_ROW(softstemn_transfer_to_softstemn,   softstemn,  softstemn_transfer,  UPD_NONWOODY),
+
+	/* Leaf, fine root, fruit and soft stem litterfall (with N retranslocation) */
+	N_ROW(leafn_to_litr1n,     litr1n,   leafn,     UPD_ALL),
+	N_ROW(leafn_to_litr2n,     litr2n,   leafn,     UPD_ALL),
+	N_ROW(leafn_to_litr3n,     litr3n,   leafn,     UPD_ALL),
+	N_ROW(leafn_to_litr4n,     litr4n,   leafn,     UPD_ALL),
+	N_ROW(leafn_to_retransn,   retransn, leafn,     UPD_ALL),
+	N_ROW(frootn_to_litr1n,    litr1n,   frootn,    UPD_ALL),
+	N_ROW(frootn_to_litr2n,    litr2n,   frootn,    UPD_ALL),
+	N_ROW(frootn_to_litr3n,    litr3n,   frootn,    UPD_ALL),
+	N_ROW(frootn_to_litr4n,    litr4n,   frootn,    UPD_ALL),
+	N_ROW(fruitn_to_litr1n,    litr1n,   fruitn,    UPD_ALL),
+	N_ROW(fruitn_to_litr2n,    litr2n,   fruitn,    UPD_ALL),
+	N_ROW(fruitn_to_litr3n,    litr3n,   fruitn,    UPD_ALL),
+	N_ROW(fruitn_to_litr4n,    litr4n,   fruitn,    UPD_ALL),
+	N_ROW(softstemn_to_litr1n, litr1n,   softstemn, UPD_ALL),
+	N_ROW(softstemn_to_litr2n, litr2n,   softstemn, UPD_ALL),
+	N_ROW(softstemn_to_litr3n, litr3n,   softstemn, UPD_ALL),
+	N_ROW(softstemn_to_litr4n, litr4n,   softstemn, UPD_ALL),
+
+	/* live wood turnover to dead wood (with N retranslocation) */
+	N_ROW(livestemn_to_deadstemn,   deadstemn,  livestemn,  UPD_ALL),
+	N_ROW(livestemn_to_retransn,    retransn,   livestemn,  UPD_ALL),
+	N_ROW(livecrootn_to_deadcrootn, deadcrootn, livecrootn, UPD_ALL),
+	N_ROW(livecrootn_to_retransn,   retransn,   livecrootn, UPD_ALL),
+
+	/* Fluxes out of coarse woody debris into litter pools */
+	N_ROW(cwdn_to_litr2n, litr2n, cwdn, UPD_ALL),
+	N_ROW(cwdn_to_litr3n, litr3n, cwdn, UPD_ALL),
+	N_ROW(cwdn_to_litr4n, litr4n, cwdn, UPD_ALL)
+};
+
+/* Litter and soil decomposition fluxes with immobilization and mineralization:
+a negative immobilization flux (net mineralization) is partly volatilized (denitrif_prop) */
+static const decomp_row nitrogen_decomp[] =
+{
+	N_DECOMP(litr1n_to_soil1n, soil1n, litr1n, sminn_to_soil1n_l1, sminn_to_nvol_l1s1),
+	N_DECOMP(litr2n_to_soil2n, soil2n, litr2n, sminn_to_soil2n_l2, sminn_to_nvol_l2s2),
+	{ offsetof(nflux_struct, litr3n_to_litr2n), offsetof(nstate_struct, litr2n), offsetof(nstate_struct, litr3n), UPD_NONE, UPD_NONE },
+	N_DECOMP(litr4n_to_soil3n, soil3n, litr4n, sminn_to_soil3n_l4, sminn_to_nvol_l4s3),
+	N_DECOMP(soil1n_to_soil2n, soil2n, soil1n, sminn_to_soil2n_s1, sminn_to_nvol_s1s2),
+	N_DECOMP(soil2n_to_soil3n, soil3n, soil2n, sminn_to_soil3n_s2, sminn_to_nvol_s2s3),
+	N_DECOMP(soil3n_to_soil4n, soil4n, soil3n, sminn_to_soil4n_s3, sminn_to_nvol_s3s4)
+};
+
+static const transfer_row nitrogen_alloc[] =
+{
+	/* Bulk denitrification of soil mineral N */
+	N_SNK(sminn_to_denitrif, nvol_snk),
+
+	/* Plant allocation flux, from N retrans pool */
+	N_ROW(retransn_to_npool, npool, retransn, UPD_ALL),
+
+	/* Daily allocation fluxes */
+	N_ROW(npool_to_leafn,              leafn,              npool, UPD_ALL),
+	N_ROW(npool_to_leafn_storage,      leafn_storage,      npool, UPD_ALL),
+	N_ROW(npool_to_frootn,             frootn,             npool, UPD_ALL),
+	N_ROW(npool_to_frootn_storage,     frootn_storage,     npool, UPD_ALL),
+	N_ROW(npool_to_fruitn,             fruitn,             npool, UPD_ALL),
+	N_ROW(npool_to_fruitn_storage,     fruitn_storage,     npool, UPD_ALL),
+	N_ROW(npool_to_livestemn,          livestemn,          npool, UPD_WOODY),
+	N_ROW(npool_to_livestemn_storage,  livestemn_storage,  npool, UPD_WOODY),
+	N_ROW(npool_to_deadstemn,          deadstemn,          npool, UPD_WOODY),
+	N_ROW(npool_to_deadstemn_storage,  deadstemn_storage,  npool, UPD_WOODY),
+	N_ROW(npool_to_livecrootn,         livecrootn,         npool, UPD_WOODY),
+	N_ROW(npool_to_livecrootn_storage, livecrootn_storage, npool, UPD_WOODY),
+	N_ROW(npool_to_deadcrootn,         deadcrootn,         npool, UPD_WOODY),
+	N_ROW(npool_to_deadcrootn_storage, deadcrootn_storage, npool, UPD_WOODY),
+	N_ROW(npool_to_softstemn,          softstemn,          npool, UPD_NONWOODY),
+	N_ROW(npool_to_softstemn_storage,  softstemn_storage,  npool, UPD_NONWOODY)
+};
+
+static const transfer_row nitrogen_annual[] =
+{
+	N_ROW(leafn_storage_to_leafn_transfer,           leafn_transfer,      leafn_storage,      UPD_ALL),
+	N_ROW(frootn_storage_to_frootn_transfer,         frootn_transfer,     frootn_storage,     UPD_ALL),
+	N_ROW(fruitn_storage_to_fruitn_transfer,         fruitn_transfer,     fruitn_storage,     UPD_ALL),
+	N_ROW(livestemn_storage_to_livestemn_transfer,   livestemn_transfer,  livestemn_storage,  UPD_WOODY),
+	N_ROW(deadstemn_storage_to_deadstemn_transfer,   deadstemn_transfer,  deadstemn_storage,  UPD_WOODY),
+	N_ROW(livecrootn_storage_to_livecrootn_transfer, livecrootn_transfer, livecrootn_storage, UPD_WOODY),
+	N_ROW(deadcrootn_storage_to_deadcrootn_transfer, deadcrootn_transfer, deadcrootn_storage, UPD_WOODY),
+	N_ROW(softstemn_storage_to_softstemn_transfer,   softstemn_transfer,  softstemn_storage,  UPD_NONWOODY)
+};
+
+#define NROWS(table) ((int)(sizeof(table)/sizeof(table[0])))
+
+static void apply_transfers(const transfer_row* table, int nrow, void* flux, void* state, int woody, int annual);
+
+static void apply_transfers(const transfer_row* table, int nrow, void* flux, void* state, int woody, int annual)
+{
+	/* walk the table once: dst += flux, src -= flux (or src += flux for cumulative source terms).
+	On the annual allocation day the flux is the whole source pool. */
+	int i;
+	double f;
+	const transfer_row* row;
+
+	for (i = 0; i < nrow; i++)
+	{
+		row = &table[i];
+		if ((row->flag & UPD_WOODY) && !woody) continue;
+		if ((row->flag & UPD_NONWOODY) && woody) continue;
+
+		if (annual) FIELD(flux, row->flux) = FIELD(state, row->src);
+		f = FIELD(flux, row->flux);
+
+		FIELD(state, row->dst) += f;
+		if (row->src != UPD_NONE)
+		{
+			if (row->flag & UPD_SRC_ADD)
+				FIELD(state, row->src) += f;
+			else
+				FIELD(state, row->src) -= f;
+		}
+	}
+}
 
-int daily_water_state_update(wflux_struct* wf, wstate_struct* ws)
+int daily_state_update(const epconst_struct* epc, wflux_struct* wf, wstate_struct* ws, cflux_struct* cf, cstate_struct* cs,
+	                   nflux_struct* nf, nstate_struct* ns, int alloc, int woody, int evergreen)
 {
-	/* daily update of the water state variables */
-	 
+	/* daily update of the water, carbon and nitrogen state variables */
+
 	int ok=1;
+	int i;
+	double sminn_flux, nvol_flux;
+	const decomp_row* row;
 
 	/* Hidy 2011 - multilayer soil */
 	int layer;
 	double soilw_SUM = 0;
-	
+
+	/* ******************************************************************************** */
+	/* WATER */
+
 	/* precipitation fluxes */
 	ws->canopyw        += wf->prcp_to_canopyw;
 	ws->prcp_src       += wf->prcp_to_canopyw;
-	
+
 	ws->prcp_src       += wf->prcp_to_soilw;
-	
+
 	ws->snoww          += wf->prcp_to_snoww;
 	ws->prcp_src       += wf->prcp_to_snoww;
-	
+
 	/* canopy intercepted water fluxes */
 	ws->canopyevap_snk += wf->canopyw_evap;
 	ws->canopyw        -= wf->canopyw_evap;
@@ -58,16 +372,16 @@ int daily_water_state_update(wflux_struct* wf, wstate_struct* ws)
 	ws->snoww          -= wf->snoww_to_soilw;
 	ws->snowsubl_snk   += wf->snoww_subl;
 	ws->snoww          -= wf->snoww_subl;
-	
+
 	 /* !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! */
 	/* MODIFICATIONS -  Hidy 2011 */
-	
+
 	/* bare soil evaporation */
 	ws->soilevap_snk   += wf->soilw_evap;
-	
+
 	/* transpiration */
 	ws->trans_snk      += wf->soilw_trans_SUM;
-	
+
 	/* runoff - from the top soil layer (net loss) */
 	ws->runoff_snk	   += wf->prcp_to_runoff;
 
@@ -80,9 +394,9 @@ int daily_water_state_update(wflux_struct* wf, wstate_struct* ws)
 	/* deep transpiration: transpiration from bottom layer is net gain for the sytem*/
 	ws->deeptrans_src += wf->soilw_trans[N_SOILLAYERS-1];
 
-   
-	
-	/* !!!!!!!!!!!!!!!!!!!!!!!!!!!!! MULTILAYER SOIL !!!!!!!!!!!!!!!!!!!!!!!!!! */	
+
+
+	/* !!!!!!!!!!!!!!!!!!!!!!!!!!!!! MULTILAYER SOIL !!!!!!!!!!!!!!!!!!!!!!!!!! */
 	for (layer = 0; layer < N_SOILLAYERS; layer++)
 	{
 		soilw_SUM           +=  ws->soilw[layer];
@@ -92,309 +406,13 @@ int daily_water_state_update(wflux_struct* wf, wstate_struct* ws)
 	ws->soilw_SUM = soilw_SUM;
 
 	wf->evapotransp = wf->canopyw_evap + wf->soilw_evap + wf->soilw_trans_SUM + wf->snoww_subl;
-	
-	
-	return (!ok);
-}
 
-int daily_carbon_state_update(cflux_struct* cf, cstate_struct* cs,
-int alloc, int woody, int evergreen)
-{
-	/* daily update of the carbon state variables */
-	
-	int ok=1;
-	
-	/* C state variables are updated below in the order of the relevant
-	fluxes in the daily model loop */
-	
-	/* NOTE: Mortality fluxes are all accounted for in a separate routine, 
-	which is to be called after this routine.  This is a special case
-	where the updating of state variables is order-sensitive, since 
-	otherwise the complications of possibly having mortality fluxes drive 
-	the pools negative would create big, unnecessary headaches. */
-	
-	/* Phenology fluxes */
-	/* leaf and fine root transfer growth */
-	cs->leafc            += cf->leafc_transfer_to_leafc;
-	cs->leafc_transfer   -= cf->leafc_transfer_to_leafc;
-	cs->frootc           += cf->frootc_transfer_to_frootc;
-	cs->frootc_transfer  -= cf->frootc_transfer_to_frootc;
-	/* fruit simulation - Hidy 2013 */
-	cs->fruitc           += cf->fruitc_transfer_to_fruitc;
-	cs->fruitc_transfer  -= cf->fruitc_transfer_to_fruitc;
-
- 
-	/* TREE-specific and NON-WOODY SPECIFIC fluxes */
-	if (woody)
-	{
-		/* Stem and coarse root transfer growth */
-		cs->livestemc             += cf->livestemc_transfer_to_livestemc;
-		cs->livestemc_transfer    -= cf->livestemc_transfer_to_livestemc;
-		cs->deadstemc             += cf->deadstemc_transfer_to_deadstemc;
-		cs->deadstemc_transfer    -= cf->deadstemc_transfer_to_deadstemc;
-		cs->livecrootc            += cf->livecrootc_transfer_to_livecrootc;
-		cs->livecrootc_transfer   -= cf->livecrootc_transfer_to_livecrootc;
-		cs->deadcrootc            += cf->deadcrootc_transfer_to_deadcrootc;
-		cs->deadcrootc_transfer   -= cf->deadcrootc_transfer_to_deadcrootc;
-	}
-	else
-	{ 	/* SOFT STEM SIMULATION of non-woody biomes - Hidy 2015 */
-		cs->softstemc           += cf->softstemc_transfer_to_softstemc;
-		cs->softstemc_transfer  -= cf->softstemc_transfer_to_softstemc;
-	
-	}
-	/* Leaf and fine root litterfall */
-	cs->litr1c     += cf->leafc_to_litr1c;
-	cs->leafc      -= cf->leafc_to_litr1c;
-	cs->litr2c     += cf->leafc_to_litr2c;
-	cs->leafc      -= cf->leafc_to_litr2c;
-	cs->litr3c     += cf->leafc_to_litr3c;
-	cs->leafc      -= cf->leafc_to_litr3c;
-	cs->litr4c     += cf->leafc_to_litr4c;
-	cs->leafc      -= cf->leafc_to_litr4c;
-	cs->litr1c     += cf->frootc_to_litr1c;
-	cs->frootc     -= cf->frootc_to_litr1c;
-	cs->litr2c     += cf->frootc_to_litr2c;
-	cs->frootc     -= cf->frootc_to_litr2c;
-	cs->litr3c     += cf->frootc_to_litr3c;
-	cs->frootc     -= cf->frootc_to_litr3c;
-	cs->litr4c     += cf->frootc_to_litr4c;
-	cs->frootc     -= cf->frootc_to_litr4c;
-	/* fruit simulation - Hidy 2013. */
-	cs->litr1c     += cf->fruitc_to_litr1c;
-	cs->fruitc     -= cf->fruitc_to_litr1c;
-	cs->litr2c     += cf->fruitc_to_litr2c;
-	cs->fruitc     -= cf->fruitc_to_litr2c;
-	cs->litr3c     += cf->fruitc_to_litr3c;
-	cs->fruitc     -= cf->fruitc_to_litr3c;
-	cs->litr4c     += cf->fruitc_to_litr4c;
-	cs->fruitc     -= cf->fruitc_to_litr4c;
-
-	/* TREE-specific and NON-WOODY SPECIFIC fluxes */
-	if (woody)
-	{  /* livewood turnover fluxes */
-		cs->deadstemc  += cf->livestemc_to_deadstemc;
-		cs->livestemc  -= cf->livestemc_to_deadstemc;
-		cs->deadcrootc += cf->livecrootc_to_deadcrootc;
-		cs->livecrootc -= cf->livecrootc_to_deadcrootc;
-	}
-	else
-	{
-		/* soft stem simulation - Hidy 2015. */
-		cs->litr1c     += cf->softstemc_to_litr1c;
-		cs->softstemc  -= cf->softstemc_to_litr1c;
-		cs->litr2c     += cf->softstemc_to_litr2c;
-		cs->softstemc  -= cf->softstemc_to_litr2c;
-		cs->litr3c     += cf->softstemc_to_litr3c;
-		cs->softstemc  -= cf->softstemc_to_litr3c;
-		cs->litr4c     += cf->softstemc_to_litr4c;
-		cs->softstemc  -= cf->softstemc_to_litr4c;
-	
-	}
-	
-	/* Maintenance respiration fluxes */
-	cs->leaf_mr_snk  += cf->leaf_day_mr;
-	cs->cpool        -= cf->leaf_day_mr;
-	cs->leaf_mr_snk  += cf->leaf_night_mr;
-	cs->cpool        -= cf->leaf_night_mr;
-	cs->froot_mr_snk += cf->froot_mr;
-	cs->cpool        -= cf->froot_mr;
-	 /*fruit simulation - Hidy 2013. */
-    cs->fruit_mr_snk += cf->fruit_mr;
-	cs->cpool        -= cf->fruit_mr;
-
-	
-
-	/* TREE-specific and NON-WOODY SPECIFIC fluxes */
-	if (woody)
-	{
-		cs->livestem_mr_snk  += cf->livestem_mr;
-		cs->cpool            -= cf->livestem_mr;
-		cs->livecroot_mr_snk += cf->livecroot_mr;
-		cs->cpool            -= cf->livecroot_mr;
-	}
-	else
-	{
-		/*softstem simulation - Hidy 2013. */
-		cs->softstem_mr_snk += cf->softstem_mr;
-		cs->cpool        -= cf->softstem_mr;
-	
-	}
-	
-	/* Photosynthesis fluxes */
-	cs->cpool        += cf->psnsun_to_cpool;
-	cs->psnsun_src   += cf->psnsun_to_cpool;
-	cs->cpool        += cf->psnshade_to_cpool;
-	cs->psnshade_src += cf->psnshade_to_cpool;
-	
-	/* Litter decomposition fluxes */
-	/* Fluxes out of coarse woody debris into litter pools */
-	cs->litr2c       += cf->cwdc_to_litr2c;
-	cs->cwdc         -= cf->cwdc_to_litr2c;
-	cs->litr3c       += cf->cwdc_to_litr3c;
-	cs->cwdc         -= cf->cwdc_to_litr3c;
-	cs->litr4c       += cf->cwdc_to_litr4c;
-	cs->cwdc         -= cf->cwdc_to_litr4c;
-	/* Fluxes out of labile litter pool */
-	cs->litr1_hr_snk += cf->litr1_hr;
-	cs->litr1c       -= cf->litr1_hr;
-	cs->soil1c       += cf->litr1c_to_soil1c;
-	cs->litr1c       -= cf->litr1c_to_soil1c;
-	/* Fluxes out of cellulose litter pool */
-	cs->litr2_hr_snk += cf->litr2_hr;
-	cs->litr2c       -= cf->litr2_hr;
-	cs->soil2c       += cf->litr2c_to_soil2c;
-	cs->litr2c       -= cf->litr2c_to_soil2c;
-	/* Fluxes from shielded to unshielded cellulose pools */
-	cs->litr2c       += cf->litr3c_to_litr2c;
-	cs->litr3c       -= cf->litr3c_to_litr2c;
-	/* Fluxes out of lignin litter pool */
-	cs->litr4_hr_snk += cf->litr4_hr;
-	cs->litr4c       -= cf->litr4_hr;
-	cs->soil3c       += cf->litr4c_to_soil3c;
-	cs->litr4c       -= cf->litr4c_to_soil3c;
-	/* Fluxes out of fast soil pool */
-	cs->soil1_hr_snk += cf->soil1_hr;
-	cs->soil1c       -= cf->soil1_hr;
-	cs->soil2c       += cf->soil1c_to_soil2c;
-	cs->soil1c       -= cf->soil1c_to_soil2c;
-	/* Fluxes out of medium soil pool */
-	cs->soil2_hr_snk += cf->soil2_hr;
-	cs->soil2c       -= cf->soil2_hr;
-	cs->soil3c       += cf->soil2c_to_soil3c;
-	cs->soil2c       -= cf->soil2c_to_soil3c;
-	/* Fluxes out of slow soil pool */
-	cs->soil3_hr_snk += cf->soil3_hr;
-	cs->soil3c       -= cf->soil3_hr;
-	cs->soil4c       += cf->soil3c_to_soil4c;
-	cs->soil3c       -= cf->soil3c_to_soil4c;
-	/* Fluxes out of recalcitrant SOM pool */
-	cs->soil4_hr_snk += cf->soil4_hr;
-	cs->soil4c       -= cf->soil4_hr;
-
-	
-	/* Daily allocation fluxes */
-	/* daily leaf allocation fluxes */
-	cs->leafc          += cf->cpool_to_leafc;
-	cs->cpool          -= cf->cpool_to_leafc;
-	cs->leafc_storage  += cf->cpool_to_leafc_storage;
-	cs->cpool          -= cf->cpool_to_leafc_storage;
-	/* Daily fine root allocation fluxes */
-	cs->frootc         += cf->cpool_to_frootc;
-	cs->cpool          -= cf->cpool_to_frootc;
-	cs->frootc_storage += cf->cpool_to_frootc_storage;
-	cs->cpool          -= cf->cpool_to_frootc_storage;
-	/* fruit simulation - Hidy 2013. */
-	cs->fruitc         += cf->cpool_to_fruitc;
-	cs->cpool          -= cf->cpool_to_fruitc;
-	cs->fruitc_storage += cf->cpool_to_fruitc_storage;
-	cs->cpool          -= cf->cpool_to_fruitc_storage; 
-
-	/* TREE-specific and NON-WOODY SPECIFIC fluxes */
-	if (woody)
-	{
-		/* Daily live stem wood allocation fluxes */
-		cs->livestemc          += cf->cpool_to_livestemc;
-		cs->cpool              -= cf->cpool_to_livestemc;
-		cs->livestemc_storage  += cf->cpool_to_livestemc_storage;
-		cs->cpool              -= cf->cpool_to_livestemc_storage;
-		/* Daily dead stem wood allocation fluxes */
-		cs->deadstemc          += cf->cpool_to_deadstemc;
-		cs->cpool              -= cf->cpool_to_deadstemc;
-		cs->deadstemc_storage  += cf->cpool_to_deadstemc_storage;
-		cs->cpool              -= cf->cpool_to_deadstemc_storage;
-		/* Daily live coarse root wood allocation fluxes */
-		cs->livecrootc         += cf->cpool_to_livecrootc;
-		cs->cpool              -= cf->cpool_to_livecrootc;
-		cs->livecrootc_storage += cf->cpool_to_livecrootc_storage;
-		cs->cpool              -= cf->cpool_to_livecrootc_storage;
-		/* Daily dead coarse root wood allocation fluxes */
-		cs->deadcrootc         += cf->cpool_to_deadcrootc;
-		cs->cpool              -= cf->cpool_to_deadcrootc;
-		cs->deadcrootc_storage += cf->cpool_to_deadcrootc_storage;
-		cs->cpool              -= cf->cpool_to_deadcrootc_storage;
-	}
-	else
-	{ /* SOFT STEM SIMULATION of non-woody biomes - Hidy 2015 */
-		/* softstem simulation - Hidy 2013. */
-		cs->softstemc			+= cf->cpool_to_softstemc;
-		cs->cpool				-= cf->cpool_to_softstemc;
-		cs->softstemc_storage	+= cf->cpool_to_softstemc_storage;
-		cs->cpool				-= cf->cpool_to_softstemc_storage; 
-	
-	}
-	/* Daily allocation for transfer growth respiration */
-	cs->gresp_storage  += cf->cpool_to_gresp_storage;
-	cs->cpool          -= cf->cpool_to_gresp_storage;
-	
-	/* Daily growth respiration fluxes */
-		/* Leaf growth respiration */
-		cs->leaf_gr_snk     += cf->cpool_leaf_gr;
-		cs->cpool           -= cf->cpool_leaf_gr;
-		cs->leaf_gr_snk     += cf->cpool_leaf_storage_gr;
-		cs->cpool           -= cf->cpool_leaf_storage_gr;
-		cs->leaf_gr_snk     += cf->transfer_leaf_gr;
-		cs->gresp_transfer  -= cf->transfer_leaf_gr;
-		/* Fine root growth respiration */
-		cs->froot_gr_snk    += cf->cpool_froot_gr;
-		cs->cpool           -= cf->cpool_froot_gr;
-		cs->froot_gr_snk    += cf->cpool_froot_storage_gr;
-		cs->cpool           -= cf->cpool_froot_storage_gr;
-		cs->froot_gr_snk    += cf->transfer_froot_gr;
-		cs->gresp_transfer  -= cf->transfer_froot_gr;
-		/* fruit simulation - Hidy 2013. */
-		cs->fruit_gr_snk     += cf->cpool_fruit_gr;
-		cs->cpool            -= cf->cpool_fruit_gr;
-		cs->fruit_gr_snk     += cf->cpool_fruit_storage_gr;
-		cs->cpool            -= cf->cpool_fruit_storage_gr;
-		cs->fruit_gr_snk     += cf->transfer_fruit_gr;
-		cs->gresp_transfer   -= cf->transfer_fruit_gr;
-	
-
-		/* TREE-specific and NON-WOODY SPECIFIC fluxes */
-		if (woody)
-		{	
-			/* Live stem growth respiration */ 
-			cs->livestem_gr_snk  += cf->cpool_livestem_gr;
-			cs->cpool            -= cf->cpool_livestem_gr;
-			cs->livestem_gr_snk  += cf->cpool_livestem_storage_gr;
-			cs->cpool            -= cf->cpool_livestem_storage_gr;
-			cs->livestem_gr_snk  += cf->transfer_livestem_gr;
-			cs->gresp_transfer   -= cf->transfer_livestem_gr;
-			/* Dead stem growth respiration */ 
-			cs->deadstem_gr_snk  += cf->cpool_deadstem_gr;
-			cs->cpool            -= cf->cpool_deadstem_gr;
-			cs->deadstem_gr_snk  += cf->cpool_deadstem_storage_gr;
-			cs->cpool            -= cf->cpool_deadstem_storage_gr;
-			cs->deadstem_gr_snk  += cf->transfer_deadstem_gr;
-			cs->gresp_transfer   -= cf->transfer_deadstem_gr;
-			/* Live coarse root growth respiration */ 
-			cs->livecroot_gr_snk += cf->cpool_livecroot_gr;
-			cs->cpool            -= cf->cpool_livecroot_gr;
-			cs->livecroot_gr_snk += cf->cpool_livecroot_storage_gr;
-			cs->cpool            -= cf->cpool_livecroot_storage_gr;
-			cs->livecroot_gr_snk += cf->transfer_livecroot_gr;
-			cs->gresp_transfer   -= cf->transfer_livecroot_gr;
-			/* Dead coarse root growth respiration */ 
-			cs->deadcroot_gr_snk += cf->cpool_deadcroot_gr;
-			cs->cpool            -= cf->cpool_deadcroot_gr;
-			cs->deadcroot_gr_snk += cf->cpool_deadcroot_storage_gr;
-			cs->cpool            -= cf->cpool_deadcroot_storage_gr;
-			cs->deadcroot_gr_snk += cf->transfer_deadcroot_gr;
-			cs->gresp_transfer   -= cf->transfer_deadcroot_gr;
-		}
-		else
-		{	/* SOFT STEM SIMULATION of non-woody biomes - Hidy 2015 */
-
-			cs->softstem_gr_snk     += cf->cpool_softstem_gr;
-			cs->cpool            -= cf->cpool_softstem_gr;
-			cs->softstem_gr_snk     += cf->cpool_softstem_storage_gr;
-			cs->cpool            -= cf->cpool_softstem_storage_gr;
-			cs->softstem_gr_snk     += cf->transfer_softstem_gr;
-			cs->gresp_transfer   -= cf->transfer_softstem_gr;
-		}
 
-	
+	/* ******************************************************************************** */
+	/* CARBON */
+
+	apply_transfers(carbon_daily, NROWS(carbon_daily), cf, cs, woody, 0);
+
 	/* Annual allocation fluxes, one day per year */
 	if (alloc)
 	{
@@ -403,55 +421,8 @@ int alloc, int woody, int evergreen)
 		the state_variable update routine.  This is required to have the
 		allocation of excess C and N show up as new growth in the next growing
 		season, instead of two growing seasons from now. */
-		cf->leafc_storage_to_leafc_transfer = cs->leafc_storage;
-		cf->frootc_storage_to_frootc_transfer = cs->frootc_storage;
-		cf->gresp_storage_to_gresp_transfer = cs->gresp_storage;
-		/* fruit simulation - Hidy 2013. */
-		cf->fruitc_storage_to_fruitc_transfer = cs->fruitc_storage;
-	
-		/* TREE-specific and NON-WOODY SPECIFIC fluxes */
-		if (woody)
-		{
-			cf->livestemc_storage_to_livestemc_transfer = cs->livestemc_storage;
-			cf->deadstemc_storage_to_deadstemc_transfer = cs->deadstemc_storage;
-			cf->livecrootc_storage_to_livecrootc_transfer = cs->livecrootc_storage;
-			cf->deadcrootc_storage_to_deadcrootc_transfer = cs->deadcrootc_storage;
-		}
-		else
-		{ 	/* SOFT STEM SIMULATION  of non-woody biomes - Hidy 2015. */
-			cf->softstemc_storage_to_softstemc_transfer = cs->softstemc_storage;
-	
-		}
-		/* update states variables */
-		cs->leafc_transfer    += cf->leafc_storage_to_leafc_transfer;
-		cs->leafc_storage     -= cf->leafc_storage_to_leafc_transfer;
-		cs->frootc_transfer   += cf->frootc_storage_to_frootc_transfer;
-		cs->frootc_storage    -= cf->frootc_storage_to_frootc_transfer;
-		cs->gresp_transfer    += cf->gresp_storage_to_gresp_transfer;
-		cs->gresp_storage     -= cf->gresp_storage_to_gresp_transfer;
-		/* fruit simulation - Hidy 2013. */
-		cs->fruitc_transfer    += cf->fruitc_storage_to_fruitc_transfer;
-		cs->fruitc_storage     -= cf->fruitc_storage_to_fruitc_transfer;
-
-		/* TREE-specific and NON-WOODY SPECIFIC fluxes */
-		if (woody)
-		{
-			cs->livestemc_transfer  += cf->livestemc_storage_to_livestemc_transfer;
-			cs->livestemc_storage   -= cf->livestemc_storage_to_livestemc_transfer;
-
-			cs->deadstemc_transfer  += cf->deadstemc_storage_to_deadstemc_transfer;
-			cs->deadstemc_storage   -= cf->deadstemc_storage_to_deadstemc_transfer;
-			cs->livecrootc_transfer += cf->livecrootc_storage_to_livecrootc_transfer;
-			cs->livecrootc_storage  -= cf->livecrootc_storage_to_livecrootc_transfer;
-			cs->deadcrootc_transfer += cf->deadcrootc_storage_to_deadcrootc_transfer;
-			cs->deadcrootc_storage  -= cf->deadcrootc_storage_to_deadcrootc_transfer;
-		}
-		else
-		{	/* softstem simulation - Hidy 2013. */
-			cs->softstemc_transfer    += cf->softstemc_storage_to_softstemc_transfer;
-			cs->softstemc_storage     -= cf->softstemc_storage_to_softstemc_transfer;
-		}
-		
+		apply_transfers(carbon_annual, NROWS(carbon_annual), cf, cs, woody, 1);
+
 		/* for deciduous system, force leafc and frootc to exactly 0.0 on the
 		last day */
 		if (!evergreen)
@@ -461,109 +432,11 @@ int alloc, int woody, int evergreen)
 		}
 	} /* end if allocation day */
 
-	return (!ok);
-}		
 
-int daily_nitrogen_state_update(const epconst_struct* epc, nflux_struct* nf, nstate_struct* ns,
-int alloc, int woody, int evergreen)
-{
-	int ok=1;
+	/* ******************************************************************************** */
+	/* NITROGEN */
 
-	/* N state variables are updated below in the order of the relevant
-	fluxes in the daily model loop */
-	
-	/* NOTE: Mortality fluxes are all accounted for in a separate routine, 
-	which is to be called after this routine.  This is a special case
-	where the updating of state variables is order-sensitive, since 
-	otherwise the complications of possibly having mortality fluxes drive 
-	the pools negative would create big, unnecessary headaches. */
-	
-	/* Phenology fluxes */
-	/* Leaf and fine root transfer growth */
-	ns->leafn           += nf->leafn_transfer_to_leafn;
-	ns->leafn_transfer  -= nf->leafn_transfer_to_leafn;
-	ns->frootn          += nf->frootn_transfer_to_frootn;
-	ns->frootn_transfer -= nf->frootn_transfer_to_frootn;
-	/* fruit simulation - Hidy 2013. */
-	ns->fruitn           += nf->fruitn_transfer_to_fruitn;
-	ns->fruitn_transfer  -= nf->fruitn_transfer_to_fruitn;
-	
-	/* TREE-specific and NON-WOODY SPECIFIC fluxes */
-	if (woody)
-	{
-		/* Stem and coarse root transfer growth */
-		ns->livestemn           += nf->livestemn_transfer_to_livestemn;
-		ns->livestemn_transfer  -= nf->livestemn_transfer_to_livestemn;
-		ns->deadstemn           += nf->deadstemn_transfer_to_deadstemn;
-		ns->deadstemn_transfer  -= nf->deadstemn_transfer_to_deadstemn;
-		ns->livecrootn          += nf->livecrootn_transfer_to_livecrootn;
-		ns->livecrootn_transfer -= nf->livecrootn_transfer_to_livecrootn;
-		ns->deadcrootn          += nf->deadcrootn_transfer_to_deadcrootn;
-		ns->deadcrootn_transfer -= nf->deadcrootn_transfer_to_deadcrootn;
-	}
-	else
-	{
-		/* softstem simulation - Hidy 2013. */
-		ns->softstemn           += nf->softstemn_transfer_to_softstemn;
-		ns->softstemn_transfer  -= nf->softstemn_transfer_to_softstemn;
-	}
-	/* Leaf and fine root litterfall */
-	ns->litr1n     += nf->leafn_to_litr1n;
-	ns->leafn      -= nf->leafn_to_litr1n;
-	ns->litr2n     += nf->leafn_to_litr2n;
-	ns->leafn      -= nf->leafn_to_litr2n;
-	ns->litr3n     += nf->leafn_to_litr3n;
-	ns->leafn      -= nf->leafn_to_litr3n;
-	ns->litr4n     += nf->leafn_to_litr4n;
-	ns->leafn      -= nf->leafn_to_litr4n;
-	ns->retransn   += nf->leafn_to_retransn;   /* N retranslocation */
-	ns->leafn      -= nf->leafn_to_retransn;
-	ns->litr1n     += nf->frootn_to_litr1n;
-	ns->frootn     -= nf->frootn_to_litr1n;
-	ns->litr2n     += nf->frootn_to_litr2n;
-	ns->frootn     -= nf->frootn_to_litr2n;
-	ns->litr3n     += nf->frootn_to_litr3n;
-	ns->frootn     -= nf->frootn_to_litr3n;
-	ns->litr4n     += nf->frootn_to_litr4n;
-	ns->frootn     -= nf->frootn_to_litr4n;
-	/* fruit simulation - Hidy 2013. */
-	ns->litr1n     += nf->fruitn_to_litr1n;
-	ns->fruitn     -= nf->fruitn_to_litr1n;
-	ns->litr2n     += nf->fruitn_to_litr2n;
-	ns->fruitn     -= nf->fruitn_to_litr2n;
-	ns->litr3n     += nf->fruitn_to_litr3n;
-	ns->fruitn     -= nf->fruitn_to_litr3n;
-	ns->litr4n     += nf->fruitn_to_litr4n;
-	ns->fruitn     -= nf->fruitn_to_litr4n;
-	/* softstemn simulation - Hidy 2013. */
-	ns->litr1n     += nf->softstemn_to_litr1n;
-	ns->softstemn  -= nf->softstemn_to_litr1n;
-	ns->litr2n     += nf->softstemn_to_litr2n;
-	ns->softstemn  -= nf->softstemn_to_litr2n;
-	ns->litr3n     += nf->softstemn_to_litr3n;
-	ns->softstemn  -= nf->softstemn_to_litr3n;
-	ns->litr4n     += nf->softstemn_to_litr4n;
-	ns->softstemn  -= nf->softstemn_to_litr4n;
-
-	/* live wood turnover to dead wood */
-	ns->deadstemn  += nf->livestemn_to_deadstemn;
-	ns->livestemn  -= nf->livestemn_to_deadstemn;
-	ns->retransn   += nf->livestemn_to_retransn;   /* N retranslocation */
-	ns->livestemn  -= nf->livestemn_to_retransn;
-	ns->deadcrootn += nf->livecrootn_to_deadcrootn;
-	ns->livecrootn -= nf->livecrootn_to_deadcrootn;
-	ns->retransn   += nf->livecrootn_to_retransn;   /* N retranslocation */
-	ns->livecrootn -= nf->livecrootn_to_retransn;
-
-
-	/* Litter and soil decomposition fluxes */
-	/* Fluxes out of coarse woody debris into litter pools */
-	ns->litr2n     += nf->cwdn_to_litr2n;
-	ns->cwdn       -= nf->cwdn_to_litr2n;
-	ns->litr3n     += nf->cwdn_to_litr3n;
-	ns->cwdn       -= nf->cwdn_to_litr3n;
-	ns->litr4n     += nf->cwdn_to_litr4n;
-	ns->cwdn       -= nf->cwdn_to_litr4n;
+	apply_transfers(nitrogen_plant, NROWS(nitrogen_plant), nf, ns, woody, 0);
 
 	if (ns->cwdn < 0)
 	{
@@ -573,219 +446,43 @@ int alloc, int woody, int evergreen)
 		nf->cwdn_to_litr4n += ns->cwdn * nf->cwdn_to_litr4n/cwdnflux;
 		ns->cwdn = 0;
 	}
+
 	/* N fluxes for immobilization and mineralization */
-	ns->soil1n     += nf->litr1n_to_soil1n;
-	ns->litr1n     -= nf->litr1n_to_soil1n;
-	if (nf->sminn_to_soil1n_l1 < 0.0)
-	{
-		nf->sminn_to_nvol_l1s1 = -epc->denitrif_prop * nf->sminn_to_soil1n_l1;
-	}
-	else
-	{
-		nf->sminn_to_nvol_l1s1 = 0.0;
-	}
-	ns->soil1n             += nf->sminn_to_soil1n_l1;
-	nf->sminn_to_soil_SUM  += nf->sminn_to_soil1n_l1;
-	ns->nvol_snk	       += nf->sminn_to_nvol_l1s1;
-	nf->sminn_to_soil_SUM  += nf->sminn_to_nvol_l1s1;
-	
-	ns->soil2n     += nf->litr2n_to_soil2n;
-	ns->litr2n     -= nf->litr2n_to_soil2n;
-	if (nf->sminn_to_soil2n_l2 < 0.0)
-	{
-		nf->sminn_to_nvol_l2s2 = -epc->denitrif_prop * nf->sminn_to_soil2n_l2;
-	}
-	else
-	{
-		nf->sminn_to_nvol_l2s2 = 0.0;
-	}
-	ns->soil2n            += nf->sminn_to_soil2n_l2;
-	nf->sminn_to_soil_SUM += nf->sminn_to_soil2n_l2;
-	ns->nvol_snk          += nf->sminn_to_nvol_l2s2;
-	nf->sminn_to_soil_SUM += nf->sminn_to_nvol_l2s2;
-	
-	ns->litr2n     += nf->litr3n_to_litr2n;
-	ns->litr3n     -= nf->litr3n_to_litr2n;
-	
-	ns->soil3n     += nf->litr4n_to_soil3n;
-	ns->litr4n     -= nf->litr4n_to_soil3n;
-	if (nf->sminn_to_soil3n_l4 < 0.0)
-	{
-		nf->sminn_to_nvol_l4s3 = -epc->denitrif_prop * nf->sminn_to_soil3n_l4;
-	}
-	else
-	{
-		nf->sminn_to_nvol_l4s3 = 0.0;
-	}
-	ns->soil3n            += nf->sminn_to_soil3n_l4;
-	nf->sminn_to_soil_SUM += nf->sminn_to_soil3n_l4;
-	ns->nvol_snk          += nf->sminn_to_nvol_l4s3;
-	nf->sminn_to_soil_SUM += nf->sminn_to_nvol_l4s3;
-	
-	ns->soil2n     += nf->soil1n_to_soil2n;
-	ns->soil1n     -= nf->soil1n_to_soil2n;
-	if (nf->sminn_to_soil2n_s1 < 0.0)
-	{
-		nf->sminn_to_nvol_s1s2 = -epc->denitrif_prop * nf->sminn_to_soil2n_s1;
-	}
-	else
-	{
-		nf->sminn_to_nvol_s1s2 = 0.0;
-	}
-	ns->soil2n            += nf->sminn_to_soil2n_s1;
-	nf->sminn_to_soil_SUM += nf->sminn_to_soil2n_s1;
-	ns->nvol_snk          += nf->sminn_to_nvol_s1s2;
-	nf->sminn_to_soil_SUM += nf->sminn_to_nvol_s1s2;
-	
-	ns->soil3n     += nf->soil2n_to_soil3n;
-	ns->soil2n     -= nf->soil2n_to_soil3n;
-	if (nf->sminn_to_soil3n_s2 < 0.0)
-	{
-		nf->sminn_to_nvol_s2s3 = -epc->denitrif_prop * nf->sminn_to_soil3n_s2;
-	}
-	else
-	{
-		nf->sminn_to_nvol_s2s3 = 0.0;
-	}
-	ns->soil3n            += nf->sminn_to_soil3n_s2;
-	nf->sminn_to_soil_SUM += nf->sminn_to_soil3n_s2;
-	ns->nvol_snk          += nf->sminn_to_nvol_s2s3;
-	nf->sminn_to_soil_SUM += nf->sminn_to_nvol_s2s3;
-	
-	ns->soil4n     += nf->soil3n_to_soil4n;
-	ns->soil3n     -= nf->soil3n_to_soil4n;
-	if (nf->sminn_to_soil4n_s3 < 0.0)
+	for (i = 0; i < NROWS(nitrogen_decomp); i++)
 	{
-		nf->sminn_to_nvol_s3s4 = -epc->denitrif_prop * nf->sminn_to_soil4n_s3;
-	}
-	else
-	{
-		nf->sminn_to_nvol_s3s4 = 0.0;
+		row = &nitrogen_decomp[i];
+
+		FIELD(ns, row->dst) += FIELD(nf, row->flux);
+		FIELD(ns, row->src) -= FIELD(nf, row->flux);
+
+		if (row->sminn_flux == UPD_NONE) continue;
+
+		sminn_flux = FIELD(nf, row->sminn_flux);
+		if (sminn_flux < 0.0)
+			nvol_flux = -epc->denitrif_prop * sminn_flux;
+		else
+			nvol_flux = 0.0;
+		FIELD(nf, row->nvol_flux) = nvol_flux;
+
+		FIELD(ns, row->dst)   += sminn_flux;
+		nf->sminn_to_soil_SUM += sminn_flux;
+		ns->nvol_snk          += nvol_flux;
+		nf->sminn_to_soil_SUM += nvol_flux;
 	}
-	ns->soil4n            += nf->sminn_to_soil4n_s3;
-	nf->sminn_to_soil_SUM += nf->sminn_to_soil4n_s3;
-	ns->nvol_snk          += nf->sminn_to_nvol_s3s4;
-	nf->sminn_to_soil_SUM += nf->sminn_to_nvol_s3s4;
-	
+
 	nf->sminn_to_nvol_s4  = epc->denitrif_prop * nf->soil4n_to_sminn;
 	nf->sminn_to_soil_SUM -= nf->soil4n_to_sminn;
 	ns->soil4n            -= nf->soil4n_to_sminn;
 	ns->nvol_snk          += nf->sminn_to_nvol_s4;
 	nf->sminn_to_soil_SUM += nf->sminn_to_nvol_s4;
 
-	/* Bulk denitrification of soil mineral N */
-	ns->nvol_snk            += nf->sminn_to_denitrif;
-	
-	/* Plant allocation flux, from N retrans pool */
-	ns->npool     += nf->retransn_to_npool;
-	ns->retransn  -= nf->retransn_to_npool;
+	apply_transfers(nitrogen_alloc, NROWS(nitrogen_alloc), nf, ns, woody, 0);
 
-		
-	/* Daily allocation fluxes */
-	/* Daily leaf allocation fluxes */
-	ns->leafn          += nf->npool_to_leafn;
-	ns->npool          -= nf->npool_to_leafn;
-	ns->leafn_storage  += nf->npool_to_leafn_storage;
-	ns->npool          -= nf->npool_to_leafn_storage;
-	/* Daily fine root allocation fluxes */
-	ns->frootn         += nf->npool_to_frootn;
-	ns->npool          -= nf->npool_to_frootn;
-	ns->frootn_storage += nf->npool_to_frootn_storage;
-	ns->npool          -= nf->npool_to_frootn_storage;
-	/* Daily fruit allocation fluxes - Hidy 2013. */
-	ns->fruitn          += nf->npool_to_fruitn;
-	ns->npool           -= nf->npool_to_fruitn;
-	ns->fruitn_storage  += nf->npool_to_fruitn_storage;
-	ns->npool           -= nf->npool_to_fruitn_storage;
-	
-	/* TREE-specific and NON-WOODY SPECIFIC fluxes */
-	if (woody)
-	{
-		/* Daily live stem allocation fluxes */
-		ns->livestemn          += nf->npool_to_livestemn;
-		ns->npool              -= nf->npool_to_livestemn;
-		ns->livestemn_storage  += nf->npool_to_livestemn_storage;
-		ns->npool              -= nf->npool_to_livestemn_storage;
-		/* Daily dead stem allocation fluxes */
-		ns->deadstemn          += nf->npool_to_deadstemn;
-		ns->npool              -= nf->npool_to_deadstemn;
-		ns->deadstemn_storage  += nf->npool_to_deadstemn_storage;
-		ns->npool              -= nf->npool_to_deadstemn_storage;
-		/* Daily live coarse root allocation fluxes */
-		ns->livecrootn         += nf->npool_to_livecrootn;
-		ns->npool              -= nf->npool_to_livecrootn;
-		ns->livecrootn_storage += nf->npool_to_livecrootn_storage;
-		ns->npool              -= nf->npool_to_livecrootn_storage;
-		/* Daily dead coarse root allocation fluxes */
-		ns->deadcrootn         += nf->npool_to_deadcrootn;
-		ns->npool              -= nf->npool_to_deadcrootn;
-		ns->deadcrootn_storage += nf->npool_to_deadcrootn_storage;
-		ns->npool              -= nf->npool_to_deadcrootn_storage;
-	}
-	else
-	{
-		/* Daily softstem allocation fluxes - Hidy 2013. */
-		ns->softstemn          += nf->npool_to_softstemn;
-		ns->npool              -= nf->npool_to_softstemn;
-		ns->softstemn_storage  += nf->npool_to_softstemn_storage;
-		ns->npool              -= nf->npool_to_softstemn_storage;
-	}
-	
-	
 	/* Annual allocation fluxes, one day per year */
 	if (alloc)
 	{
-		/* Move storage material into transfer compartments on the annual
-		allocation day. This is a special case, where a flux is assessed in
-		the state_variable update routine.  This is required to have the
-		allocation of excess C and N show up as new growth in the next growing
-		season, instead of two growing seasons from now. */
-		nf->leafn_storage_to_leafn_transfer = ns->leafn_storage;
-		nf->frootn_storage_to_frootn_transfer = ns->frootn_storage;
-		/* fruit simulation - Hidy 2013. */
-		nf->fruitn_storage_to_fruitn_transfer = ns->fruitn_storage;
-		/* TREE-specific and NON-WOODY SPECIFIC fluxes */
-		if (woody)
-		{
-			nf->livestemn_storage_to_livestemn_transfer = ns->livestemn_storage;
-			nf->deadstemn_storage_to_deadstemn_transfer = ns->deadstemn_storage;
-			nf->livecrootn_storage_to_livecrootn_transfer = ns->livecrootn_storage;
-			nf->deadcrootn_storage_to_deadcrootn_transfer = ns->deadcrootn_storage;
-		}
-		else
-		{
-			/* softstem simulation - Hidy 2013. */
-			nf->softstemn_storage_to_softstemn_transfer = ns->softstemn_storage;
-		}
-		/* update states variables */
-		ns->leafn_transfer    += nf->leafn_storage_to_leafn_transfer;
-		ns->leafn_storage     -= nf->leafn_storage_to_leafn_transfer;
-		ns->frootn_transfer   += nf->frootn_storage_to_frootn_transfer;
-		ns->frootn_storage    -= nf->frootn_storage_to_frootn_transfer;
-		/* fruit simulation - Hidy 2013. */
-		ns->fruitn_transfer    += nf->fruitn_storage_to_fruitn_transfer;
-		ns->fruitn_storage     -= nf->fruitn_storage_to_fruitn_transfer;
-
-		
-		/* TREE-specific and NON-WOODY SPECIFIC fluxes */
-		if (woody)
-		{
-			ns->livestemn_transfer  += nf->livestemn_storage_to_livestemn_transfer;
-			ns->livestemn_storage   -= nf->livestemn_storage_to_livestemn_transfer;
-			ns->deadstemn_transfer  += nf->deadstemn_storage_to_deadstemn_transfer;
-			ns->deadstemn_storage   -= nf->deadstemn_storage_to_deadstemn_transfer;
-			ns->livecrootn_transfer += nf->livecrootn_storage_to_livecrootn_transfer;
-			ns->livecrootn_storage  -= nf->livecrootn_storage_to_livecrootn_transfer;
-			ns->deadcrootn_transfer += nf->deadcrootn_storage_to_deadcrootn_transfer;
-			ns->deadcrootn_storage  -= nf->deadcrootn_storage_to_deadcrootn_transfer;
-		}
-		else
-		{
-			/* softstem simulation - Hidy 2013. */
-			ns->softstemn_transfer    += nf->softstemn_storage_to_softstemn_transfer;
-			ns->softstemn_storage     -= nf->softstemn_storage_to_softstemn_transfer;
+		apply_transfers(nitrogen_annual, NROWS(nitrogen_annual), nf, ns, woody, 1);
 
-		}
 		/* for deciduous system, force leafn and frootn to exactly 0.0 on the
 		last day */
 		if (!evergreen)
@@ -793,7 +490,7 @@ int alloc, int woody, int evergreen)
 			if (ns->leafn < 1e-10) ns->leafn = 0.0;
 			if (ns->frootn < 1e-10) ns->frootn = 0.0;
 		}
-	} /* end if annual allocation day */ 
-	
+	} /* end if annual allocation day */
+
 	return (!ok);
 }
@@ -0,0 +1,135 @@
+/*
+tempresp.c
+tabulated temperature response functions (Q10 and Lloyd-Taylor) shared by
+maintenance respiration, decomposition and photosynthesis
+
+The response functions depend only on temperature, so they are tabulated once
+(at the first call) on a regular grid of TEMPRESP_STEP (0.01 deg C) with
+TEMPRESP_NT nodes starting at tempresp_tmin, and evaluated by linear interpolation.
+The relative interpolation error is bounded by h*h/8 * max|f''/f|, which is
+below 1e-6 for all tables (see tempresp_maxrelerr() and tempresp_bench).
+Outside the tabulated range the exact function is evaluated.
+Compiling with -DTEMPRESP_EXACT switches off the tables.
+
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+Biome-BGCMuSo v4.0.2
+Original code: Copyright 2000, Peter E. Thornton
+Numerical Terradynamic Simulation Group, The University of Montana, USA
+Modified code: Copyright 2016, D. Hidy [dori.hidy@gmail.com]
+Hungarian Academy of Sciences, Hungary
+See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentation, model executable and example input files.
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "bgc_struct.h"
+#include "bgc_func.h"
+#include "bgc_constants.h"
+
+#define TEMPRESP_STEP   0.01   /* (deg C) resolution of the tables */
+#define TEMPRESP_NT     10001  /* number of nodes: 100 deg C range */
+
+/* (deg C) lower end of the tables: Lloyd-Taylor is singular at -46.02 C and
+it is used by decomp() only above -10 C */
+static const double tempresp_tmin[N_TEMPRESP] = {-40.0, -10.0, -40.0, -40.0, -40.0, -40.0};
+
+static double tempresp_table[N_TEMPRESP][TEMPRESP_NT];
+static int tempresp_ready = 0;
+
+static void tempresp_init(void);
+
+double tempresp_exact(int func, double t)
+{
+	double tk;
+
+	switch (func)
+	{
+	/* maintenance respiration, Q10 = Q10_VALUE, reference temperature 20 C (Ryan 1991) */
+	case TR_Q10_MR:
+		return pow(Q10_VALUE, (t-20.0)/10.0);
+
+	/* decomposition rate scalar, Lloyd and Taylor (1994) eqn. 11 with 25 C reference */
+	case TR_LLOYDTAYLOR:
+		tk = t + 273.15;
+		return exp(308.56*((1.0/71.02)-(1.0/(tk-227.13))));
+
+	/* photosynthesis kinetic constants relative to their 25 C values
+	(Woodrow and Berry 1980, De Pury and Farquhar 1997); see photosynthesis.c */
+	case TR_PSN_KO:
+		return pow(1.2, (t-25.0)/10.0);
+	case TR_PSN_KC:
+		if (t > 15.0) return pow(2.1, (t-25.0)/10.0);
+		else          return pow(1.8*2.1, (t-15.0)/10.0) / 2.1;
+	case TR_PSN_ACT:
+		if (t > 15.0) return pow(2.4, (t-25.0)/10.0);
+		else          return pow(1.8*2.4, (t-15.0)/10.0) / 2.4;
+	case TR_PSN_KP:
+		return pow(2.1, (t-25.0)/10.0);
+
+	default:
+		printf("Error in tempresp_exact(): unknown response function %i\n", func);
+		return 0.0;
+	}
+}
+
+double tempresp(int func, double t)
+{
+#ifdef TEMPRESP_EXACT
+	return tempresp_exact(func, t);
+#else
+	double x, frac;
+	int i;
+	const double* tab;
+
+	if (!tempresp_ready) tempresp_init();
+
+	if (func < 0 || func >= N_TEMPRESP) return tempresp_exact(func, t);
+
+	/* out of the tabulated range (or NaN): exact evaluation */
+	x = (t - tempresp_tmin[func]) / TEMPRESP_STEP;
+	if (!(x >= 0 && x < TEMPRESP_NT - 1)) return tempresp_exact(func, t);
+
+	i = (int) x;
+	frac = x - i;
+
+	tab = tempresp_table[func];
+	return tab[i] + frac * (tab[i+1] - tab[i]);
+#endif
+}
+
+double tempresp_maxrelerr(int func)
+{
+	/* maximum relative error of the interpolation, checked at the midpoints
+	and quarter points of every interval of the table */
+	int i, k;
+	double t, exact, err;
+	double maxerr = 0;
+
+	for (i = 0; i < TEMPRESP_NT - 1; i++)
+	{
+		for (k = 1; k < 4; k++)
+		{
+			t = tempresp_tmin[func] + (i + 0.25*k) * TEMPRESP_STEP;
+			exact = tempresp_exact(func, t);
+			err = fabs(tempresp(func, t) - exact) / exact;
+			if (err > maxerr) maxerr = err;
+		}
+	}
+
+	return maxerr;
+}
+
+static void tempresp_init(void)
+{
+	int func, i;
+
+	for (func = 0; func < N_TEMPRESP; func++)
+	{
+		for (i = 0; i < TEMPRESP_NT; i++)
+			tempresp_table[func][i] = tempresp_exact(func, tempresp_tmin[func] + i * TEMPRESP_STEP);
+	}
+
+	tempresp_ready = 1;
+}
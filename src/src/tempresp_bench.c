@@ -0,0 +1,68 @@
+/*
+tempresp_bench.c
+accuracy and speed benchmark of the tabulated temperature response functions (tempresp.c)
+build and run from the src directory: make bench_tempresp
+
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+Biome-BGCMuSo v4.0.2
+Original code: Copyright 2000, Peter E. Thornton
+Numerical Terradynamic Simulation Group, The University of Montana, USA
+Modified code: Copyright 2016, D. Hidy [dori.hidy@gmail.com]
+Hungarian Academy of Sciences, Hungary
+See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentation, model executable and example input files.
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "bgc_struct.h"
+#include "bgc_func.h"
+#include "bgc_constants.h"
+
+#define NCALL 2000000    /* number of evaluations per timing loop */
+
+int main(int argc, char* argv[])
+{
+	static const char* name[N_TEMPRESP] = {"Q10 maint. resp.", "Lloyd-Taylor", "psn Ko", "psn Kc", "psn act", "psn Kp"};
+	int func, i;
+	double* temp;
+	double sum_exact, sum_table, t_exact, t_table;
+	clock_t c0;
+
+	/* pseudo-random temperatures covering the range of daily air and soil temperatures */
+	temp = (double*) malloc(NCALL * sizeof(double));
+	if (!temp)
+	{
+		printf("Error allocating memory in tempresp_bench\n");
+		return EXIT_FAILURE;
+	}
+	srand(1);
+	for (i = 0; i < NCALL; i++) temp[i] = -10.0 + 45.0 * rand() / (double) RAND_MAX;
+
+	printf("tabulated temperature responses: linear interpolation, 0.01 deg C resolution\n");
+	printf("%-18s %14s %14s %14s %9s\n", "function", "max.rel.error", "exact(ns)", "table(ns)", "speedup");
+
+	for (func = 0; func < N_TEMPRESP; func++)
+	{
+		/* first call builds the tables, keep it out of the timing */
+		sum_table = tempresp(func, 0.0);
+
+		c0 = clock();
+		sum_exact = 0;
+		for (i = 0; i < NCALL; i++) sum_exact += tempresp_exact(func, temp[i]);
+		t_exact = (double)(clock() - c0) / CLOCKS_PER_SEC;
+
+		c0 = clock();
+		sum_table = 0;
+		for (i = 0; i < NCALL; i++) sum_table += tempresp(func, temp[i]);
+		t_table = (double)(clock() - c0) / CLOCKS_PER_SEC;
+
+		printf("%-18s %14.3e %14.2f %14.2f %8.2fx   (checksum diff %.2e)\n", name[func], tempresp_maxrelerr(func),
+			1e9 * t_exact / NCALL, 1e9 * t_table / NCALL, t_table > 0 ? t_exact / t_table : 0.0,
+			(sum_table - sum_exact) / sum_exact);
+	}
+
+	free(temp);
+	return EXIT_SUCCESS;
+}
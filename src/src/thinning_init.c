@@ -120,7 +120,7 @@ int thinning_init(file init, control_struct* ctrl, thinning_struct* THN)
 
 	if (THN->THN_flag == 2)
 	{
-		fclose (THN_file.ptr);
+		file_close (&THN_file);
 	}
 
 	THN->mgmd = -1;
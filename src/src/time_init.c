@@ -81,6 +81,9 @@ int time_init(file init, control_struct *ctrl)
 		ok=0;
 	}
 
+	/* convergence criteria of the spinup: command line (--spinup-stop) only */
+	spinconv_defaults(ctrl);
+
 	
 	return (!ok);
 }
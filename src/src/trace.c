@@ -0,0 +1,191 @@
+/*
+trace.c
+timeline of a run in the Chrome trace format (JSON array of events, can be
+opened in chrome://tracing and in Perfetto): with --trace <file> the phases of
+the run (reading the inputs, metarr_init, prephenology, the spinup cycles, the
+simulated years, the annual output, the closing of the output files and the
+restart writing) are written as begin/end events, enclosed in TRACE_BEGIN and
+TRACE_END (see bgc_func.h), which cost only a test of trace_on if the tracing
+is off.
+Every event is appended to the file with one write (the file is opened with
+O_APPEND), so several processes can write the same trace: the scenario
+children of a run, or the runs of many sites started with the same --trace
+file. The process id is the pid and the thread id of the events, the process
+is named after the init file (and the scenario), the site and the scenario are
+arguments of the events. The opening bracket of the array is written by the
+first process, the test of the empty file and the write are done under a
+write lock of the file (fcntl), so two runs starting together do not both
+write it. The closing bracket of the array is optional in the format, it is
+not written.
+
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+Biome-BGCMuSo v4.0.2
+Copyright 2016, D. Hidy [dori.hidy@gmail.com]
+Hungarian Academy of Sciences, Hungary
+See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentation, model executable and example input files.
+*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+#include "bgc_struct.h"
+#include "bgc_func.h"
+
+int trace_on = 0;
+
+#ifndef _WIN32
+static int trace_fd = -1;
+#else
+static FILE* trace_file = NULL;
+#endif
+static int trace_pid = 0;
+static char trace_site[128];
+static char trace_scenario[64];
+
+/* microseconds of the wall clock (the same time axis for all the processes) */
+static double trace_us(void)
+{
+#ifdef _WIN32
+	return 1e6 * (double) clock() / CLOCKS_PER_SEC;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return 1e6 * (double) ts.tv_sec + 1e-3 * (double) ts.tv_nsec;
+#endif
+}
+
+static void trace_write(const char* line, size_t len)
+{
+#ifndef _WIN32
+	if (write(trace_fd, line, len) != (ssize_t) len) trace_on = 0;
+#else
+	if (fwrite(line, 1, len, trace_file) != len || fflush(trace_file)) trace_on = 0;
+#endif
+}
+
+/* name of the process in the viewer: the init file and the scenario */
+static void trace_name_process(void)
+{
+	char line[400];
+	int len;
+
+	len = snprintf(line, sizeof(line), "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s%s%s\"}},\n",
+		trace_pid, trace_pid, trace_site, trace_scenario[0] ? " " : "", trace_scenario);
+	if (len > 0 && len < (int) sizeof(line)) trace_write(line, (size_t) len);
+}
+
+int trace_open(const char* name, const char* site)
+{
+	const char* p;
+	int i;
+
+#ifndef _WIN32
+	struct stat st;
+	struct flock lock;
+
+	trace_fd = open(name, O_WRONLY | O_CREAT | O_APPEND, 0644);
+	if (trace_fd < 0)
+	{
+		printf("Error opening trace file %s\n", name);
+		return 1;
+	}
+	trace_pid = (int) getpid();
+	trace_on = 1;
+	/* the first process writing the file opens the array (under the lock of the file) */
+	memset(&lock, 0, sizeof(lock));
+	lock.l_type = F_WRLCK;
+	lock.l_whence = SEEK_SET;
+	if (fcntl(trace_fd, F_SETLKW, &lock))
+	{
+		printf("Error locking trace file %s\n", name);
+		trace_close();
+		return 1;
+	}
+	if (!fstat(trace_fd, &st) && st.st_size == 0) trace_write("[\n", 2);
+	lock.l_type = F_UNLCK;
+	fcntl(trace_fd, F_SETLK, &lock);
+#else
+	trace_file = fopen(name, "a");
+	if (!trace_file)
+	{
+		printf("Error opening trace file %s\n", name);
+		return 1;
+	}
+	trace_on = 1;
+	if (ftell(trace_file) == 0) trace_write("[\n", 2);
+#endif
+
+	/* site: the init file name without the directory, quotes and backslashes are left out */
+	p = strrchr(site, '/');
+	if (!p) p = strrchr(site, '\\');
+	p = p ? p + 1 : site;
+	for (i = 0; *p && i < (int) sizeof(trace_site) - 1; p++)
+	{
+		if (*p != '"' && *p != '\\') trace_site[i++] = *p;
+	}
+	trace_site[i] = '\0';
+	trace_scenario[0] = '\0';
+
+	trace_name_process();
+	if (!trace_on)
+	{
+		printf("Error writing trace file %s\n", name);
+		trace_close();
+		return 1;
+	}
+	return 0;
+}
+
+/* a scenario child (scenario_branch) continues the trace as a new process */
+void trace_fork(const char* scenario)
+{
+#ifndef _WIN32
+	trace_pid = (int) getpid();
+#endif
+	strncpy(trace_scenario, scenario, sizeof(trace_scenario) - 1);
+	trace_scenario[sizeof(trace_scenario) - 1] = '\0';
+	trace_name_process();
+}
+
+/* ph: 'B' begin or 'E' end of a phase; year < 0: no year argument */
+void trace_event(char ph, const char* name, int year)
+{
+	char line[400];
+	char yeararg[32];
+	int len;
+
+	if (year >= 0) snprintf(yeararg, sizeof(yeararg), ",\"year\":%d", year);
+	else yeararg[0] = '\0';
+
+	len = snprintf(line, sizeof(line), "{\"name\":\"%s\",\"cat\":\"muso\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,"
+		"\"args\":{\"site\":\"%s\",\"scenario\":\"%s\"%s}},\n",
+		name, ph, trace_us(), trace_pid, trace_pid, trace_site, trace_scenario, yeararg);
+	if (len > 0 && len < (int) sizeof(line)) trace_write(line, (size_t) len);
+}
+
+int trace_close(void)
+{
+	int ok = 1;
+
+	/* the file is closed also after a write error (trace_on cleared by trace_write) */
+	trace_on = 0;
+#ifndef _WIN32
+	if (trace_fd < 0) return 0;
+	if (close(trace_fd)) ok = 0;
+	trace_fd = -1;
+#else
+	if (!trace_file) return 0;
+	if (fclose(trace_file)) ok = 0;
+	trace_file = NULL;
+#endif
+	if (!ok) printf("Error closing trace file\n");
+
+	return (!ok);
+}
@@ -32,6 +32,7 @@ See the website of Biome-BGCMuSo at http://nimbus.elte.hu/bbgc/ for documentatio
 #include "pointbgc_struct.h"   /* data structures for point driver */
 #include "bgc_io.h"
 #include "pointbgc_func.h"
+#include "misc_func.h"
 //#define DEBUG
 
 
@@ -89,6 +90,9 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 	/* irrigation variables - by Hidy 2015*/
 	irrigation_struct       IRG;
 
+	/* compiled management calendar */
+	mgmcalendar_struct      mgmcal;
+
 	/* GSI variables - by Hidy 2009. */
 	GSI_struct      GSI;
 
@@ -104,6 +108,8 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 
 	/* photosynthesis structures */
 	psn_struct         psn_sun, psn_shade;
+	psn_struct*        psn_canopy[2];
+	activity_struct    act;
 	
 	/* temporary nitrogen variables for decomposition and allocation */
 	ntemp_struct       nt;
@@ -189,7 +195,7 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 	/* allocate memory for local output arrays */
 	if (ok && dayout) 
 	{
-		dayarr = (float*) malloc(ctrl.ndayout * sizeof(float));
+		dayarr = (float*) mem_alloc(MEM_OUTPUT, ctrl.ndayout * sizeof(float));
 		if (!dayarr)
 		{
 			printf("Error allocating for local daily output array in bgc()\n");
@@ -198,7 +204,7 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 	}
 	if (ok && ctrl.domonavg) 
 	{
-		monavgarr = (float*) malloc(ctrl.ndayout * sizeof(float));
+		monavgarr = (float*) mem_alloc(MEM_OUTPUT, ctrl.ndayout * sizeof(float));
 		if (!monavgarr)
 		{
 			printf("Error allocating for monthly average output array in bgc()\n");
@@ -207,7 +213,7 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 	}
 	if (ok && ctrl.doannavg) 
 	{
-		annavgarr = (float*) malloc(ctrl.ndayout * sizeof(float));
+		annavgarr = (float*) mem_alloc(MEM_OUTPUT, ctrl.ndayout * sizeof(float));
 		if (!annavgarr)
 		{
 			printf("Error allocating for annual average output array in bgc()\n");
@@ -216,7 +222,7 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 	}
 	if (ok && ctrl.doannual)
 	{
-		annarr = (float*) malloc(ctrl.nannout * sizeof(float));
+		annarr = (float*) mem_alloc(MEM_OUTPUT, ctrl.nannout * sizeof(float));
 		if (!annarr)
 		{
 			printf("Error allocating for local annual output array in bgc()\n");
@@ -226,7 +232,7 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 	/* allocate space for the output map pointers */
 	if (ok) 
 	{
-		output_map = (double**) malloc(NMAP * sizeof(double*));
+		output_map = (double**) mem_alloc(MEM_OUTPUT, NMAP * sizeof(double*));
 		if (!output_map)
 		{
 			printf("Error allocating for output map in output_map_init()\n");
@@ -293,9 +299,9 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 	if (ctrl.GSI_flag)
 	{
 		
-		if (ok && GSI_calculation(&metarr, &ctrl, &sitec, &epc, &GSI, &phenarr))
+		if (ok && GSI_calculation_cached(&metarr, &ctrl, &sitec, &epc, &GSI, &phenarr))
 		{
-			printf("Error in call to GSI_calculation(), from bgc()\n");
+			printf("Error in call to GSI_calculation_cached(), from bgc()\n");
 			ok=0;
 		}
 
@@ -317,15 +323,24 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 #endif
 
 	/* determine phenological signals */
-	if (ok && prephenology(bgcout->log_file, &ctrl, &epc, &sitec, &metarr, &phenarr))
+	TRACE_BEGIN("prephenology");
+	if (ok && prephenology_cached(bgcout->log_file, &ctrl, &epc, &sitec, &metarr, &phenarr))
 	{
-		printf("Error in call to prephenology(), from bgc()\n");
+		printf("Error in call to prephenology_cached(), from bgc()\n");
 		ok=0;
 	}
+	TRACE_END("prephenology");
 	
 #ifdef DEBUG
 	printf("done prephenology\n");
 #endif
+
+	/* management days of the input arrays into the management calendar */
+	if (ok && mgm_calendar_init(&ctrl, &FRZ, &GRZ, &HRV, &MOW, &PLT, &PLG, &THN, &IRG, &mgmcal))
+	{
+		printf("Error in call to mgm_calendar_init(), from bgc()\n");
+		ok=0;
+	}
 	
 	/* calculate the annual average air temperature for use in soil 
 	temperature corrections. This code added 9 February 1999, in
@@ -338,6 +353,13 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 	}
 	tair_annavg /= (double)nmetdays;
 
+	/* soil temperature of the layers before the first call of multilayer_tsoil (the layers
+	are averaged by multilayer_hydrolparams on the first simulation day) */
+	for (i=0 ; i<N_SOILLAYERS ; i++)
+	{
+		metv.tsoil[i] = sitec.tair_annavg;
+	}
+
 
 		/* set the initial rates of litterfall and live wood turnover */
 	if (epc.evergreen)
@@ -396,8 +418,11 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 	/* !!!!!!!!!!!!!!!!!!!!!!! */
 	/* BEGIN OF THE ANNUAL LOOP */
 
+	if (runstatus_on) runstatus_phase("transient", ctrl.simyears);
+
 	for (simyr=0 ; ok && simyr<ctrl.simyears ; simyr++)
 	{
+		TRACE_BEGIN_YEAR("transient year", ctrl.simstartyear+simyr);
 
 		/* output to screen to indicate start of simulation year */
 		if (ctrl.onscreen) printf("Year: %6d\n",ctrl.simstartyear+simyr);
@@ -419,6 +444,7 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 			/* Ndep from file */
 			metv.co2 = co2.co2ppm_array[simyr];
 		}
+		conduct_factors(&metv);
 
 		 /* atmospheric Ndep handling */
 		if (!(ndep.varndep))
@@ -438,6 +464,7 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 		/* BEGIN OF THE DAILY LOOP */
 		for (yday=0 ; ok && yday<NDAY_OF_YEAR ; yday++)
 		{
+			PROF_BEGIN(PT_DAY);
 
 #ifdef DEBUG
 			printf("year %d\tyday %d\n",simyr,yday);
@@ -467,11 +494,13 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 			nf = zero_nf;
 
 			/* MANAGEMENT DAYS - Hidy 2013. */
-			if (ok && management(&ctrl, &FRZ, &GRZ, &HRV, &MOW, &PLT, &PLG, &THN, &IRG))
+			PROF_BEGIN(PT_MANAGEMENT);
+			if (ok && management(&ctrl, &mgmcal, &FRZ, &GRZ, &HRV, &MOW, &PLT, &PLG, &THN, &IRG))
 			{
 				printf("Error in management days() from bgc()\n");
 				ok=0;
 			}
+			PROF_END(PT_MANAGEMENT);
 
 
 			/* soil hydrological parameters: psi and vwc  */
@@ -486,22 +515,28 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 #endif
 
 			/* daily meteorological variables from metarrays */
+			PROF_BEGIN(PT_DAYMET);
 			if (ok && daymet(&ctrl, &metarr, &sitec, &epc, &PLT, &HRV,&ws, &epv, &metv, &tair_annavg, metday))
 			{
 				printf("Error in daymet() from bgc()\n");
 				ok=0;
 			}
+			PROF_END(PT_DAYMET);
 			
 #ifdef DEBUG
 			printf("%d\t%d\tdone daymet\n",simyr,yday);
 #endif
 			
 			/* soil temperature calculations */
+			PROF_BEGIN(PT_TSOIL);
+			if (kernelrec_on) kernelrec_in(KR_TSOIL, 6, KR_ARG(yday), KR_ARG(epc), KR_ARG(sitec), KR_ARG(ws), KR_ARG(metv), KR_ARG(epv));
 			if (ok && multilayer_tsoil(yday, &epc, &sitec, &ws, &metv, &epv))
 			{
 				printf("Error in multilayer_tsoil() from bgc()\n");
 				ok=0;
 			}
+			if (kernelrec_on) kernelrec_out(KR_TSOIL);
+			PROF_END(PT_TSOIL);
 #ifdef DEBUG
 			printf("%d\t%d\tdone multilayer_tsoil\n",simyr,yday);
 #endif
@@ -516,6 +551,13 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 #ifdef DEBUG
 			printf("%d\t%d\tdone dayphen\n",simyr,yday);
 #endif
+
+			/* activity mask of the day: processes without work are skipped */
+			if (ok && activity_mask(&metv, &phen, &cs, &ns, &ws, GSI.snowcover_limit, &PLT, &THN, &MOW, &GRZ, &HRV, &PLG, &FRZ, &IRG, &act))
+			{
+				printf("Error in activity_mask() from bgc()\n");
+				ok=0;
+			}
 	
 
 			/* test for the annual allocation day */
@@ -524,11 +566,13 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 
 
 			/* phenology fluxes */
+			PROF_BEGIN(PT_PHENOLOGY);
 			if (ok && phenology(&ctrl, &epc, &phen, &epv, &cs, &cf, &ns, &nf))
 			{
 				printf("Error in phenology() from bgc()\n");
 				ok=0;
 			}
+			PROF_END(PT_PHENOLOGY);
 			
 #ifdef DEBUG
 			printf("%d\t%d\tdone phenology\n",simyr,yday);
@@ -538,11 +582,13 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 			/* !!!!!!!!!!!!!!!!!!!!!!!!!!!!!! Hidy 2011 - MULTILAYER SOIL!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! */
 
 			/* rooting depth */
+ 			 PROF_BEGIN(PT_ROOTDEPTH);
  			 if (ok && multilayer_rootdepth(&ctrl, &epc, &sitec, &phen,  &PLT, &HRV, &epv, &ns))
 			 {
 				printf("Error in multilayer_rootdepth() from bgc()\n");
 				ok=0;
 			 }
+ 			 PROF_END(PT_ROOTDEPTH);
 #ifdef DEBUG
 			printf("%d\t%d\tdone multilayer_rootdepth\n",simyr,yday);
 #endif
@@ -553,11 +599,13 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 			leaf area for sun and shade canopy fractions, then calculate
 			canopy radiation interception and transmission */
                         
+			PROF_BEGIN(PT_RADTRANS);
 			if (ok && radtrans(&cs, &epc, &metv, &epv, sitec.sw_alb))
 			{
 				printf("Error in radtrans() from bgc()\n");
 				ok=0;
 			}
+			PROF_END(PT_RADTRANS);
 			
 
 			
@@ -582,7 +630,7 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 
 	
 			/* snowmelt (when there is a snowpack) */
-			if (ok && ws.snoww && snowmelt(&metv, &wf, ws.snoww))
+			if (ok && act.snowmelt && snowmelt(&metv, &wf, ws.snoww))
 			{
 				printf("Error in snowmelt() from bgc()\n");
 				ok=0;
@@ -605,11 +653,13 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 #endif
 
        /* conductance - Hidy 2011 */
+			PROF_BEGIN(PT_CONDUCT);
 			if (ok && conduct_calc(&ctrl, &metv, &epc, &sitec, &epv, simyr))
 			{
 				printf("Error in conduct_calc() from bgc()\n");
 				ok=0;
 			}
+			PROF_END(PT_CONDUCT);
 			
 #ifdef DEBUG
 			printf("%d\t%d\tdone conduct_calc\n",simyr,yday);
@@ -617,11 +667,13 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 		
 			
 			/* daily maintenance respiration */
+			PROF_BEGIN(PT_MAINT_RESP);
 			if (ok && maint_resp(&cs, &ns, &epc, &metv, &cf, &epv))
 			{
 				printf("Error in m_resp() from bgc()\n");
 				ok=0;
 			}
+			PROF_END(PT_MAINT_RESP);
 
 #ifdef DEBUG
 			printf("%d\t%d\tdone maint resp\n",simyr,yday);
@@ -635,15 +687,19 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 			/* do canopy ET calculations whenever there is leaf area
 			displayed, since there may be intercepted water on the 
 			canopy that needs to be dealt with */
-			if (ok && cs.leafc && metv.dayl)
+			if (ok && act.canopy)
 			{
 	
 				/* evapo-transpiration */
+				PROF_BEGIN(PT_CANOPY_ET);
+				if (kernelrec_on) kernelrec_in(KR_CANOPY_ET, 4, KR_ARG(epc), KR_ARG(metv), KR_ARG(epv), KR_ARG(wf));
 				if (ok && canopy_et(&epc, &metv, &epv, &wf))
 				{
 					printf("Error in canopy_et() from bgc()\n");
 					ok=0;
 				}
+				if (kernelrec_on) kernelrec_out(KR_CANOPY_ET);
+				PROF_END(PT_CANOPY_ET);
 				
 #ifdef DEBUG
 				printf("%d\t%d\tdone canopy_et\n",simyr,yday);
@@ -655,72 +711,52 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 			keeps the occurrence of new growth consistent with the treatment
 			of litterfall and allocation */
 
-			if (ok && cs.leafc && phen.remdays_curgrowth && metv.dayl && ws.snoww <= GSI.snowcover_limit)
+			if (ok && act.psn)
 			{
-				/* SUNLIT canopy fraction photosynthesis */
+				/* SUNLIT and SHADED canopy fraction photosynthesis */
 				/* set the input variables */
-				psn_sun.c3 = epc.c3_flag;
-				psn_sun.co2 = metv.co2;
-				psn_sun.pa = metv.pa;
-				psn_sun.t = metv.tday;
+				psn_sun.c3 = psn_shade.c3 = epc.c3_flag;
+				psn_sun.co2 = psn_shade.co2 = metv.co2;
+				psn_sun.pa = psn_shade.pa = metv.pa;
+				psn_sun.t = psn_shade.t = metv.tday;
 				psn_sun.lnc = 1.0 / (epv.sun_proj_sla * epc.leaf_cn);
-				psn_sun.flnr = epc.flnr;
-				psn_sun.flnp = epc.flnp;
-				psn_sun.ppfd = metv.ppfd_per_plaisun;
-				/* convert conductance from m/s --> umol/m2/s/Pa, and correct
-				for CO2 vs. water vapor */
-				psn_sun.g = epv.gl_t_wv_sun * 1e6/(1.6*R*(metv.tday+273.15));
-				psn_sun.dlmr = epv.dlmr_area_sun;
-				if (ok && photosynthesis(&epc, &metv, &psn_sun))
-				{
-					printf("Error in photosynthesis() from bgc()\n");
-					ok=0;
-				}
-				
-#ifdef DEBUG
-				printf("%d\t%d\tdone sun psn\n",simyr,yday);
-#endif
-
-				epv.assim_sun = psn_sun.A;
-				
-				/* for the final flux assignment, the assimilation output
-				needs to have the maintenance respiration rate added, this
-				sum multiplied by the projected leaf area in the relevant canopy
-				fraction, and this total converted from umol/m2/s -> kgC/m2/d */
-	
-				cf.psnsun_to_cpool = (epv.assim_sun + epv.dlmr_area_sun) * epv.plaisun * metv.dayl * 12.011e-9; 
-				
-						
-				/* SHADED canopy fraction photosynthesis */
-				psn_shade.c3 = epc.c3_flag;
-				psn_shade.co2 = metv.co2;
-				psn_shade.pa = metv.pa;
-				psn_shade.t = metv.tday;
 				psn_shade.lnc = 1.0 / (epv.shade_proj_sla * epc.leaf_cn);
-				psn_shade.flnr = epc.flnr;
+				psn_sun.flnr = psn_shade.flnr = epc.flnr;
+				psn_sun.flnp = psn_shade.flnp = epc.flnp;
+				psn_sun.ppfd = metv.ppfd_per_plaisun;
 				psn_shade.ppfd = metv.ppfd_per_plaishade;
 				/* convert conductance from m/s --> umol/m2/s/Pa, and correct
 				for CO2 vs. water vapor */
+				psn_sun.g = epv.gl_t_wv_sun * 1e6/(1.6*R*(metv.tday+273.15));
 				psn_shade.g = epv.gl_t_wv_shade * 1e6/(1.6*R*(metv.tday+273.15));
+				psn_sun.dlmr = epv.dlmr_area_sun;
 				psn_shade.dlmr = epv.dlmr_area_shade;
-			
-				if (ok && photosynthesis(&epc, &metv, &psn_shade))
+
+				/* the two canopy fractions share the temperature dependent terms: solved in one batch */
+				psn_canopy[0] = &psn_sun;
+				psn_canopy[1] = &psn_shade;
+				PROF_BEGIN(PT_PHOTOSYNTHESIS);
+				if (kernelrec_on) kernelrec_in(KR_PHOTOSYNTHESIS, 4, KR_ARG(epc), KR_ARG(metv), KR_ARG(psn_sun), KR_ARG(psn_shade));
+				if (ok && photosynthesis_n(&epc, &metv, psn_canopy, 2))
 				{
-					printf("Error in photosynthesis() from bgc()\n");
+					printf("Error in photosynthesis_n() from bgc()\n");
 					ok=0;
 				}
-				
+				if (kernelrec_on) kernelrec_out(KR_PHOTOSYNTHESIS);
+				PROF_END(PT_PHOTOSYNTHESIS);
+
 #ifdef DEBUG
-				printf("%d\t%d\tdone shade_psn\n",simyr,yday);
+				printf("%d\t%d\tdone sun and shade psn\n",simyr,yday);
 #endif
 
+				epv.assim_sun = psn_sun.A;
 				epv.assim_shade = psn_shade.A;
 
 				/* for the final flux assignment, the assimilation output
 				needs to have the maintenance respiration rate added, this
 				sum multiplied by the projected leaf area in the relevant canopy
 				fraction, and this total converted from umol/m2/s -> kgC/m2/d */
-
+				cf.psnsun_to_cpool = (epv.assim_sun + epv.dlmr_area_sun) * epv.plaisun * metv.dayl * 12.011e-9; 
 				cf.psnshade_to_cpool = (epv.assim_shade + epv.dlmr_area_shade) * epv.plaishade * metv.dayl * 12.011e-9; 
 
 			} /* end of photosynthesis calculations */
@@ -753,11 +789,13 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 			/* !!!!!!!!!!!!!!!!!!!!!! TRANSPIRATION AND SOILPSI IN MULTILAYER SOIL!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! */
 		
 			/* Hidy 2010 - calculate the part-transpiration from total transpiration */
+			PROF_BEGIN(PT_TRANSPIRATION);
 			if (ok && multilayer_transpiration(&ctrl, &sitec, &epv, &ws, &wf))
 			{
 				printf("Error in multilayer_transpiration() from bgc()\n");
 				ok=0;
 			}
+			PROF_END(PT_TRANSPIRATION);
 #ifdef DEBUG
 			printf("%d\t%d\tdone multilayer_transpiration\n",simyr,yday);
 #endif
@@ -769,11 +807,15 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 			
 
 			/* daily litter and soil decomp and nitrogen fluxes */
+			PROF_BEGIN(PT_DECOMP);
+			if (kernelrec_on) kernelrec_in(KR_DECOMP, 9, KR_ARG(metv), KR_ARG(epc), KR_ARG(epv), KR_ARG(sitec), KR_ARG(cs), KR_ARG(cf), KR_ARG(ns), KR_ARG(nf), KR_ARG(nt));
 			if (ok && decomp(&metv,&epc,&epv,&sitec,&cs,&cf,&ns,&nf,&nt))
 			{
 				printf("Error in decomp() from bgc.c\n");
 				ok=0;
 			}
+			if (kernelrec_on) kernelrec_out(KR_DECOMP);
+			PROF_END(PT_DECOMP);
 			
 #ifdef DEBUG
 			printf("%d\t%d\tdone decomp\n",simyr,yday);
@@ -784,11 +826,13 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 			immobilization fluxes and plant growth N demand is resolved
 			here.  On days with no growth, no allocation occurs, but
 			immobilization fluxes are updated normally */
+			PROF_BEGIN(PT_DAILY_ALLOCATION);
 			if (ok && daily_allocation(&epc,&sitec,&cf,&cs,&nf,&ns,&epv,&nt))
 			{
 				printf("Error in daily_allocation() from bgc.c\n");
 				ok=0;
 			}
+			PROF_END(PT_DAILY_ALLOCATION);
 
 #ifdef DEBUG
 			printf("%d\t%d\tdone daily_allocation\n",simyr,yday);
@@ -839,17 +883,19 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 			/* Hidy 2013 - multilayer soil hydrology: percolation calculation based on PRCP, RUNOFF, EVAP, TRANS */
 			
 	               /* IRRIGATION - Hidy 2015. */
-			if (ok && irrigation(&ctrl, &IRG, &ws, &wf))
+			if (ok && act.IRG && irrigation(&ctrl, &IRG, &ws, &wf))
 			{
 				printf("Error in irrigation() from bgc()\n");
 				ok=0;
 			}
 
+			PROF_BEGIN(PT_HYDROLPROCESS);
 			if (ok && multilayer_hydrolprocess(&ctrl, &sitec, &epc, &epv, &ws, &wf))
 			{
 				printf("Error in multilayer_hydrolprocess() from bgc()\n");
 				ok=0;
 			}
+			PROF_END(PT_HYDROLPROCESS);
 
 #ifdef DEBUG
 			printf("%d\t%d\tdone multilayer_hydrolprocess\n",simyr,yday);
@@ -858,39 +904,17 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
                
 			/* !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! */
 
-			/* daily update of the water state variables */
-			if (ok && daily_water_state_update(&wf, &ws))
+			/* daily update of the water, carbon and nitrogen state variables */
+			PROF_BEGIN(PT_STATE_UPDATE);
+			if (ok && daily_state_update(&epc, &wf, &ws, &cf, &cs, &nf, &ns, annual_alloc, epc.woody, epc.evergreen))
 			{
-				printf("Error in daily_water_state_update() from bgc()\n");
+				printf("Error in daily_state_update() from bgc()\n");
 				ok=0;
 			}
+			PROF_END(PT_STATE_UPDATE);
 			
 #ifdef DEBUG
-			printf("%d\t%d\tdone water state update\n",simyr,yday);
-#endif
-		
-			
-
-			/* daily update of carbon state variables */
-			if (ok && daily_carbon_state_update(&cf, &cs, annual_alloc, epc.woody, epc.evergreen))
-			{
-				printf("Error in daily_carbon_state_update() from bgc()\n");
-				ok=0;
-			}
-
-#ifdef DEBUG
-			printf("%d\t%d\tdone carbon state update\n",simyr,yday);
-#endif
-
-			/* daily update of nitrogen state variables */
-			if (ok && daily_nitrogen_state_update(&epc, &nf, &ns, annual_alloc, epc.woody, epc.evergreen))
-			{
-				printf("Error in daily_nitrogen_state_update() from bgc()\n");
-				ok=0;
-			}
-			
-#ifdef DEBUG
-			printf("%d\t%d\tdone nitrogen state update\n",simyr,yday);
+			printf("%d\t%d\tdone state update\n",simyr,yday);
 #endif
 
 
@@ -898,54 +922,15 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 			/* !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!  MANAGEMENT SUBMODULES !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! */
 
 			
-			/* PLANTING - Hidy 2009. */
-			if (ok && planting(&ctrl, &epc, &PLT, &cf, &nf, &cs, &ns))
-			{
-				printf("Error in planting() from bgc()\n");
-				ok=0;
-			}
-
-		   	/* THINNIG - Hidy 2012. */
-			if (ok && thinning(&ctrl, &epc, &THN, &cf, &nf, &wf, &cs, &ns, &ws))
-			{
-				printf("Error in thinning() from bgc()\n");
-				ok=0;
-			}
-
-			/* MOWING - Hidy 2008. */
-			if (ok && mowing(&ctrl, &epc, &MOW, &cf, &nf, &wf, &cs, &ns, &ws))
-			{
-				printf("Error in mowing() from bgc()\n");
-				ok=0;
-			}
-
-			 /* GRAZING - Hidy 2009. */
-			if (ok && grazing(&ctrl, &epc, &GRZ, &cf, &nf, &wf, &cs, &ns, &ws))
-			{
-				printf("Error in grazing() from bgc()\n");
-				ok=0;
-			}
-	
-		   	/* HARVESTING - Hidy 2012. */
-			if (ok && harvesting(&ctrl, &epc, &HRV, &cf, &nf, &wf, &cs, &ns, &ws))
-			{
-				printf("Error in harvesting() from bgc()\n");
-				ok=0;
-			}
- 
-			/* PLOUGHING - Hidy 2012. */
-			if (ok && ploughing(&ctrl, &epc, &sitec, &metv,  &epv, &PLG, &cf, &nf, &wf, &cs, &ns, &ws))
+			/* planting, thinning, mowing, grazing, harvesting, ploughing and fertilizing (idle ones are skipped) */
+			PROF_BEGIN(PT_MGM_SUBMODULES);
+			if (ok && mgm_submodules(&ctrl, &epc, &sitec, &metv, &epv, &act, &PLT, &THN, &MOW, &GRZ, &HRV, &PLG, &FRZ,
+				                       &cf, &nf, &wf, &cs, &ns, &ws))
 			{
-				printf("Error in ploughing() from bgc()\n");
+				printf("Error in mgm_submodules() from bgc()\n");
 				ok=0;
 			}
-		 
-			/* FERTILIZING -  Hidy 2008 */
-	    	if (ok && fertilizing(&ctrl, &FRZ, &cs, &ns, &cf, &nf))
-			{
-				printf("Error in fertilizing() from bgc()\n");
-				ok=0;
-			}	
+			PROF_END(PT_MGM_SUBMODULES);
 
 			cs.CTDBc =  cs.litr1c_strg_HRV + cs.litr1c_strg_MOW + cs.litr1c_strg_THN + 
 			cs.litr2c_strg_HRV + cs.litr2c_strg_MOW + cs.litr2c_strg_THN + 
@@ -962,11 +947,13 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 			/* this is done last, with a special state update procedure, to
 			insure that pools don't go negative due to mortality fluxes
 			conflicting with other proportional fluxes */
+			PROF_BEGIN(PT_MORTALITY);
 			if (ok && mortality(&ctrl, &epc, &cs, &cf, &ns, &nf, simyr))
 			{
 				printf("Error in mortality() from bgc()\n");
 				ok=0;
 			}
+			PROF_END(PT_MORTALITY);
 			
 #ifdef DEBUG
 			printf("%d\t%d\tdone mortality\n",simyr,yday);
@@ -989,67 +976,32 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
                         This is a special state variable update routine, done after the other fluxes and states are
                         reconciled in order to avoid negative sminn (nleaching is included) */
 
+			PROF_BEGIN(PT_SMINN);
 			if (ok && multilayer_sminn(&epc, &sitec, &epv, &ns, &nf, &ws, &wf))
 			{
 				printf("Error in multilayer_sminn() from bgc()\n");
 				ok=0;
 			}
+			PROF_END(PT_SMINN);
 			
 #ifdef DEBUG
 			printf("%d\t%d\tdone multilayer_sminn\n",simyr,yday);
 #endif
 
 			/* Hidy 2013 - test again for very low state variable values and force them
-				to 0.0 to avoid rounding and floating point overflow errors */
-			if (ok && precision_control(&ws, &cs, &ns))
+				to 0.0 to avoid rounding and floating point overflow errors, then test for
+				water, carbon and nitrogen balance */
+			PROF_BEGIN(PT_BALANCE);
+			if (ok && check_balance(&ws, &cs, &ns, first_balance))
 			{
-				printf("Error in call to precision_control() from bgc()\n");
-				ok=0;
-			} 
-				
-#ifdef DEBUG
-				printf("%d\t%d\tdone precision_control\n",simyr,yday);
-#endif
-
-
-			/* test for water balance*/
-			if (ok && check_water_balance(&ws, first_balance))
-			{
-				printf("Error in check_water_balance() from bgc()\n");
+				printf("Error in check_balance() from bgc()\n");
 				printf("%d\n",metday);
 				ok=0;
 			}
-			 
-#ifdef DEBUG
-			printf("%d\t%d\tdone water balance\n",simyr,yday);
-#endif
-
-	
-                         /* test for carbon balance */
-			if (ok  && check_carbon_balance(&cs, first_balance))
-			{
-				printf("Error in check_carbon_balance() from bgc()\n");
-				printf("%d\n",metday);
-				ok=0;
-			}
-	
-		
+			PROF_END(PT_BALANCE);
 			
 #ifdef DEBUG
-			printf("%d\t%d\tdone carbon balance\n",simyr,yday); 
-#endif
-
-			/* test for nitrogen balance -  modified by Hidy 2008 */
-			if (ok && check_nitrogen_balance(&ns, first_balance))
-			{
-				printf("Error in check_nitrogen_balance() from bgc()\n");
-				printf("%d\n",metday);
-				ok=0;
-			}
-			
-			
-#ifdef DEBUG
-			printf("%d\t%d\tdone nitrogen balance\n",simyr,yday);
+			printf("%d\t%d\tdone balance\n",simyr,yday);
 #endif
 		
 
@@ -1067,7 +1019,10 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 
 	          
 		
+		PROF_END(PT_DAY);
 	}
+		TRACE_END_YEAR("transient year", ctrl.simstartyear+simyr);
+		if (runstatus_on) runstatus_year(simyr+1, &ctrl, bgcout);
 }
 	bgcin->ws = ws;
 	bgcin->cs = cs;
@@ -1089,6 +1044,14 @@ int transient_bgc(bgcin_struct* bgcin, bgcout_struct* bgcout)
 
 
 	
+	/* free memory of the output arrays */
+	if (dayout) mem_free(dayarr);
+	if (ctrl.domonavg) mem_free(monavgarr);
+	if (ctrl.doannavg) mem_free(annavgarr);
+	if (ctrl.doannual) mem_free(annarr);
+	mem_free(output_map);
+	mgm_calendar_free(&mgmcal);
+
 	/* print timing info if error */
 	if (!ok)
 	{